@@ -27,6 +27,7 @@ Rectangle {
     signal deleteFileClicked()
     signal fileClicked()
     signal openLocationClicked()
+    signal historyClicked()
     signal checkboxClicked()
     signal addToGitignore(string pattern)
 
@@ -72,6 +73,12 @@ Rectangle {
             text: "查看差异"
             onTriggered: root.fileClicked()
         }
+
+        MenuItem {
+            text: "查看文件历史"
+            visible: !root.isNewFile
+            onTriggered: root.historyClicked()
+        }
         
         MenuSeparator {}
         
@@ -93,6 +93,7 @@ Item {
     signal discardFile(string path)
     signal fileClicked(string path, bool staged)
     signal openFileLocation(string path)
+    signal showFileHistory(string path)
     signal deleteNewFile(string path)
     signal addToGitignore(string pattern)
     signal openGitignoreManager()
@@ -532,6 +533,7 @@ Item {
                     onDeleteFileClicked: root.deleteNewFile(modelData.path)
                     onFileClicked: root.fileClicked(modelData.path, root.isStaged)
                     onOpenLocationClicked: root.openFileLocation(modelData.path)
+                    onHistoryClicked: root.showFileHistory(modelData.path)
                     onAddToGitignore: (pattern) => root.addToGitignore(pattern)
                 }
 
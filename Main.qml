@@ -492,7 +492,7 @@ ApplicationWindow {
         onRemoteFilesNeedRefresh: {
             // Auto refresh remote files list after file operations
             if (remoteFileBrowserDrawer.opened) {
-                gitManager.loadRemoteFiles(gitManager.remoteCurrentPath)
+                gitManager.loadRemoteFiles(gitManager.remoteCurrentPath, true)
             }
         }
         onIsValidRepoChanged: {
@@ -1782,29 +1782,106 @@ ApplicationWindow {
         }
     }
 
-    // Diff dialog
-    property string diffDialogPath: ""
-    property bool diffDialogStaged: false
-    property var diffDialogData: []
-    
+    // Diff dialog - lines come from gitManager.diff page by page
+    function openDiffDialog(path, staged) {
+        gitManager.diff.open(path, staged)
+        diffDialog.open()
+    }
+
+    // Rich text for a diff line with its intra-line changes (model.spans) highlighted
+    function diffSpanHtml(content, spans, color) {
+        function escape(s) {
+            return s.replace(/&/g, "&amp;").replace(/</g, "&lt;").replace(/>/g, "&gt;")
+        }
+        var html = ""
+        var pos = 0
+        for (var i = 0; i < spans.length; i++) {
+            var span = spans[i]
+            html += escape(content.substring(pos, span.start))
+            html += "<span style=\"background-color:" + color + "\">"
+                    + escape(content.substr(span.start, span.length)) + "</span>"
+            pos = span.start + span.length
+        }
+        html += escape(content.substring(pos))
+        return "<span style=\"white-space:pre-wrap\">" + html + "</span>"
+    }
+
+    // One half of a side-by-side diff row (diff dialog split view)
+    component DiffSide: Rectangle {
+        id: side
+        property string type
+        property int lineNum
+        property string content
+        property var spans: []
+        property bool moved
+
+        clip: true
+        color: {
+            if (type === "header") return "#dbeafe"
+            if (type === "filler") return "#f3f4f6"
+            if (moved) return "#ede9fe"
+            if (type === "add") return "#dcfce7"
+            if (type === "delete") return "#fee2e2"
+            return "transparent"
+        }
+
+        Text {
+            id: sideNumber
+            x: 6
+            width: 40
+            anchors.verticalCenter: parent.verticalCenter
+            text: side.lineNum > 0 ? side.lineNum : ""
+            font.family: "Consolas, Monaco, monospace"
+            font.pixelSize: 12
+            color: "#9ca3af"
+            horizontalAlignment: Text.AlignRight
+        }
+
+        Text {
+            anchors.left: sideNumber.right
+            anchors.leftMargin: 10
+            anchors.right: parent.right
+            anchors.verticalCenter: parent.verticalCenter
+            text: side.spans.length > 0
+                  ? window.diffSpanHtml(side.content, side.spans,
+                                        side.type === "add" ? "#86efac" : "#fca5a5")
+                  : side.content
+            textFormat: side.spans.length > 0 ? Text.RichText : Text.PlainText
+            wrapMode: Text.NoWrap
+            font.family: "Consolas, Monaco, monospace"
+            font.pixelSize: 12
+            color: {
+                if (side.type === "header") return "#1d4ed8"
+                if (side.moved) return "#5b21b6"
+                if (side.type === "add") return "#166534"
+                if (side.type === "delete") return "#991b1b"
+                return "#374151"
+            }
+        }
+    }
+
     Dialog {
         id: diffDialog
+        // Side-by-side layout comes from gitManager.diffSplit, built on the same parsed lines
+        property bool splitView: false
         title: ""
         anchors.centerIn: parent
-        width: Math.min(800, window.width - 80)
+        width: Math.min(splitView ? 1200 : 800, window.width - 80)
         height: Math.min(600, window.height - 100)
         modal: true
         standardButtons: Dialog.NoButton
         padding: 0
         topPadding: 0
 
+        onClosed: gitManager.diff.clear()
+
         background: Rectangle {
             color: "#F8FBFE"
             radius: 12
         }
 
         header: MacTitleBar {
-            title: "文件差异 - " + diffDialogPath
+            title: "文件差异 - " + gitManager.diff.filePath
             onCloseClicked: diffDialog.close()
         }
 
@@ -1877,11 +1954,56 @@ ApplicationWindow {
                             anchors.verticalCenter: parent.verticalCenter
                         }
                     }
+
+                    Row {
+                        spacing: 6
+                        visible: diffDialog.splitView
+                        Rectangle {
+                            width: 12
+                            height: 12
+                            radius: 2
+                            color: "#ede9fe"
+                            border.color: "#8b5cf6"
+                            border.width: 1
+                            anchors.verticalCenter: parent.verticalCenter
+                        }
+                        Text {
+                            text: "移动"
+                            font.pixelSize: 12
+                            color: "#5b21b6"
+                            anchors.verticalCenter: parent.verticalCenter
+                        }
+                    }
                     
                     Item { Layout.fillWidth: true }
+
+                    // Unified / side-by-side switch
+                    Row {
+                        spacing: 10
+                        Repeater {
+                            model: [{ label: "统一", split: false }, { label: "并排", split: true }]
+                            delegate: Text {
+                                required property var modelData
+                                text: modelData.label
+                                font.pixelSize: 12
+                                font.bold: diffDialog.splitView === modelData.split
+                                color: diffDialog.splitView === modelData.split ? "#3b82f6"
+                                       : (modeArea.containsMouse ? "#374151" : "#9ca3af")
+
+                                MouseArea {
+                                    id: modeArea
+                                    anchors.fill: parent
+                                    anchors.margins: -4
+                                    hoverEnabled: true
+                                    cursorShape: Qt.PointingHandCursor
+                                    onClicked: diffDialog.splitView = modelData.split
+                                }
+                            }
+                        }
+                    }
                     
                     Text {
-                        text: diffDialogStaged ? "已暂存" : "未暂存"
+                        text: (gitManager.diff.loading ? "加载中... " : "") + (gitManager.diff.staged ? "已暂存" : "未暂存")
                         font.pixelSize: 11
                         color: "#6b7280"
                     }
@@ -1901,8 +2023,10 @@ ApplicationWindow {
                         id: diffListView
                         anchors.fill: parent
                         anchors.margins: 1
-                        model: diffDialogData
+                        visible: !diffDialog.splitView
+                        model: gitManager.diff
                         clip: true
+                        reuseItems: true
                         
                         ScrollBar.vertical: ScrollBar {
                             policy: ScrollBar.AsNeeded
@@ -1912,9 +2036,9 @@ ApplicationWindow {
                             width: diffListView.width
                             height: diffLineText.implicitHeight + 8
                             color: {
-                                if (modelData.type === "add") return "#dcfce7"
-                                if (modelData.type === "delete") return "#fee2e2"
-                                if (modelData.type === "header") return "#dbeafe"
+                                if (model.type === "add") return "#dcfce7"
+                                if (model.type === "delete") return "#fee2e2"
+                                if (model.type === "header") return "#dbeafe"
                                 return "transparent"
                             }
                             
@@ -1929,7 +2053,7 @@ ApplicationWindow {
                                 // Line number
                                 Text {
                                     width: 40
-                                    text: modelData.lineNum > 0 ? modelData.lineNum : ""
+                                    text: model.lineNum > 0 ? model.lineNum : ""
                                     font.family: "Consolas, Monaco, monospace"
                                     font.pixelSize: 12
                                     color: "#9ca3af"
@@ -1940,16 +2064,16 @@ ApplicationWindow {
                                 Text {
                                     width: 16
                                     text: {
-                                        if (modelData.type === "add") return "+"
-                                        if (modelData.type === "delete") return "-"
+                                        if (model.type === "add") return "+"
+                                        if (model.type === "delete") return "-"
                                         return " "
                                     }
                                     font.family: "Consolas, Monaco, monospace"
                                     font.pixelSize: 12
                                     font.bold: true
                                     color: {
-                                        if (modelData.type === "add") return "#22c55e"
-                                        if (modelData.type === "delete") return "#ef4444"
+                                        if (model.type === "add") return "#22c55e"
+                                        if (model.type === "delete") return "#ef4444"
                                         return "#9ca3af"
                                     }
                                 }
@@ -1957,14 +2081,19 @@ ApplicationWindow {
                                 // Content
                                 Text {
                                     id: diffLineText
+                                    readonly property var spans: model.spans
                                     width: parent.width - 76
-                                    text: modelData.content || ""
+                                    text: spans.length > 0
+                                          ? window.diffSpanHtml(model.content, spans,
+                                                                model.type === "add" ? "#86efac" : "#fca5a5")
+                                          : model.content
+                                    textFormat: spans.length > 0 ? Text.RichText : Text.PlainText
                                     font.family: "Consolas, Monaco, monospace"
                                     font.pixelSize: 12
                                     color: {
-                                        if (modelData.type === "add") return "#166534"
-                                        if (modelData.type === "delete") return "#991b1b"
-                                        if (modelData.type === "header") return "#1d4ed8"
+                                        if (model.type === "add") return "#166534"
+                                        if (model.type === "delete") return "#991b1b"
+                                        if (model.type === "header") return "#1d4ed8"
                                         return "#374151"
                                     }
                                     wrapMode: Text.WrapAnywhere
@@ -1975,8 +2104,76 @@ ApplicationWindow {
                         // Empty state
                         Text {
                             anchors.centerIn: parent
-                            visible: diffDialogData.length === 0
-                            text: "没有差异内容"
+                            visible: diffListView.count === 0 && !gitManager.diff.loading
+                            text: gitManager.diff.error !== "" ? gitManager.diff.error
+                                  : gitManager.diff.binary ? "二进制文件，不显示差异" : "没有差异内容"
+                            font.pixelSize: 14
+                            color: "#9ca3af"
+                        }
+                    }
+
+                    // Side-by-side: one row holds both sides, so they always scroll together.
+                    // Rows have a fixed height (no wrapping) to keep 100k-row diffs smooth.
+                    ListView {
+                        id: diffSplitListView
+                        anchors.fill: parent
+                        anchors.margins: 1
+                        visible: diffDialog.splitView
+                        model: diffDialog.splitView ? gitManager.diffSplit : null
+                        clip: true
+                        reuseItems: true
+
+                        ScrollBar.vertical: ScrollBar {
+                            policy: ScrollBar.AsNeeded
+                        }
+
+                        delegate: Row {
+                            required property string oldType
+                            required property int oldLineNum
+                            required property string oldContent
+                            required property var oldSpans
+                            required property bool oldMoved
+                            required property string newType
+                            required property int newLineNum
+                            required property string newContent
+                            required property var newSpans
+                            required property bool newMoved
+
+                            width: diffSplitListView.width
+                            height: 22
+
+                            DiffSide {
+                                width: parent.width / 2
+                                height: parent.height
+                                type: oldType
+                                lineNum: oldLineNum
+                                content: oldContent
+                                spans: oldSpans
+                                moved: oldMoved
+                            }
+
+                            Rectangle {
+                                width: 1
+                                height: parent.height
+                                color: "#e5e7eb"
+                            }
+
+                            DiffSide {
+                                width: parent.width / 2 - 1
+                                height: parent.height
+                                type: newType
+                                lineNum: newLineNum
+                                content: newContent
+                                spans: newSpans
+                                moved: newMoved
+                            }
+                        }
+
+                        Text {
+                            anchors.centerIn: parent
+                            visible: diffSplitListView.count === 0 && !gitManager.diff.loading
+                            text: gitManager.diff.error !== "" ? gitManager.diff.error
+                                  : gitManager.diff.binary ? "二进制文件，不显示差异" : "没有差异内容"
                             font.pixelSize: 14
                             color: "#9ca3af"
                         }
@@ -3596,13 +3793,9 @@ ApplicationWindow {
                     deleteNewFilePath = path
                     deleteNewFileConfirmDialog.open()
                 }
-                onFileClicked: (path, staged) => {
-                    diffDialogPath = path
-                    diffDialogStaged = staged
-                    diffDialogData = gitManager.getFileDiff(path, staged)
-                    diffDialog.open()
-                }
+                onFileClicked: (path, staged) => openDiffDialog(path, staged)
                 onOpenFileLocation: (path) => gitManager.openFileLocation(path)
+                onShowFileHistory: (path) => openFileHistory(path)
                 onAddToGitignore: (pattern) => gitManager.addToGitignore(pattern)
                 onOpenGitignoreManager: gitignoreDialog.open()
             }
@@ -3626,13 +3819,9 @@ ApplicationWindow {
                     gitManager.setBulkOperationMode(true)
                     gitManager.unstageAll()
                 }
-                onFileClicked: (path, staged) => {
-                    diffDialogPath = path
-                    diffDialogStaged = staged
-                    diffDialogData = gitManager.getFileDiff(path, staged)
-                    diffDialog.open()
-                }
+                onFileClicked: (path, staged) => openDiffDialog(path, staged)
                 onOpenFileLocation: (path) => gitManager.openFileLocation(path)
+                onShowFileHistory: (path) => openFileHistory(path)
                 onOpenGitignoreManager: gitignoreDialog.open()
             }
         }
@@ -4540,8 +4729,8 @@ ApplicationWindow {
         // Loading spinner container
         Rectangle {
             anchors.centerIn: parent
-            width: 120
-            height: 120
+            width: gitManager.canCancel ? 240 : 120
+            height: loadingColumn.implicitHeight + 40
             radius: 16
             color: isDarkMode ? "#2a2a2a" : "#ffffff"
             border.color: isDarkMode ? "#444444" : "#e0e0e0"
@@ -4557,6 +4746,7 @@ ApplicationWindow {
             }
 
             Column {
+                id: loadingColumn
                 anchors.centerIn: parent
                 spacing: 16
 
@@ -4586,11 +4776,41 @@ ApplicationWindow {
                 }
 
                 Text {
-                    text: "处理中..."
+                    text: gitManager.operationName !== "" ? gitManager.operationName + "中..." : "处理中..."
                     font.pixelSize: 14
                     color: theme.text
                     anchors.horizontalCenter: parent.horizontalCenter
                 }
+
+                // 进度（git --progress 输出的阶段和百分比）
+                Text {
+                    visible: gitManager.progressText !== ""
+                    text: gitManager.progressText
+                    font.pixelSize: 12
+                    color: theme.textDim
+                    width: 200
+                    elide: Text.ElideRight
+                    horizontalAlignment: Text.AlignHCenter
+                    anchors.horizontalCenter: parent.horizontalCenter
+                }
+
+                ProgressBar {
+                    visible: gitManager.canCancel && gitManager.progressPercent >= 0
+                    from: 0
+                    to: 100
+                    value: gitManager.progressPercent
+                    width: 200
+                    anchors.horizontalCenter: parent.horizontalCenter
+                }
+
+                ActionButton {
+                    visible: gitManager.canCancel
+                    text: "取消"
+                    icon: "\uf00d"
+                    fontFamily: fontAwesome.name
+                    anchors.horizontalCenter: parent.horizontalCenter
+                    onClicked: gitManager.cancelOperation()
+                }
             }
         }
 
@@ -4607,17 +4827,14 @@ ApplicationWindow {
         edge: Qt.RightEdge
 
         property string historySearchFilter: ""
-        property var filteredHistory: {
-            if (!historySearchFilter || historySearchFilter.trim() === "") {
-                return gitManager.commitHistory
-            }
-            var keyword = historySearchFilter.toLowerCase()
-            return gitManager.commitHistory.filter(function(commit) {
-                return commit.message.toLowerCase().indexOf(keyword) >= 0 ||
-                       commit.author.toLowerCase().indexOf(keyword) >= 0 ||
-                       commit.shortHash.toLowerCase().indexOf(keyword) >= 0
-            })
+
+        // 搜索由 git 在整个历史中完成，输入停顿后再重新读取
+        Timer {
+            id: historySearchTimer
+            interval: 300
+            onTriggered: gitManager.history.filter = commitHistoryDrawer.historySearchFilter
         }
+        onHistorySearchFilterChanged: historySearchTimer.restart()
 
         background: Rectangle {
             color: "#F8FBFE"
@@ -4669,7 +4886,7 @@ ApplicationWindow {
 
                         Text {
                             anchors.fill: parent
-                            text: "搜索提交信息、作者..."
+                            text: "搜索提交信息、作者、文件路径、提交 ID..."
                             font.pixelSize: 13
                             color: "#9ca3af"
                             visible: !historySearchField.text && !historySearchField.activeFocus
@@ -4708,7 +4925,8 @@ ApplicationWindow {
                 
                 Text {
                     anchors.verticalCenter: parent.verticalCenter
-                    text: gitManager.currentBranch + " · " + commitHistoryDrawer.filteredHistory.length + " 条记录"
+                    text: gitManager.currentBranch + " · " + gitManager.history.count
+                          + (gitManager.history.finished ? "" : "+") + " 条记录"
                     font.pixelSize: 12
                     color: "#6b7280"
                 }
@@ -4750,7 +4968,7 @@ ApplicationWindow {
                     id: commitListView
                     anchors.fill: parent
                     anchors.margins: 4
-                    model: commitHistoryDrawer.filteredHistory
+                    model: gitManager.history
                     spacing: 6
 
                     ScrollBar.vertical: ScrollBar {
@@ -4766,17 +4984,36 @@ ApplicationWindow {
 
                         property bool isFirst: index === 0
                         property bool isExpanded: false
+                        // 供内层 Repeater 使用（在 Repeater 内部 model 指向它自己的属性）
+                        property var files: model.files
 
                         HoverHandler {
                             id: commitHover
                         }
 
+                        // 提交图：上下各伸出半个列表间距，与相邻行的线接上；分支过多时只显示前 12 条泳道
+                        CommitGraphItem {
+                            id: commitGraph
+                            anchors.left: parent.left
+                            anchors.leftMargin: 6
+                            y: -commitListView.spacing / 2
+                            width: model.graph.lane >= 0 ? Math.min(gitManager.history.graphLanes, 12) * laneSpacing : 0
+                            height: parent.height + commitListView.spacing
+                            visible: width > 0
+                            clip: true
+                            graph: model.graph
+                            laneSpacing: 14
+                            // 与第一行的提交 id 标签垂直居中
+                            nodeY: commitListView.spacing / 2 + 12 + 11
+                        }
+
                         ColumnLayout {
                             id: commitContent
                             anchors.left: parent.left
                             anchors.right: parent.right
                             anchors.top: parent.top
                             anchors.margins: 12
+                            anchors.leftMargin: 12 + (commitGraph.visible ? commitGraph.width : 0)
                             spacing: 8
 
                             // Header row - hash, branch, time, actions
@@ -4794,7 +5031,7 @@ ApplicationWindow {
                                     Text {
                                         id: hashText
                                         anchors.centerIn: parent
-                                        text: modelData.shortHash
+                                        text: model.shortHash
                                         font.pixelSize: 11
                                         font.family: "Consolas"
                                         font.bold: true
@@ -4832,7 +5069,7 @@ ApplicationWindow {
 
                                 // Full date and time
                                 Text {
-                                    text: modelData.fullDate || modelData.relativeDate
+                                    text: model.fullDate || model.relativeDate
                                     font.pixelSize: 11
                                     color: theme.textDim
                                     Layout.fillWidth: true
@@ -4841,11 +5078,11 @@ ApplicationWindow {
 
                                 // Relative time
                                 Text {
-                                    text: "(" + modelData.relativeDate + ")"
+                                    text: "(" + model.relativeDate + ")"
                                     font.pixelSize: 10
                                     color: theme.textDim
                                     opacity: 0.7
-                                    visible: modelData.fullDate !== undefined
+                                    visible: model.fullDate !== ""
                                 }
 
                                 // Fixed action buttons on the right
@@ -4876,7 +5113,7 @@ ApplicationWindow {
 
                                         TapHandler {
                                             onTapped: {
-                                                editCommitMessage = modelData.message
+                                                editCommitMessage = model.message
                                                 editCommitDialog.open()
                                             }
                                         }
@@ -4885,7 +5122,7 @@ ApplicationWindow {
                                         MouseArea {
                                             anchors.fill: parent
                                             onClicked: {
-                                                editCommitMessage = modelData.message
+                                                editCommitMessage = model.message
                                                 editCommitDialog.open()
                                             }
                                             cursorShape: Qt.PointingHandCursor
@@ -4896,6 +5133,76 @@ ApplicationWindow {
                                         ToolTip.delay: 500
                                     }
 
+                                    // Full diff of this commit
+                                    Rectangle {
+                                        visible: commitHover.hovered
+                                        width: 28
+                                        height: 28
+                                        radius: 6
+                                        color: commitDiffHover.hovered ? theme.surfaceLight : "transparent"
+
+                                        Text {
+                                            anchors.centerIn: parent
+                                            text: "\uf1c9"
+                                            font.family: fontAwesome.name
+                                            font.pixelSize: 12
+                                            color: theme.primary
+                                        }
+
+                                        HoverHandler {
+                                            id: commitDiffHover
+                                            cursorShape: Qt.PointingHandCursor
+                                        }
+
+                                        // Block mouse events from propagating
+                                        MouseArea {
+                                            anchors.fill: parent
+                                            onClicked: {
+                                                gitManager.commitDiff.open(model.hash)
+                                                commitDiffDrawer.open()
+                                            }
+                                        }
+
+                                        ToolTip.visible: commitDiffHover.hovered
+                                        ToolTip.text: "查看完整差异"
+                                        ToolTip.delay: 500
+                                    }
+
+                                    // Browse files at this commit
+                                    Rectangle {
+                                        visible: commitHover.hovered
+                                        width: 28
+                                        height: 28
+                                        radius: 6
+                                        color: browseCommitHover.hovered ? theme.surfaceLight : "transparent"
+
+                                        Text {
+                                            anchors.centerIn: parent
+                                            text: "\uf07c"
+                                            font.family: fontAwesome.name
+                                            font.pixelSize: 12
+                                            color: theme.primary
+                                        }
+
+                                        HoverHandler {
+                                            id: browseCommitHover
+                                            cursorShape: Qt.PointingHandCursor
+                                        }
+
+                                        // Block mouse events from propagating
+                                        MouseArea {
+                                            anchors.fill: parent
+                                            onClicked: {
+                                                gitManager.revisionBrowser.open(model.hash)
+                                                revisionBrowserDrawer.open()
+                                            }
+                                        }
+
+                                        ToolTip.visible: browseCommitHover.hovered
+                                        ToolTip.text: "浏览此版本的文件"
+                                        ToolTip.delay: 500
+                                    }
+
                                     // Revert button
                                     Rectangle {
                                         visible: commitHover.hovered
@@ -4921,8 +5228,8 @@ ApplicationWindow {
                                         MouseArea {
                                             anchors.fill: parent
                                             onClicked: {
-                                                revertCommitHash = modelData.hash
-                                                revertCommitMsg = modelData.message
+                                                revertCommitHash = model.hash
+                                                revertCommitMsg = model.message
                                                 revertCommitDialog.open()
                                             }
                                         }
@@ -4955,7 +5262,7 @@ ApplicationWindow {
 
                                     Text {
                                         id: msgText
-                                        text: modelData.message
+                                        text: model.message
                                         font.pixelSize: 13
                                         font.bold: true
                                         color: theme.text
@@ -4976,7 +5283,7 @@ ApplicationWindow {
                                     color: theme.secondary
                                 }
                                 Text {
-                                    text: modelData.author
+                                    text: model.author
                                     font.pixelSize: 11
                                     color: theme.secondary
                                 }
@@ -4986,7 +5293,7 @@ ApplicationWindow {
                             ColumnLayout {
                                 Layout.fillWidth: true
                                 spacing: 4
-                                visible: !modelData.isMessageOnly
+                                visible: !model.isMessageOnly
 
                                 // Files header - clickable to expand
                                 Rectangle {
@@ -5025,11 +5332,25 @@ ApplicationWindow {
                                         }
 
                                         Text {
-                                            text: modelData.fileCount + " 个文件变更"
+                                            text: model.fileCount + " 个文件变更"
                                             font.pixelSize: 11
                                             color: theme.text
                                         }
 
+                                        Text {
+                                            text: "+" + model.additions
+                                            font.pixelSize: 10
+                                            font.family: "Consolas"
+                                            color: theme.success
+                                        }
+
+                                        Text {
+                                            text: "-" + model.deletions
+                                            font.pixelSize: 10
+                                            font.family: "Consolas"
+                                            color: theme.error
+                                        }
+
                                         Item { Layout.fillWidth: true }
 
                                         Text {
@@ -5049,7 +5370,7 @@ ApplicationWindow {
                                     visible: commitDelegate.isExpanded
 
                                     Repeater {
-                                        model: modelData.files
+                                        model: commitDelegate.files
 
                                         Rectangle {
                                             Layout.fillWidth: true
@@ -5105,6 +5426,15 @@ ApplicationWindow {
                                                     elide: Text.ElideMiddle
                                                     Layout.fillWidth: true
                                                 }
+
+                                                // Line stats
+                                                Text {
+                                                    text: modelData.isBinary ? "二进制"
+                                                          : "+" + modelData.additions + " -" + modelData.deletions
+                                                    font.pixelSize: 10
+                                                    font.family: "Consolas"
+                                                    color: theme.textDim
+                                                }
                                             }
                                         }
                                     }
@@ -5117,7 +5447,7 @@ ApplicationWindow {
                                 height: 28
                                 radius: 4
                                 color: Qt.rgba(59, 130, 246, 0.1)
-                                visible: modelData.isMessageOnly
+                                visible: model.isMessageOnly
 
                                 RowLayout {
                                     anchors.fill: parent
@@ -5145,7 +5475,7 @@ ApplicationWindow {
                     // Empty state
                     Rectangle {
                         anchors.centerIn: parent
-                        visible: gitManager.commitHistory.length === 0 && !gitManager.isLoading
+                        visible: gitManager.history.count === 0 && !gitManager.history.loading
                         color: "transparent"
 
                         ColumnLayout {
@@ -5516,7 +5846,7 @@ ApplicationWindow {
                             anchors.margins: -6
                             hoverEnabled: true
                             cursorShape: Qt.PointingHandCursor
-                            onClicked: gitManager.loadRemoteFiles(gitManager.remoteCurrentPath)
+                            onClicked: gitManager.loadRemoteFiles(gitManager.remoteCurrentPath, true)
                         }
                     }
                 }
@@ -5771,6 +6101,39 @@ ApplicationWindow {
                                 ToolTip.delay: 500
                             }
 
+                            // File history button (for files only)
+                            Rectangle {
+                                visible: !remoteFileDelegate.isDir && remoteFileHover.hovered
+                                width: 28
+                                height: 28
+                                radius: 6
+                                color: fileHistoryBtnArea.containsMouse ? theme.surfaceLight : "transparent"
+                                Layout.alignment: Qt.AlignVCenter
+
+                                Text {
+                                    anchors.centerIn: parent
+                                    text: "\uf1da"
+                                    font.family: fontAwesome.name
+                                    font.pixelSize: 12
+                                    color: theme.primary
+                                }
+
+                                MouseArea {
+                                    id: fileHistoryBtnArea
+                                    anchors.fill: parent
+                                    hoverEnabled: true
+                                    cursorShape: Qt.PointingHandCursor
+                                    onClicked: function(mouse) {
+                                        mouse.accepted = true
+                                        openFileHistory(modelData.path)
+                                    }
+                                }
+
+                                ToolTip.visible: fileHistoryBtnArea.containsMouse
+                                ToolTip.text: "文件历史"
+                                ToolTip.delay: 500
+                            }
+
                             // Rename button
                             Rectangle {
                                 id: renameBtn
@@ -5882,82 +6245,876 @@ ApplicationWindow {
         }
     }
 
-    // Remote File Editor Dialog
-    property string remoteEditFilePath: ""
-    property string remoteEditOriginalContent: ""  // 存储原始内容用于比较
+    // Commit diff - full patch of one commit, one collapsible section per file
+    Drawer {
+        id: commitDiffDrawer
+        width: Math.min(parent.width - 80, 900)
+        height: parent.height
+        edge: Qt.RightEdge
 
-    Dialog {
-        id: remoteFileEditorDialog
-        title: ""
-        anchors.centerIn: parent
-        width: Math.min(parent.width - 60, 650)
-        height: Math.min(parent.height - 60, 500)
-        modal: true
-        standardButtons: Dialog.NoButton
+        property var diff: gitManager.commitDiff
 
-        onOpened: {
-            // 对话框打开时保存原始内容
-            // 使用延迟确保fileContent已加载
-            Qt.callLater(function() {
-                remoteEditOriginalContent = gitManager.fileContent
-                console.log("Original content saved, length:", remoteEditOriginalContent.length)
-            })
-        }
+        onClosed: diff.clear()
 
         background: Rectangle {
             color: "#F8FBFE"
-            radius: 12
         }
 
-        header: MacTitleBar {
-            title: "编辑文件"
-            onCloseClicked: remoteFileEditorDialog.close()
-        }
+        ColumnLayout {
+            anchors.fill: parent
+            spacing: 0
 
-        contentItem: ColumnLayout {
-            spacing: 12
+            MacTitleBar {
+                Layout.fillWidth: true
+                title: "提交差异"
+                onCloseClicked: commitDiffDrawer.close()
+            }
 
-            // File path
             RowLayout {
+                Layout.fillWidth: true
+                Layout.margins: 16
+                Layout.topMargin: 4
                 spacing: 8
+
                 Text {
-                    text: "\uf15b"
-                    font.family: fontAwesome.name
+                    text: commitDiffDrawer.diff.commitHash.substring(0, 7)
                     font.pixelSize: 12
-                    color: "#6b7280"
+                    font.family: "Consolas"
+                    font.bold: true
+                    color: theme.primary
                 }
+
                 Text {
-                    text: remoteEditFilePath
+                    text: commitDiffDrawer.diff.fileCount + " 个文件" + (commitDiffDrawer.diff.loading ? "，加载中..." : "")
                     font.pixelSize: 12
-                    color: "#6b7280"
-                    elide: Text.ElideMiddle
+                    color: theme.textDim
                     Layout.fillWidth: true
                 }
             }
 
-            // Editor
             Rectangle {
                 Layout.fillWidth: true
                 Layout.fillHeight: true
+                Layout.margins: 16
+                Layout.topMargin: 0
                 radius: 8
                 color: "#ffffff"
                 border.color: "#e5e7eb"
                 border.width: 1
+                clip: true
 
-                ScrollView {
+                ListView {
+                    id: commitDiffListView
                     anchors.fill: parent
-                    anchors.margins: 8
+                    anchors.margins: 1
+                    model: commitDiffDrawer.diff
+                    clip: true
 
-                    TextArea {
-                        id: remoteFileEditor
-                        text: gitManager.fileContent
-                        color: "#1a1a1a"
-                        font.family: "Consolas, Monaco, monospace"
-                        font.pixelSize: 13
-                        wrapMode: TextArea.NoWrap
-                        selectByMouse: true
-                        background: null
-                    }
+                    ScrollBar.vertical: ScrollBar {
+                        policy: ScrollBar.AsNeeded
+                    }
+
+                    delegate: Rectangle {
+                        width: commitDiffListView.width
+                        height: model.type === "file" ? 34 : commitDiffLineText.implicitHeight + 4
+                        color: {
+                            if (model.type === "file") return fileHeaderHover.hovered ? "#eef2f7" : "#f3f4f6"
+                            if (model.type === "add") return "#dcfce7"
+                            if (model.type === "delete") return "#fee2e2"
+                            if (model.type === "header") return "#dbeafe"
+                            return "transparent"
+                        }
+
+                        // File header: click to expand / collapse
+                        RowLayout {
+                            visible: model.type === "file"
+                            anchors.fill: parent
+                            anchors.leftMargin: 10
+                            anchors.rightMargin: 10
+                            spacing: 8
+
+                            Text {
+                                text: model.binary ? "\uf1c6" : (model.expanded ? "\uf078" : "\uf054")
+                                font.family: fontAwesome.name
+                                font.pixelSize: 10
+                                color: theme.textDim
+                            }
+
+                            Text {
+                                text: model.status
+                                font.pixelSize: 11
+                                font.bold: true
+                                color: model.status === "A" ? theme.success : model.status === "D" ? theme.error : theme.warning
+                            }
+
+                            Text {
+                                text: model.oldPath !== "" ? model.oldPath + " → " + model.path : model.path
+                                font.pixelSize: 12
+                                font.family: "Consolas, Monaco, monospace"
+                                color: theme.text
+                                elide: Text.ElideMiddle
+                                Layout.fillWidth: true
+                            }
+
+                            Text {
+                                text: model.binary ? "二进制文件"
+                                      : model.fileLoading ? "加载中..."
+                                      : (!model.expanded && model.large ? "改动较多，点击展开" : "")
+                                font.pixelSize: 11
+                                color: theme.textDim
+                            }
+
+                            Text {
+                                visible: !model.binary
+                                text: "+" + model.additions
+                                font.pixelSize: 11
+                                color: theme.success
+                            }
+
+                            Text {
+                                visible: !model.binary
+                                text: "-" + model.deletions
+                                font.pixelSize: 11
+                                color: theme.error
+                            }
+                        }
+
+                        HoverHandler {
+                            id: fileHeaderHover
+                            enabled: model.type === "file"
+                            cursorShape: model.binary ? Qt.ArrowCursor : Qt.PointingHandCursor
+                        }
+
+                        TapHandler {
+                            enabled: model.type === "file"
+                            onTapped: commitDiffDrawer.diff.toggle(index)
+                        }
+
+                        // Patch line
+                        Row {
+                            visible: model.type !== "file"
+                            anchors.fill: parent
+                            anchors.leftMargin: 8
+                            anchors.rightMargin: 8
+                            anchors.topMargin: 2
+                            spacing: 12
+
+                            Text {
+                                width: 40
+                                text: model.lineNum > 0 ? model.lineNum : ""
+                                font.family: "Consolas, Monaco, monospace"
+                                font.pixelSize: 12
+                                color: "#9ca3af"
+                                horizontalAlignment: Text.AlignRight
+                            }
+
+                            Text {
+                                width: 16
+                                text: model.type === "add" ? "+" : (model.type === "delete" ? "-" : " ")
+                                font.family: "Consolas, Monaco, monospace"
+                                font.pixelSize: 12
+                                font.bold: true
+                                color: model.type === "add" ? "#22c55e" : (model.type === "delete" ? "#ef4444" : "#9ca3af")
+                            }
+
+                            Text {
+                                id: commitDiffLineText
+                                width: parent.width - 76
+                                text: model.type === "file" ? "" : model.content
+                                textFormat: Text.PlainText
+                                font.family: "Consolas, Monaco, monospace"
+                                font.pixelSize: 12
+                                color: {
+                                    if (model.type === "add") return "#166534"
+                                    if (model.type === "delete") return "#991b1b"
+                                    if (model.type === "header") return "#1d4ed8"
+                                    return "#374151"
+                                }
+                                wrapMode: Text.WrapAnywhere
+                            }
+                        }
+                    }
+                }
+
+                Text {
+                    anchors.centerIn: parent
+                    visible: commitDiffDrawer.diff.count === 0
+                    text: commitDiffDrawer.diff.error !== "" ? commitDiffDrawer.diff.error
+                          : commitDiffDrawer.diff.loading ? "加载中..." : "没有差异内容"
+                    font.pixelSize: 13
+                    color: theme.textDim
+                }
+            }
+        }
+    }
+
+    // File history - commits that touched one file, following renames
+    Drawer {
+        id: fileHistoryDrawer
+        width: 450
+        height: parent.height
+        edge: Qt.RightEdge
+
+        property var history: gitManager.fileHistory
+
+        background: Rectangle {
+            color: "#F8FBFE"
+        }
+
+        ColumnLayout {
+            anchors.fill: parent
+            spacing: 0
+
+            MacTitleBar {
+                Layout.fillWidth: true
+                title: "文件历史"
+                onCloseClicked: fileHistoryDrawer.close()
+            }
+
+            RowLayout {
+                Layout.fillWidth: true
+                Layout.margins: 16
+                Layout.topMargin: 4
+                spacing: 8
+
+                Text {
+                    text: "\uf15b"
+                    font.family: fontAwesome.name
+                    font.pixelSize: 12
+                    color: theme.textDim
+                }
+
+                Text {
+                    text: fileHistoryDrawer.history.path
+                    font.pixelSize: 12
+                    color: theme.text
+                    elide: Text.ElideMiddle
+                    Layout.fillWidth: true
+                }
+
+                Text {
+                    text: fileHistoryDrawer.history.count + (fileHistoryDrawer.history.finished ? "" : "+") + " 条记录"
+                    font.pixelSize: 11
+                    color: theme.textDim
+                }
+            }
+
+            Rectangle {
+                Layout.fillWidth: true
+                Layout.fillHeight: true
+                Layout.margins: 16
+                Layout.topMargin: 0
+                radius: 8
+                color: "#ffffff"
+                clip: true
+
+                ListView {
+                    id: fileHistoryListView
+                    anchors.fill: parent
+                    anchors.margins: 4
+                    model: fileHistoryDrawer.history
+                    spacing: 6
+
+                    delegate: Rectangle {
+                        id: fileCommitDelegate
+                        width: fileHistoryListView.width
+                        height: fileCommitContent.height + 20
+                        radius: 8
+                        color: fileCommitHover.hovered ? theme.surface : theme.surfaceLight
+
+                        // 只列出了这个文件的修改，第一项就是它（重命名时带有旧路径）
+                        property var change: model.files.length > 0 ? model.files[0] : null
+
+                        HoverHandler {
+                            id: fileCommitHover
+                        }
+
+                        ColumnLayout {
+                            id: fileCommitContent
+                            anchors.left: parent.left
+                            anchors.right: parent.right
+                            anchors.top: parent.top
+                            anchors.margins: 12
+                            spacing: 6
+
+                            RowLayout {
+                                Layout.fillWidth: true
+                                spacing: 8
+
+                                Rectangle {
+                                    width: fileHashText.width + 12
+                                    height: 22
+                                    radius: 4
+                                    color: Qt.rgba(74, 144, 217, 0.15)
+
+                                    Text {
+                                        id: fileHashText
+                                        anchors.centerIn: parent
+                                        text: model.shortHash
+                                        font.pixelSize: 11
+                                        font.family: "Consolas"
+                                        font.bold: true
+                                        color: theme.primary
+                                    }
+                                }
+
+                                Text {
+                                    text: model.fullDate || model.relativeDate
+                                    font.pixelSize: 11
+                                    color: theme.textDim
+                                    Layout.fillWidth: true
+                                    elide: Text.ElideRight
+                                }
+
+                                Text {
+                                    visible: fileCommitDelegate.change !== null && !fileCommitDelegate.change.isBinary
+                                    text: fileCommitDelegate.change ? "+" + fileCommitDelegate.change.additions : ""
+                                    font.pixelSize: 11
+                                    color: theme.success
+                                }
+
+                                Text {
+                                    visible: fileCommitDelegate.change !== null && !fileCommitDelegate.change.isBinary
+                                    text: fileCommitDelegate.change ? "-" + fileCommitDelegate.change.deletions : ""
+                                    font.pixelSize: 11
+                                    color: theme.error
+                                }
+                            }
+
+                            Text {
+                                text: model.message
+                                font.pixelSize: 13
+                                font.bold: true
+                                color: theme.text
+                                Layout.fillWidth: true
+                                wrapMode: Text.Wrap
+                            }
+
+                            Text {
+                                text: "\uf007  " + model.author
+                                font.family: fontAwesome.name
+                                font.pixelSize: 11
+                                color: theme.secondary
+                            }
+
+                            // 重命名：旧路径 → 新路径
+                            Text {
+                                visible: fileCommitDelegate.change !== null && fileCommitDelegate.change.oldPath !== ""
+                                text: fileCommitDelegate.change ? fileCommitDelegate.change.statusText + "：" + fileCommitDelegate.change.oldPath
+                                                                  + " → " + fileCommitDelegate.change.path : ""
+                                font.pixelSize: 11
+                                color: theme.warning
+                                Layout.fillWidth: true
+                                elide: Text.ElideMiddle
+                            }
+                        }
+                    }
+                }
+
+                Text {
+                    anchors.centerIn: parent
+                    visible: fileHistoryDrawer.history.count === 0
+                    text: fileHistoryDrawer.history.loading ? "加载中..." : "没有提交记录"
+                    font.pixelSize: 13
+                    color: theme.textDim
+                }
+            }
+        }
+    }
+
+    // Revision browser - browse files of any commit, branch or tag without checkout
+    Drawer {
+        id: revisionBrowserDrawer
+        width: 520
+        height: parent.height
+        edge: Qt.RightEdge
+
+        property var browser: gitManager.revisionBrowser
+
+        onClosed: browser.closePreview()
+
+        background: Rectangle {
+            color: "#F8FBFE"
+        }
+
+        ColumnLayout {
+            anchors.fill: parent
+            spacing: 0
+
+            // macOS style header
+            MacTitleBar {
+                Layout.fillWidth: true
+                title: "版本浏览"
+                onCloseClicked: revisionBrowserDrawer.close()
+            }
+
+            // Revision input
+            Rectangle {
+                Layout.fillWidth: true
+                Layout.leftMargin: 16
+                Layout.rightMargin: 16
+                Layout.topMargin: 8
+                height: 36
+                radius: 8
+                color: "#f9fafb"
+                border.color: revisionField.activeFocus ? "#3b82f6" : "#e5e7eb"
+                border.width: 1
+
+                RowLayout {
+                    anchors.fill: parent
+                    anchors.margins: 10
+                    spacing: 8
+
+                    Text {
+                        text: "\uf126"
+                        font.family: fontAwesome.name
+                        font.pixelSize: 12
+                        color: "#9ca3af"
+                    }
+
+                    TextInput {
+                        id: revisionField
+                        Layout.fillWidth: true
+                        font.pixelSize: 13
+                        color: "#1f2937"
+                        clip: true
+                        selectByMouse: true
+                        onAccepted: revisionBrowserDrawer.browser.open(text)
+
+                        Text {
+                            anchors.fill: parent
+                            text: "输入提交、分支或标签后回车..."
+                            font.pixelSize: 13
+                            color: "#9ca3af"
+                            visible: !revisionField.text && !revisionField.activeFocus
+                        }
+
+                        Connections {
+                            target: revisionBrowserDrawer.browser
+                            function onRevisionChanged() {
+                                if (!revisionField.activeFocus) {
+                                    revisionField.text = revisionBrowserDrawer.browser.revision
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+
+            // Revision info
+            Rectangle {
+                Layout.fillWidth: true
+                Layout.leftMargin: 16
+                Layout.rightMargin: 16
+                Layout.topMargin: 8
+                height: 36
+                radius: 6
+                color: "#f0f4f8"
+
+                RowLayout {
+                    anchors.fill: parent
+                    anchors.leftMargin: 12
+                    anchors.rightMargin: 12
+                    spacing: 8
+
+                    Text {
+                        text: "\uf1da"
+                        font.family: fontAwesome.name
+                        font.pixelSize: 12
+                        color: "#6b7280"
+                    }
+                    Text {
+                        text: revisionBrowserDrawer.browser.commitHash !== ""
+                              ? revisionBrowserDrawer.browser.commitHash.substring(0, 8)
+                              : (revisionBrowserDrawer.browser.loading ? "加载中..." : "未打开版本")
+                        font.pixelSize: 12
+                        font.family: "Consolas"
+                        color: "#1a1a1a"
+                    }
+                    Item { Layout.fillWidth: true }
+                    Text {
+                        text: revisionBrowserDrawer.browser.count + " 项"
+                        font.pixelSize: 11
+                        color: theme.textDim
+                    }
+                }
+            }
+
+            // Error message
+            Text {
+                Layout.fillWidth: true
+                Layout.leftMargin: 16
+                Layout.rightMargin: 16
+                Layout.topMargin: 6
+                visible: revisionBrowserDrawer.browser.error !== ""
+                text: revisionBrowserDrawer.browser.error
+                font.pixelSize: 11
+                color: theme.error
+                wrapMode: Text.Wrap
+            }
+
+            // Tree list
+            Rectangle {
+                Layout.fillWidth: true
+                Layout.fillHeight: true
+                Layout.topMargin: 8
+                radius: 8
+                color: theme.surfaceLight
+                clip: true
+
+                ListView {
+                    id: revisionTreeView
+                    anchors.fill: parent
+                    anchors.margins: 4
+                    model: revisionBrowserDrawer.browser
+                    spacing: 1
+                    reuseItems: true
+
+                    ScrollBar.vertical: ScrollBar {
+                        policy: ScrollBar.AsNeeded
+                    }
+
+                    delegate: Rectangle {
+                        id: revisionItemDelegate
+
+                        width: revisionTreeView.width
+                        height: 30
+                        radius: 6
+                        color: revisionBrowserDrawer.browser.previewPath === model.path ? Qt.rgba(59, 130, 246, 0.12)
+                             : revisionItemHover.hovered ? theme.surface : "transparent"
+
+                        HoverHandler {
+                            id: revisionItemHover
+                            cursorShape: Qt.PointingHandCursor
+                        }
+
+                        TapHandler {
+                            onTapped: revisionBrowserDrawer.browser.preview(index)
+                        }
+
+                        RowLayout {
+                            anchors.fill: parent
+                            anchors.leftMargin: 8 + model.depth * 16
+                            anchors.rightMargin: 12
+                            spacing: 6
+
+                            // Expand arrow
+                            Text {
+                                Layout.preferredWidth: 10
+                                text: model.loading ? "\uf110"
+                                      : model.isDir ? (model.expanded ? "\uf078" : "\uf054") : ""
+                                font.family: fontAwesome.name
+                                font.pixelSize: 9
+                                color: theme.textDim
+                            }
+
+                            Text {
+                                text: model.isDir ? (model.expanded ? "\uf07c" : "\uf07b")
+                                      : model.type === "commit" ? "\uf1e6" : "\uf15b"
+                                font.family: fontAwesome.name
+                                font.pixelSize: 13
+                                color: model.isDir ? "#f59e0b" : "#6b7280"
+                            }
+
+                            Text {
+                                text: model.name
+                                font.pixelSize: 13
+                                color: theme.text
+                                elide: Text.ElideRight
+                                Layout.fillWidth: true
+                            }
+
+                            Text {
+                                visible: !model.isDir && model.size > 0
+                                text: formatFileSize(model.size)
+                                font.pixelSize: 10
+                                color: theme.textDim
+
+                                function formatFileSize(bytes) {
+                                    if (!bytes || bytes === 0) return ""
+                                    if (bytes < 1024) return bytes + " B"
+                                    if (bytes < 1024 * 1024) return (bytes / 1024).toFixed(1) + " KB"
+                                    return (bytes / 1024 / 1024).toFixed(1) + " MB"
+                                }
+                            }
+                        }
+                    }
+
+                    // Loading / empty state
+                    Text {
+                        anchors.centerIn: parent
+                        visible: revisionBrowserDrawer.browser.count === 0
+                        text: revisionBrowserDrawer.browser.loading ? "加载中..." : "暂无文件"
+                        font.pixelSize: 12
+                        color: theme.textDim
+                    }
+                }
+            }
+
+            // File preview
+            Rectangle {
+                Layout.fillWidth: true
+                Layout.preferredHeight: parent.height * 0.45
+                Layout.topMargin: 8
+                visible: revisionBrowserDrawer.browser.previewPath !== ""
+                radius: 8
+                color: "#ffffff"
+                border.color: "#e5e7eb"
+                border.width: 1
+                clip: true
+
+                ColumnLayout {
+                    anchors.fill: parent
+                    anchors.margins: 8
+                    spacing: 6
+
+                    RowLayout {
+                        Layout.fillWidth: true
+                        spacing: 8
+
+                        Text {
+                            text: revisionBrowserDrawer.browser.previewPath
+                            font.pixelSize: 12
+                            font.bold: true
+                            color: theme.text
+                            elide: Text.ElideMiddle
+                            Layout.fillWidth: true
+                        }
+
+                        Text {
+                            text: "\uf00d"
+                            font.family: fontAwesome.name
+                            font.pixelSize: 12
+                            color: closePreviewArea.containsMouse ? "#ef4444" : "#9ca3af"
+
+                            MouseArea {
+                                id: closePreviewArea
+                                anchors.fill: parent
+                                anchors.margins: -6
+                                hoverEnabled: true
+                                cursorShape: Qt.PointingHandCursor
+                                onClicked: revisionBrowserDrawer.browser.closePreview()
+                            }
+                        }
+                    }
+
+                    Text {
+                        Layout.fillWidth: true
+                        visible: revisionBrowserDrawer.browser.previewTruncated
+                        text: "文件较大，只显示前 1 MB"
+                        font.pixelSize: 11
+                        color: theme.warning
+                    }
+
+                    ScrollView {
+                        Layout.fillWidth: true
+                        Layout.fillHeight: true
+                        visible: !revisionBrowserDrawer.browser.previewLoading && !revisionBrowserDrawer.browser.previewBinary
+
+                        TextArea {
+                            readOnly: true
+                            selectByMouse: true
+                            text: revisionBrowserDrawer.browser.previewContent
+                            font.family: "Consolas"
+                            font.pixelSize: 12
+                            color: theme.text
+                            wrapMode: TextEdit.NoWrap
+                            background: null
+                        }
+                    }
+
+                    Text {
+                        Layout.fillWidth: true
+                        Layout.fillHeight: true
+                        visible: revisionBrowserDrawer.browser.previewLoading || revisionBrowserDrawer.browser.previewBinary
+                        text: revisionBrowserDrawer.browser.previewLoading ? "加载中..."
+                              : "二进制文件，无法预览（" + (revisionBrowserDrawer.browser.previewSize / 1024).toFixed(1) + " KB）"
+                        font.pixelSize: 12
+                        color: theme.textDim
+                        horizontalAlignment: Text.AlignHCenter
+                        verticalAlignment: Text.AlignVCenter
+                    }
+                }
+            }
+        }
+    }
+
+    // Remote File Editor Dialog
+    property string remoteEditFilePath: ""
+    property string remoteEditOriginalContent: ""  // 存储原始内容用于比较
+
+    Dialog {
+        id: remoteFileEditorDialog
+        title: ""
+        anchors.centerIn: parent
+        width: Math.min(parent.width - 60, 650)
+        height: Math.min(parent.height - 60, 500)
+        modal: true
+        standardButtons: Dialog.NoButton
+
+        onOpened: {
+            // 对话框打开时保存原始内容
+            // 使用延迟确保fileContent已加载
+            Qt.callLater(function() {
+                remoteEditOriginalContent = gitManager.fileContent
+                console.log("Original content saved, length:", remoteEditOriginalContent.length)
+            })
+        }
+
+        // 关闭时停止追溯（git blame 可能还在运行）
+        onClosed: gitManager.blame.enabled = false
+
+        background: Rectangle {
+            color: "#F8FBFE"
+            radius: 12
+        }
+
+        header: MacTitleBar {
+            title: "编辑文件"
+            onCloseClicked: remoteFileEditorDialog.close()
+        }
+
+        contentItem: ColumnLayout {
+            spacing: 12
+
+            // File path
+            RowLayout {
+                spacing: 8
+                Text {
+                    text: "\uf15b"
+                    font.family: fontAwesome.name
+                    font.pixelSize: 12
+                    color: "#6b7280"
+                }
+                Text {
+                    text: remoteEditFilePath
+                    font.pixelSize: 12
+                    color: "#6b7280"
+                    elide: Text.ElideMiddle
+                    Layout.fillWidth: true
+                }
+
+                // 切换逐行追溯
+                Text {
+                    text: "\uf1da  " + (gitManager.blame.enabled ? "返回编辑" : "追溯")
+                    font.family: fontAwesome.name
+                    font.pixelSize: 12
+                    color: blameToggleArea.containsMouse || gitManager.blame.enabled ? "#3b82f6" : "#6b7280"
+                    MouseArea {
+                        id: blameToggleArea
+                        anchors.fill: parent
+                        anchors.margins: -6
+                        hoverEnabled: true
+                        cursorShape: Qt.PointingHandCursor
+                        onClicked: gitManager.blame.enabled = !gitManager.blame.enabled
+                    }
+                    ToolTip.visible: blameToggleArea.containsMouse
+                    ToolTip.text: "查看每一行最后由哪个提交修改"
+                    ToolTip.delay: 500
+                }
+            }
+
+            // Editor
+            Rectangle {
+                Layout.fillWidth: true
+                Layout.fillHeight: true
+                radius: 8
+                color: "#ffffff"
+                border.color: "#e5e7eb"
+                border.width: 1
+
+                ScrollView {
+                    anchors.fill: parent
+                    anchors.margins: 8
+                    visible: !gitManager.blame.enabled
+
+                    TextArea {
+                        id: remoteFileEditor
+                        text: gitManager.fileContent
+                        color: "#1a1a1a"
+                        font.family: "Consolas, Monaco, monospace"
+                        font.pixelSize: 13
+                        wrapMode: TextArea.NoWrap
+                        selectByMouse: true
+                        background: null
+                    }
+                }
+
+                // 逐行追溯：每段第一行显示提交、作者和日期，追溯结果按段陆续填入
+                ListView {
+                    id: blameListView
+                    anchors.fill: parent
+                    anchors.margins: 8
+                    visible: gitManager.blame.enabled
+                    clip: true
+                    model: gitManager.blame
+                    flickableDirection: Flickable.HorizontalAndVerticalFlick
+                    contentWidth: Math.max(width, 900)
+                    boundsBehavior: Flickable.StopAtBounds
+                    ScrollBar.vertical: ScrollBar {}
+
+                    delegate: Row {
+                        width: blameListView.contentWidth
+                        height: 18
+                        spacing: 8
+
+                        Rectangle {
+                            width: 220
+                            height: parent.height
+                            color: model.uncommitted ? "#fef3c7" : (model.hunkStart ? "#f3f4f6" : "#f9fafb")
+
+                            Text {
+                                anchors.fill: parent
+                                anchors.leftMargin: 6
+                                visible: model.hunkStart
+                                text: !model.loaded ? "..." : model.uncommitted ? model.author
+                                      : model.shortHash + "  " + model.author + "  " + model.date
+                                font.family: "Consolas"
+                                font.pixelSize: 11
+                                color: model.uncommitted ? "#b45309" : "#6b7280"
+                                elide: Text.ElideRight
+                                verticalAlignment: Text.AlignVCenter
+                            }
+
+                            ToolTip.visible: blameLineHover.hovered && model.loaded
+                            ToolTip.text: model.summary
+                            ToolTip.delay: 500
+
+                            HoverHandler {
+                                id: blameLineHover
+                            }
+                        }
+
+                        Text {
+                            width: 36
+                            height: parent.height
+                            text: model.lineNumber
+                            font.family: "Consolas"
+                            font.pixelSize: 11
+                            color: "#9ca3af"
+                            horizontalAlignment: Text.AlignRight
+                            verticalAlignment: Text.AlignVCenter
+                        }
+
+                        Text {
+                            height: parent.height
+                            text: model.text
+                            textFormat: Text.PlainText
+                            font.family: "Consolas, Monaco, monospace"
+                            font.pixelSize: 13
+                            color: "#1a1a1a"
+                            verticalAlignment: Text.AlignVCenter
+                        }
+                    }
+                }
+
+                Text {
+                    anchors.centerIn: parent
+                    visible: gitManager.blame.enabled && (gitManager.blame.error !== "" || gitManager.blame.count === 0)
+                    text: gitManager.blame.error !== "" ? gitManager.blame.error
+                          : gitManager.blame.loading ? "加载中..." : "没有内容"
+                    font.pixelSize: 12
+                    color: "#6b7280"
                 }
             }
 
@@ -6388,6 +7545,16 @@ ApplicationWindow {
     property var imageList: []
     property int currentImageIndex: 0
 
+    // 打开单个文件的历史（跟随重命名）；同一个文件再次打开时重新读取（HEAD 没变时命中缓存）
+    function openFileHistory(path) {
+        if (gitManager.fileHistory.path === path) {
+            gitManager.fileHistory.reload()
+        } else {
+            gitManager.fileHistory.path = path
+        }
+        fileHistoryDrawer.open()
+    }
+
     function openImagePreview(path, name) {
         // Build image list from current remote files
         imageList = []
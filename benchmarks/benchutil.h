@@ -0,0 +1,85 @@
+#ifndef BENCHUTIL_H
+#define BENCHUTIL_H
+
+#include <QElapsedTimer>
+#include <QtGlobal>
+#include <cstdio>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#elif defined(Q_OS_WIN)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_MACOS)
+#include <malloc/malloc.h>
+#endif
+
+// 基准测试工具的公共部分：堆内存统计与结果输出
+namespace Bench {
+
+// 当前进程已分配的堆内存（字节），不支持的平台返回 -1
+// glibc / macOS 统计 malloc 中正在使用的字节；Windows 使用进程的私有提交内存
+inline qint64 heapBytes()
+{
+#if defined(__GLIBC__)
+#if __GLIBC_PREREQ(2, 33)
+    const struct mallinfo2 info = mallinfo2();
+#else
+    const struct mallinfo info = mallinfo();
+#endif
+    return qint64(info.uordblks) + qint64(info.hblkhd);
+#elif defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS_EX counters = {};
+    ::GetProcessMemoryInfo(::GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS *>(&counters),
+                           sizeof(counters));
+    return qint64(counters.PrivateUsage);
+#elif defined(Q_OS_MACOS)
+    malloc_statistics_t stats = {};
+    ::malloc_zone_statistics(nullptr, &stats);
+    return qint64(stats.size_in_use);
+#else
+    return -1;
+#endif
+}
+
+inline double megabytes(qint64 bytes)
+{
+    return bytes / (1024.0 * 1024.0);
+}
+
+// 一次测量：耗时和期间净增的堆内存
+struct Measurement
+{
+    qint64 elapsedMs = 0;
+    qint64 heapDelta = 0;
+};
+
+template <typename Function>
+Measurement measure(Function function)
+{
+    Measurement result;
+    const qint64 before = heapBytes();
+    QElapsedTimer timer;
+    timer.start();
+    function();
+    result.elapsedMs = timer.elapsed();
+    result.heapDelta = before < 0 ? -1 : heapBytes() - before;
+    return result;
+}
+
+inline void printRow(const char *label, const Measurement &measurement)
+{
+    if (measurement.heapDelta < 0) {
+        std::printf("  %-36s %10s  %7lld ms\n", label, "n/a", static_cast<long long>(measurement.elapsedMs));
+    } else {
+        std::printf("  %-36s %7.1f MB  %7lld ms\n", label, megabytes(measurement.heapDelta),
+                    static_cast<long long>(measurement.elapsedMs));
+    }
+}
+
+} // namespace Bench
+
+#endif // BENCHUTIL_H
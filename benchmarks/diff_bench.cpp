@@ -0,0 +1,205 @@
+// 进程内差异与 git diff 的对比基准
+// 同一对文件分别用 GitDiffEngine 和 git diff --no-index 比较（相同的算法、缩进启发、上下文选项），
+// 比较耗时，并逐行核对两者输出的 unified 差异完全相同。
+//
+// 用法：diff_bench [行数，默认 200000]
+//       diff_bench <旧文件> <新文件>
+#include "benchutil.h"
+#include "gitdiffengine.h"
+#include "gitpatchparser.h"
+#include "gitprocess.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QStringList>
+#include <QTemporaryDir>
+
+namespace {
+
+// 类似源代码的文件：函数、不同层次的缩进、空行和大量重复的行（如 "}"、"return 0;"）
+QByteArray syntheticSource(int lines, quint32 seed)
+{
+    static const char *const bodies[] = {"return 0;", "x++;", "if (ready) {", "}", "call(value);", "",
+                                         "// comment", "break;", "value = compute(x, y);", "continue;"};
+    auto next = [&seed]() {
+        seed = seed * 1103515245u + 12345u;
+        return (seed >> 8) & 0xffffff;
+    };
+    QByteArray text;
+    text.reserve(qsizetype(lines) * 24);
+    int depth = 0;
+    for (int i = 0; i < lines; i++) {
+        if (depth == 0) {
+            text += "int function" + QByteArray::number(i) + "(int x)\n{\n";
+            depth = 1;
+            i++;
+            continue;
+        }
+        const char *body = bodies[next() % 10];
+        if (depth > 1 && next() % 4 == 0) {
+            depth--;
+            text += QByteArray(depth * 4, ' ') + "}\n";
+            continue;
+        }
+        if (next() % 30 == 0) {
+            depth = 0;
+            text += "}\n\n";
+            continue;
+        }
+        text += QByteArray(depth * 4, ' ') + body + '\n';
+        if (QByteArrayView(body).endsWith('{') && depth < 6) {
+            depth++;
+        }
+    }
+    return text;
+}
+
+// 大约每 50 行一处修改：删除、插入复制来的几行（让修改块可以上下移动）或改写一行
+QByteArray mutate(const QByteArray &source, quint32 seed)
+{
+    auto next = [&seed]() {
+        seed = seed * 1103515245u + 12345u;
+        return (seed >> 8) & 0xffffff;
+    };
+    QList<QByteArray> lines = source.split('\n');
+    for (qsizetype i = 0; i < lines.size(); i++) {
+        if (next() % 50 != 0) {
+            continue;
+        }
+        switch (next() % 3) {
+        case 0:
+            lines.remove(i, qMin<qsizetype>(lines.size() - i, 1 + next() % 4));
+            break;
+        case 1: {
+            const qsizetype from = qMax<qsizetype>(0, i - qsizetype(next() % 6));
+            const QList<QByteArray> copy = lines.mid(from, i - from + 1);
+            for (qsizetype c = 0; c < copy.size(); c++) {
+                lines.insert(i + 1 + c, copy[c]);
+            }
+            i += copy.size();
+            break;
+        }
+        default:
+            lines[i] += " // changed";
+            break;
+        }
+    }
+    return lines.join('\n');
+}
+
+struct Variant
+{
+    const char *name;
+    GitDiffEngine::Algorithm algorithm;
+    bool indentHeuristic;
+    int context;
+};
+
+// 一行差异的文本形式，用于比较两种实现的输出
+QByteArray describe(GitDiffLine::Type type, int oldLine, int newLine, QByteArrayView content)
+{
+    return QByteArray::number(int(type)) + ' ' + QByteArray::number(oldLine) + ' ' + QByteArray::number(newLine) + ' '
+        + content.toByteArray();
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments().mid(1);
+
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        std::fprintf(stderr, "cannot create a temporary directory\n");
+        return 1;
+    }
+    QByteArray oldText;
+    QByteArray newText;
+    if (args.size() >= 2) {
+        QFile oldFile(args[0]);
+        QFile newFile(args[1]);
+        if (!oldFile.open(QIODevice::ReadOnly) || !newFile.open(QIODevice::ReadOnly)) {
+            std::fprintf(stderr, "cannot read %s or %s\n", qPrintable(args[0]), qPrintable(args[1]));
+            return 1;
+        }
+        oldText = oldFile.readAll();
+        newText = newFile.readAll();
+    } else {
+        const int lines = args.isEmpty() ? 200000 : qMax(10, args[0].toInt());
+        oldText = syntheticSource(lines, 12345);
+        newText = mutate(oldText, 54321);
+    }
+    // git diff --no-index 比较的是临时目录中的副本，两边的输入完全相同
+    auto writeCopy = [&dir](const QString &name, const QByteArray &text) {
+        QFile file(dir.filePath(name));
+        if (!file.open(QIODevice::WriteOnly) || file.write(text) != text.size()) {
+            std::fprintf(stderr, "cannot write %s\n", qPrintable(file.fileName()));
+            return false;
+        }
+        return true;
+    };
+    if (!writeCopy("old", oldText) || !writeCopy("new", newText)) {
+        return 1;
+    }
+    std::printf("old %.1f MB, new %.1f MB\n", Bench::megabytes(oldText.size()), Bench::megabytes(newText.size()));
+    std::printf("%-24s %12s %12s %9s %10s\n", "variant", "git diff ms", "engine ms", "speedup", "lines");
+
+    const Variant variants[] = {
+        {"myers, indent heuristic", GitDiffEngine::Myers, true, 3},
+        {"myers", GitDiffEngine::Myers, false, 3},
+        {"histogram, indent", GitDiffEngine::Histogram, true, 3},
+        {"myers, indent, -U10", GitDiffEngine::Myers, true, 10},
+    };
+    bool consistent = true;
+    for (const Variant &variant : variants) {
+        QList<QByteArray> gitLines;
+        GitPatchParser parser;
+        parser.setLineHandler([&gitLines](GitDiffLine::Type type, int oldLine, int newLine, QByteArrayView content) {
+            gitLines.append(describe(type, oldLine, newLine, content));
+        });
+        GitResult result;
+        const Bench::Measurement git = Bench::measure([&]() {
+            GitProcess process(dir.path());
+            process.setOutputHandler([&parser](const QByteArray &chunk) {
+                parser.feed(chunk);
+            });
+            result = process.run({"diff", "--no-index", "--no-color", "--no-ext-diff",
+                                  variant.algorithm == GitDiffEngine::Histogram ? "--diff-algorithm=histogram"
+                                                                                : "--diff-algorithm=myers",
+                                  variant.indentHeuristic ? "--indent-heuristic" : "--no-indent-heuristic",
+                                  "-U" + QString::number(variant.context), "old", "new"}, -1);
+            parser.finish();
+        });
+        // 有差异时 git diff --no-index 的退出码是 1
+        if (result.exitCode != 0 && result.exitCode != 1) {
+            std::fprintf(stderr, "git diff failed: %s\n", qPrintable(result.errorText()));
+            return 1;
+        }
+
+        QList<QByteArray> engineLines;
+        const Bench::Measurement engine = Bench::measure([&]() {
+            GitDiffEngine diff(oldText, newText);
+            diff.forEachLine(diff.diff(variant.algorithm, variant.indentHeuristic),
+                             [&engineLines](GitDiffLine::Type type, int oldLine, int newLine, QByteArrayView content) {
+                engineLines.append(describe(type, oldLine, newLine, content));
+            }, variant.context);
+        });
+
+        std::printf("%-24s %12lld %12lld %8.1fx %10lld\n", variant.name, static_cast<long long>(git.elapsedMs),
+                    static_cast<long long>(engine.elapsedMs),
+                    double(qMax<qint64>(1, git.elapsedMs)) / qMax<qint64>(1, engine.elapsedMs),
+                    static_cast<long long>(engineLines.size()));
+        if (engineLines != gitLines) {
+            qsizetype first = 0;
+            while (first < qMin(engineLines.size(), gitLines.size()) && engineLines[first] == gitLines[first]) {
+                first++;
+            }
+            std::fprintf(stderr, "%s: output differs from git diff at line %lld\n  git:    %s\n  engine: %s\n",
+                         variant.name, static_cast<long long>(first),
+                         first < gitLines.size() ? gitLines[first].constData() : "(end)",
+                         first < engineLines.size() ? engineLines[first].constData() : "(end)");
+            consistent = false;
+        }
+    }
+    return consistent ? 0 : 1;
+}
@@ -0,0 +1,158 @@
+// 路径驻留表的内存基准
+// 同一批仓库相对路径出现在状态、提交文件、目录浏览等多个列表中：
+// 以前每个列表各自解码出 QString 路径，并用 section('/', -1) 另存文件名；
+// 现在路径驻留到 GitPathTable，条目只保存表指针 + 32 位 id。
+//
+// 用法：pathtable_bench [路径数，默认 500000] [--lists N，默认 3] [--repo <仓库>]
+// 指定 --repo 时使用该仓库 git ls-files -z 的真实路径（不足路径数时按原样使用）
+#include "benchutil.h"
+#include "gitpathtable.h"
+#include "gittokenizer.h"
+#include <QCoreApplication>
+#include <QProcess>
+#include <QStringList>
+#include <vector>
+
+namespace {
+
+// 模拟大仓库的目录结构：1-6 层目录，同级目录名大量重复，约 5% 的中文文件名
+std::vector<QByteArray> syntheticPaths(int count)
+{
+    static const char *const dirs[] = {"src", "include", "tests", "docs", "third_party",
+                                       "tools", "assets", "lib", "app", "modules"};
+    static const char *const extensions[] = {".cpp", ".h", ".qml", ".md", ".png", ".json", ".txt", ".py"};
+
+    quint32 seed = 12345;
+    auto next = [&seed]() {
+        seed = seed * 1103515245u + 12345u;
+        return (seed >> 8) & 0xffffff;
+    };
+
+    std::vector<QByteArray> paths;
+    paths.reserve(count);
+    for (int i = 0; i < count; i++) {
+        QByteArray path;
+        const int depth = 1 + int(next() % 6);
+        for (int d = 0; d < depth; d++) {
+            path += dirs[next() % 10];
+            path += QByteArray::number(next() % 40);
+            path += '/';
+        }
+        if (next() % 20 == 0) {
+            path += "文档_";
+        }
+        path += "file_" + QByteArray::number(i) + extensions[next() % 8];
+        paths.push_back(path);
+    }
+    return paths;
+}
+
+std::vector<QByteArray> repoPaths(const QString &repoPath, int limit)
+{
+    std::vector<QByteArray> paths;
+    QProcess process;
+    process.setWorkingDirectory(repoPath);
+    process.start("git", {"ls-files", "-z"});
+    if (!process.waitForFinished(-1) || process.exitCode() != 0) {
+        std::fprintf(stderr, "git ls-files failed in %s\n", qPrintable(repoPath));
+        return paths;
+    }
+    const QByteArray output = process.readAllStandardOutput();
+    GitTokenizer::forEachRecord(output, '\0', [&paths, limit](QByteArrayView path) {
+        if (int(paths.size()) < limit) {
+            paths.push_back(path.toByteArray());
+        }
+    });
+    return paths;
+}
+
+// 驻留之前的条目：路径和文件名各是一个独立分配的 QString
+struct StringEntry
+{
+    QString path;
+    QString name;
+};
+
+struct RefEntry
+{
+    GitPathRef path;
+};
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    int count = 500000;
+    int lists = 3;
+    QString repoPath;
+    const QStringList args = app.arguments().mid(1);
+    for (int i = 0; i < args.size(); i++) {
+        if (args[i] == "--repo" && i + 1 < args.size()) {
+            repoPath = args[++i];
+        } else if (args[i] == "--lists" && i + 1 < args.size()) {
+            lists = qMax(1, args[++i].toInt());
+        } else {
+            count = qMax(1, args[i].toInt());
+        }
+    }
+
+    const std::vector<QByteArray> paths = repoPath.isEmpty() ? syntheticPaths(count) : repoPaths(repoPath, count);
+    if (paths.empty()) {
+        return 1;
+    }
+    qint64 totalBytes = 0;
+    for (const QByteArray &path : paths) {
+        totalBytes += path.size();
+    }
+    std::printf("%zu paths (average %.1f bytes UTF-8), each listed %d times%s\n", paths.size(),
+                double(totalBytes) / paths.size(), lists, repoPath.isEmpty() ? " (synthetic)" : "");
+    std::printf("  %-36s %10s  %10s\n", "", "heap", "build");
+
+    // 之前：每个列表独立解码（git 输出各自读取），文件名另存一份
+    {
+        std::vector<std::vector<StringEntry>> entryLists(lists);
+        const Bench::Measurement before = Bench::measure([&]() {
+            for (std::vector<StringEntry> &entries : entryLists) {
+                entries.reserve(paths.size());
+                for (const QByteArray &path : paths) {
+                    const QString text = QString::fromUtf8(path);
+                    entries.push_back({text, text.section('/', -1)});
+                }
+            }
+        });
+        Bench::printRow("QString path + name (before)", before);
+    }
+
+    // 之后：路径只驻留一次，列表中只有引用
+    {
+        GitPathTable *table = GitPathTable::forRepo(QStringLiteral("pathtable-bench"));
+        std::vector<std::vector<RefEntry>> entryLists(lists);
+        const Bench::Measurement after = Bench::measure([&]() {
+            for (std::vector<RefEntry> &entries : entryLists) {
+                entries.reserve(paths.size());
+                for (const QByteArray &path : paths) {
+                    entries.push_back({GitPathRef(table, QByteArrayView(path))});
+                }
+            }
+        });
+        Bench::printRow("GitPathTable + 32-bit ids (after)", after);
+        std::printf("  %-36s %7.1f MB  (table's own estimate, %lld paths)\n", "  of which path table",
+                    Bench::megabytes(table->memoryUsage()), static_cast<long long>(table->count()));
+
+        // 界面读取时才转换：抽查转换回来的路径与原始路径一致
+        qint64 mismatches = 0;
+        const std::vector<RefEntry> &entries = entryLists.front();
+        for (size_t i = 0; i < entries.size(); i += 97) {
+            if (entries[i].path.toString() != QString::fromUtf8(paths[i])) {
+                mismatches++;
+            }
+        }
+        if (mismatches > 0) {
+            std::fprintf(stderr, "%lld interned paths do not round-trip\n", static_cast<long long>(mismatches));
+            return 1;
+        }
+    }
+    return 0;
+}
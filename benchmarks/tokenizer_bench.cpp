@@ -0,0 +1,256 @@
+// git 输出解析的前后对比基准
+// 之前：整段输出 QString::fromUtf8 后 split('\n')，每行再 split / section / QRegularExpression；
+// 之后：GitTokenizer 直接在 QByteArray 上按行、按字段切分，只有显示到界面的字段才转换成 QString。
+// 每个场景使用与真实命令格式相同的合成输出，两种解析的结果数量必须一致。
+//
+// 用法：tokenizer_bench [行数，默认 2000000]
+#include "benchutil.h"
+#include "gittokenizer.h"
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+
+namespace {
+
+QByteArray fakeOid(quint32 seed)
+{
+    QByteArray oid = QByteArray::number(seed * 2654435761u, 16).rightJustified(8, '0');
+    return oid.repeated(5);
+}
+
+QByteArray fakePath(int i)
+{
+    static const char *const dirs[] = {"src", "include", "tests", "docs", "assets", "lib", "app"};
+    return QByteArray(dirs[i % 7]) + "/module" + QByteArray::number(i % 97) + "/file_" + QByteArray::number(i) + ".cpp";
+}
+
+// git rev-list --objects --all："<oid> <path>"
+QByteArray revListOutput(int lines)
+{
+    QByteArray output;
+    output.reserve(qsizetype(lines) * 80);
+    for (int i = 0; i < lines; i++) {
+        output += fakeOid(i) + ' ' + fakePath(i) + '\n';
+    }
+    return output;
+}
+
+// git cat-file --batch-check="%(objectname) %(objecttype) %(objectsize)"
+QByteArray batchCheckOutput(int lines)
+{
+    static const char *const types[] = {"blob", "tree", "commit", "blob"};
+    QByteArray output;
+    output.reserve(qsizetype(lines) * 56);
+    for (int i = 0; i < lines; i++) {
+        output += fakeOid(i) + ' ' + types[i % 4] + ' ' + QByteArray::number((i * 7919) % 5000000) + '\n';
+    }
+    return output;
+}
+
+// git ls-tree -l："<mode> <type> <oid> <size 右对齐>\t<path>"
+QByteArray lsTreeOutput(int lines)
+{
+    QByteArray output;
+    output.reserve(qsizetype(lines) * 100);
+    for (int i = 0; i < lines; i++) {
+        const bool tree = i % 10 == 0;
+        output += QByteArray(tree ? "040000 tree " : "100644 blob ") + fakeOid(i) + ' '
+                + (tree ? QByteArray("-") : QByteArray::number(i * 31)).rightJustified(7, ' ') + '\t' + fakePath(i) + '\n';
+    }
+    return output;
+}
+
+// git status --porcelain："XY <path>"，重命名为 "R  old -> new"
+QByteArray statusOutput(int lines)
+{
+    QByteArray output;
+    output.reserve(qsizetype(lines) * 50);
+    for (int i = 0; i < lines; i++) {
+        if (i % 50 == 0) {
+            output += "R  " + fakePath(i) + " -> " + fakePath(i + 1) + '\n';
+        } else {
+            output += QByteArray(i % 3 == 0 ? " M " : "?? ") + fakePath(i) + '\n';
+        }
+    }
+    return output;
+}
+
+struct Scenario
+{
+    const char *name;
+    QByteArray output;
+    qint64 (*before)(const QByteArray &);
+    qint64 (*after)(const QByteArray &);
+};
+
+// 以下 before* 与 GitTokenizer 之前 gitmanager.cpp 中的解析方式相同，返回解析出的条目数
+
+qint64 revListBefore(const QByteArray &output)
+{
+    qint64 count = 0;
+    const QStringList lines = QString::fromUtf8(output).split('\n', Qt::SkipEmptyParts);
+    for (const QString &line : lines) {
+        int space = line.indexOf(' ');
+        if (space > 0) {
+            QString hash = line.left(space);
+            QString path = line.mid(space + 1);
+            count += !hash.isEmpty() && !path.isEmpty();
+        }
+    }
+    return count;
+}
+
+qint64 revListAfter(const QByteArray &output)
+{
+    qint64 count = 0;
+    GitTokenizer::forEachLine(output, [&count](QByteArrayView line) {
+        const auto fields = GitTokenizer::split<2>(line, ' ');
+        count += fields.count == 2 && !fields[1].isEmpty();
+    });
+    return count;
+}
+
+qint64 batchCheckBefore(const QByteArray &output)
+{
+    qint64 count = 0;
+    const QStringList lines = QString::fromUtf8(output).split('\n', Qt::SkipEmptyParts);
+    for (const QString &line : lines) {
+        const QStringList parts = line.split(' ', Qt::SkipEmptyParts);
+        if (parts.size() >= 3 && parts[1] == "blob") {
+            count += parts[2].toLongLong() >= 0;
+        }
+    }
+    return count;
+}
+
+qint64 batchCheckAfter(const QByteArray &output)
+{
+    qint64 count = 0;
+    GitTokenizer::forEachLine(output, [&count](QByteArrayView line) {
+        const auto fields = GitTokenizer::split<3>(line, ' ');
+        if (fields.count == 3 && fields[1] == "blob") {
+            count += GitTokenizer::toInt64(fields[2]) >= 0;
+        }
+    });
+    return count;
+}
+
+qint64 lsTreeBefore(const QByteArray &output)
+{
+    qint64 count = 0;
+    const QStringList lines = QString::fromUtf8(output).split('\n', Qt::SkipEmptyParts);
+    for (const QString &line : lines) {
+        QRegularExpression re("^(\\d+)\\s+(\\w+)\\s+(\\w+)\\s+(\\S+)\\s+(.+)$");
+        QRegularExpressionMatch match = re.match(line);
+        if (match.hasMatch()) {
+            QString fullPath = match.captured(5);
+            QString name = fullPath.section('/', -1);
+            count += !name.isEmpty() && match.captured(2).size() == 4;
+        }
+    }
+    return count;
+}
+
+qint64 lsTreeAfter(const QByteArray &output)
+{
+    qint64 count = 0;
+    GitTokenizer::forEachLine(output, [&count](QByteArrayView line) {
+        const auto fields = GitTokenizer::splitWhitespace<5>(line);
+        if (fields.count == 5) {
+            // 名称会显示到界面上，转换成 QString
+            const QByteArrayView path = fields[4];
+            const QString name = GitTokenizer::toString(path.sliced(path.lastIndexOf('/') + 1));
+            count += !name.isEmpty() && fields[1].size() == 4;
+        }
+    });
+    return count;
+}
+
+qint64 statusBefore(const QByteArray &output)
+{
+    qint64 count = 0;
+    QString text = QString::fromUtf8(output);
+    if (text.contains(QChar::ReplacementCharacter)) {
+        text = QString::fromLocal8Bit(output);
+    }
+    const QStringList lines = text.split('\n', Qt::SkipEmptyParts);
+    for (const QString &line : lines) {
+        if (line.length() < 3) continue;
+        QString filePath = line.mid(3);
+        if (filePath.contains(" -> ")) {
+            filePath = filePath.section(" -> ", -1);
+        }
+        QString fileName = filePath.section('/', -1);
+        count += !fileName.isEmpty();
+    }
+    return count;
+}
+
+qint64 statusAfter(const QByteArray &output)
+{
+    qint64 count = 0;
+    GitTokenizer::forEachLine(output, [&count](QByteArrayView line) {
+        if (line.size() < 3) return;
+        QByteArrayView filePath = line.sliced(3);
+        const qsizetype arrow = filePath.indexOf(" -> ");
+        if (arrow >= 0) {
+            filePath = filePath.sliced(arrow + 4);
+        }
+        const QString path = GitTokenizer::toString(filePath);
+        count += path.size() > 0;
+    });
+    return count;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const int lines = argc > 1 ? qMax(1, QByteArray(argv[1]).toInt()) : 2000000;
+
+    const Scenario scenarios[] = {
+        {"rev-list --objects", revListOutput(lines), revListBefore, revListAfter},
+        {"cat-file --batch-check", batchCheckOutput(lines), batchCheckBefore, batchCheckAfter},
+        {"ls-tree -l", lsTreeOutput(lines / 4), lsTreeBefore, lsTreeAfter},
+        {"status --porcelain", statusOutput(lines / 4), statusBefore, statusAfter},
+    };
+
+    std::printf("%-24s %9s %12s %12s %9s %10s\n", "output", "MB", "before ms", "after ms", "speedup", "after MB/s");
+    bool consistent = true;
+    for (const Scenario &scenario : scenarios) {
+        qint64 beforeCount = 0;
+        qint64 afterCount = 0;
+        const Bench::Measurement before = Bench::measure([&]() { beforeCount = scenario.before(scenario.output); });
+        const Bench::Measurement after = Bench::measure([&]() { afterCount = scenario.after(scenario.output); });
+
+        const double megabytes = Bench::megabytes(scenario.output.size());
+        std::printf("%-24s %9.1f %12lld %12lld %8.1fx %10.0f\n", scenario.name, megabytes,
+                    static_cast<long long>(before.elapsedMs), static_cast<long long>(after.elapsedMs),
+                    double(qMax<qint64>(1, before.elapsedMs)) / qMax<qint64>(1, after.elapsedMs),
+                    megabytes * 1000.0 / qMax<qint64>(1, after.elapsedMs));
+        if (beforeCount != afterCount) {
+            std::fprintf(stderr, "%s: before parsed %lld entries, after %lld\n", scenario.name,
+                         static_cast<long long>(beforeCount), static_cast<long long>(afterCount));
+            consistent = false;
+        }
+    }
+
+    // 分隔符扫描本身：SIMD indexOf 与 QByteArray::count（memchr）对比
+    const QByteArray &largest = scenarios[0].output;
+    qint64 simdLines = 0;
+    qint64 plainLines = 0;
+    const Bench::Measurement simd = Bench::measure([&]() { simdLines = GitTokenizer::count(largest, '\n'); });
+    const Bench::Measurement plain = Bench::measure([&]() { plainLines = largest.count('\n'); });
+    std::printf("%-24s %9.1f %12lld %12lld  (QByteArray::count vs GitTokenizer::count)\n", "newline scan",
+                Bench::megabytes(largest.size()), static_cast<long long>(plain.elapsedMs),
+                static_cast<long long>(simd.elapsedMs));
+    if (simdLines != plainLines) {
+        std::fprintf(stderr, "newline scan: %lld vs %lld\n", static_cast<long long>(simdLines),
+                     static_cast<long long>(plainLines));
+        consistent = false;
+    }
+    return consistent ? 0 : 1;
+}
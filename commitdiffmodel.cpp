@@ -0,0 +1,475 @@
+#include "commitdiffmodel.h"
+#include "gitlogparser.h"
+#include "gitoperationqueue.h"
+#include "gitprocess.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <algorithm>
+
+namespace {
+
+// 与第一个父提交比较（合并提交也只有一份差异），与历史列表一样检测重命名
+QStringList diffOptions()
+{
+    return {"-1", "-m", "--first-parent", "-M"};
+}
+
+QStringList patchArguments(const QString &commitHash)
+{
+    return QStringList{"log"} + diffOptions()
+        + QStringList{"-p", "--format=", "--no-color", "--no-ext-diff", commitHash};
+}
+
+} // namespace
+
+CommitDiffModel::CommitDiffModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+CommitDiffModel::~CommitDiffModel()
+{
+    if (m_token) {
+        m_token->cancel();
+    }
+}
+
+int CommitDiffModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_count;
+}
+
+QVariant CommitDiffModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_count) {
+        return QVariant();
+    }
+    const int fileIndex = fileAt(index.row());
+    const FileSection &section = m_files.at(fileIndex);
+    const int line = index.row() - m_fileRow.at(fileIndex) - 1;
+
+    switch (role) {
+    case FileIndexRole:
+        return fileIndex;
+    case PathRole:
+        return section.file.filePath();
+    case OldPathRole:
+        return section.file.oldFilePath();
+    case StatusRole:
+        return section.file.statusName();
+    case StatusTextRole:
+        return section.file.statusText();
+    case AdditionsRole:
+        return section.file.additions;
+    case DeletionsRole:
+        return section.file.deletions;
+    case BinaryRole:
+        return section.file.isBinary();
+    case LargeRole:
+        return section.isLarge();
+    case ExpandedRole:
+        return section.expanded;
+    case FileLoadingRole:
+        return section.loading;
+    }
+
+    if (line < 0) {
+        switch (role) {
+        case TypeRole:
+            return QStringLiteral("file");
+        case Qt::DisplayRole:
+        case ContentRole:
+            return section.file.filePath();
+        case LineNumRole:
+        case OldLineRole:
+        case NewLineRole:
+            return 0;
+        }
+        return QVariant();
+    }
+
+    const GitDiffLine &diffLine = section.lines.at(line);
+    switch (role) {
+    case TypeRole:
+        return GitDiffLine::typeName(diffLine.type);
+    case Qt::DisplayRole:
+    case ContentRole:
+        return diffLine.content;
+    case LineNumRole:
+        return diffLine.lineNum();
+    case OldLineRole:
+        return diffLine.oldLine;
+    case NewLineRole:
+        return diffLine.newLine;
+    }
+    return QVariant();
+}
+
+QHash<int, QByteArray> CommitDiffModel::roleNames() const
+{
+    return {
+        {TypeRole, "type"},
+        {ContentRole, "content"},
+        {LineNumRole, "lineNum"},
+        {OldLineRole, "oldLine"},
+        {NewLineRole, "newLine"},
+        {FileIndexRole, "fileIndex"},
+        {PathRole, "path"},
+        {OldPathRole, "oldPath"},
+        {StatusRole, "status"},
+        {StatusTextRole, "statusText"},
+        {AdditionsRole, "additions"},
+        {DeletionsRole, "deletions"},
+        {BinaryRole, "binary"},
+        {LargeRole, "large"},
+        {ExpandedRole, "expanded"},
+        {FileLoadingRole, "fileLoading"}
+    };
+}
+
+void CommitDiffModel::setRepoPath(const QString &repoPath)
+{
+    if (repoPath == m_repoPath) {
+        return;
+    }
+    m_repoPath = repoPath;
+    clear();
+}
+
+void CommitDiffModel::open(const QString &commitHash)
+{
+    clear();
+    m_commitHash = commitHash;
+    emit commitHashChanged();
+    if (m_repoPath.isEmpty() || commitHash.isEmpty() || commitHash.startsWith('-')) {
+        return;
+    }
+    setLoading(true);
+
+    const int generation = m_generation;
+    m_token = GitCancelToken::create(QString());
+    QString repoPath = m_repoPath;
+    GitCancelToken::Ptr token = m_token;
+    QPointer<CommitDiffModel> self(this);
+    QFuture<void> future = GitOperationQueue::forRepo(repoPath)->run(GitOperationQueue::Read, [self, repoPath, commitHash, token, generation]() {
+        QElapsedTimer timer;
+        timer.start();
+
+        auto deliver = [&self, generation](const QList<GitPatchParser::Section> &sections, bool finished, const QString &error) {
+            QMetaObject::invokeMethod(self.data(), [self, generation, sections, finished, error]() {
+                if (self) {
+                    self->applySections(generation, sections, finished, error);
+                }
+            }, Qt::QueuedConnection);
+        };
+
+        // 1. 文件列表：状态、增删行数（二进制文件为 "-"，git 只读取判断所需的部分）
+        GitLogParser listParser(GitPathTable::forRepo(repoPath));
+        GitProcess listProcess(repoPath, token);
+        listProcess.setOutputHandler([&listParser](const QByteArray &chunk) {
+            listParser.feed(chunk);
+        });
+        GitResult listResult = listProcess.run(QStringList{"log"} + diffOptions() + GitLogParser::formatArguments() + QStringList{commitHash});
+        if (listResult.cancelled) return;
+        listParser.finish();
+        const QList<CommitEntry> commits = listParser.takeCommits();
+        if (!listResult.ok() || commits.isEmpty()) {
+            deliver({}, true, listResult.ok() ? QString("找不到提交：%1").arg(commitHash) : listResult.errorText());
+            return;
+        }
+        const QList<CommitFileEntry> files = commits.first().files;
+
+        // 小文件按顺序自动展开，直到总行数用完
+        QList<bool> expanded(files.size(), false);
+        int budget = CommitDiffModel::AutoExpandLines;
+        int lastExpanded = -1;
+        for (qsizetype i = 0; i < files.size(); i++) {
+            const CommitFileEntry &file = files[i];
+            const int lines = file.additions + file.deletions;
+            if (file.isBinary() || lines > CommitDiffModel::LargeFileLines || lines > budget) continue;
+            expanded[i] = true;
+            budget -= lines;
+            lastExpanded = int(i);
+        }
+        QMetaObject::invokeMethod(self.data(), [self, generation, files, expanded]() {
+            if (self) {
+                self->applyFiles(generation, files, expanded);
+            }
+        }, Qt::QueuedConnection);
+        qDebug() << "Commit diff:" << files.size() << "files listed in" << timer.elapsed() << "ms";
+
+        if (lastExpanded < 0) {
+            deliver({}, true, QString());
+            return;
+        }
+
+        // 2. 补丁：折叠的文件只跳过；最后一个自动展开的文件完成后就不再需要 git 的输出
+        GitPatchParser patch;
+        patch.setSectionFilter([&expanded](int index) {
+            return index < expanded.size() && expanded[index];
+        });
+        GitCancelToken::Ptr streamToken = GitCancelToken::create(QString());
+        bool done = false;
+        GitProcess process(repoPath, streamToken);
+        process.setOutputHandler([&](const QByteArray &chunk) {
+            if (done) return;
+            if (token->isCancelled()) {
+                streamToken->cancel();
+                return;
+            }
+            patch.feed(chunk);
+            if (patch.hasSections()) {
+                deliver(patch.takeSections(), false, QString());
+            }
+            if (patch.sectionCount() > lastExpanded + 1) {
+                done = true;
+                streamToken->cancel();
+            }
+        });
+        GitResult result = process.run(patchArguments(commitHash));
+        if (token->isCancelled() || (result.cancelled && !done)) return;
+        if (!done) {
+            patch.finish();
+        }
+        deliver(patch.takeSections(), true, (result.ok() || done) ? QString() : result.errorText());
+        qDebug() << "Commit diff:" << commitHash.left(7) << "patches streamed in" << timer.elapsed() << "ms"
+                 << (done ? "(stopped early)" : "");
+    });
+}
+
+void CommitDiffModel::toggle(int row)
+{
+    if (row < 0 || row >= m_count) {
+        return;
+    }
+    const int fileIndex = fileAt(row);
+    if (m_fileRow.at(fileIndex) != row) {
+        return;  // 只有标题行可以折叠
+    }
+    FileSection &section = m_files[fileIndex];
+
+    if (section.expanded) {
+        const int lines = visibleLines(fileIndex);
+        if (lines > 0) {
+            const int first = row + 1;
+            beginRemoveRows(QModelIndex(), first, first + lines - 1);
+            section.expanded = false;
+            shiftRows(fileIndex + 1, -lines);
+            m_count -= lines;
+            endRemoveRows();
+            emit countChanged();
+        } else {
+            section.expanded = false;
+        }
+        emitHeaderChanged(fileIndex);
+        return;
+    }
+
+    if (section.file.isBinary()) {
+        return;
+    }
+    section.expanded = true;
+    if (section.loaded) {
+        // 折叠时保留了读取过的行，重新插入即可
+        setLines(fileIndex, QList<GitDiffLine>(section.lines));
+    } else if (!section.loading) {
+        loadFile(fileIndex);
+    }
+    emitHeaderChanged(fileIndex);
+}
+
+void CommitDiffModel::clear()
+{
+    if (m_token) {
+        m_token->cancel();
+        m_token.reset();
+    }
+    ++m_generation;
+
+    beginResetModel();
+    m_files.clear();
+    m_fileRow.clear();
+    m_count = 0;
+    endResetModel();
+    emit countChanged();
+    emit fileCountChanged();
+
+    if (!m_commitHash.isEmpty()) {
+        m_commitHash.clear();
+        emit commitHashChanged();
+    }
+    setError(QString());
+    setLoading(false);
+}
+
+void CommitDiffModel::applyFiles(int generation, const QList<CommitFileEntry> &files, const QList<bool> &expanded)
+{
+    if (generation != m_generation) {
+        return;
+    }
+    beginResetModel();
+    m_files.clear();
+    m_fileRow.clear();
+    m_files.reserve(files.size());
+    m_fileRow.reserve(files.size());
+    for (qsizetype i = 0; i < files.size(); i++) {
+        FileSection section;
+        section.file = files[i];
+        section.expanded = expanded.value(i);
+        section.loading = section.expanded;  // 等待补丁流
+        section.loaded = section.file.isBinary();
+        m_fileRow.append(int(i));
+        m_files.append(section);
+    }
+    m_count = int(files.size());
+    endResetModel();
+    emit countChanged();
+    emit fileCountChanged();
+}
+
+void CommitDiffModel::applySections(int generation, const QList<GitPatchParser::Section> &sections, bool finished, const QString &error)
+{
+    if (generation != m_generation) {
+        return;
+    }
+
+    for (const GitPatchParser::Section &patch : sections) {
+        if (patch.index >= m_files.size()) continue;
+        m_files[patch.index].loading = false;
+        setLines(patch.index, patch.lines);
+        emitHeaderChanged(patch.index);
+    }
+
+    if (finished) {
+        // 补丁流提前结束或与文件列表对不上的文件：恢复为折叠，展开时单独读取
+        for (int i = 0; i < m_files.size(); i++) {
+            FileSection &section = m_files[i];
+            if (section.loading) {
+                section.loading = false;
+                section.expanded = false;
+                emitHeaderChanged(i);
+            }
+        }
+        if (!error.isEmpty()) {
+            setError(error);
+        }
+        setLoading(false);
+    }
+}
+
+void CommitDiffModel::applyFileSection(int generation, int fileIndex, const QList<GitDiffLine> &lines, const QString &error)
+{
+    if (generation != m_generation || fileIndex >= m_files.size()) {
+        return;
+    }
+    m_files[fileIndex].loading = false;
+    if (error.isEmpty()) {
+        setLines(fileIndex, lines);
+    } else {
+        m_files[fileIndex].expanded = false;
+        setError(error);
+    }
+    emitHeaderChanged(fileIndex);
+}
+
+void CommitDiffModel::setLines(int fileIndex, const QList<GitDiffLine> &lines)
+{
+    FileSection &section = m_files[fileIndex];
+    if (!section.expanded || lines.isEmpty()) {
+        section.lines = lines;
+        section.loaded = true;
+        return;
+    }
+    const int first = m_fileRow.at(fileIndex) + 1;
+    const int count = int(lines.size());
+    beginInsertRows(QModelIndex(), first, first + count - 1);
+    section.lines = lines;
+    section.loaded = true;
+    shiftRows(fileIndex + 1, count);
+    m_count += count;
+    endInsertRows();
+    emit countChanged();
+}
+
+void CommitDiffModel::loadFile(int fileIndex)
+{
+    FileSection &section = m_files[fileIndex];
+    section.loading = true;
+
+    // 只读取这一个文件的补丁；重命名时两个路径都要给出，git 才能配对
+    QStringList args = patchArguments(m_commitHash) << "--" << section.file.filePath();
+    if (!section.file.oldFilePath().isEmpty()) {
+        args << section.file.oldFilePath();
+    }
+    if (!m_token) {
+        m_token = GitCancelToken::create(QString());
+    }
+
+    const int generation = m_generation;
+    QString repoPath = m_repoPath;
+    GitCancelToken::Ptr token = m_token;
+    QPointer<CommitDiffModel> self(this);
+    QFuture<void> future = GitOperationQueue::forRepo(repoPath)->run(GitOperationQueue::Read, [self, repoPath, args, token, generation, fileIndex]() {
+        GitPatchParser patch;
+        GitProcess process(repoPath, token);
+        process.setOutputHandler([&patch](const QByteArray &chunk) {
+            patch.feed(chunk);
+        });
+        GitResult result = process.run(args);
+        if (result.cancelled) return;
+        patch.finish();
+        const QList<GitPatchParser::Section> sections = patch.takeSections();
+        const QList<GitDiffLine> lines = sections.isEmpty() ? QList<GitDiffLine>() : sections.first().lines;
+        const QString error = result.ok() ? QString() : result.errorText();
+        QMetaObject::invokeMethod(self.data(), [self, generation, fileIndex, lines, error]() {
+            if (self) {
+                self->applyFileSection(generation, fileIndex, lines, error);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+int CommitDiffModel::fileAt(int row) const
+{
+    auto it = std::upper_bound(m_fileRow.cbegin(), m_fileRow.cend(), row);
+    return int(it - m_fileRow.cbegin()) - 1;
+}
+
+int CommitDiffModel::visibleLines(int fileIndex) const
+{
+    const FileSection &section = m_files.at(fileIndex);
+    return section.expanded && section.loaded ? int(section.lines.size()) : 0;
+}
+
+void CommitDiffModel::shiftRows(int fromFile, int delta)
+{
+    for (int i = fromFile; i < m_fileRow.size(); i++) {
+        m_fileRow[i] += delta;
+    }
+}
+
+void CommitDiffModel::emitHeaderChanged(int fileIndex)
+{
+    const QModelIndex header = index(m_fileRow.at(fileIndex));
+    emit dataChanged(header, header);
+}
+
+void CommitDiffModel::setLoading(bool loading)
+{
+    if (m_loading != loading) {
+        m_loading = loading;
+        emit loadingChanged();
+    }
+}
+
+void CommitDiffModel::setError(const QString &error)
+{
+    if (m_error != error) {
+        m_error = error;
+        emit errorChanged();
+    }
+}
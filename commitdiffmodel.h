@@ -0,0 +1,118 @@
+#ifndef COMMITDIFFMODEL_H
+#define COMMITDIFFMODEL_H
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QString>
+#include <qqml.h>
+#include <memory>
+#include "gitentries.h"
+#include "gitpatchparser.h"
+
+class GitCancelToken;
+
+// 一个提交的完整差异，按文件分段展开为一维列表（文件标题行 + 该文件的补丁行），由 ListView 虚拟化显示
+// 以前历史中只列出文件名。现在打开提交时：
+// - 先用 --raw --numstat 列出所有文件（状态、增删行数、是否二进制），标题行立即出现
+// - 再流式读取 git log -p，每完成一个文件就插入它的补丁行；二进制文件由 numstat 判断，不读取内容
+// - 超过 LargeFileLines 行的文件默认折叠，自动展开的总行数达到 AutoExpandLines 后
+//   终止 git，其余文件在展开时单独读取（git log -p -- <路径>）
+// 合并提交显示与第一个父提交的差异。
+class CommitDiffModel : public QAbstractListModel
+{
+    Q_OBJECT
+    QML_ELEMENT
+    QML_UNCREATABLE("由 GitManager.commitDiff 提供")
+    Q_PROPERTY(QString commitHash READ commitHash NOTIFY commitHashChanged)
+    Q_PROPERTY(int fileCount READ fileCount NOTIFY fileCountChanged)
+    Q_PROPERTY(bool loading READ isLoading NOTIFY loadingChanged)
+    Q_PROPERTY(QString error READ error NOTIFY errorChanged)
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+
+public:
+    enum Roles {
+        TypeRole = Qt::UserRole + 1,  // "file" / "header" / "context" / "add" / "delete"
+        ContentRole,
+        LineNumRole,
+        OldLineRole,
+        NewLineRole,
+        FileIndexRole,
+        PathRole,
+        OldPathRole,
+        StatusRole,
+        StatusTextRole,
+        AdditionsRole,
+        DeletionsRole,
+        BinaryRole,
+        LargeRole,
+        ExpandedRole,
+        FileLoadingRole
+    };
+
+    explicit CommitDiffModel(QObject *parent = nullptr);
+    ~CommitDiffModel() override;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    QString commitHash() const { return m_commitHash; }
+    int fileCount() const { return int(m_files.size()); }
+    bool isLoading() const { return m_loading; }
+    QString error() const { return m_error; }
+
+    // 切换或关闭仓库时清空
+    void setRepoPath(const QString &repoPath);
+
+    Q_INVOKABLE void open(const QString &commitHash);
+    // 展开或折叠文件（row 是文件标题行）；第一次展开折叠的文件时读取它的补丁
+    Q_INVOKABLE void toggle(int row);
+    Q_INVOKABLE void clear();
+
+    static constexpr int LargeFileLines = 400;
+    static constexpr int AutoExpandLines = 3000;
+
+signals:
+    void commitHashChanged();
+    void fileCountChanged();
+    void loadingChanged();
+    void errorChanged();
+    void countChanged();
+
+private:
+    struct FileSection {
+        CommitFileEntry file;
+        bool expanded = false;
+        bool loaded = false;
+        bool loading = false;
+        QList<GitDiffLine> lines;
+
+        int changedLines() const { return file.isBinary() ? 0 : file.additions + file.deletions; }
+        bool isLarge() const { return changedLines() > LargeFileLines; }
+    };
+
+    void applyFiles(int generation, const QList<CommitFileEntry> &files, const QList<bool> &expanded);
+    void applySections(int generation, const QList<GitPatchParser::Section> &sections, bool finished, const QString &error);
+    void applyFileSection(int generation, int fileIndex, const QList<GitDiffLine> &lines, const QString &error);
+    void setLines(int fileIndex, const QList<GitDiffLine> &lines);
+    void loadFile(int fileIndex);
+    int fileAt(int row) const;
+    int visibleLines(int fileIndex) const;
+    void shiftRows(int fromFile, int delta);
+    void emitHeaderChanged(int fileIndex);
+    void setLoading(bool loading);
+    void setError(const QString &error);
+
+    QString m_repoPath;
+    QString m_commitHash;
+    bool m_loading = false;
+    QString m_error;
+    int m_generation = 0;  // 每次打开递增，丢弃过期的异步结果
+
+    QList<FileSection> m_files;
+    QList<int> m_fileRow;  // 每个文件标题行的行号（递增）
+    int m_count = 0;
+    std::shared_ptr<GitCancelToken> m_token;
+};
+
+#endif // COMMITDIFFMODEL_H
@@ -0,0 +1,176 @@
+#include "commitgraphitem.h"
+#include <QColor>
+#include <QSGGeometryNode>
+#include <QSGVertexColorMaterial>
+#include <QtMath>
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+constexpr qreal kLineWidth = 2.0;
+constexpr qreal kNodeRadius = 4.5;
+constexpr int kNodeSegments = 12;
+
+// 泳道颜色按编号循环
+QColor laneColor(int lane)
+{
+    static const QColor palette[] = {
+        QColor("#4a90d9"), QColor("#7c5cbf"), QColor("#2ea44f"), QColor("#e36209"),
+        QColor("#d73a49"), QColor("#0598bc"), QColor("#b08800"), QColor("#6f42c1"),
+    };
+    return palette[lane % int(std::size(palette))];
+}
+
+class VertexWriter
+{
+public:
+    explicit VertexWriter(QList<QSGGeometry::ColoredPoint2D> *vertices) : m_vertices(vertices) {}
+
+    void line(QPointF from, QPointF to, const QColor &color)
+    {
+        const qreal dx = to.x() - from.x();
+        const qreal dy = to.y() - from.y();
+        const qreal length = qSqrt(dx * dx + dy * dy);
+        if (length <= 0) return;
+        // 线段加粗成矩形：两侧各偏移半个线宽
+        const qreal nx = -dy / length * kLineWidth / 2;
+        const qreal ny = dx / length * kLineWidth / 2;
+        const QPointF a(from.x() + nx, from.y() + ny);
+        const QPointF b(from.x() - nx, from.y() - ny);
+        const QPointF c(to.x() + nx, to.y() + ny);
+        const QPointF d(to.x() - nx, to.y() - ny);
+        triangle(a, b, c, color);
+        triangle(b, d, c, color);
+    }
+
+    void circle(QPointF center, qreal radius, const QColor &color)
+    {
+        QPointF previous(center.x() + radius, center.y());
+        for (int i = 1; i <= kNodeSegments; i++) {
+            const qreal angle = 2 * M_PI * i / kNodeSegments;
+            const QPointF next(center.x() + radius * qCos(angle), center.y() + radius * qSin(angle));
+            triangle(center, previous, next, color);
+            previous = next;
+        }
+    }
+
+private:
+    void triangle(QPointF a, QPointF b, QPointF c, const QColor &color)
+    {
+        for (QPointF p : {a, b, c}) {
+            QSGGeometry::ColoredPoint2D vertex;
+            vertex.set(float(p.x()), float(p.y()), uchar(color.red()), uchar(color.green()),
+                       uchar(color.blue()), uchar(color.alpha()));
+            m_vertices->append(vertex);
+        }
+    }
+
+    QList<QSGGeometry::ColoredPoint2D> *m_vertices;
+};
+
+} // namespace
+
+CommitGraphItem::CommitGraphItem(QQuickItem *parent)
+    : QQuickItem(parent)
+{
+    setFlag(ItemHasContents, true);
+}
+
+void CommitGraphItem::setGraph(const GitGraphRow &graph)
+{
+    if (graph == m_graph) {
+        return;
+    }
+    m_graph = graph;
+    emit graphChanged();
+    update();
+}
+
+void CommitGraphItem::setLaneSpacing(qreal spacing)
+{
+    if (qFuzzyCompare(spacing, m_laneSpacing) || spacing <= 0) {
+        return;
+    }
+    m_laneSpacing = spacing;
+    emit laneSpacingChanged();
+    update();
+}
+
+void CommitGraphItem::setNodeY(qreal y)
+{
+    if (qFuzzyCompare(y, m_nodeY)) {
+        return;
+    }
+    m_nodeY = y;
+    emit nodeYChanged();
+    update();
+}
+
+void CommitGraphItem::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+    if (newGeometry.size() != oldGeometry.size()) {
+        update();
+    }
+}
+
+QSGNode *CommitGraphItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
+{
+    auto *node = static_cast<QSGGeometryNode *>(oldNode);
+    if (!m_graph.isValid() || width() <= 0 || height() <= 0) {
+        delete node;
+        return nullptr;
+    }
+
+    // 超出宽度的泳道不生成顶点（连到它们的斜线仍然画到边缘为止，由 clip 裁掉）
+    const int visibleLanes = qMax(1, int(width() / m_laneSpacing) + 1);
+    const qreal bottom = height();
+    const qreal nodeY = qBound<qreal>(0, m_nodeY, bottom);
+    auto laneX = [this](int lane) { return m_laneSpacing * (lane + 0.5); };
+
+    QList<QSGGeometry::ColoredPoint2D> vertices;
+    VertexWriter writer(&vertices);
+
+    for (qsizetype i = 0; i + 1 < m_graph.through.size(); i += 2) {
+        const int last = qMin<int>(m_graph.through[i + 1], visibleLanes - 1);
+        for (int lane = m_graph.through[i]; lane <= last; lane++) {
+            writer.line(QPointF(laneX(lane), 0), QPointF(laneX(lane), bottom), laneColor(lane));
+        }
+    }
+
+    const QPointF center(laneX(m_graph.lane), nodeY);
+    if (m_graph.continuesUp && m_graph.lane < visibleLanes) {
+        writer.line(QPointF(center.x(), 0), center, laneColor(m_graph.lane));
+    }
+    for (quint16 parent : std::as_const(m_graph.parentLanes)) {
+        if (parent >= visibleLanes && m_graph.lane >= visibleLanes) {
+            continue;
+        }
+        // 合并线用父提交泳道的颜色，和它下面的直线接上
+        writer.line(center, QPointF(laneX(parent), bottom), laneColor(parent));
+    }
+    if (m_graph.lane < visibleLanes) {
+        const QColor color = laneColor(m_graph.lane);
+        writer.circle(center, kNodeRadius, color);
+        if (m_graph.parentLanes.size() > 1) {
+            // 合并提交：空心节点
+            writer.circle(center, kNodeRadius - kLineWidth, QColor(Qt::white));
+        }
+    }
+
+    if (!node) {
+        node = new QSGGeometryNode;
+        auto *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_ColoredPoint2D(), 0);
+        geometry->setDrawingMode(QSGGeometry::DrawTriangles);
+        node->setGeometry(geometry);
+        node->setFlag(QSGNode::OwnsGeometry);
+        node->setMaterial(new QSGVertexColorMaterial);
+        node->setFlag(QSGNode::OwnsMaterial);
+    }
+    QSGGeometry *geometry = node->geometry();
+    geometry->allocate(int(vertices.size()));
+    std::copy(vertices.cbegin(), vertices.cend(), geometry->vertexDataAsColoredPoint2D());
+    node->markDirty(QSGNode::DirtyGeometry);
+    return node;
+}
@@ -0,0 +1,44 @@
+#ifndef COMMITGRAPHITEM_H
+#define COMMITGRAPHITEM_H
+
+#include <QQuickItem>
+#include "gitgraphlayout.h"
+
+// 历史列表每一行左侧的提交图
+// 直接生成场景图的三角形（一个几何节点、顶点着色），不经过 Canvas/QPainter 的离屏绘制；
+// 只生成宽度范围内的泳道，分支再多每行的顶点数也有上限。
+// 项目的上下边缘与相邻行相接，节点画在 nodeY 高度。
+class CommitGraphItem : public QQuickItem
+{
+    Q_OBJECT
+    QML_ELEMENT
+    Q_PROPERTY(GitGraphRow graph READ graph WRITE setGraph NOTIFY graphChanged)
+    Q_PROPERTY(qreal laneSpacing READ laneSpacing WRITE setLaneSpacing NOTIFY laneSpacingChanged)
+    Q_PROPERTY(qreal nodeY READ nodeY WRITE setNodeY NOTIFY nodeYChanged)
+
+public:
+    explicit CommitGraphItem(QQuickItem *parent = nullptr);
+
+    GitGraphRow graph() const { return m_graph; }
+    void setGraph(const GitGraphRow &graph);
+    qreal laneSpacing() const { return m_laneSpacing; }
+    void setLaneSpacing(qreal spacing);
+    qreal nodeY() const { return m_nodeY; }
+    void setNodeY(qreal y);
+
+signals:
+    void graphChanged();
+    void laneSpacingChanged();
+    void nodeYChanged();
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+
+private:
+    GitGraphRow m_graph;
+    qreal m_laneSpacing = 14;
+    qreal m_nodeY = 20;
+};
+
+#endif // COMMITGRAPHITEM_H
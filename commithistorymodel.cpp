@@ -0,0 +1,698 @@
+#include "commithistorymodel.h"
+#include "gitfilehistory.h"
+#include "githistoryindex.h"
+#include "gitlogparser.h"
+#include "gitoperationqueue.h"
+#include "gitprocess.h"
+#include "gittokenizer.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QPointer>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <QtConcurrent>
+
+// GUI 线程与读取历史的工作线程之间共享：requested 是视图需要的行数
+struct CommitHistoryModel::StreamState
+{
+    QMutex mutex;
+    QWaitCondition demand;
+    int requested = 0;
+    bool stopped = false;
+};
+
+namespace {
+
+// 历史读取专用的线程池：git log 在整个浏览期间停在等待 fetchMore 上，搜索索引的构建也要很久，
+// 放在全局线程池会占住其他模型（文件列表、差异）使用的线程
+class HistoryThreadPool : public QThreadPool
+{
+public:
+    HistoryThreadPool()
+    {
+        setMaxThreadCount(4);
+        setExpiryTimeout(60000);
+    }
+};
+
+Q_GLOBAL_STATIC(HistoryThreadPool, historyThreadPool)
+
+} // namespace
+
+CommitHistoryModel::CommitHistoryModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+CommitHistoryModel::~CommitHistoryModel()
+{
+    stopStream();
+}
+
+int CommitHistoryModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_count;
+}
+
+QVariant CommitHistoryModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_count) {
+        return QVariant();
+    }
+
+    const CommitEntry *commit = commitAt(index.row());
+    if (!commit) {
+        // 该页已滑出窗口，正在重新读取；先只显示提交 id
+        switch (role) {
+        case HashRole:
+            return hashAt(index.row());
+        case ShortHashRole:
+            return hashAt(index.row()).left(7);
+        case MaterializedRole:
+            return false;
+        case FilesRole:
+            return QVariant::fromValue(QList<CommitFileEntry>());
+        case FileCountRole:
+        case AdditionsRole:
+        case DeletionsRole:
+            return 0;
+        case IsMessageOnlyRole:
+            return false;
+        case GraphRole:
+            return QVariant::fromValue(graphAt(index.row()));
+        }
+        return QString();
+    }
+
+    switch (role) {
+    case HashRole:
+        return commit->hash;
+    case ShortHashRole:
+        return commit->shortHash();
+    case AuthorRole:
+        return commit->author;
+    case RelativeDateRole:
+        return commit->relativeDate;
+    case FullDateRole:
+        return commit->fullDate;
+    case Qt::DisplayRole:
+    case MessageRole:
+        return commit->message;
+    case FilesRole:
+        return QVariant::fromValue(commit->files);
+    case FileCountRole:
+        return commit->fileCount();
+    case IsMessageOnlyRole:
+        return commit->isMessageOnly();
+    case AdditionsRole:
+        return commit->additions();
+    case DeletionsRole:
+        return commit->deletions();
+    case MaterializedRole:
+        return true;
+    case GraphRole:
+        return QVariant::fromValue(graphAt(index.row()));
+    }
+    return QVariant();
+}
+
+QHash<int, QByteArray> CommitHistoryModel::roleNames() const
+{
+    return {
+        {HashRole, "hash"},
+        {ShortHashRole, "shortHash"},
+        {AuthorRole, "author"},
+        {RelativeDateRole, "relativeDate"},
+        {FullDateRole, "fullDate"},
+        {MessageRole, "message"},
+        {FilesRole, "files"},
+        {FileCountRole, "fileCount"},
+        {IsMessageOnlyRole, "isMessageOnly"},
+        {AdditionsRole, "additions"},
+        {DeletionsRole, "deletions"},
+        {MaterializedRole, "materialized"},
+        {GraphRole, "graph"}
+    };
+}
+
+bool CommitHistoryModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && !m_finished && m_stream;
+}
+
+void CommitHistoryModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
+    {
+        QMutexLocker locker(&m_stream->mutex);
+        if (m_stream->requested > m_count) {
+            return;  // 上一页还没到
+        }
+        m_stream->requested = m_count + PageSize;
+    }
+    m_stream->demand.wakeAll();
+    setLoading(true);
+}
+
+void CommitHistoryModel::setFilter(const QString &filter)
+{
+    const QString trimmed = filter.trimmed();
+    if (trimmed == m_filter) {
+        return;
+    }
+    m_filter = trimmed;
+    emit filterChanged();
+    reload();
+}
+
+void CommitHistoryModel::setPath(const QString &path)
+{
+    if (path == m_path) {
+        return;
+    }
+    m_path = path;
+    emit pathChanged();
+    reload();
+}
+
+void CommitHistoryModel::setRepoPath(const QString &repoPath)
+{
+    if (repoPath == m_repoPath) {
+        return;
+    }
+    // 只在打开历史时才开始读取
+    m_repoPath = repoPath;
+    if (!m_path.isEmpty()) {
+        m_path.clear();
+        emit pathChanged();
+    }
+    m_head = CommitEntry();
+    emit headChanged();
+    clear();
+}
+
+void CommitHistoryModel::reload()
+{
+    clear();
+    if (m_repoPath.isEmpty()) {
+        return;
+    }
+    const int generation = m_generation;
+
+    if (!m_path.isEmpty()) {
+        loadFileHistory(generation);
+        return;
+    }
+    if (m_filter.isEmpty()) {
+        // 打开或刷新历史时顺便把搜索索引追加到当前 HEAD
+        QString repoPath = m_repoPath;
+        QFuture<bool> indexFuture = QtConcurrent::run(historyThreadPool(), [repoPath]() {
+            return GitHistoryIndex::forRepo(repoPath)->update();
+        });
+    } else if (GitHistoryIndex::forRepo(m_repoPath)->isReady()) {
+        searchIndex(generation);
+        return;
+    } else {
+        searchLog(generation);
+        return;
+    }
+
+    m_finished = false;
+    emit finishedChanged();
+    setLoading(true);
+
+    m_stream = std::make_shared<StreamState>();
+    m_stream->requested = PageSize;
+    m_streamToken = GitCancelToken::create(QString());
+
+    // 提交图要求父提交出现在所有子提交之后（默认按时间排序，时钟不准时会打乱）
+    const QStringList args = QStringList{"log"} + GitLogParser::formatArguments() + QStringList{"--date-order"};
+
+    // 这个 git log 在整个浏览期间一直存在，大部分时间在等待 fetchMore，
+    // 既不占用仓库读线程池（线程数很少），也不占用全局线程池，使用历史专用的线程池
+    QString repoPath = m_repoPath;
+    std::shared_ptr<StreamState> state = m_stream;
+    GitCancelToken::Ptr token = m_streamToken;
+    QPointer<CommitHistoryModel> self(this);
+    QFuture<void> future = QtConcurrent::run(historyThreadPool(), [self, repoPath, args, state, token, generation]() {
+        QElapsedTimer timer;
+        timer.start();
+
+        auto deliver = [&self, generation](const QList<CommitEntry> &commits, bool finished, const QString &error) {
+            QMetaObject::invokeMethod(self.data(), [self, generation, commits, finished, error]() {
+                if (self) {
+                    self->appendCommits(generation, commits, finished, error);
+                }
+            }, Qt::QueuedConnection);
+        };
+
+        GitLogParser parser(GitPathTable::forRepo(repoPath));
+        int produced = 0;
+        GitProcess process(repoPath, token);
+        process.setOutputHandler([&](const QByteArray &chunk) {
+            parser.feed(chunk);
+            if (!parser.hasCommits()) return;
+            QList<CommitEntry> commits = parser.takeCommits();
+            produced += int(commits.size());
+            deliver(commits, false, QString());
+            if (produced == int(commits.size())) {
+                qDebug() << "Commit history: first" << produced << "commits in" << timer.elapsed() << "ms";
+            }
+
+            // 视图不需要更多时停在这里：不再读取管道，git 写满后自己暂停
+            QMutexLocker locker(&state->mutex);
+            while (!state->stopped && produced >= state->requested) {
+                state->demand.wait(&state->mutex);
+            }
+        });
+
+        // 等待 fetchMore 期间没有输出，不能启用卡死检测
+        GitResult result = process.run(args, -1);
+        if (result.cancelled) {
+            return;
+        }
+        parser.finish();
+        QList<CommitEntry> commits = parser.takeCommits();
+        produced += int(commits.size());
+        // 空仓库（还没有提交）时 git log 报错，当作没有历史
+        const QString error = (result.ok() || produced == 0) ? QString() : result.errorText();
+        deliver(commits, true, error);
+        qDebug() << "Commit history:" << produced << "commits streamed in" << timer.elapsed() << "ms";
+    });
+}
+
+void CommitHistoryModel::searchIndex(int generation)
+{
+    setLoading(true);
+    QString repoPath = m_repoPath;
+    QString filter = m_filter;
+    QPointer<CommitHistoryModel> self(this);
+    QFuture<void> future = GitOperationQueue::forRepo(repoPath)->run(GitOperationQueue::Read, [self, repoPath, filter, generation]() {
+        const QStringList hashes = GitHistoryIndex::forRepo(repoPath)->search(filter);
+        const int oidSize = hashes.isEmpty() ? 0 : int(hashes.first().size() / 2);
+        QByteArray oids;
+        oids.reserve(hashes.size() * oidSize);
+        for (const QString &hash : hashes) {
+            oids.append(QByteArray::fromHex(hash.toLatin1()).leftJustified(oidSize, '\0', true));
+        }
+        QMetaObject::invokeMethod(self.data(), [self, generation, oids, oidSize]() {
+            if (self) {
+                self->appendOids(generation, oids, oidSize, QStringList(), true, QString());
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void CommitHistoryModel::searchLog(int generation)
+{
+    m_finished = false;
+    emit finishedChanged();
+    setLoading(true);
+    m_streamToken = GitCancelToken::create(QString());
+
+    // 索引还没建好时直接扫描 git log：提交信息或作者包含关键字
+    // （git log 的 --grep 与 --author 同时给出时要求两者都匹配，所以只取 id、作者和完整信息，在这里过滤）
+    QString repoPath = m_repoPath;
+    QString filter = m_filter;
+    GitCancelToken::Ptr token = m_streamToken;
+    QPointer<CommitHistoryModel> self(this);
+    QFuture<void> future = QtConcurrent::run(historyThreadPool(), [self, repoPath, filter, token, generation]() {
+        auto deliver = [&self, generation](const QByteArray &oids, int oidSize, bool finished, const QString &error) {
+            QMetaObject::invokeMethod(self.data(), [self, generation, oids, oidSize, finished, error]() {
+                if (self) {
+                    self->appendOids(generation, oids, oidSize, QStringList(), finished, error);
+                }
+            }, Qt::QueuedConnection);
+        };
+
+        QElapsedTimer timer;
+        timer.start();
+        QByteArray oids;
+        int oidSize = 0;
+        int matched = 0;
+        // 记录："<id> US <作者> <<邮箱>> US <完整信息>"，与 git log -i --fixed-strings 相同，不区分大小写
+        auto match = [&](QByteArrayView record) {
+            const auto fields = GitTokenizer::split<3>(record, '\x1f');
+            if (fields.count < 3) return;
+            if (!GitTokenizer::toString(fields[1]).contains(filter, Qt::CaseInsensitive)
+                && !GitTokenizer::toString(fields[2]).contains(filter, Qt::CaseInsensitive)) {
+                return;
+            }
+            const QByteArray oid = QByteArray::fromHex(fields[0].toByteArray());
+            oidSize = int(oid.size());
+            oids.append(oid);
+            matched++;
+        };
+
+        QByteArray buffer;
+        bool received = false;
+        GitProcess process(repoPath, token);
+        process.setOutputHandler([&](const QByteArray &chunk) {
+            received = true;
+            buffer.append(chunk);
+            const qsizetype end = buffer.lastIndexOf('\0');
+            if (end < 0) return;
+            GitTokenizer::forEachRecord(QByteArrayView(buffer).first(end), '\0', match);
+            buffer.remove(0, end + 1);
+            if (!oids.isEmpty()) {
+                deliver(oids, oidSize, false, QString());
+                oids.clear();
+            }
+        });
+
+        GitResult result = process.run({"log", "-z", "--format=%H%x1f%an <%ae>%x1f%B"}, 30000);
+        if (result.cancelled) {
+            return;
+        }
+        GitTokenizer::forEachRecord(buffer, '\0', match);
+        // 空仓库（还没有提交）时 git log 报错，当作没有结果
+        const QString error = (result.ok() || !received) ? QString() : result.errorText();
+        deliver(oids, oidSize, true, error);
+        qDebug() << "Commit search:" << matched << "commits matched in" << timer.elapsed() << "ms";
+    });
+}
+
+void CommitHistoryModel::loadFileHistory(int generation)
+{
+    m_finished = false;
+    emit finishedChanged();
+    setLoading(true);
+    m_streamToken = GitCancelToken::create(QString());
+
+    QString repoPath = m_repoPath;
+    QString path = m_path;
+    GitCancelToken::Ptr token = m_streamToken;
+    QPointer<CommitHistoryModel> self(this);
+    QFuture<void> future = GitOperationQueue::forRepo(repoPath)->run(GitOperationQueue::Read, [self, repoPath, path, token, generation]() {
+        auto deliver = [&self, generation](const QByteArray &oids, int oidSize, const QStringList &names,
+                                           bool finished, const QString &error) {
+            QMetaObject::invokeMethod(self.data(), [self, generation, oids, oidSize, names, finished, error]() {
+                if (self) {
+                    self->appendOids(generation, oids, oidSize, names, finished, error);
+                }
+            }, Qt::QueuedConnection);
+        };
+
+        GitFileHistory *history = GitFileHistory::forRepo(repoPath);
+        history->checkChangedPathFilters();
+
+        GitResult head = GitProcess(repoPath, token).run({"rev-parse", "--verify", "--quiet", "HEAD"}, 10000);
+        if (head.cancelled) return;
+        const QString tip = head.outputText();
+        if (!head.ok() || tip.isEmpty()) {
+            deliver(QByteArray(), 0, QStringList(), true, QString());  // 还没有提交
+            return;
+        }
+
+        GitFileHistory::Result result;
+        if (history->lookup(tip, path, &result)) {
+            deliver(result.oids, result.oidSize, result.names, true, QString());
+            return;
+        }
+
+        // 提交 id 边查询边显示，完整信息按页读取
+        QString error;
+        const bool ok = history->walk(tip, path, token, [&deliver](const QByteArray &oids, int oidSize, const QStringList &names) {
+            deliver(oids, oidSize, names, false, QString());
+        }, &result, &error);
+        if (!ok && token->isCancelled()) return;
+        deliver(QByteArray(), result.oidSize, result.names, true, error);
+    });
+}
+
+void CommitHistoryModel::appendOids(int generation, const QByteArray &oids, int oidSize, const QStringList &pathNames,
+                                    bool finished, const QString &error)
+{
+    if (generation != m_generation) {
+        return;
+    }
+
+    if (!pathNames.isEmpty()) {
+        m_pathNames = pathNames;
+    }
+    // 只有提交 id，完整信息在显示到该页时按 id 读取
+    if (!oids.isEmpty() && oidSize > 0) {
+        m_oidSize = oidSize;
+        const int rows = int(oids.size() / oidSize);
+        beginInsertRows(QModelIndex(), m_count, m_count + rows - 1);
+        m_oids.append(oids);
+        m_count += rows;
+        endInsertRows();
+        emit countChanged();
+    }
+
+    if (finished) {
+        if (!m_finished) {
+            m_finished = true;
+            emit finishedChanged();
+        }
+        if (!error.isEmpty()) {
+            emit errorOccurred(error);
+        }
+        setLoading(false);
+    }
+}
+
+void CommitHistoryModel::clear()
+{
+    stopStream();
+    ++m_generation;
+
+    beginResetModel();
+    m_count = 0;
+    m_oids.clear();
+    m_oidSize = 0;
+    m_pages.clear();
+    m_pageOrder.clear();
+    m_pendingPages.clear();
+    m_pathNames.clear();
+    m_graphLayout.clear();
+    m_graph.clear();
+    endResetModel();
+    emit countChanged();
+    if (m_graphLanes != 0) {
+        m_graphLanes = 0;
+        emit graphLanesChanged();
+    }
+
+    if (!m_finished) {
+        m_finished = true;
+        emit finishedChanged();
+    }
+    setLoading(false);
+}
+
+void CommitHistoryModel::stopStream()
+{
+    if (m_stream) {
+        {
+            QMutexLocker locker(&m_stream->mutex);
+            m_stream->stopped = true;
+        }
+        m_stream->demand.wakeAll();
+    }
+    if (m_streamToken) {
+        m_streamToken->cancel();
+    }
+    m_stream.reset();
+    m_streamToken.reset();
+}
+
+void CommitHistoryModel::appendCommits(int generation, const QList<CommitEntry> &commits, bool finished, const QString &error)
+{
+    if (generation != m_generation) {
+        return;
+    }
+
+    if (!commits.isEmpty()) {
+        const bool first = m_count == 0;
+        if (m_oidSize == 0) {
+            m_oidSize = int(commits.first().hash.size() / 2);
+        }
+
+        const int graphLanes = m_graphLanes;
+        beginInsertRows(QModelIndex(), m_count, m_count + int(commits.size()) - 1);
+        for (const CommitEntry &commit : commits) {
+            const int page = m_count / PageSize;
+            m_oids.append(QByteArray::fromHex(commit.hash.toLatin1()).leftJustified(m_oidSize, '\0', true));
+            if (m_filter.isEmpty()) {
+                m_graph.append(m_graphLayout.append(commit.hash, commit.parents));
+                m_graphLanes = qMax(m_graphLanes, m_graph.last().width);
+            }
+            QList<CommitEntry> &rows = m_pages[page];
+            if (rows.isEmpty()) {
+                m_pageOrder.append(page);
+            }
+            rows.append(commit);
+            m_count++;
+        }
+        endInsertRows();
+        emit countChanged();
+        if (m_graphLanes != graphLanes) {
+            emit graphLanesChanged();
+        }
+        evictPages();
+
+        if (first && m_filter.isEmpty()) {
+            m_head = commits.first();
+            emit headChanged();
+        }
+    }
+
+    if (finished) {
+        m_finished = true;
+        emit finishedChanged();
+        if (m_count == 0 && m_filter.isEmpty() && !m_head.hash.isEmpty()) {
+            m_head = CommitEntry();
+            emit headChanged();
+        }
+        if (!error.isEmpty()) {
+            emit errorOccurred(error);
+        }
+    }
+
+    bool satisfied = finished;
+    if (!satisfied && m_stream) {
+        QMutexLocker locker(&m_stream->mutex);
+        satisfied = m_count >= m_stream->requested;
+    }
+    if (satisfied) {
+        setLoading(false);
+    }
+}
+
+const CommitEntry *CommitHistoryModel::commitAt(int row) const
+{
+    const int page = row / PageSize;
+    auto it = m_pages.constFind(page);
+    if (it == m_pages.constEnd() || row % PageSize >= it->size()) {
+        requestPage(page);
+        return nullptr;
+    }
+    if (m_pageOrder.last() != page) {
+        m_pageOrder.removeOne(page);
+        m_pageOrder.append(page);
+    }
+    return &it->at(row % PageSize);
+}
+
+void CommitHistoryModel::requestPage(int page) const
+{
+    if (m_pendingPages.contains(page) || m_repoPath.isEmpty()) {
+        return;
+    }
+    m_pendingPages.insert(page);
+
+    const int first = page * PageSize;
+    const int last = qMin(m_count, first + PageSize);
+    QStringList hashes;
+    hashes.reserve(last - first);
+    for (int row = first; row < last; row++) {
+        hashes.append(hashAt(row));
+    }
+
+    // 按 id 读取指定的提交，保持命令行中的顺序
+    QStringList args = QStringList{"log", "--no-walk=unsorted"} + GitLogParser::formatArguments() + hashes;
+    if (!m_pathNames.isEmpty()) {
+        // 文件历史：只列出该文件（包括重命名之前的路径）的修改
+        args << "--" << m_pathNames;
+    }
+    const int generation = m_generation;
+    QString repoPath = m_repoPath;
+    QPointer<CommitHistoryModel> self(const_cast<CommitHistoryModel *>(this));
+    QFuture<void> future = GitOperationQueue::forRepo(repoPath)->run(GitOperationQueue::Read, [self, repoPath, args, generation, page]() {
+        GitLogParser parser(GitPathTable::forRepo(repoPath));
+        GitProcess process(repoPath);
+        process.setOutputHandler([&parser](const QByteArray &chunk) {
+            parser.feed(chunk);
+        });
+        process.run(args);
+        parser.finish();
+        QList<CommitEntry> commits = parser.takeCommits();
+        QMetaObject::invokeMethod(self.data(), [self, generation, page, commits]() {
+            if (self) {
+                self->applyPage(generation, page, commits);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void CommitHistoryModel::applyPage(int generation, int page, const QList<CommitEntry> &commits)
+{
+    if (generation != m_generation) {
+        return;
+    }
+    const int first = page * PageSize;
+    const int last = qMin(m_count, first + PageSize) - 1;
+    m_pendingPages.remove(page);
+
+    // 按 id 对应：提交可能已被 gc 清除，文件历史的路径限制也可能滤掉个别提交（如合并），
+    // 读不到的行只保留提交 id 并标记出来，不再重新读取
+    QList<CommitEntry> rows = commits;
+    if (commits.size() != last - first + 1) {
+        QHash<QString, CommitEntry> byHash;
+        for (const CommitEntry &commit : commits) {
+            byHash.insert(commit.hash, commit);
+        }
+        rows.clear();
+        rows.reserve(last - first + 1);
+        int missing = 0;
+        for (int row = first; row <= last; row++) {
+            const QString hash = hashAt(row);
+            auto it = byHash.constFind(hash);
+            if (it != byHash.constEnd()) {
+                rows.append(*it);
+                continue;
+            }
+            CommitEntry placeholder;
+            placeholder.hash = hash;
+            placeholder.message = QStringLiteral("（无法读取该提交）");
+            rows.append(placeholder);
+            missing++;
+        }
+        qWarning() << "Commit history: page" << page << "reload missed" << missing << "of" << rows.size() << "commits";
+    }
+
+    m_pages.insert(page, rows);
+    m_pageOrder.removeOne(page);
+    m_pageOrder.append(page);
+    evictPages();
+    emit dataChanged(index(first), index(last));
+}
+
+void CommitHistoryModel::evictPages()
+{
+    // 正在追加的最后一页不释放
+    const int tailPage = m_count > 0 ? (m_count - 1) / PageSize : 0;
+    for (qsizetype i = 0; m_pageOrder.size() > WindowPages && i < m_pageOrder.size();) {
+        if (m_pageOrder[i] == tailPage) {
+            i++;
+            continue;
+        }
+        m_pages.remove(m_pageOrder.takeAt(i));
+    }
+}
+
+GitGraphRow CommitHistoryModel::graphAt(int row) const
+{
+    return row < m_graph.size() ? m_graph.at(row) : GitGraphRow();
+}
+
+QString CommitHistoryModel::hashAt(int row) const
+{
+    return QString::fromLatin1(m_oids.mid(qsizetype(row) * m_oidSize, m_oidSize).toHex());
+}
+
+void CommitHistoryModel::setLoading(bool loading)
+{
+    if (m_loading != loading) {
+        m_loading = loading;
+        emit loadingChanged();
+    }
+}
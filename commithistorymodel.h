@@ -0,0 +1,145 @@
+#ifndef COMMITHISTORYMODEL_H
+#define COMMITHISTORYMODEL_H
+
+#include <QAbstractListModel>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <qqml.h>
+#include <memory>
+#include "gitentries.h"
+#include "gitgraphlayout.h"
+
+class GitCancelToken;
+
+// 提交历史的分页模型
+// 以前历史固定只取 30 条（git log -30），搜索在 QML 中用 JavaScript 过滤这 30 条。现在：
+// - 整个历史只运行一个 git log（GitLogParser 增量解析），视图滚动到底部时 fetchMore
+//   再放行下一页；没有需求时工作线程停在输出回调中，管道写满后 git 自然暂停，不会读完整个历史
+// - 每行只常驻提交 id（原始字节连续存放），完整的提交信息按页保存，最多 WindowPages 页，
+//   滑出窗口的页被释放，再次滚动到时用 git log --no-walk 按 id 重新读取该页
+// - 搜索使用 GitHistoryIndex（整个历史的三字节组索引）；索引建好之前交给 git（--grep / --author）
+// - 未过滤时按 --date-order 读取（父提交总在所有子提交之后），每页到达时由 GitGraphLayout 分配泳道，
+//   每行的图（几个泳道号）常驻，不随窗口释放；搜索结果不是连续的历史，不画图
+// - 设置 path 后只显示一个文件的历史（跟随重命名）：提交 id 由 GitFileHistory 查询并按 HEAD 缓存，
+//   完整信息与搜索结果一样按页读取，只列出该文件的修改；此时不使用 filter
+class CommitHistoryModel : public QAbstractListModel
+{
+    Q_OBJECT
+    QML_ELEMENT
+    QML_UNCREATABLE("由 GitManager.history 提供")
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+    Q_PROPERTY(bool loading READ isLoading NOTIFY loadingChanged)
+    Q_PROPERTY(bool finished READ isFinished NOTIFY finishedChanged)
+    Q_PROPERTY(QString filter READ filter WRITE setFilter NOTIFY filterChanged)
+    Q_PROPERTY(QString path READ path WRITE setPath NOTIFY pathChanged)
+    Q_PROPERTY(int graphLanes READ graphLanes NOTIFY graphLanesChanged)
+
+public:
+    enum Roles {
+        HashRole = Qt::UserRole + 1,
+        ShortHashRole,
+        AuthorRole,
+        RelativeDateRole,
+        FullDateRole,
+        MessageRole,
+        FilesRole,
+        FileCountRole,
+        IsMessageOnlyRole,
+        AdditionsRole,
+        DeletionsRole,
+        MaterializedRole,
+        GraphRole
+    };
+
+    explicit CommitHistoryModel(QObject *parent = nullptr);
+    ~CommitHistoryModel() override;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    bool isLoading() const { return m_loading; }
+    bool isFinished() const { return m_finished; }
+    QString filter() const { return m_filter; }
+    void setFilter(const QString &filter);
+    QString path() const { return m_path; }
+    void setPath(const QString &path);
+    // 已读取的行中图的最大宽度（泳道数），供视图决定图的列宽
+    int graphLanes() const { return m_graphLanes; }
+
+    // 未过滤时的第一条（HEAD），不受窗口释放影响
+    CommitEntry headCommit() const { return m_head; }
+
+    // 切换或关闭仓库时清空（不会开始读取）
+    void setRepoPath(const QString &repoPath);
+
+    // 从 HEAD 重新开始读取历史
+    Q_INVOKABLE void reload();
+
+signals:
+    void countChanged();
+    void loadingChanged();
+    void finishedChanged();
+    void filterChanged();
+    void pathChanged();
+    void graphLanesChanged();
+    void headChanged();
+    void errorOccurred(const QString &message);
+
+private:
+    struct StreamState;
+
+    void clear();
+    void stopStream();
+    void searchIndex(int generation);
+    void searchLog(int generation);
+    void loadFileHistory(int generation);
+    void appendOids(int generation, const QByteArray &oids, int oidSize, const QStringList &pathNames,
+                    bool finished, const QString &error);
+    void appendCommits(int generation, const QList<CommitEntry> &commits, bool finished, const QString &error);
+    const CommitEntry *commitAt(int row) const;
+    void requestPage(int page) const;
+    void applyPage(int generation, int page, const QList<CommitEntry> &commits);
+    void evictPages();
+    QString hashAt(int row) const;
+    GitGraphRow graphAt(int row) const;
+    void setLoading(bool loading);
+
+    static constexpr int PageSize = 200;
+    static constexpr int WindowPages = 8;
+
+    QString m_repoPath;
+    QString m_filter;
+    QString m_path;
+    QStringList m_pathNames;  // 文件历史中该文件用过的所有路径（按页读取时作为路径限制）
+    int m_generation = 0;  // 每次重新读取递增，丢弃过期的异步结果
+    int m_count = 0;
+    bool m_loading = false;
+    bool m_finished = true;
+    CommitEntry m_head;
+
+    // 所有已读取行的提交 id（原始字节，每个 m_oidSize 字节）
+    QByteArray m_oids;
+    int m_oidSize = 0;
+
+    // 已展开的页：页号 -> 该页的提交
+    mutable QHash<int, QList<CommitEntry>> m_pages;
+    mutable QList<int> m_pageOrder;  // 最近访问的在末尾
+    mutable QSet<int> m_pendingPages;
+
+    // 每行的提交图（只在未过滤时）
+    GitGraphLayout m_graphLayout;
+    QList<GitGraphRow> m_graph;
+    int m_graphLanes = 0;
+
+    std::shared_ptr<StreamState> m_stream;
+    std::shared_ptr<GitCancelToken> m_streamToken;
+};
+
+#endif // COMMITHISTORYMODEL_H
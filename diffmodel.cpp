@@ -0,0 +1,624 @@
+#include "diffmodel.h"
+#include "gitconfig.h"
+#include "gitdiffcache.h"
+#include "gitdiffengine.h"
+#include "gitindex.h"
+#include "gitobjectcache.h"
+#include "gitoperationqueue.h"
+#include "gitprocess.h"
+#include "gittokenizer.h"
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QPointer>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace {
+
+// 逐页检测编码时合并各页的结果：一页出现非 UTF-8 内容，整个差异都按它解码
+GitEncoding::Encoding mergeEncoding(GitEncoding::Encoding current, GitEncoding::Encoding page)
+{
+    if (page == GitEncoding::Ascii || page == current) {
+        return current;
+    }
+    if (current == GitEncoding::Ascii) {
+        return page;
+    }
+    return GitEncoding::Local;
+}
+
+// 未跟踪文件是否二进制：与 git 相同，看开头 8000 字节中有没有 NUL
+bool looksBinary(QByteArrayView head)
+{
+    return GitTokenizer::indexOf(head.first(qMin<qsizetype>(head.size(), 8000)), '\0') >= 0;
+}
+
+// 超过这个大小的文件仍由 git diff 流式比较，不整个读入内存
+constexpr qint64 kInProcessLimit = 64 * 1024 * 1024;
+
+// 进程内比较按仓库的 diff 配置进行（与 git diff 的结果相同），选项是缓存键的一部分
+struct EngineOptions
+{
+    bool supported = true;  // patience、minimal 等进程内没有实现的算法交给 git diff
+    GitDiffEngine::Algorithm algorithm = GitDiffEngine::Myers;
+    bool indentHeuristic = true;
+    int context = GitDiffEngine::DefaultContext;
+    int interHunkContext = 0;
+
+    QByteArray key() const
+    {
+        return (algorithm == GitDiffEngine::Histogram ? "histogram" : "myers")
+            + QByteArray(indentHeuristic ? " indent" : "") + " -U" + QByteArray::number(context)
+            + " --inter-hunk-context=" + QByteArray::number(interHunkContext);
+    }
+};
+
+EngineOptions engineOptions(const GitConfig::Snapshot &config)
+{
+    EngineOptions options;
+    const QByteArray algorithm = config.value("diff.algorithm").trimmed().toLower();
+    if (algorithm == "histogram") {
+        options.algorithm = GitDiffEngine::Histogram;
+    } else if (!algorithm.isEmpty() && algorithm != "myers" && algorithm != "default") {
+        options.supported = false;
+    }
+    // diff.external 会让 git diff 完全换成外部程序
+    if (config.values.contains("diff.external")) {
+        options.supported = false;
+    }
+    options.indentHeuristic = config.boolValue("diff.indentheuristic", true);
+    options.context = qMax(0, config.intValue("diff.context", GitDiffEngine::DefaultContext));
+    options.interHunkContext = qMax(0, config.intValue("diff.interhunkcontext", 0));
+    return options;
+}
+
+// 工作区文件与暂存区版本都能直接读到时（index 由 GitIndex 解析，暂存区内容由 GitObjectCache 缓存），
+// 读出两边的内容用于进程内比较；需要 git 才能得到正确结果（属性转换、冲突、拆分的 index 等）时返回 false
+bool loadWorkingPair(const QString &repoPath, const QString &filePath, QString *oid, QByteArray *base, QByteArray *work)
+{
+    const QFileInfo info(repoPath + "/" + filePath);
+    if (!info.isFile() || info.isSymLink() || info.size() > kInProcessLimit) {
+        return false;
+    }
+    GitIndex *index = GitIndex::forRepo(repoPath);
+    if (!index->blobId(filePath, oid)) {
+        return false;
+    }
+    const GitIndex::Conversion conversion = index->conversion(filePath);
+    if (conversion == GitIndex::Unsupported) {
+        return false;
+    }
+
+    QFile file(info.filePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    *work = file.readAll();
+    if (!GitObjectCache::forRepo(repoPath)->content(*oid, base)) {
+        return false;
+    }
+
+    if (conversion == GitIndex::CrlfToLf && !looksBinary(*work) && work->contains('\r')) {
+        // 与 git 相同，比较前把工作区的 CRLF 换成 LF；暂存区里已经有 CR 或工作区有单独的 CR 时
+        // git 的处理更复杂，交给它
+        if (base->contains('\r') || GitTokenizer::count(*work, '\r') != work->count("\r\n")) {
+            return false;
+        }
+        work->replace("\r\n", "\n");
+    }
+    return true;
+}
+
+} // namespace
+
+DiffModel::DiffModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+DiffModel::~DiffModel()
+{
+    if (m_token) {
+        m_token->cancel();
+    }
+}
+
+int DiffModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_count;
+}
+
+QVariant DiffModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_count) {
+        return QVariant();
+    }
+    QByteArrayView content;
+    const Line &line = lineAt(index.row(), &content);
+
+    switch (role) {
+    case TypeRole:
+        return GitDiffLine::typeName(line.type);
+    case Qt::DisplayRole:
+    case ContentRole:
+        // 只有进入视图的行才解码
+        return GitEncoding::decode(content, m_encoding);
+    case LineNumRole:
+        return line.type == GitDiffLine::Header ? 0 : (line.type == GitDiffLine::Delete ? line.oldLine : line.newLine);
+    case OldLineRole:
+        return line.oldLine;
+    case NewLineRole:
+        return line.newLine;
+    case SpansRole: {
+        QVariantList spans;
+        if (line.type != GitDiffLine::Delete && line.type != GitDiffLine::Add) {
+            return spans;
+        }
+        // 块中的行第一次进入视图时才计算整个块
+        const int hunk = hunkAt(index.row());
+        if (hunk >= 0) {
+            requestSpans(hunk);
+        }
+        for (const GitDiffEngine::Span &span : m_spans.value(index.row())) {
+            spans.append(QVariantMap{{"start", span.start}, {"length", span.length}});
+        }
+        return spans;
+    }
+    }
+    return QVariant();
+}
+
+QHash<int, QByteArray> DiffModel::roleNames() const
+{
+    return {
+        {TypeRole, "type"},
+        {ContentRole, "content"},
+        {LineNumRole, "lineNum"},
+        {OldLineRole, "oldLine"},
+        {NewLineRole, "newLine"},
+        {SpansRole, "spans"}
+    };
+}
+
+void DiffModel::setRepoPath(const QString &repoPath)
+{
+    if (repoPath == m_repoPath) {
+        return;
+    }
+    m_repoPath = repoPath;
+    clear();
+}
+
+void DiffModel::open(const QString &filePath, bool staged)
+{
+    clear();
+    m_filePath = filePath;
+    m_staged = staged;
+    emit filePathChanged();
+    if (m_repoPath.isEmpty() || filePath.isEmpty()) {
+        return;
+    }
+    setLoading(true);
+
+    const int generation = m_generation;
+    m_token = GitCancelToken::create(QString());
+    QString repoPath = m_repoPath;
+    GitCancelToken::Ptr token = m_token;
+    QPointer<DiffModel> self(this);
+    QFuture<void> future = GitOperationQueue::forRepo(repoPath)->run(GitOperationQueue::Read, [self, repoPath, filePath, staged, token, generation]() {
+        QElapsedTimer timer;
+        timer.start();
+
+        // diff 片段较短，单独检测容易误判，优先使用工作区文件的编码（有缓存）；
+        // 文件已删除或是 UTF-8 时逐页检测
+        const QString fullPath = repoPath + "/" + filePath;
+        const bool fixedEncoding = QFileInfo::exists(fullPath)
+            && GitEncoding::fileEncoding(fullPath) == GitEncoding::Gb18030;
+        GitEncoding::Encoding encoding = fixedEncoding ? GitEncoding::Gb18030 : GitEncoding::Ascii;
+
+        int pages = 0;
+        qint64 rows = 0;
+        auto sendPage = [&](const DiffModel::Page &sent, GitEncoding::Encoding sentEncoding) {
+            pages++;
+            rows += sent.lines.size();
+            QMetaObject::invokeMethod(self.data(), [self, generation, sent, sentEncoding]() {
+                if (self) {
+                    self->applyPage(generation, sent, sentEncoding);
+                }
+            }, Qt::QueuedConnection);
+        };
+        auto sendFinished = [&](bool binary, const QString &error) {
+            QMetaObject::invokeMethod(self.data(), [self, generation, binary, error]() {
+                if (self) {
+                    self->applyFinished(generation, binary, error);
+                }
+            }, Qt::QueuedConnection);
+        };
+
+        // 比较的两边都能确定时（cacheKey 不为空）结果写入缓存
+        QByteArray cacheKey;
+        QList<DiffModel::Page> produced;
+        auto replayCached = [&]() {
+            GitDiffCache::Result cached;
+            if (!GitDiffCache::instance()->lookup(cacheKey, &cached)) {
+                return false;
+            }
+            for (const DiffModel::Page &cachedPage : std::as_const(cached.pages)) {
+                sendPage(cachedPage, cached.encoding);
+            }
+            sendFinished(cached.binary, QString());
+            qDebug() << "Diff:" << filePath << rows << "lines," << pages << "pages in" << timer.elapsed() << "ms (cached)";
+            return true;
+        };
+
+        DiffModel::Page page;
+        auto flush = [&]() {
+            if (page.lines.isEmpty()) return;
+            if (!fixedEncoding) {
+                encoding = mergeEncoding(encoding, GitEncoding::detect(page.bytes));
+            }
+            sendPage(page, encoding);
+            if (!cacheKey.isEmpty()) {
+                produced.append(page);
+            }
+            page = DiffModel::Page();
+        };
+        auto append = [&](GitDiffLine::Type type, int oldLine, int newLine, QByteArrayView content) {
+            page.lines.append({type, oldLine, newLine, quint32(page.bytes.size()), quint32(content.size())});
+            page.bytes.append(content);
+            if (page.lines.size() >= DiffModel::PageLines) {
+                flush();
+            }
+        };
+        auto finish = [&](bool binary, const QString &error) {
+            flush();
+            if (!cacheKey.isEmpty() && error.isEmpty()) {
+                GitDiffCache::instance()->insert(cacheKey, {produced, binary, encoding});
+            }
+            sendFinished(binary, error);
+        };
+
+        // 工作区的修改：在进程内与暂存区版本比较，不运行 git diff；
+        // 暂存区版本和工作区内容都没变时直接用上次的结果
+        QString oid;
+        QByteArray base;
+        QByteArray work;
+        const GitConfig::Snapshot config = GitConfig::forRepo(repoPath)->snapshot();
+        const EngineOptions options = engineOptions(config);
+        if (!staged && options.supported && loadWorkingPair(repoPath, filePath, &oid, &base, &work)) {
+            if (token->isCancelled()) return;
+            cacheKey = GitDiffCache::key("worktree", oid, QCryptographicHash::hash(work, QCryptographicHash::Sha1),
+                                         options.key());
+            if (replayCached()) return;
+            bool binary = false;
+            if (base != work) {
+                if (looksBinary(base) || looksBinary(work)) {
+                    binary = true;
+                } else {
+                    GitDiffEngine engine(base, work);
+                    engine.forEachLine(engine.diff(options.algorithm, options.indentHeuristic), append,
+                                       options.context, options.interHunkContext);
+                }
+            }
+            finish(binary, QString());
+            qDebug() << "Diff:" << filePath << rows << "lines," << pages << "pages in" << timer.elapsed() << "ms (in process)";
+            return;
+        }
+
+        // 暂存区的修改：HEAD 中的版本和暂存区的 blob 都没变时直接用上次的结果（新文件在 HEAD 中没有）
+        if (staged && GitIndex::forRepo(repoPath)->blobId(filePath, &oid)) {
+            GitResult head = GitProcess(repoPath, token).run({"rev-parse", "--verify", "-q", "HEAD:" + filePath}, 10000);
+            if (head.cancelled) return;
+            if (!head.stalled) {
+                // git diff 的结果还取决于路径上的属性（diff 驱动等）和仓库的 diff 配置（算法、上下文、
+                // 缩进启发、textconv 等），路径和所有 diff.* 配置都放进键
+                cacheKey = GitDiffCache::key("index", head.ok() ? head.outputText() : QString(), oid.toLatin1(),
+                                             "git diff --cached -- " + filePath.toUtf8() + '\0'
+                                                 + config.fingerprint("diff."));
+                if (replayCached()) return;
+            }
+        }
+
+        GitPatchParser parser;
+        parser.setLineHandler(append);
+        GitProcess process(repoPath, token);
+        process.setOutputHandler([&](const QByteArray &chunk) {
+            parser.feed(chunk);
+            // 第一页不等凑满，尽快显示
+            if (pages == 0) {
+                flush();
+            }
+        });
+        QStringList args{"diff"};
+        if (staged) {
+            args << "--cached";
+        }
+        args << "--" << filePath;
+        GitResult result = process.run(args);
+        if (result.cancelled) return;
+        if (!result.ok()) {
+            // 不把卡死的 diff 当成"新文件"展示
+            finish(false, result.errorText());
+            return;
+        }
+        parser.finish();
+        bool binary = false;
+        for (const GitPatchParser::Section &section : parser.takeSections()) {
+            binary = binary || section.binary;
+        }
+
+        if (parser.sectionCount() == 0 && !staged) {
+            // 未跟踪的新文件：git diff 没有输出，按块读取文件，全部显示为新增
+            QFile file(fullPath);
+            if (file.open(QIODevice::ReadOnly)) {
+                QByteArray buffer;
+                int lineNum = 0;
+                auto appendLine = [&](QByteArrayView line) {
+                    if (line.endsWith('\r')) line.chop(1);
+                    append(GitDiffLine::Add, 0, ++lineNum, line);
+                };
+                while (!token->isCancelled()) {
+                    const QByteArray block = file.read(256 * 1024);
+                    if (block.isEmpty()) break;
+                    if (lineNum == 0 && buffer.isEmpty() && looksBinary(block)) {
+                        binary = true;
+                        break;
+                    }
+                    buffer.append(block);
+                    qsizetype start = 0;
+                    for (qsizetype end; (end = GitTokenizer::indexOf(buffer, '\n', start)) >= 0; start = end + 1) {
+                        appendLine(QByteArrayView(buffer).sliced(start, end - start));
+                    }
+                    buffer.remove(0, start);
+                    if (pages == 0) {
+                        flush();
+                    }
+                }
+                if (!buffer.isEmpty() && !binary) {
+                    appendLine(buffer);
+                }
+            }
+            if (token->isCancelled()) return;
+        }
+
+        finish(binary, QString());
+        qDebug() << "Diff:" << filePath << rows << "lines," << pages << "pages in" << timer.elapsed() << "ms";
+    });
+}
+
+void DiffModel::clear()
+{
+    if (m_token) {
+        m_token->cancel();
+        m_token.reset();
+    }
+    ++m_generation;
+
+    beginResetModel();
+    m_pages.clear();
+    m_pageRow.clear();
+    m_count = 0;
+    m_encoding = GitEncoding::Ascii;
+    m_hunkRows.clear();
+    m_spanHunks.clear();
+    m_spans.clear();
+    m_deferredHunk = -1;
+    endResetModel();
+    emit countChanged();
+
+    if (!m_filePath.isEmpty()) {
+        m_filePath.clear();
+        m_staged = false;
+        emit filePathChanged();
+    }
+    if (m_binary) {
+        m_binary = false;
+        emit binaryChanged();
+    }
+    setError(QString());
+    setLoading(false);
+}
+
+void DiffModel::applyPage(int generation, const Page &page, GitEncoding::Encoding encoding)
+{
+    if (generation != m_generation || page.lines.isEmpty()) {
+        return;
+    }
+    if (encoding != m_encoding) {
+        // 后面的页发现了非 UTF-8 内容：已显示的行按新编码重新解码，行内差异重新计算
+        m_encoding = encoding;
+        m_spanHunks.clear();
+        m_spans.clear();
+        if (m_count > 0) {
+            emit dataChanged(index(0), index(m_count - 1), {ContentRole, Qt::DisplayRole, SpansRole});
+        }
+    }
+
+    const int count = int(page.lines.size());
+    const qsizetype hunks = m_hunkRows.size();
+    beginInsertRows(QModelIndex(), m_count, m_count + count - 1);
+    for (int i = 0; i < count; i++) {
+        if (page.lines[i].type == GitDiffLine::Header) {
+            m_hunkRows.append(m_count + i);
+        }
+    }
+    m_pageRow.append(m_count);
+    m_pages.append(page);
+    m_count += count;
+    endInsertRows();
+    emit countChanged();
+
+    // 等待加载完整的块后面出现了新的块：现在可以计算了
+    if (m_deferredHunk >= 0 && m_hunkRows.size() > hunks) {
+        const int hunk = m_deferredHunk;
+        m_deferredHunk = -1;
+        emitSpansChanged(hunk);
+    }
+}
+
+void DiffModel::applyFinished(int generation, bool binary, const QString &error)
+{
+    if (generation != m_generation) {
+        return;
+    }
+    if (m_binary != binary) {
+        m_binary = binary;
+        emit binaryChanged();
+    }
+    setError(error);
+    setLoading(false);
+
+    if (m_deferredHunk >= 0) {
+        const int hunk = m_deferredHunk;
+        m_deferredHunk = -1;
+        emitSpansChanged(hunk);
+    }
+}
+
+int DiffModel::hunkAt(int row) const
+{
+    auto it = std::upper_bound(m_hunkRows.cbegin(), m_hunkRows.cend(), row);
+    return int(it - m_hunkRows.cbegin()) - 1;
+}
+
+const DiffModel::Line &DiffModel::lineAt(int row, QByteArrayView *content) const
+{
+    auto it = std::upper_bound(m_pageRow.cbegin(), m_pageRow.cend(), row);
+    const int pageIndex = int(it - m_pageRow.cbegin()) - 1;
+    const Page &page = m_pages.at(pageIndex);
+    const Line &line = page.lines.at(row - m_pageRow.at(pageIndex));
+    if (content) {
+        *content = QByteArrayView(page.bytes).sliced(line.offset, line.length);
+    }
+    return line;
+}
+
+void DiffModel::requestSpans(int hunk) const
+{
+    if (m_spanHunks.contains(hunk)) {
+        return;
+    }
+    const int first = m_hunkRows[hunk];
+    const int end = hunk + 1 < m_hunkRows.size() ? m_hunkRows[hunk + 1] : m_count;
+    if (hunk + 1 == m_hunkRows.size() && m_loading) {
+        m_deferredHunk = hunk;  // 最后一个块可能还没有加载完
+        return;
+    }
+    m_spanHunks.insert(hunk);
+
+    // 块的内容（以及解码用的编码）相同，行内差异就相同
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    const char encodingTag = char(m_encoding);
+    hash.addData(QByteArrayView(&encodingTag, 1));
+    QList<GitDiffLine::Type> types;
+    QList<QByteArray> contents;
+    bool paired = false;
+    for (int row = first; row < end; row++) {
+        QByteArrayView content;
+        const Line &line = lineAt(row, &content);
+        paired = paired || (line.type == GitDiffLine::Add && !types.isEmpty() && types.last() == GitDiffLine::Delete);
+        types.append(line.type);
+        contents.append(content.toByteArray());
+        const char typeTag = char(line.type);
+        hash.addData(QByteArrayView(&typeTag, 1));
+        hash.addData(content);
+        hash.addData("\n");
+    }
+    if (!paired) {
+        return;
+    }
+    const QByteArray key = hash.result();
+    if (const HunkSpans *cached = m_spanCache.object(key)) {
+        setHunkSpans(hunk, *cached);
+        return;
+    }
+
+    const int generation = m_generation;
+    const GitEncoding::Encoding encoding = m_encoding;
+    QPointer<DiffModel> self(const_cast<DiffModel *>(this));
+    QFuture<void> future = QtConcurrent::run([self, generation, hunk, key, types, contents, encoding]() {
+        QElapsedTimer timer;
+        timer.start();
+        HunkSpans spans;
+        const int count = int(types.size());
+        int pairs = 0;
+        for (int i = 0; i < count;) {
+            if (types[i] != GitDiffLine::Delete) {
+                i++;
+                continue;
+            }
+            // 连续的删除行和紧随其后的新增行按顺序一一配对
+            const int deleted = i;
+            while (i < count && types[i] == GitDiffLine::Delete) i++;
+            const int added = i;
+            while (i < count && types[i] == GitDiffLine::Add) i++;
+            for (int k = 0; k < qMin(added - deleted, i - added); k++) {
+                const QString oldText = GitEncoding::decode(contents[deleted + k], encoding);
+                const QString newText = GitEncoding::decode(contents[added + k], encoding);
+                if (oldText.size() > DiffModel::MaxWordDiffLength || newText.size() > DiffModel::MaxWordDiffLength) {
+                    continue;
+                }
+                QList<GitDiffEngine::Span> oldSpans;
+                QList<GitDiffEngine::Span> newSpans;
+                if (GitDiffEngine::diffWords(oldText, newText, &oldSpans, &newSpans)) {
+                    spans.insert(deleted + k, oldSpans);
+                    spans.insert(added + k, newSpans);
+                }
+                pairs++;
+            }
+        }
+        qDebug() << "Diff: word spans for hunk" << hunk << ":" << pairs << "line pairs in" << timer.elapsed() << "ms";
+        QMetaObject::invokeMethod(self.data(), [self, generation, hunk, key, spans, encoding]() {
+            if (self && self->m_encoding == encoding) {
+                self->applySpans(generation, hunk, key, spans);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void DiffModel::applySpans(int generation, int hunk, const QByteArray &key, const HunkSpans &spans)
+{
+    m_spanCache.insert(key, new HunkSpans(spans));
+    if (generation != m_generation || !m_spanHunks.contains(hunk)) {
+        return;
+    }
+    setHunkSpans(hunk, spans);
+    emitSpansChanged(hunk);
+}
+
+void DiffModel::setHunkSpans(int hunk, const HunkSpans &spans) const
+{
+    const int first = m_hunkRows[hunk];
+    for (auto it = spans.cbegin(); it != spans.cend(); ++it) {
+        m_spans.insert(first + it.key(), it.value());
+    }
+}
+
+void DiffModel::emitSpansChanged(int hunk)
+{
+    const int first = m_hunkRows[hunk];
+    const int end = hunk + 1 < m_hunkRows.size() ? m_hunkRows[hunk + 1] : m_count;
+    emit dataChanged(index(first), index(end - 1), {SpansRole});
+}
+
+void DiffModel::setLoading(bool loading)
+{
+    if (m_loading != loading) {
+        m_loading = loading;
+        emit loadingChanged();
+    }
+}
+
+void DiffModel::setError(const QString &error)
+{
+    if (m_error != error) {
+        m_error = error;
+        emit errorChanged();
+    }
+}
@@ -0,0 +1,138 @@
+#ifndef DIFFMODEL_H
+#define DIFFMODEL_H
+
+#include <QAbstractListModel>
+#include <QByteArray>
+#include <QCache>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <qqml.h>
+#include <memory>
+#include "gitdiffengine.h"
+#include "gitencoding.h"
+#include "gitpatchparser.h"
+
+class GitCancelToken;
+
+// 工作区 / 暂存区中一个文件的差异（文件差异对话框）
+// 以前的 getFileDiff 在界面线程上同步运行 git diff，每一行生成一个 QVariantMap；
+// 未跟踪文件整个读入内存再逐行转换。现在：
+// - git diff 在读队列上流式运行，输出边解析边按页（PageLines 行）送到界面，第一页到达就能显示
+// - 每页只保存原始字节和每行的类型、行号、偏移，data() 被调用（行进入视图）时才解码成 QString
+// - 未跟踪文件按块读取，同样按页送出
+// - 已跟踪文件在工作区的修改不运行 git diff：直接读 index 得到暂存区版本，用 GitDiffEngine 在进程内比较
+// - 比较结果按内容缓存在 GitDiffCache 中，在文件之间来回切换时没有变化的文件直接取出上次的结果
+// - 行内差异：块（hunk）中的行第一次进入视图时，在后台把相邻的删除行和新增行逐对按词比较，
+//   结果（spans 角色）按块的内容缓存，重新打开同一个差异不需要再计算
+class DiffModel : public QAbstractListModel
+{
+    Q_OBJECT
+    QML_ELEMENT
+    QML_UNCREATABLE("由 GitManager.diff 提供")
+    Q_PROPERTY(QString filePath READ filePath NOTIFY filePathChanged)
+    Q_PROPERTY(bool staged READ isStaged NOTIFY filePathChanged)
+    Q_PROPERTY(bool loading READ isLoading NOTIFY loadingChanged)
+    Q_PROPERTY(bool binary READ isBinary NOTIFY binaryChanged)
+    Q_PROPERTY(QString error READ error NOTIFY errorChanged)
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+
+public:
+    enum Roles {
+        TypeRole = Qt::UserRole + 1,  // "header" / "context" / "add" / "delete"
+        ContentRole,
+        LineNumRole,
+        OldLineRole,
+        NewLineRole,
+        SpansRole     // 行内变化的部分：[{start, length}]，只有成对的删除 / 新增行才有
+    };
+
+    // 一页最多的行数；第一页不等凑满就送出
+    static constexpr int PageLines = 4096;
+    // 超过这个长度的行不做行内比较（压缩过的代码等）
+    static constexpr int MaxWordDiffLength = 4096;
+    // 行内差异缓存的块数
+    static constexpr int SpanCacheHunks = 1024;
+
+    struct Line {
+        GitDiffLine::Type type;
+        int oldLine;
+        int newLine;
+        quint32 offset;  // 在所在页 bytes 中的位置
+        quint32 length;
+    };
+
+    struct Page {
+        QByteArray bytes;
+        QList<Line> lines;
+    };
+
+    // 一个块的行内差异：块内行的偏移 → 变化部分
+    using HunkSpans = QHash<int, QList<GitDiffEngine::Span>>;
+
+    explicit DiffModel(QObject *parent = nullptr);
+    ~DiffModel() override;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    QString filePath() const { return m_filePath; }
+    bool isStaged() const { return m_staged; }
+    bool isLoading() const { return m_loading; }
+    bool isBinary() const { return m_binary; }
+    QString error() const { return m_error; }
+
+    // 切换或关闭仓库时清空
+    void setRepoPath(const QString &repoPath);
+
+    // staged 为 true 时比较暂存区与 HEAD（git diff --cached），否则比较工作区与暂存区
+    Q_INVOKABLE void open(const QString &filePath, bool staged);
+    Q_INVOKABLE void clear();
+
+    // 供并排视图（SideBySideDiffModel）使用：第 row 行及其原始内容；
+    // 所有页（隐式共享，复制给后台线程不拷贝内容）
+    const Line &lineAt(int row, QByteArrayView *content = nullptr) const;
+    QList<Page> pages() const { return m_pages; }
+
+signals:
+    void filePathChanged();
+    void loadingChanged();
+    void binaryChanged();
+    void errorChanged();
+    void countChanged();
+
+private:
+    void applyPage(int generation, const Page &page, GitEncoding::Encoding encoding);
+    void applyFinished(int generation, bool binary, const QString &error);
+    int hunkAt(int row) const;
+    void requestSpans(int hunk) const;
+    void applySpans(int generation, int hunk, const QByteArray &key, const HunkSpans &spans);
+    void setHunkSpans(int hunk, const HunkSpans &spans) const;
+    void emitSpansChanged(int hunk);
+    void setLoading(bool loading);
+    void setError(const QString &error);
+
+    QString m_repoPath;
+    QString m_filePath;
+    bool m_staged = false;
+    bool m_loading = false;
+    bool m_binary = false;
+    QString m_error;
+    int m_generation = 0;  // 每次打开递增，丢弃过期的异步结果
+
+    QList<Page> m_pages;
+    QList<int> m_pageRow;  // 每页第一行的行号（递增）
+    int m_count = 0;
+    GitEncoding::Encoding m_encoding = GitEncoding::Ascii;
+    std::shared_ptr<GitCancelToken> m_token;
+
+    QList<int> m_hunkRows;                  // 每个块头的行号（递增）
+    mutable QSet<int> m_spanHunks;          // 已请求行内差异的块（计算中或已完成）
+    mutable QHash<int, QList<GitDiffEngine::Span>> m_spans;  // 行号 → 变化部分
+    mutable int m_deferredHunk = -1;        // 还在加载、等完整后再计算的最后一个块
+    QCache<QByteArray, HunkSpans> m_spanCache{SpanCacheHunks};
+};
+
+#endif // DIFFMODEL_H
@@ -0,0 +1,400 @@
+#include "fileblamemodel.h"
+#include "gitencoding.h"
+#include "gitoperationqueue.h"
+#include "gitprocess.h"
+#include "gittokenizer.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QPointer>
+
+namespace {
+
+// git diff -U0 的一个修改块："@@ -<旧起始>,<旧行数> +<新起始>,<新行数> @@"
+struct DiffHunk {
+    int oldStart = 0;
+    int oldCount = 0;
+    int newStart = 0;
+    int newCount = 0;
+};
+
+// "12,3" 或 "12"（省略时行数为 1）
+void parseRange(QByteArrayView range, int *start, int *count)
+{
+    auto fields = GitTokenizer::split<2>(range, ',');
+    *start = int(GitTokenizer::toInt64(fields[0]));
+    *count = fields.count > 1 ? int(GitTokenizer::toInt64(fields[1])) : 1;
+}
+
+QList<DiffHunk> parseDiffHunks(QByteArrayView output)
+{
+    QList<DiffHunk> hunks;
+    GitTokenizer::forEachLine(output, [&hunks](QByteArrayView line) {
+        if (!line.startsWith("@@ -")) return;
+        auto fields = GitTokenizer::splitWhitespace<4>(line);
+        if (fields.count < 3 || !fields[2].startsWith('+')) return;
+        DiffHunk hunk;
+        parseRange(fields[1].sliced(1), &hunk.oldStart, &hunk.oldCount);
+        parseRange(fields[2].sliced(1), &hunk.newStart, &hunk.newCount);
+        hunks.append(hunk);
+    });
+    return hunks;
+}
+
+// HEAD 中第 line 行在工作区中的行号；该行已修改或删除时返回 0
+int mapLine(const QList<DiffHunk> &diff, int line)
+{
+    int offset = 0;
+    for (const DiffHunk &hunk : diff) {
+        if (hunk.oldCount == 0) {
+            // 纯插入：插在旧的第 oldStart 行之后
+            if (hunk.oldStart >= line) break;
+        } else {
+            if (line < hunk.oldStart) break;
+            if (line < hunk.oldStart + hunk.oldCount) return 0;
+        }
+        offset += hunk.newCount - hunk.oldCount;
+    }
+    return line + offset;
+}
+
+// 把 HEAD 行号的段映射为工作区行号的段（修改过的行被拆掉）
+QList<GitBlameHunk> mapHunks(const QList<GitBlameHunk> &hunks, const QList<DiffHunk> &diff)
+{
+    if (diff.isEmpty()) {
+        return hunks;
+    }
+    QList<GitBlameHunk> mapped;
+    mapped.reserve(hunks.size());
+    for (const GitBlameHunk &hunk : hunks) {
+        for (int line = hunk.start; line < hunk.start + hunk.count; line++) {
+            const int target = mapLine(diff, line);
+            if (target == 0) continue;
+            if (!mapped.isEmpty() && mapped.last().commit == hunk.commit
+                && mapped.last().start + mapped.last().count == target) {
+                mapped.last().count++;
+            } else {
+                mapped.append(GitBlameHunk{target, 1, hunk.commit});
+            }
+        }
+    }
+    return mapped;
+}
+
+} // namespace
+
+FileBlameModel::FileBlameModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+FileBlameModel::~FileBlameModel()
+{
+    if (m_token) {
+        m_token->cancel();
+    }
+}
+
+int FileBlameModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return int(m_lines.size());
+}
+
+QVariant FileBlameModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_lines.size()) {
+        return QVariant();
+    }
+    const int row = index.row();
+    const int commitIndex = m_lineCommit.at(row);
+
+    switch (role) {
+    case LineNumberRole:
+        return row + 1;
+    case Qt::DisplayRole:
+    case TextRole:
+        return m_lines.at(row);
+    case UncommittedRole:
+        return commitIndex == Uncommitted;
+    case LoadedRole:
+        return commitIndex != Pending;
+    case HunkStartRole:
+        return row == 0 || m_lineCommit.at(row - 1) != commitIndex;
+    }
+
+    if (commitIndex == Uncommitted) {
+        switch (role) {
+        case AuthorRole:
+            return QStringLiteral("未提交");
+        case SummaryRole:
+            return QStringLiteral("工作区中的修改");
+        }
+        return QString();
+    }
+    if (commitIndex < 0 || commitIndex >= m_commits.size()) {
+        return QString();
+    }
+
+    const GitBlameCommit &commit = m_commits.at(commitIndex);
+    switch (role) {
+    case HashRole:
+        return commit.hash;
+    case ShortHashRole:
+        return commit.hash.left(7);
+    case AuthorRole:
+        return commit.author;
+    case DateRole:
+        return QDateTime::fromSecsSinceEpoch(commit.authorTime).toString("yyyy-MM-dd");
+    case SummaryRole:
+        return commit.summary;
+    }
+    return QVariant();
+}
+
+QHash<int, QByteArray> FileBlameModel::roleNames() const
+{
+    return {
+        {LineNumberRole, "lineNumber"},
+        {TextRole, "text"},
+        {HashRole, "hash"},
+        {ShortHashRole, "shortHash"},
+        {AuthorRole, "author"},
+        {DateRole, "date"},
+        {SummaryRole, "summary"},
+        {UncommittedRole, "uncommitted"},
+        {LoadedRole, "loaded"},
+        {HunkStartRole, "hunkStart"}
+    };
+}
+
+void FileBlameModel::setEnabled(bool enabled)
+{
+    if (enabled == m_enabled) {
+        return;
+    }
+    m_enabled = enabled;
+    emit enabledChanged();
+    if (m_enabled) {
+        reload();
+    } else {
+        clear();
+    }
+}
+
+void FileBlameModel::setRepoPath(const QString &repoPath)
+{
+    if (repoPath == m_repoPath) {
+        return;
+    }
+    m_repoPath = repoPath;
+    m_filePath.clear();
+    emit filePathChanged();
+    clear();
+}
+
+void FileBlameModel::setFilePath(const QString &filePath)
+{
+    if (filePath != m_filePath) {
+        m_filePath = filePath;
+        emit filePathChanged();
+    }
+    // 同一个文件重新打开时也重新读取（可能在外部修改过；HEAD 没变时命中缓存）
+    if (m_enabled) {
+        reload();
+    } else {
+        clear();
+    }
+}
+
+void FileBlameModel::reload()
+{
+    clear();
+    if (m_repoPath.isEmpty() || m_filePath.isEmpty()) {
+        return;
+    }
+    setLoading(true);
+
+    const int generation = m_generation;
+    m_token = GitCancelToken::create(QString());
+    QString repoPath = m_repoPath;
+    QString filePath = m_filePath;
+    GitCancelToken::Ptr token = m_token;
+    QPointer<FileBlameModel> self(this);
+    QFuture<void> future = GitOperationQueue::forRepo(repoPath)->run(GitOperationQueue::Read, [self, repoPath, filePath, token, generation]() {
+        QElapsedTimer timer;
+        timer.start();
+
+        auto deliver = [&self, generation](const QList<GitBlameCommit> &commits, const QList<GitBlameHunk> &hunks,
+                                           bool finished, const QString &error) {
+            QMetaObject::invokeMethod(self.data(), [self, generation, commits, hunks, finished, error]() {
+                if (self) {
+                    self->applyHunks(generation, commits, hunks, finished, error);
+                }
+            }, Qt::QueuedConnection);
+        };
+
+        // 1. 工作区中的文件：所有行先显示出来
+        const QString fullPath = repoPath + "/" + filePath;
+        QFile file(fullPath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            deliver({}, {}, true, "无法打开文件");
+            return;
+        }
+        const QByteArray contents = file.readAll();
+        file.close();
+        QStringList lines = GitEncoding::decode(contents, GitEncoding::fileEncoding(fullPath, contents)).split('\n');
+        if (!lines.isEmpty() && lines.last().isEmpty()) {
+            lines.removeLast();
+        }
+        for (QString &line : lines) {
+            if (line.endsWith('\r')) line.chop(1);
+        }
+        const int lineCount = int(lines.size());
+        QMetaObject::invokeMethod(self.data(), [self, generation, lines]() {
+            if (self) {
+                self->applyLines(generation, lines);
+            }
+        }, Qt::QueuedConnection);
+
+        // 2. HEAD 中的版本；不在 HEAD 中（新文件或还没有提交）时整个文件都是未提交的
+        GitResult blob = GitProcess(repoPath, token).run({"rev-parse", "--verify", "--quiet", "HEAD:" + filePath}, 10000);
+        if (blob.cancelled) return;
+        const QString blobOid = blob.outputText();
+        if (!blob.ok() || blobOid.isEmpty()) {
+            deliver({}, {GitBlameHunk{1, lineCount, Uncommitted}}, true, QString());
+            return;
+        }
+
+        // 3. 工作区相对 HEAD 的修改：修改过的行是未提交的，其余行的追溯与 HEAD 相同
+        GitResult diffResult = GitProcess(repoPath, token).run(
+            {"diff", "--no-color", "--no-ext-diff", "--no-renames", "-U0", "HEAD", "--", filePath});
+        if (diffResult.cancelled) return;
+        const QList<DiffHunk> diff = parseDiffHunks(diffResult.output);
+        QList<GitBlameHunk> uncommitted;
+        for (const DiffHunk &hunk : diff) {
+            if (hunk.newCount > 0) {
+                uncommitted.append(GitBlameHunk{hunk.newStart, hunk.newCount, Uncommitted});
+            }
+        }
+        if (!uncommitted.isEmpty()) {
+            deliver({}, uncommitted, false, QString());
+        }
+
+        // 4. HEAD 版本的追溯：缓存中有就直接映射
+        GitBlameCache *cache = GitBlameCache::forRepo(repoPath);
+        GitBlameResult cached;
+        if (cache->lookup(blobOid, filePath, &cached)) {
+            deliver(cached.commits, mapHunks(cached.hunks, diff), true, QString());
+            qDebug() << "Blame:" << filePath << "from cache in" << timer.elapsed() << "ms";
+            return;
+        }
+
+        GitBlameParser parser;
+        qsizetype sentCommits = 0;
+        bool first = true;
+        auto flush = [&](bool finished, const QString &error) {
+            QList<GitBlameHunk> hunks = parser.takeHunks();
+            if (hunks.isEmpty() && !finished) return;
+            deliver(parser.commits().mid(sentCommits), mapHunks(hunks, diff), finished, error);
+            sentCommits = parser.commits().size();
+            if (first && !hunks.isEmpty()) {
+                first = false;
+                qDebug() << "Blame:" << filePath << "first hunk in" << timer.elapsed() << "ms";
+            }
+        };
+
+        GitProcess process(repoPath, token);
+        process.setOutputHandler([&](const QByteArray &chunk) {
+            parser.feed(chunk);
+            flush(false, QString());
+        });
+        // 历史很长时 git 可能很久才输出下一段，不启用卡死检测（关闭或切换文件时取消）
+        GitResult result = process.run({"blame", "--incremental", "--porcelain", "HEAD", "--", filePath}, -1);
+        if (result.cancelled) return;
+        parser.finish();
+        if (result.ok()) {
+            cache->insert(blobOid, filePath, parser.result());
+        }
+        flush(true, result.ok() ? QString() : result.errorText());
+        qDebug() << "Blame:" << filePath << lineCount << "lines in" << timer.elapsed() << "ms";
+    });
+}
+
+void FileBlameModel::clear()
+{
+    if (m_token) {
+        m_token->cancel();
+        m_token.reset();
+    }
+    ++m_generation;
+
+    beginResetModel();
+    m_lines.clear();
+    m_lineCommit.clear();
+    m_commits.clear();
+    endResetModel();
+    emit countChanged();
+
+    setError(QString());
+    setLoading(false);
+}
+
+void FileBlameModel::applyLines(int generation, const QStringList &lines)
+{
+    if (generation != m_generation) {
+        return;
+    }
+    beginResetModel();
+    m_lines = lines;
+    m_lineCommit = QList<int>(lines.size(), Pending);
+    endResetModel();
+    emit countChanged();
+}
+
+void FileBlameModel::applyHunks(int generation, const QList<GitBlameCommit> &commits, const QList<GitBlameHunk> &hunks,
+                                bool finished, const QString &error)
+{
+    if (generation != m_generation) {
+        return;
+    }
+
+    m_commits.append(commits);
+    const int lineCount = int(m_lineCommit.size());
+    for (const GitBlameHunk &hunk : hunks) {
+        const int first = qMax(hunk.start - 1, 0);
+        const int last = qMin(hunk.start - 1 + hunk.count, lineCount) - 1;
+        if (first > last) continue;
+        for (int row = first; row <= last; row++) {
+            m_lineCommit[row] = hunk.commit;
+        }
+        // 下一行是否是新段的开始也可能变化
+        emit dataChanged(index(first), index(qMin(last + 1, lineCount - 1)));
+    }
+
+    if (finished) {
+        if (!error.isEmpty()) {
+            setError(error);
+        }
+        setLoading(false);
+    }
+}
+
+void FileBlameModel::setLoading(bool loading)
+{
+    if (m_loading != loading) {
+        m_loading = loading;
+        emit loadingChanged();
+    }
+}
+
+void FileBlameModel::setError(const QString &error)
+{
+    if (m_error != error) {
+        m_error = error;
+        emit errorChanged();
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef FILEBLAMEMODEL_H
+#define FILEBLAMEMODEL_H
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <qqml.h>
+#include <memory>
+#include "gitblame.h"
+
+class GitCancelToken;
+
+// 文件查看器的逐行追溯（每一行最后由哪个提交修改）
+// - 先读出工作区文件的全部行，行立即出现，追溯信息随后按段填入
+// - git blame --incremental 边运行边输出，每确定一段就显示，不必等整个文件追溯完
+// - HEAD 版本的结果按 (blob id, 路径) 缓存在 GitBlameCache 中；工作区有修改时只运行
+//   git diff -U0 HEAD，把缓存中 HEAD 的行号映射到工作区，修改过的行标记为未提交，
+//   不需要重新追溯整个文件
+class FileBlameModel : public QAbstractListModel
+{
+    Q_OBJECT
+    QML_ELEMENT
+    QML_UNCREATABLE("由 GitManager.blame 提供")
+    Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(QString filePath READ filePath NOTIFY filePathChanged)
+    Q_PROPERTY(bool loading READ isLoading NOTIFY loadingChanged)
+    Q_PROPERTY(QString error READ error NOTIFY errorChanged)
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+
+public:
+    enum Roles {
+        LineNumberRole = Qt::UserRole + 1,
+        TextRole,
+        HashRole,
+        ShortHashRole,
+        AuthorRole,
+        DateRole,
+        SummaryRole,
+        UncommittedRole,
+        LoadedRole,
+        HunkStartRole
+    };
+
+    explicit FileBlameModel(QObject *parent = nullptr);
+    ~FileBlameModel() override;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    bool isEnabled() const { return m_enabled; }
+    // 打开追溯视图时才运行 git blame
+    void setEnabled(bool enabled);
+    QString filePath() const { return m_filePath; }
+    bool isLoading() const { return m_loading; }
+    QString error() const { return m_error; }
+
+    // 切换或关闭仓库时清空
+    void setRepoPath(const QString &repoPath);
+    // 文件查看器打开的文件（相对仓库根目录）
+    void setFilePath(const QString &filePath);
+
+    // 重新读取（文件在外部修改之后）
+    Q_INVOKABLE void reload();
+
+signals:
+    void enabledChanged();
+    void filePathChanged();
+    void loadingChanged();
+    void errorChanged();
+    void countChanged();
+
+private:
+    void clear();
+    void applyLines(int generation, const QStringList &lines);
+    void applyHunks(int generation, const QList<GitBlameCommit> &commits, const QList<GitBlameHunk> &hunks,
+                    bool finished, const QString &error);
+    void setLoading(bool loading);
+    void setError(const QString &error);
+
+    // m_lineCommit 中的特殊值
+    static constexpr int Pending = -1;
+    static constexpr int Uncommitted = -2;
+
+    QString m_repoPath;
+    QString m_filePath;
+    bool m_enabled = false;
+    bool m_loading = false;
+    QString m_error;
+    int m_generation = 0;  // 每次重新读取递增，丢弃过期的异步结果
+
+    QStringList m_lines;
+    QList<int> m_lineCommit;  // 每行对应 m_commits 中的序号
+    QList<GitBlameCommit> m_commits;
+    std::shared_ptr<GitCancelToken> m_token;
+};
+
+#endif // FILEBLAMEMODEL_H
@@ -0,0 +1,130 @@
+#include "gitblame.h"
+#include "gitoperationqueue.h"
+#include "gittokenizer.h"
+#include <QMutexLocker>
+
+namespace {
+
+bool isObjectId(QByteArrayView token)
+{
+    if (token.size() != 40 && token.size() != 64) {
+        return false;
+    }
+    for (char c : token) {
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+void GitBlameParser::feed(QByteArrayView chunk)
+{
+    m_buffer.append(chunk);
+    qsizetype end = m_buffer.lastIndexOf('\n');
+    if (end < 0) {
+        return;
+    }
+    // 只处理完整的行
+    GitTokenizer::forEachLine(QByteArrayView(m_buffer).first(end), [this](QByteArrayView line) {
+        parseLine(line);
+    });
+    m_buffer.remove(0, end + 1);
+}
+
+void GitBlameParser::finish()
+{
+    if (!m_buffer.isEmpty()) {
+        GitTokenizer::forEachLine(m_buffer, [this](QByteArrayView line) {
+            parseLine(line);
+        });
+        m_buffer.clear();
+    }
+}
+
+QList<GitBlameHunk> GitBlameParser::takeHunks()
+{
+    QList<GitBlameHunk> hunks = m_result.hunks.mid(m_delivered);
+    m_delivered = m_result.hunks.size();
+    return hunks;
+}
+
+void GitBlameParser::parseLine(QByteArrayView line)
+{
+    if (!m_inHunk) {
+        // "<提交> <原行号> <行号> <行数>"
+        auto fields = GitTokenizer::split<4>(line, ' ');
+        if (fields.count < 4 || !isObjectId(fields[0])) {
+            return;
+        }
+        const QString hash = GitTokenizer::toString(fields[0]);
+        auto it = m_commitIndex.constFind(hash);
+        if (it == m_commitIndex.constEnd()) {
+            GitBlameCommit commit;
+            commit.hash = hash;
+            it = m_commitIndex.insert(hash, int(m_result.commits.size()));
+            m_result.commits.append(commit);
+        }
+        m_current.commit = it.value();
+        m_current.start = int(GitTokenizer::toInt64(fields[2]));
+        m_current.count = int(GitTokenizer::toInt64(fields[3]));
+        m_inHunk = true;
+        return;
+    }
+
+    auto fields = GitTokenizer::split<2>(line, ' ');
+    const QByteArrayView key = fields[0];
+    GitBlameCommit &commit = m_result.commits[m_current.commit];
+    if (key == "filename") {
+        // 一段结束
+        if (m_current.start > 0 && m_current.count > 0) {
+            m_result.hunks.append(m_current);
+        }
+        m_current = GitBlameHunk();
+        m_inHunk = false;
+    } else if (key == "author") {
+        commit.author = GitTokenizer::toString(fields[1]);
+    } else if (key == "author-time") {
+        commit.authorTime = GitTokenizer::toInt64(fields[1]);
+    } else if (key == "summary") {
+        commit.summary = GitTokenizer::toString(fields[1]);
+    } else if (key == "boundary") {
+        commit.boundary = true;
+    }
+}
+
+GitBlameCache *GitBlameCache::forRepo(const QString &repoPath)
+{
+    return GitRepoRegistry<GitBlameCache>::instance(repoPath, []() {
+        return new GitBlameCache();
+    });
+}
+
+bool GitBlameCache::lookup(const QString &blobOid, const QString &path, GitBlameResult *result) const
+{
+    const QString key = blobOid + ':' + path;
+    QMutexLocker locker(&m_mutex);
+    auto it = m_results.constFind(key);
+    if (it == m_results.constEnd()) {
+        return false;
+    }
+    *result = it.value();
+    m_order.removeOne(key);
+    m_order.append(key);
+    return true;
+}
+
+void GitBlameCache::insert(const QString &blobOid, const QString &path, const GitBlameResult &result)
+{
+    const QString key = blobOid + ':' + path;
+    QMutexLocker locker(&m_mutex);
+    if (!m_results.contains(key)) {
+        m_order.append(key);
+    }
+    m_results.insert(key, result);
+    while (m_order.size() > MaxEntries) {
+        m_results.remove(m_order.takeFirst());
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef GITBLAME_H
+#define GITBLAME_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+// git blame 的一个提交（同一个提交在结果中只保存一次，行通过序号引用）
+struct GitBlameCommit
+{
+    QString hash;
+    QString author;
+    qint64 authorTime = 0;  // 秒
+    QString summary;
+    bool boundary = false;
+};
+
+// 连续的若干行来自同一个提交
+struct GitBlameHunk
+{
+    int start = 0;   // 从 1 开始的行号
+    int count = 0;
+    int commit = 0;  // GitBlameResult::commits 中的序号
+};
+
+struct GitBlameResult
+{
+    QList<GitBlameCommit> commits;
+    QList<GitBlameHunk> hunks;
+};
+
+// git blame --incremental 输出的增量解析
+// 每一段以 "<提交> <原行号> <行号> <行数>" 开始、以 "filename <路径>" 结束；
+// 提交第一次出现时中间带有作者、时间和摘要，之后只有这两行。git 每确定一段就输出一段，
+// 先输出的往往是最近修改过的行，可以边读边显示。
+class GitBlameParser
+{
+public:
+    void feed(QByteArrayView chunk);
+    void finish();
+
+    // 已解析的全部提交（序号不变，只会在末尾追加）
+    const QList<GitBlameCommit> &commits() const { return m_result.commits; }
+    // 取出上次调用之后完成的段
+    QList<GitBlameHunk> takeHunks();
+    GitBlameResult result() const { return m_result; }
+
+private:
+    void parseLine(QByteArrayView line);
+
+    QByteArray m_buffer;
+    GitBlameResult m_result;
+    QHash<QString, int> m_commitIndex;
+    qsizetype m_delivered = 0;
+    GitBlameHunk m_current;
+    bool m_inHunk = false;
+};
+
+// 按 (blob id, 路径) 缓存 HEAD 版本的 blame 结果
+// 同一个文件再次打开、或只在工作区修改过时不再运行 git blame，
+// 工作区的修改通过 git diff 把 HEAD 的行号映射过去（见 FileBlameModel）。
+class GitBlameCache
+{
+public:
+    static GitBlameCache *forRepo(const QString &repoPath);
+
+    bool lookup(const QString &blobOid, const QString &path, GitBlameResult *result) const;
+    void insert(const QString &blobOid, const QString &path, const GitBlameResult &result);
+
+private:
+    GitBlameCache() = default;
+    Q_DISABLE_COPY(GitBlameCache)
+
+    static constexpr int MaxEntries = 64;
+
+    mutable QMutex m_mutex;
+    QHash<QString, GitBlameResult> m_results;
+    mutable QStringList m_order;  // 最近使用的在末尾
+};
+
+#endif // GITBLAME_H
@@ -0,0 +1,180 @@
+#include "gitconfig.h"
+#include "gitoperationqueue.h"
+#include "gitprocess.h"
+#include "gittokenizer.h"
+#include <QAtomicInt>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QStringList>
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+int nextRevision()
+{
+    static QAtomicInt revision;
+    return revision.fetchAndAddRelaxed(1) + 1;
+}
+
+} // namespace
+
+QByteArray GitConfig::Snapshot::value(const QByteArray &key, const QByteArray &defaultValue) const
+{
+    auto it = values.constFind(key);
+    return it == values.constEnd() ? defaultValue : it.value();
+}
+
+bool GitConfig::Snapshot::boolValue(const QByteArray &key, bool defaultValue) const
+{
+    auto it = values.constFind(key);
+    if (it == values.constEnd()) {
+        return defaultValue;
+    }
+    if (it->isNull()) {
+        return true;
+    }
+    const QByteArray value = it->trimmed().toLower();
+    if (value == "true" || value == "yes" || value == "on") {
+        return true;
+    }
+    if (value.isEmpty() || value == "false" || value == "no" || value == "off") {
+        return false;
+    }
+    bool ok = false;
+    const int number = value.toInt(&ok);
+    return ok ? number != 0 : defaultValue;
+}
+
+int GitConfig::Snapshot::intValue(const QByteArray &key, int defaultValue) const
+{
+    QByteArray value = this->value(key).trimmed().toLower();
+    if (value.isEmpty()) {
+        return defaultValue;
+    }
+    qint64 factor = 1;
+    switch (value.back()) {
+    case 'k': factor = 1024; break;
+    case 'm': factor = 1024 * 1024; break;
+    case 'g': factor = 1024 * 1024 * 1024; break;
+    }
+    if (factor != 1) {
+        value.chop(1);
+    }
+    bool ok = false;
+    const qint64 number = value.toLongLong(&ok) * factor;
+    return ok && number >= std::numeric_limits<int>::min() && number <= std::numeric_limits<int>::max() ? int(number) : defaultValue;
+}
+
+QByteArray GitConfig::Snapshot::fingerprint(const QByteArray &prefix) const
+{
+    QList<QByteArray> keys;
+    for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+        if (it.key().startsWith(prefix)) {
+            keys.append(it.key());
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+    QByteArray fingerprint;
+    for (const QByteArray &key : std::as_const(keys)) {
+        const QByteArray value = values.value(key);
+        fingerprint += key + (value.isNull() ? QByteArray() : '=' + value) + ';';
+    }
+    return fingerprint;
+}
+
+GitConfig *GitConfig::forRepo(const QString &repoPath)
+{
+    return GitRepoRegistry<GitConfig>::instance(repoPath, [&repoPath]() {
+        return new GitConfig(repoPath);
+    });
+}
+
+GitConfig::Snapshot GitConfig::snapshot()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_loaded || sourcesChanged()) {
+        read();
+    }
+    return m_snapshot;
+}
+
+GitConfig::Source GitConfig::stat(const QString &path)
+{
+    Source source;
+    source.path = path;
+    const QFileInfo info(path);
+    if (info.exists()) {
+        source.size = info.size();
+        source.modified = info.lastModified();
+    }
+    return source;
+}
+
+bool GitConfig::sourcesChanged() const
+{
+    for (const Source &source : m_sources) {
+        const Source current = stat(source.path);
+        if (current.size != source.size || current.modified != source.modified) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void GitConfig::read()
+{
+    m_loaded = true;
+    m_snapshot = Snapshot();
+    m_snapshot.revision = nextRevision();
+
+    QStringList paths;
+    // 全局配置可能还不存在，用户之后才创建（与 git 查找的位置相同）
+    const QString home = qEnvironmentVariable("HOME", QDir::homePath());
+    const QString globalPath = qEnvironmentVariable("GIT_CONFIG_GLOBAL");
+    if (!globalPath.isEmpty()) {
+        paths << globalPath;
+    } else {
+        paths << qEnvironmentVariable("XDG_CONFIG_HOME", home + "/.config") + "/git/config" << home + "/.gitconfig";
+    }
+
+    // -z 输出：来源（"file:<路径>"）NUL "<键>\n<值>" NUL；只写变量名的没有 "\n<值>"
+    GitResult result = GitProcess(m_repoPath).run({"config", "--list", "--show-origin", "-z"}, 10000);
+    QList<QByteArrayView> fields;
+    GitTokenizer::forEachRecord(result.output, '\0', [&fields](QByteArrayView field) {
+        fields.append(field);
+    });
+    for (qsizetype i = 0; i + 1 < fields.size(); i += 2) {
+        const QByteArrayView origin = fields[i];
+        if (origin.startsWith("file:")) {
+            QString path = GitTokenizer::toString(origin.sliced(5));
+            if (QFileInfo(path).isRelative()) {
+                path = m_repoPath + "/" + path;
+            }
+            path = QDir::cleanPath(path);
+            if (!paths.contains(path)) {
+                paths << path;
+            }
+        }
+        const QByteArrayView entry = fields[i + 1];
+        const qsizetype newline = entry.indexOf('\n');
+        if (newline < 0) {
+            m_snapshot.values.insert(entry.toByteArray(), QByteArray());
+        } else {
+            // 空值（"key ="）不是 null，与只写变量名区分开：git 把空值当作 false
+            QByteArray value = entry.sliced(newline + 1).toByteArray();
+            if (value.isNull()) {
+                value = QByteArray("");
+            }
+            m_snapshot.values.insert(entry.first(newline).toByteArray(), value);
+        }
+    }
+
+    m_sources.clear();
+    for (const QString &path : std::as_const(paths)) {
+        m_sources.append(stat(path));
+    }
+    qDebug() << "Config:" << m_snapshot.values.size() << "entries from" << m_sources.size() << "files";
+}
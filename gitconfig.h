@@ -0,0 +1,59 @@
+#ifndef GITCONFIG_H
+#define GITCONFIG_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+// 仓库实际生效的 git 配置（系统、全局、仓库各级合并后的结果），供进程内代替 git 的部分按用户配置工作
+// - 一次 git config --list --show-origin -z 读出全部配置，记下每个来源文件，再加上还不存在的全局配置文件；
+//   这些文件的大小或修改时间变化后，下次查询时重新读取
+// - 每次重新读取 revision 递增，调用方据此丢弃依赖旧配置的缓存
+class GitConfig
+{
+public:
+    struct Snapshot {
+        // 键为 git 输出的规范形式（节名和变量名小写），多次设置时取最后一个；只写变量名没有值时为 null
+        QHash<QByteArray, QByteArray> values;
+        int revision = 0;
+
+        QByteArray value(const QByteArray &key, const QByteArray &defaultValue = QByteArray()) const;
+        // 与 git 相同：true / yes / on / 非 0 的数为真，只写变量名也为真
+        bool boolValue(const QByteArray &key, bool defaultValue) const;
+        // 支持 k / m / g 后缀；无法解析时返回默认值
+        int intValue(const QByteArray &key, int defaultValue) const;
+        // 以 prefix 开头的所有配置按键排序后拼接，作为缓存键的一部分
+        QByteArray fingerprint(const QByteArray &prefix) const;
+    };
+
+    // 获取指定仓库的配置
+    static GitConfig *forRepo(const QString &repoPath);
+
+    // 在工作线程中调用：来源文件有变化时先重新读取
+    Snapshot snapshot();
+
+private:
+    explicit GitConfig(const QString &repoPath) : m_repoPath(repoPath) {}
+    Q_DISABLE_COPY(GitConfig)
+
+    struct Source {
+        QString path;
+        qint64 size = -1;  // 文件不存在时为 -1
+        QDateTime modified;
+    };
+
+    static Source stat(const QString &path);
+    bool sourcesChanged() const;
+    void read();
+
+    QString m_repoPath;
+    QMutex m_mutex;
+    bool m_loaded = false;
+    QList<Source> m_sources;
+    Snapshot m_snapshot;
+};
+
+#endif // GITCONFIG_H
@@ -0,0 +1,231 @@
+#include "gitdiffcache.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QSettings>
+#include <QStandardPaths>
+
+namespace {
+
+constexpr quint32 kFileMagic = 0x47444946;  // "GDIF"
+constexpr quint32 kFileVersion = 1;
+
+} // namespace
+
+GitDiffCache::GitDiffCache()
+{
+    m_diskSpill.storeRelaxed(QSettings("GitPushTool", "DiffCache").value("diskSpill", false).toBool() ? 1 : 0);
+    m_directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/diff-cache";
+}
+
+GitDiffCache *GitDiffCache::instance()
+{
+    // 与其他缓存相同，生命周期与程序相同
+    static GitDiffCache *cache = new GitDiffCache();
+    return cache;
+}
+
+QByteArray GitDiffCache::key(QByteArrayView kind, const QString &oldId, QByteArrayView newId, QByteArrayView options)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(kind);
+    hash.addData(QByteArrayView("\0", 1));
+    hash.addData(oldId.toLatin1());
+    hash.addData(QByteArrayView("\0", 1));
+    hash.addData(newId);
+    hash.addData(QByteArrayView("\0", 1));
+    hash.addData(options);
+    return hash.result();
+}
+
+bool GitDiffCache::lookup(const QByteArray &key, Result *result)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_results.constFind(key);
+        if (it != m_results.constEnd()) {
+            *result = it.value();
+            m_order.removeOne(key);
+            m_order.append(key);
+            return true;
+        }
+    }
+    if (!diskSpill() || !readFile(key, result)) {
+        return false;
+    }
+    // 读回内存；文件删除，再被挤出时重新写入
+    {
+        QMutexLocker locker(&m_diskMutex);
+        const QString path = filePath(key);
+        const qint64 size = QFileInfo(path).size();
+        if (QFile::remove(path) && m_diskBytes >= 0) {
+            m_diskBytes -= size;
+        }
+    }
+    insert(key, *result);
+    return true;
+}
+
+void GitDiffCache::insert(const QByteArray &key, const Result &result)
+{
+    const qint64 size = cost(result);
+    if (size > MemoryBytes / 4) {
+        return;  // 太大的不缓存，避免把其他结果都挤出去
+    }
+
+    QList<QPair<QByteArray, Result>> evicted;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_results.contains(key)) {
+            return;
+        }
+        m_results.insert(key, result);
+        m_order.append(key);
+        m_bytes += size;
+        while (m_bytes > MemoryBytes && m_order.size() > 1) {
+            const QByteArray oldest = m_order.takeFirst();
+            Result dropped = m_results.take(oldest);
+            m_bytes -= cost(dropped);
+            evicted.append({oldest, std::move(dropped)});
+        }
+    }
+    if (diskSpill() && !evicted.isEmpty()) {
+        spill(evicted);
+    }
+}
+
+void GitDiffCache::clear()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_results.clear();
+        m_order.clear();
+        m_bytes = 0;
+    }
+    removeFiles();
+}
+
+void GitDiffCache::removeFiles()
+{
+    QMutexLocker locker(&m_diskMutex);
+    const QFileInfoList files = QDir(m_directory).entryInfoList({"*.diff"}, QDir::Files);
+    for (const QFileInfo &info : files) {
+        QFile::remove(info.filePath());
+    }
+    m_diskBytes = -1;
+}
+
+qint64 GitDiffCache::cost(const Result &result)
+{
+    qint64 bytes = 0;
+    for (const DiffModel::Page &page : result.pages) {
+        bytes += page.bytes.size() + page.lines.size() * qint64(sizeof(DiffModel::Line));
+    }
+    return bytes;
+}
+
+QString GitDiffCache::filePath(const QByteArray &key) const
+{
+    return m_directory + "/" + QString::fromLatin1(key.toHex()) + ".diff";
+}
+
+bool GitDiffCache::readFile(const QByteArray &key, Result *result) const
+{
+    QFile file(filePath(key));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_8);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 encoding = 0;
+    bool binary = false;
+    quint32 pageCount = 0;
+    in >> magic >> version >> encoding >> binary >> pageCount;
+    if (magic != kFileMagic || version != kFileVersion) {
+        return false;
+    }
+
+    QList<DiffModel::Page> pages;
+    pages.reserve(pageCount);
+    for (quint32 p = 0; p < pageCount && in.status() == QDataStream::Ok; p++) {
+        DiffModel::Page page;
+        quint32 lineCount = 0;
+        in >> page.bytes >> lineCount;
+        page.lines.reserve(lineCount);
+        for (quint32 i = 0; i < lineCount && in.status() == QDataStream::Ok; i++) {
+            qint8 type = 0;
+            DiffModel::Line line;
+            in >> type >> line.oldLine >> line.newLine >> line.offset >> line.length;
+            line.type = GitDiffLine::Type(type);
+            if (qint64(line.offset) + line.length > page.bytes.size()) {
+                in.setStatus(QDataStream::ReadCorruptData);
+                break;
+            }
+            page.lines.append(line);
+        }
+        pages.append(page);
+    }
+    if (in.status() != QDataStream::Ok) {
+        qWarning() << "Diff cache: ignoring corrupt file" << file.fileName();
+        return false;
+    }
+    result->pages = std::move(pages);
+    result->binary = binary;
+    result->encoding = GitEncoding::Encoding(encoding);
+    return true;
+}
+
+void GitDiffCache::spill(const QList<QPair<QByteArray, Result>> &evicted)
+{
+    QMutexLocker locker(&m_diskMutex);
+    QDir directory(m_directory);
+    if (m_diskBytes < 0) {
+        directory.mkpath(".");
+        m_diskBytes = 0;
+        for (const QFileInfo &info : directory.entryInfoList({"*.diff"}, QDir::Files)) {
+            m_diskBytes += info.size();
+        }
+    }
+
+    for (const auto &[key, result] : evicted) {
+        QSaveFile file(filePath(key));
+        if (!file.open(QIODevice::WriteOnly)) {
+            qWarning() << "Diff cache: cannot write" << file.fileName();
+            return;
+        }
+        QDataStream out(&file);
+        out.setVersion(QDataStream::Qt_6_8);
+        out << kFileMagic << kFileVersion << qint32(result.encoding) << result.binary << quint32(result.pages.size());
+        for (const DiffModel::Page &page : result.pages) {
+            out << page.bytes << quint32(page.lines.size());
+            for (const DiffModel::Line &line : page.lines) {
+                out << qint8(line.type) << line.oldLine << line.newLine << line.offset << line.length;
+            }
+        }
+        if (file.commit()) {
+            m_diskBytes += QFileInfo(file.fileName()).size();
+        }
+    }
+
+    if (m_diskBytes <= DiskBytes) {
+        return;
+    }
+    // 超出磁盘上限：从最旧的文件开始删除，降到上限的 3/4
+    const QFileInfoList files = directory.entryInfoList({"*.diff"}, QDir::Files, QDir::Time | QDir::Reversed);
+    for (const QFileInfo &info : files) {
+        if (m_diskBytes <= DiskBytes * 3 / 4) {
+            break;
+        }
+        if (QFile::remove(info.filePath())) {
+            m_diskBytes -= info.size();
+        }
+    }
+}
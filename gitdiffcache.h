@@ -0,0 +1,68 @@
+#ifndef GITDIFFCACHE_H
+#define GITDIFFCACHE_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include "diffmodel.h"
+
+// 文件差异的结果缓存，供差异对话框在文件之间来回切换时使用
+// 键只由内容决定：旧版本的 blob id、新版本内容的哈希（或暂存区 blob id）和比较选项，
+// 文件没有变化时再次打开直接送出上次的页，不比较、不运行 git diff；文件改动后键自然不同。
+// - 内存中按字节数限制的 LRU
+// - 可选写盘：从内存中挤出的结果写到缓存目录，之后命中时读回内存
+//   （QSettings GitPushTool/DiffCache 的 diskSpill，默认关闭；磁盘上同样按总大小淘汰最旧的文件）。
+//   文件中是仓库内容的片段，关闭或切换仓库时与内存中的结果一起清除，不会留在磁盘上
+class GitDiffCache
+{
+public:
+    struct Result {
+        QList<DiffModel::Page> pages;
+        bool binary = false;
+        GitEncoding::Encoding encoding = GitEncoding::Ascii;
+    };
+
+    static constexpr qint64 MemoryBytes = 64 * 1024 * 1024;
+    static constexpr qint64 DiskBytes = 256 * 1024 * 1024;
+
+    // 进程内唯一的缓存（键与仓库无关）
+    static GitDiffCache *instance();
+
+    // kind 区分比较的两边（工作区 / 暂存区），options 为影响结果的其他参数
+    static QByteArray key(QByteArrayView kind, const QString &oldId, QByteArrayView newId, QByteArrayView options);
+
+    // 任意线程
+    bool lookup(const QByteArray &key, Result *result);
+    void insert(const QByteArray &key, const Result &result);
+
+    bool diskSpill() const { return m_diskSpill.loadRelaxed() != 0; }
+    void setDiskSpill(bool enabled) { m_diskSpill.storeRelaxed(enabled ? 1 : 0); }
+    // 任意线程：删除磁盘上的文件（包括上次运行异常退出时留下的）
+    void removeFiles();
+    // 任意线程：清空内存中的结果并删除磁盘上的文件
+    void clear();
+
+private:
+    GitDiffCache();
+    Q_DISABLE_COPY(GitDiffCache)
+
+    static qint64 cost(const Result &result);
+    QString filePath(const QByteArray &key) const;
+    bool readFile(const QByteArray &key, Result *result) const;
+    void spill(const QList<QPair<QByteArray, Result>> &evicted);
+
+    QMutex m_mutex;
+    QHash<QByteArray, Result> m_results;
+    QList<QByteArray> m_order;  // 最近使用的在末尾
+    qint64 m_bytes = 0;
+
+    QAtomicInt m_diskSpill;
+    QString m_directory;
+    QMutex m_diskMutex;
+    qint64 m_diskBytes = -1;  // 第一次写盘时统计
+};
+
+#endif // GITDIFFCACHE_H
@@ -0,0 +1,1116 @@
+#include "gitdiffengine.h"
+#include "gittokenizer.h"
+#include <QString>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GITDIFFENGINE_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define GITDIFFENGINE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// 哈希：两个 64 位通道，每 16 字节与输入异或后做 "低 32 位 × 常数 + 高低交换"，最后用 fmix64 混合
+constexpr quint32 kHashMultiplier = 0x9E3779B1u;
+constexpr quint64 kHashSeed0 = 0x243F6A8885A308D3ull;
+constexpr quint64 kHashSeed1 = 0x13198A2E03707344ull;
+
+// 与 git 的 xdiff 相同的参数：
+// 代价超过 max(sqrt(N + M), MinCost) 后不再寻找最优解；超过 MinCost 后，走得足够远
+// 并带有 SnakeCount 行相同内容的路径直接作为切分点
+constexpr int kMinCost = 256;
+constexpr int kSnakeCount = 20;
+constexpr int kHeuristicFactor = 4;
+// 出现次数超过 min(sqrt(行数), MaxEqualLimit) 的行算作"多匹配"；判断时前后各看 SimScanWindow 行
+constexpr int kMaxEqualLimit = 1024;
+constexpr int kSimScanWindow = 100;
+// Histogram：出现次数超过这个值的行不作为切分点
+constexpr int kMaxChain = 64;
+
+#if defined(GITDIFFENGINE_NEON)
+// NEON 没有 movemask：把比较结果每字节右移压成 4 位/字节的 64 位掩码
+inline quint64 neonMask(uint8x16_t eq)
+{
+    uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(eq), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0);
+}
+#elif !defined(GITDIFFENGINE_SSE2)
+inline quint64 mixLane(quint64 lane)
+{
+    return quint64(quint32(lane)) * kHashMultiplier + ((lane << 32) | (lane >> 32));
+}
+#endif
+
+inline quint64 finalizeHash(quint64 lane0, quint64 lane1, qsizetype size)
+{
+    quint64 h = lane0 ^ ((lane1 << 29) | (lane1 >> 35)) ^ (quint64(size) * kHashMultiplier);
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+// "@@ -12,5 +12,7 @@"：只有一行时省略行数，没有行时起始行号是它前面的一行
+QByteArray rangeText(char sign, int start, int count)
+{
+    QByteArray text(1, sign);
+    text += QByteArray::number(count == 0 ? start : start + 1);
+    if (count != 1) {
+        text += ',' + QByteArray::number(count);
+    }
+    return text;
+}
+
+// git 默认的函数行（块头 "@@ ... @@" 后面的部分）：以字母、'_' 或 '$' 开头的行，
+// 最多取 80 字节并去掉结尾空白；不是函数行时返回 -1
+qsizetype funcNameLength(QByteArrayView line)
+{
+    if (line.isEmpty()) return -1;
+    const uchar first = uchar(line.front());
+    if (!((first >= 'a' && first <= 'z') || (first >= 'A' && first <= 'Z') || first == '_' || first == '$')) {
+        return -1;
+    }
+    qsizetype length = qMin<qsizetype>(line.size(), 80);
+    while (length > 0 && std::isspace(uchar(line[length - 1]))) {
+        length--;
+    }
+    return length;
+}
+
+// 缩进启发（git 的 diff.indentHeuristic，默认开启）：块可以上下移动时，按前后几行的缩进和空行
+// 给每个可能的位置打分，选最像"在语句块边界上切开"的位置。参数与 git xdiff 的实现相同
+constexpr int kMaxIndent = 200;
+constexpr int kMaxBlanks = 20;
+constexpr int kIndentHeuristicMaxSliding = 100;
+constexpr int kStartOfFilePenalty = 1;
+constexpr int kEndOfFilePenalty = 21;
+constexpr int kTotalBlankWeight = -30;
+constexpr int kPostBlankWeight = 6;
+constexpr int kRelativeIndentPenalty = -4;
+constexpr int kRelativeIndentWithBlankPenalty = 10;
+constexpr int kRelativeOutdentPenalty = 24;
+constexpr int kRelativeOutdentWithBlankPenalty = 17;
+constexpr int kRelativeDedentPenalty = 23;
+constexpr int kRelativeDedentWithBlankPenalty = 17;
+constexpr int kIndentWeight = 60;
+
+// 行首缩进的宽度（制表符对齐到 8 列），只有空白的行返回 -1
+int lineIndent(QByteArrayView line)
+{
+    int indent = 0;
+    for (const char c : line) {
+        if (!std::isspace(uchar(c))) {
+            return indent;
+        }
+        if (c == ' ') {
+            indent += 1;
+        } else if (c == '\t') {
+            indent += 8 - indent % 8;
+        }
+        if (indent >= kMaxIndent) {
+            return kMaxIndent;
+        }
+    }
+    return -1;
+}
+
+// 在某一行之前切开时，这一行与前后非空行的缩进、中间的空行数
+struct SplitMeasurement {
+    bool endOfFile = false;
+    int indent = -1;
+    int preBlank = 0;
+    int preIndent = -1;
+    int postBlank = 0;
+    int postIndent = -1;
+};
+
+// 一次移动对应两个切开的位置（块的开头和结尾），分数相加；越小越好
+struct SplitScore {
+    int effectiveIndent = 0;
+    int penalty = 0;
+};
+
+void addSplitScore(const SplitMeasurement &m, SplitScore &score)
+{
+    if (m.preIndent == -1 && m.preBlank == 0) {
+        score.penalty += kStartOfFilePenalty;
+    }
+    if (m.endOfFile) {
+        score.penalty += kEndOfFilePenalty;
+    }
+    const int postBlank = m.indent == -1 ? 1 + m.postBlank : 0;
+    const int totalBlank = m.preBlank + postBlank;
+    score.penalty += kTotalBlankWeight * totalBlank;
+    score.penalty += kPostBlankWeight * postBlank;
+
+    const int indent = m.indent != -1 ? m.indent : m.postIndent;
+    const bool anyBlanks = totalBlank != 0;
+    score.effectiveIndent += indent;
+    if (indent == -1 || m.preIndent == -1 || indent == m.preIndent) {
+        return;
+    }
+    if (indent > m.preIndent) {
+        score.penalty += anyBlanks ? kRelativeIndentWithBlankPenalty : kRelativeIndentPenalty;
+    } else if (m.postIndent != -1 && m.postIndent > indent) {
+        score.penalty += anyBlanks ? kRelativeOutdentWithBlankPenalty : kRelativeOutdentPenalty;
+    } else {
+        score.penalty += anyBlanks ? kRelativeDedentWithBlankPenalty : kRelativeDedentPenalty;
+    }
+}
+
+int compareScores(const SplitScore &a, const SplitScore &b)
+{
+    const int indents = (a.effectiveIndent > b.effectiveIndent) - (a.effectiveIndent < b.effectiveIndent);
+    return kIndentWeight * indents + (a.penalty - b.penalty);
+}
+
+QByteArrayView lineContent(QByteArrayView line)
+{
+    if (line.endsWith('\n')) line.chop(1);
+    if (line.endsWith('\r')) line.chop(1);
+    return line;
+}
+
+} // namespace
+
+quint64 GitDiffEngine::hashLine(QByteArrayView line)
+{
+    const char *p = line.data();
+    qsizetype remaining = line.size();
+    alignas(16) char tail[16] = {};
+
+#if defined(GITDIFFENGINE_SSE2)
+    const __m128i multiplier = _mm_set_epi32(0, int(kHashMultiplier), 0, int(kHashMultiplier));
+    __m128i acc = _mm_set_epi64x(qint64(kHashSeed1), qint64(kHashSeed0));
+    auto round = [&](const char *block) {
+        acc = _mm_xor_si128(acc, _mm_loadu_si128(reinterpret_cast<const __m128i *>(block)));
+        acc = _mm_add_epi64(_mm_mul_epu32(acc, multiplier), _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    };
+#elif defined(GITDIFFENGINE_NEON)
+    const uint32x2_t multiplier = vdup_n_u32(kHashMultiplier);
+    uint64x2_t acc = vcombine_u64(vcreate_u64(kHashSeed0), vcreate_u64(kHashSeed1));
+    auto round = [&](const char *block) {
+        acc = veorq_u64(acc, vreinterpretq_u64_u8(vld1q_u8(reinterpret_cast<const quint8 *>(block))));
+        const uint64x2_t product = vmull_u32(vmovn_u64(acc), multiplier);
+        acc = vaddq_u64(product, vreinterpretq_u64_u32(vrev64q_u32(vreinterpretq_u32_u64(acc))));
+    };
+#else
+    quint64 acc[2] = {kHashSeed0, kHashSeed1};
+    auto round = [&](const char *block) {
+        quint64 words[2];
+        std::memcpy(words, block, 16);
+        acc[0] = mixLane(acc[0] ^ words[0]);
+        acc[1] = mixLane(acc[1] ^ words[1]);
+    };
+#endif
+
+    while (remaining >= 16) {
+        round(p);
+        p += 16;
+        remaining -= 16;
+    }
+    if (remaining > 0) {
+        std::memcpy(tail, p, size_t(remaining));
+        round(tail);
+    }
+
+#if defined(GITDIFFENGINE_SSE2)
+    alignas(16) quint64 lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i *>(lanes), acc);
+    return finalizeHash(lanes[0], lanes[1], line.size());
+#elif defined(GITDIFFENGINE_NEON)
+    return finalizeHash(vgetq_lane_u64(acc, 0), vgetq_lane_u64(acc, 1), line.size());
+#else
+    return finalizeHash(acc[0], acc[1], line.size());
+#endif
+}
+
+bool GitDiffEngine::equalBytes(const char *a, const char *b, qsizetype size)
+{
+#if defined(GITDIFFENGINE_SSE2)
+    while (size >= 16) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a));
+        const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xFFFF) {
+            return false;
+        }
+        a += 16;
+        b += 16;
+        size -= 16;
+    }
+#elif defined(GITDIFFENGINE_NEON)
+    while (size >= 16) {
+        const uint8x16_t x = vld1q_u8(reinterpret_cast<const quint8 *>(a));
+        const uint8x16_t y = vld1q_u8(reinterpret_cast<const quint8 *>(b));
+        if (neonMask(vceqq_u8(x, y)) != ~quint64(0)) {
+            return false;
+        }
+        a += 16;
+        b += 16;
+        size -= 16;
+    }
+#endif
+    return size == 0 || std::memcmp(a, b, size_t(size)) == 0;
+}
+
+qsizetype GitDiffEngine::commonPrefix(QByteArrayView a, QByteArrayView b)
+{
+    const qsizetype size = qMin(a.size(), b.size());
+    const char *x = a.data();
+    const char *y = b.data();
+    qsizetype i = 0;
+
+#if defined(GITDIFFENGINE_SSE2)
+    for (; size - i >= 16; i += 16) {
+        const __m128i u = _mm_loadu_si128(reinterpret_cast<const __m128i *>(x + i));
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(y + i));
+        const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(u, v));
+        if (mask != 0xFFFF) {
+            return i + qCountTrailingZeroBits(quint32(~mask & 0xFFFF));
+        }
+    }
+#elif defined(GITDIFFENGINE_NEON)
+    for (; size - i >= 16; i += 16) {
+        const uint8x16_t u = vld1q_u8(reinterpret_cast<const quint8 *>(x + i));
+        const uint8x16_t v = vld1q_u8(reinterpret_cast<const quint8 *>(y + i));
+        const quint64 mask = neonMask(vceqq_u8(u, v));
+        if (mask != ~quint64(0)) {
+            return i + qCountTrailingZeroBits(~mask) / 4;
+        }
+    }
+#endif
+    while (i < size && x[i] == y[i]) {
+        i++;
+    }
+    return i;
+}
+
+qsizetype GitDiffEngine::commonSuffix(QByteArrayView a, QByteArrayView b)
+{
+    const qsizetype size = qMin(a.size(), b.size());
+    const char *x = a.data() + a.size();
+    const char *y = b.data() + b.size();
+    qsizetype i = 0;
+
+#if defined(GITDIFFENGINE_SSE2)
+    for (; size - i >= 16; i += 16) {
+        const __m128i u = _mm_loadu_si128(reinterpret_cast<const __m128i *>(x - i - 16));
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(y - i - 16));
+        const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(u, v));
+        if (mask != 0xFFFF) {
+            // 最后一个不同字节之后的都相同
+            return i + qCountLeadingZeroBits(quint32(~mask & 0xFFFF)) - 16;
+        }
+    }
+#elif defined(GITDIFFENGINE_NEON)
+    for (; size - i >= 16; i += 16) {
+        const uint8x16_t u = vld1q_u8(reinterpret_cast<const quint8 *>(x - i - 16));
+        const uint8x16_t v = vld1q_u8(reinterpret_cast<const quint8 *>(y - i - 16));
+        const quint64 mask = neonMask(vceqq_u8(u, v));
+        if (mask != ~quint64(0)) {
+            return i + qCountLeadingZeroBits(~mask) / 4;
+        }
+    }
+#endif
+    while (i < size && x[-i - 1] == y[-i - 1]) {
+        i++;
+    }
+    return i;
+}
+
+GitDiffEngine::GitDiffEngine(QByteArrayView oldText, QByteArrayView newText)
+{
+    m_old.text = oldText;
+    m_new.text = newText;
+    prepare();
+}
+
+void GitDiffEngine::prepare()
+{
+    for (Side *side : {&m_old, &m_new}) {
+        const QByteArrayView text = side->text;
+        side->starts.reserve(GitTokenizer::count(text, '\n') + 2);
+        qsizetype start = 0;
+        while (start < text.size()) {
+            side->starts.append(start);
+            const qsizetype end = GitTokenizer::indexOf(text, '\n', start);
+            start = end < 0 ? text.size() : end + 1;
+        }
+        side->starts.append(text.size());
+        side->changed.fill(false, side->starts.size() - 1);
+        side->ids.fill(-1, side->starts.size() - 1);
+    }
+
+    // 开头相同的完整行：两边各自在相同字节内结束的行数取较小值
+    // （最后一行没有换行时，只有两边都在同一位置结束才算相同）
+    auto linesWithin = [](const Side &side, qsizetype bytes) {
+        return int(std::upper_bound(side.starts.cbegin(), side.starts.cend(), bytes) - side.starts.cbegin()) - 1;
+    };
+    const qsizetype prefix = commonPrefix(m_old.text, m_new.text);
+    m_prefixLines = qMin(linesWithin(m_old, prefix), linesWithin(m_new, prefix));
+
+    // 结尾相同的完整行（不能与开头重叠）
+    const qsizetype prefixBytes = m_old.starts[m_prefixLines];
+    const qsizetype suffix = qMin(commonSuffix(m_old.text, m_new.text),
+                                  qMin(m_old.text.size(), m_new.text.size()) - prefixBytes);
+    auto linesInSuffix = [](const Side &side, qsizetype bytes) {
+        const qsizetype from = side.text.size() - bytes;
+        auto it = std::lower_bound(side.starts.cbegin(), side.starts.cend() - 1, from);
+        return int(side.starts.cend() - 1 - it);
+    };
+    m_suffixLines = qMin(linesInSuffix(m_old, suffix), linesInSuffix(m_new, suffix));
+}
+
+void GitDiffEngine::assignIds(int prefixLines, int suffixLines)
+{
+    // 按内容编号：哈希相同再比较字节
+    const int oldMiddle = oldLineCount() - prefixLines - suffixLines;
+    const int newMiddle = newLineCount() - prefixLines - suffixLines;
+    qsizetype capacity = 16;
+    while (capacity < 2 * qsizetype(oldMiddle + newMiddle)) {
+        capacity *= 2;
+    }
+    const qsizetype mask = capacity - 1;
+    QList<int> table(capacity, -1);
+    struct LineClass {
+        quint64 hash;
+        QByteArrayView line;
+    };
+    QList<LineClass> classes;
+
+    for (Side *side : {&m_old, &m_new}) {
+        std::fill(side->ids.begin(), side->ids.end(), -1);
+        const int end = int(side->starts.size()) - 1 - suffixLines;
+        for (int i = prefixLines; i < end; i++) {
+            const QByteArrayView line = side->line(i);
+            const quint64 hash = hashLine(line);
+            qsizetype slot = qsizetype(hash) & mask;
+            while (table[slot] >= 0) {
+                const LineClass &existing = classes[table[slot]];
+                if (existing.hash == hash && existing.line.size() == line.size()
+                    && equalBytes(existing.line.data(), line.data(), line.size())) {
+                    break;
+                }
+                slot = (slot + 1) & mask;
+            }
+            if (table[slot] < 0) {
+                table[slot] = int(classes.size());
+                classes.append({hash, line});
+            }
+            side->ids[i] = table[slot];
+        }
+    }
+    m_idCount = int(classes.size());
+
+    // 相同的开头结尾不参与比较，但 git 统计每行在另一边出现的次数时包括它们：
+    // 只查找中间部分已有的编号，没有的保持 -1
+    for (Side *side : {&m_old, &m_new}) {
+        const int count = int(side->starts.size()) - 1;
+        for (int i = 0; i < count; i++) {
+            if (i == prefixLines) {
+                i = count - suffixLines;
+                if (i >= count) break;
+            }
+            const QByteArrayView line = side->line(i);
+            const quint64 hash = hashLine(line);
+            for (qsizetype slot = qsizetype(hash) & mask; table[slot] >= 0; slot = (slot + 1) & mask) {
+                const LineClass &existing = classes[table[slot]];
+                if (existing.hash == hash && existing.line.size() == line.size()
+                    && equalBytes(existing.line.data(), line.data(), line.size())) {
+                    side->ids[i] = table[slot];
+                    break;
+                }
+            }
+        }
+    }
+}
+
+QList<GitDiffEngine::Change> GitDiffEngine::diff(Algorithm algorithm, bool indentHeuristic)
+{
+    std::fill(m_old.changed.begin(), m_old.changed.end(), false);
+    std::fill(m_new.changed.begin(), m_new.changed.end(), false);
+
+    if (algorithm == Histogram) {
+        // git 的 histogram 不去掉相同的开头结尾：开头的行也可能被选为切分点，结果会不同
+        assignIds(0, 0);
+        histogram(0, oldLineCount(), 0, newLineCount());
+    } else {
+        assignIds(m_prefixLines, m_suffixLines);
+        myers(0, oldLineCount(), 0, newLineCount(), m_prefixLines, m_suffixLines);
+    }
+    slide(m_old, m_new, indentHeuristic);
+    slide(m_new, m_old, indentHeuristic);
+    return collectChanges();
+}
+
+void GitDiffEngine::myers(int oldBegin, int oldEnd, int newBegin, int newEnd, int prefixLines, int suffixLines)
+{
+    // 与 xdiff 的 xdl_cleanup_records 相同：另一边没有的行一定是修改，直接标记，不参与比较；
+    // 在另一边出现很多次、又夹在这种行中间的行也一样处理。
+    // 出现次数和"很多次"的界限按整个范围计算，丢弃只在去掉相同开头结尾后的部分进行
+    auto bogoSqrt = [](int n) {
+        int i = 1;
+        for (; n > 0; n >>= 2) i <<= 1;
+        return i;
+    };
+    QList<int> oldCount(m_idCount, 0);
+    QList<int> newCount(m_idCount, 0);
+    for (int i = oldBegin; i < oldEnd; i++) {
+        if (m_old.ids[i] >= 0) oldCount[m_old.ids[i]]++;
+    }
+    for (int j = newBegin; j < newEnd; j++) {
+        if (m_new.ids[j] >= 0) newCount[m_new.ids[j]]++;
+    }
+
+    Sequence a;
+    Sequence b;
+    auto reduce = [&](Side &side, int begin, int end, const QList<int> &otherCount, Sequence &sequence) {
+        const int limit = qMin(bogoSqrt(end - begin), kMaxEqualLimit);
+        begin += prefixLines;
+        end -= suffixLines;
+        QList<quint8> discard(end - begin);
+        for (int i = begin; i < end; i++) {
+            const int matches = otherCount[side.ids[i]];
+            discard[i - begin] = matches == 0 ? 0 : (matches >= limit ? 2 : 1);
+        }
+        for (int i = begin; i < end; i++) {
+            const quint8 kind = discard[i - begin];
+            if (kind == 1 || (kind == 2 && !isBuriedMultimatch(discard, i - begin))) {
+                sequence.ids.append(side.ids[i]);
+                sequence.lines.append(i);
+            } else {
+                side.changed[i] = true;
+            }
+        }
+    };
+    reduce(m_old, oldBegin, oldEnd, newCount, a);
+    reduce(m_new, newBegin, newEnd, oldCount, b);
+
+    const int maxCost = qMax(kMinCost, bogoSqrt(int(a.ids.size() + b.ids.size()) + 3));
+    QList<int> forward;
+    QList<int> backward;
+
+    // 分治用显式栈，差异很大时递归深度可能达到行数
+    struct Box {
+        int ob, oe, nb, ne;
+        bool needMin;
+    };
+    QList<Box> stack{{0, int(a.ids.size()), 0, int(b.ids.size()), false}};
+    while (!stack.isEmpty()) {
+        Box box = stack.takeLast();
+        while (box.ob < box.oe && box.nb < box.ne && a.ids[box.ob] == b.ids[box.nb]) {
+            box.ob++;
+            box.nb++;
+        }
+        while (box.ob < box.oe && box.nb < box.ne && a.ids[box.oe - 1] == b.ids[box.ne - 1]) {
+            box.oe--;
+            box.ne--;
+        }
+        if (box.ob == box.oe || box.nb == box.ne) {
+            for (int i = box.ob; i < box.oe; i++) m_old.changed[a.lines[i]] = true;
+            for (int j = box.nb; j < box.ne; j++) m_new.changed[b.lines[j]] = true;
+            continue;
+        }
+        const Split split = middleSnake(a, b, box.ob, box.oe, box.nb, box.ne, box.needMin, maxCost, forward, backward);
+        stack.append({split.oldIndex, box.oe, split.newIndex, box.ne, split.minHigh});
+        stack.append({box.ob, split.oldIndex, box.nb, split.newIndex, split.minLow});
+    }
+}
+
+bool GitDiffEngine::isBuriedMultimatch(const QList<quint8> &discard, int index)
+{
+    // xdl_clean_mmatch：前后（各最多 100 行）连续的都是无匹配或多匹配的行，
+    // 且多匹配的行所占比例不超过 1/4 时丢弃
+    const int first = qMax(0, index - kSimScanWindow);
+    const int last = qMin(int(discard.size()) - 1, index + kSimScanWindow);
+    int none = 0;
+    int multi = 1;
+    for (int r = index - 1; r >= first; r--) {
+        if (discard[r] == 0) none++;
+        else if (discard[r] == 2) multi++;
+        else break;
+    }
+    if (none == 0) {
+        return false;
+    }
+    int noneAfter = 0;
+    int multiAfter = 1;
+    for (int r = index + 1; r <= last; r++) {
+        if (discard[r] == 0) noneAfter++;
+        else if (discard[r] == 2) multiAfter++;
+        else break;
+    }
+    if (noneAfter == 0) {
+        return false;
+    }
+    none += noneAfter;
+    multi += multiAfter;
+    return multi * 4 < multi + none;
+}
+
+GitDiffEngine::Split GitDiffEngine::middleSnake(const Sequence &sa, const Sequence &sb, int oldBegin, int oldEnd,
+                                                int newBegin, int newEnd, bool needMin, int maxCost,
+                                                QList<int> &forward, QList<int> &backward)
+{
+    // 对角线 k = x - y，x / y 是相对区间起点的位置；forward[k] 是 d 步内在 k 上走到的最大 x，
+    // backward[k] 是从终点倒走 d 步在 k 上到达的最小 x
+    const int n = oldEnd - oldBegin;
+    const int m = newEnd - newBegin;
+    const int delta = n - m;
+    const bool odd = delta & 1;
+    const int offset = m + 1;
+    constexpr int None = -1;
+    forward.fill(None, n + m + 3);
+    backward.fill(None, n + m + 3);
+    const int *a = sa.ids.constData() + oldBegin;
+    const int *b = sb.ids.constData() + newBegin;
+    auto result = [&](int x, int y, bool minLow, bool minHigh) {
+        return Split{oldBegin + x, newBegin + y, minLow, minHigh};
+    };
+
+    for (int d = 0;; d++) {
+        bool gotSnake = false;
+
+        // 与 xdiff 相同从大到小遍历对角线，几条路径同样短时选出的结果与 git 一致
+        for (int k = d; k >= -d; k -= 2) {
+            if (k < -m || k > n) continue;
+            int x = 0;
+            if (d > 0) {
+                int down = k + 1 <= n ? forward[k + 1 + offset] : None;
+                if (down != None && down - k > m) down = None;
+                int right = k - 1 >= -m ? forward[k - 1 + offset] : None;
+                if (right != None && ++right > n) right = None;
+                x = qMax(down, right);
+                if (x == None) continue;
+            }
+            const int start = x;
+            int y = x - k;
+            while (x < n && y < m && a[x] == b[y]) {
+                x++;
+                y++;
+            }
+            gotSnake = gotSnake || x - start > kSnakeCount;
+            forward[k + offset] = x;
+            if (odd && k >= delta - (d - 1) && k <= delta + (d - 1)) {
+                const int reached = backward[k + offset];
+                if (reached != None && x >= reached) {
+                    return result(x, y, true, true);
+                }
+            }
+        }
+
+        for (int k = delta + d; k >= delta - d; k -= 2) {
+            if (k < -m || k > n) continue;
+            int x = n;
+            if (d > 0) {
+                int left = k + 1 <= n ? backward[k + 1 + offset] : None;
+                if (left != None && --left < 0) left = None;
+                int up = k - 1 >= -m ? backward[k - 1 + offset] : None;
+                if (up != None && up - k < 0) up = None;
+                if (left == None) x = up;
+                else if (up == None) x = left;
+                else x = qMin(left, up);
+                if (x == None) continue;
+            }
+            const int start = x;
+            int y = x - k;
+            while (x > 0 && y > 0 && a[x - 1] == b[y - 1]) {
+                x--;
+                y--;
+            }
+            gotSnake = gotSnake || start - x > kSnakeCount;
+            backward[k + offset] = x;
+            if (!odd && k >= -d && k <= d) {
+                const int reached = forward[k + offset];
+                if (reached != None && reached >= x) {
+                    return result(x, y, true, true);
+                }
+            }
+        }
+
+        if (needMin) {
+            continue;
+        }
+
+        // 代价已经较大时，如果某条路径走得足够远并且末尾有一段足够长的相同行，直接在那里切开
+        if (gotSnake && d > kMinCost) {
+            int best = 0;
+            int bestX = 0;
+            int bestY = 0;
+            for (int k = d; k >= -d; k -= 2) {
+                if (k < -m || k > n || forward[k + offset] == None) continue;
+                const int x = forward[k + offset];
+                const int y = x - k;
+                const int v = x + y - qAbs(k);
+                if (v > kHeuristicFactor * d && v > best && kSnakeCount <= x && x < n && kSnakeCount <= y && y < m) {
+                    int r = 1;
+                    while (r <= kSnakeCount && a[x - r] == b[y - r]) r++;
+                    if (r > kSnakeCount) {
+                        best = v;
+                        bestX = x;
+                        bestY = y;
+                    }
+                }
+            }
+            if (best > 0) {
+                return result(bestX, bestY, true, false);
+            }
+            for (int k = delta + d; k >= delta - d; k -= 2) {
+                if (k < -m || k > n || backward[k + offset] == None) continue;
+                const int x = backward[k + offset];
+                const int y = x - k;
+                const int v = (n - x) + (m - y) - qAbs(k - delta);
+                if (v > kHeuristicFactor * d && v > best && 0 < x && x <= n - kSnakeCount && 0 < y && y <= m - kSnakeCount) {
+                    int r = 0;
+                    while (r < kSnakeCount && a[x + r] == b[y + r]) r++;
+                    if (r == kSnakeCount) {
+                        best = v;
+                        bestX = x;
+                        bestY = y;
+                    }
+                }
+            }
+            if (best > 0) {
+                return result(bestX, bestY, false, true);
+            }
+        }
+
+        if (d >= maxCost) {
+            // 代价过大：在走得最远的对角线上切开，得到的不一定是最短的差异
+            int forwardBest = -1;
+            int forwardX = 0;
+            for (int k = d; k >= -d; k -= 2) {
+                if (k < -m || k > n || forward[k + offset] == None) continue;
+                int x = qMin(forward[k + offset], n);
+                int y = x - k;
+                if (y > m) {
+                    x = m + k;
+                    y = m;
+                }
+                if (x + y > forwardBest) {
+                    forwardBest = x + y;
+                    forwardX = x;
+                }
+            }
+            int backwardBest = n + m + 1;
+            int backwardX = n;
+            for (int k = delta + d; k >= delta - d; k -= 2) {
+                if (k < -m || k > n || backward[k + offset] == None) continue;
+                int x = qMax(0, backward[k + offset]);
+                int y = x - k;
+                if (y < 0) {
+                    x = k;
+                    y = 0;
+                }
+                if (x + y < backwardBest) {
+                    backwardBest = x + y;
+                    backwardX = x;
+                }
+            }
+            if ((n + m) - backwardBest < forwardBest) {
+                return result(forwardX, forwardBest - forwardX, true, false);
+            }
+            return result(backwardX, backwardBest - backwardX, false, true);
+        }
+    }
+}
+
+void GitDiffEngine::histogram(int oldBegin, int oldEnd, int newBegin, int newEnd)
+{
+    // 旧区间中每种行的出现次数和位置链表；只清理用过的编号，避免每个区间重新分配
+    QList<int> count(m_idCount, 0);
+    QList<int> head(m_idCount, -1);
+    QList<int> next(oldLineCount(), -1);
+    QList<int> touched;
+
+    QList<std::array<int, 4>> stack{{oldBegin, oldEnd, newBegin, newEnd}};
+    while (!stack.isEmpty()) {
+        // 与 git 相同，只在最外层去掉两边相同的开头结尾（prepare 中已经完成），
+        // 子区间不再去掉，否则选出的切分行可能不同
+        const auto [ob, oe, nb, ne] = stack.takeLast();
+        if (ob == oe || nb == ne) {
+            std::fill(m_old.changed.begin() + ob, m_old.changed.begin() + oe, true);
+            std::fill(m_new.changed.begin() + nb, m_new.changed.begin() + ne, true);
+            continue;
+        }
+
+        for (int i = oe - 1; i >= ob; i--) {
+            const int id = m_old.ids[i];
+            if (count[id] == 0) touched.append(id);
+            next[i] = head[id];
+            head[id] = i;
+            count[id]++;
+        }
+
+        // 以出现次数最少的公共行为中心向两边扩展，取次数最少（相同时最长）的一段
+        int bestCount = kMaxChain + 1;
+        int bestLength = 0;
+        int bestOld = -1;
+        int bestNew = -1;
+        bool hasCommon = false;
+        for (int j = nb; j < ne;) {
+            int nextJ = j + 1;
+            const int id = m_new.ids[j];
+            if (count[id] > 0) {
+                hasCommon = true;
+            }
+            if (count[id] > 0 && count[id] <= bestCount) {
+                for (int i = head[id]; i >= 0;) {
+                    int as = i;
+                    int bs = j;
+                    int ae = i + 1;
+                    int be = j + 1;
+                    int rc = count[id];
+                    while (as > ob && bs > nb && m_old.ids[as - 1] == m_new.ids[bs - 1]) {
+                        as--;
+                        bs--;
+                        rc = qMin(rc, count[m_old.ids[as]]);
+                    }
+                    while (ae < oe && be < ne && m_old.ids[ae] == m_new.ids[be]) {
+                        rc = qMin(rc, count[m_old.ids[ae]]);
+                        ae++;
+                        be++;
+                    }
+                    nextJ = qMax(nextJ, be);
+                    if (bestLength < ae - as || rc < bestCount) {
+                        bestLength = ae - as;
+                        bestCount = rc;
+                        bestOld = as;
+                        bestNew = bs;
+                    }
+                    // 跳过已经包含在这一段中的出现位置
+                    i = next[i];
+                    while (i >= 0 && i < ae) {
+                        i = next[i];
+                    }
+                }
+            }
+            j = nextJ;
+        }
+
+        for (int id : std::as_const(touched)) {
+            count[id] = 0;
+            head[id] = -1;
+        }
+        touched.clear();
+
+        if (bestOld < 0) {
+            if (hasCommon) {
+                // 公共行出现次数都太多，按 Myers 处理这一段（与 git 相同，先去掉这一段相同的开头结尾）
+                int prefix = 0;
+                while (ob + prefix < oe && nb + prefix < ne && m_old.ids[ob + prefix] == m_new.ids[nb + prefix]) {
+                    prefix++;
+                }
+                int suffix = 0;
+                while (oe - suffix > ob + prefix && ne - suffix > nb + prefix
+                       && m_old.ids[oe - suffix - 1] == m_new.ids[ne - suffix - 1]) {
+                    suffix++;
+                }
+                myers(ob, oe, nb, ne, prefix, suffix);
+            } else {
+                std::fill(m_old.changed.begin() + ob, m_old.changed.begin() + oe, true);
+                std::fill(m_new.changed.begin() + nb, m_new.changed.begin() + ne, true);
+            }
+            continue;
+        }
+        stack.append({bestOld + bestLength, oe, bestNew + bestLength, ne});
+        stack.append({ob, bestOld, nb, bestNew});
+    }
+}
+
+void GitDiffEngine::slide(Side &side, Side &other, bool indentHeuristic) const
+{
+    // 修改块前后有相同的行时，块可以整体上下移动而差异不变（与 git xdiff 的 xdl_change_compact 相同）：
+    // 先尽量上移、再尽量下移，途中碰到的块合并；如果某个位置能与另一边的修改块对齐，
+    // 移回最后一个对齐的位置，否则按缩进启发选择位置（关闭时停在最下面）
+    // 两边未修改的行一一对应，所以"块"（两个未修改行之间的修改行，可以为空）的个数相同，
+    // 同时遍历两边的第 i 个块
+    struct Group {
+        int start = 0;
+        int end = 0;
+    };
+    auto same = [&side](int i, int j) {
+        const QByteArrayView a = side.line(i);
+        const QByteArrayView b = side.line(j);
+        return a.size() == b.size() && equalBytes(a.data(), b.data(), a.size());
+    };
+    auto extendDown = [](const Side &s, Group &g) {
+        while (g.end < s.changed.size() && s.changed[g.end]) g.end++;
+    };
+    auto next = [&extendDown](const Side &s, Group &g) {
+        if (g.end == s.changed.size()) return false;
+        g.start = g.end + 1;
+        g.end = g.start;
+        extendDown(s, g);
+        return true;
+    };
+    auto previous = [](const Side &s, Group &g) {
+        if (g.start == 0) return false;
+        g.end = g.start - 1;
+        g.start = g.end;
+        while (g.start > 0 && s.changed[g.start - 1]) g.start--;
+        return true;
+    };
+    auto slideUp = [&](Group &g) {
+        if (g.start == 0 || !same(g.start - 1, g.end - 1)) return false;
+        side.changed[--g.start] = true;
+        side.changed[--g.end] = false;
+        while (g.start > 0 && side.changed[g.start - 1]) g.start--;
+        return true;
+    };
+    auto slideDown = [&](Group &g) {
+        if (g.end == side.changed.size() || !same(g.start, g.end)) return false;
+        side.changed[g.start++] = false;
+        side.changed[g.end++] = true;
+        extendDown(side, g);
+        return true;
+    };
+    const int lineCount = int(side.changed.size());
+    auto measure = [&side, lineCount](int split) {
+        SplitMeasurement m;
+        m.endOfFile = split >= lineCount;
+        m.indent = m.endOfFile ? -1 : lineIndent(side.line(split));
+        for (int i = split - 1; i >= 0; i--) {
+            m.preIndent = lineIndent(side.line(i));
+            if (m.preIndent != -1) break;
+            if (++m.preBlank == kMaxBlanks) {
+                m.preIndent = 0;
+                break;
+            }
+        }
+        for (int i = split + 1; i < lineCount; i++) {
+            m.postIndent = lineIndent(side.line(i));
+            if (m.postIndent != -1) break;
+            if (++m.postBlank == kMaxBlanks) {
+                m.postIndent = 0;
+                break;
+            }
+        }
+        return m;
+    };
+
+    Group g;
+    Group go;
+    extendDown(side, g);
+    extendDown(other, go);
+    do {
+        if (g.end == g.start) continue;
+
+        int earliestEnd = 0;
+        int endMatchingOther = -1;
+        int size = 0;
+        do {
+            size = g.end - g.start;
+            endMatchingOther = -1;
+            while (slideUp(g)) {
+                previous(other, go);
+            }
+            earliestEnd = g.end;
+            if (go.end > go.start) endMatchingOther = g.end;
+            while (slideDown(g)) {
+                next(other, go);
+                if (go.end > go.start) endMatchingOther = g.end;
+            }
+        } while (size != g.end - g.start);
+
+        if (g.end == earliestEnd) {
+            // 不能移动
+        } else if (endMatchingOther != -1) {
+            while (go.end == go.start) {
+                slideUp(g);
+                previous(other, go);
+            }
+        } else if (indentHeuristic) {
+            // 从最上面（最多往回 100 行）到最下面，逐个位置打分，分数相同时取靠下的
+            const int groupSize = g.end - g.start;
+            int shift = qMax(earliestEnd, qMax(g.end - groupSize - 1, g.end - kIndentHeuristicMaxSliding));
+            int bestShift = -1;
+            SplitScore bestScore;
+            for (; shift <= g.end; shift++) {
+                SplitScore score;
+                addSplitScore(measure(shift), score);
+                addSplitScore(measure(shift - groupSize), score);
+                if (bestShift == -1 || compareScores(score, bestScore) <= 0) {
+                    bestScore = score;
+                    bestShift = shift;
+                }
+            }
+            while (g.end > bestShift) {
+                slideUp(g);
+                previous(other, go);
+            }
+        }
+    } while (next(side, g) && next(other, go));
+}
+
+QList<GitDiffEngine::Change> GitDiffEngine::collectChanges() const
+{
+    QList<Change> changes;
+    const int oldCount = oldLineCount();
+    const int newCount = newLineCount();
+    int i = 0;
+    int j = 0;
+    while (i < oldCount || j < newCount) {
+        const bool oldChanged = i < oldCount && m_old.changed[i];
+        const bool newChanged = j < newCount && m_new.changed[j];
+        if (!oldChanged && !newChanged) {
+            i++;
+            j++;
+            continue;
+        }
+        Change change{i, 0, j, 0};
+        while (i < oldCount && m_old.changed[i]) {
+            i++;
+            change.oldCount++;
+        }
+        while (j < newCount && m_new.changed[j]) {
+            j++;
+            change.newCount++;
+        }
+        changes.append(change);
+    }
+    return changes;
+}
+
+void GitDiffEngine::forEachLine(const QList<Change> &changes, const GitPatchParser::LineHandler &handler, int context,
+                                int interHunkContext) const
+{
+    QByteArray funcName;
+    int funcSearched = -1;  // 已向前查找过函数行的位置，下一块只查找它之后的行
+    qsizetype first = 0;
+    while (first < changes.size()) {
+        // 间隔不超过两倍上下文（再加 diff.interHunkContext）的修改合并为一块
+        qsizetype last = first;
+        while (last + 1 < changes.size()
+               && changes[last + 1].oldStart - (changes[last].oldStart + changes[last].oldCount)
+                      <= 2 * context + interHunkContext) {
+            last++;
+        }
+        const Change &head = changes[first];
+        const Change &tail = changes[last];
+        const int oldBegin = qMax(0, head.oldStart - context);
+        const int newBegin = head.newStart - (head.oldStart - oldBegin);
+        const int oldEnd = qMin(oldLineCount(), tail.oldStart + tail.oldCount + context);
+        const int newEnd = tail.newStart + tail.newCount + (oldEnd - tail.oldStart - tail.oldCount);
+
+        for (int l = oldBegin - 1; l > funcSearched; l--) {
+            const QByteArrayView line = m_old.line(l);
+            const qsizetype length = funcNameLength(line);
+            if (length >= 0) {
+                funcName = line.first(length).toByteArray();
+                break;
+            }
+        }
+        funcSearched = qMax(funcSearched, oldBegin - 1);
+
+        QByteArray header = "@@ " + rangeText('-', oldBegin, oldEnd - oldBegin) + ' '
+            + rangeText('+', newBegin, newEnd - newBegin) + " @@";
+        if (!funcName.isEmpty()) {
+            header += ' ' + funcName;
+        }
+        handler(GitDiffLine::Header, 0, 0, header);
+
+        int o = oldBegin;
+        int n = newBegin;
+        for (qsizetype c = first; c <= last; c++) {
+            const Change &change = changes[c];
+            for (; o < change.oldStart; o++, n++) {
+                handler(GitDiffLine::Context, o + 1, n + 1, lineContent(m_old.line(o)));
+            }
+            for (; o < change.oldStart + change.oldCount; o++) {
+                handler(GitDiffLine::Delete, o + 1, 0, lineContent(m_old.line(o)));
+            }
+            for (; n < change.newStart + change.newCount; n++) {
+                handler(GitDiffLine::Add, 0, n + 1, lineContent(m_new.line(n)));
+            }
+        }
+        for (; o < oldEnd; o++, n++) {
+            handler(GitDiffLine::Context, o + 1, n + 1, lineContent(m_old.line(o)));
+        }
+        first = last + 1;
+    }
+}
+
+bool GitDiffEngine::diffWords(QStringView oldLine, QStringView newLine, QList<Span> *oldSpans, QList<Span> *newSpans)
+{
+    oldSpans->clear();
+    newSpans->clear();
+
+    struct Words {
+        QByteArray text;   // 每个词一行
+        QList<int> starts;  // 每个词的起点，末尾多一项为行长度
+    };
+    auto isWordChar = [](QChar c) {
+        return (c.isLetterOrNumber() && c.script() != QChar::Script_Han) || c == u'_';
+    };
+    auto split = [&](QStringView line) {
+        Words words;
+        int i = 0;
+        while (i < line.size()) {
+            const QChar c = line[i];
+            int j = i + 1;
+            if (isWordChar(c)) {
+                while (j < line.size() && isWordChar(line[j])) j++;
+            } else if (c.isSpace()) {
+                while (j < line.size() && line[j].isSpace()) j++;
+            } else if (c.isHighSurrogate() && j < line.size() && line[j].isLowSurrogate()) {
+                j++;
+            }
+            words.starts.append(i);
+            words.text += line.sliced(i, j - i).toUtf8();
+            words.text += '\n';
+            i = j;
+        }
+        words.starts.append(int(line.size()));
+        return words;
+    };
+    const Words oldWords = split(oldLine);
+    const Words newWords = split(newLine);
+
+    GitDiffEngine engine(oldWords.text, newWords.text);
+    const QList<Change> changes = engine.diff(Myers);
+    if (changes.isEmpty()) {
+        return false;
+    }
+
+    // 相同的部分里至少要有一个真正的词
+    bool sharesWord = false;
+    int next = 0;
+    for (qsizetype c = 0; c <= changes.size() && !sharesWord; c++) {
+        const int end = c < changes.size() ? changes[c].oldStart : int(oldWords.starts.size()) - 1;
+        for (int w = next; w < end && !sharesWord; w++) {
+            sharesWord = isWordChar(oldLine[oldWords.starts[w]]) || oldLine[oldWords.starts[w]].script() == QChar::Script_Han;
+        }
+        if (c < changes.size()) {
+            next = changes[c].oldStart + changes[c].oldCount;
+        }
+    }
+    if (!sharesWord) {
+        return false;
+    }
+
+    auto append = [](QList<Span> *spans, const Words &words, int first, int count) {
+        if (count == 0) return;
+        const int start = words.starts[first];
+        const int length = words.starts[first + count] - start;
+        if (!spans->isEmpty() && spans->last().start + spans->last().length == start) {
+            spans->last().length += length;
+        } else {
+            spans->append({start, length});
+        }
+    };
+    for (const Change &change : changes) {
+        append(oldSpans, oldWords, change.oldStart, change.oldCount);
+        append(newSpans, newWords, change.newStart, change.newCount);
+    }
+    return true;
+}
@@ -0,0 +1,106 @@
+#ifndef GITDIFFENGINE_H
+#define GITDIFFENGINE_H
+
+#include <QByteArrayView>
+#include <QList>
+#include <QStringView>
+#include "gitpatchparser.h"
+
+// 进程内的行差异，用于两个版本的内容都已经在内存中的情况（工作区文件与暂存区 blob）
+// - 按行切分用 GitTokenizer 的 SIMD 换行查找；两边相同的开头和结尾先逐 16 字节比较跳过，
+//   只有中间部分的行需要计算哈希
+// - 行哈希每次处理 16 字节（SSE2 / NEON，其他平台用相同算法的标量版本），
+//   哈希相同的行再逐 16 字节比较确认，然后编号，差异算法只比较编号
+// - Myers 与 Histogram 都按 git 的 xdiff 实现（包括预先丢弃一定是修改的行、代价过大时的启发式切分），
+//   Histogram 中出现次数都太多的区间退回 Myers
+// - 修改块的位置按 git 的规则调整（与另一边的修改对齐，否则按缩进启发选择，关闭时尽量向下），
+//   输出 unified 格式（上下文行数可设置），块头带 git 默认规则找到的函数行
+class GitDiffEngine
+{
+public:
+    enum Algorithm {
+        Myers,      // git diff 的默认算法
+        Histogram
+    };
+
+    // 一处修改：旧内容从 oldStart 开始的 oldCount 行替换为新内容从 newStart 开始的 newCount 行（行号从 0 开始）
+    struct Change {
+        int oldStart = 0;
+        int oldCount = 0;
+        int newStart = 0;
+        int newCount = 0;
+    };
+
+    // 行内变化的部分（QString 下标）
+    struct Span {
+        int start = 0;
+        int length = 0;
+    };
+
+    static constexpr int DefaultContext = 3;
+
+    GitDiffEngine(QByteArrayView oldText, QByteArrayView newText);
+
+    // indentHeuristic 对应 git 的 diff.indentHeuristic（默认开启）
+    QList<Change> diff(Algorithm algorithm = Myers, bool indentHeuristic = true);
+
+    // 按 unified 格式依次回调块头、上下文、删除、新增行（与 GitPatchParser 解析 git diff 输出的结果相同）
+    // context、interHunkContext 对应 git 的 diff.context、diff.interHunkContext
+    void forEachLine(const QList<Change> &changes, const GitPatchParser::LineHandler &handler,
+                     int context = DefaultContext, int interHunkContext = 0) const;
+
+    int oldLineCount() const { return int(m_old.starts.size()) - 1; }
+    int newLineCount() const { return int(m_new.starts.size()) - 1; }
+
+    // 一对删除 / 新增的行按词比较：连续的字母数字和 '_' 算一个词，连续的空白算一个，
+    // 汉字和其他符号各算一个；每个词当作一行交给 Myers。
+    // 两边没有相同的词（只剩空白和符号相同）时整行都变了，不值得标出，返回 false
+    static bool diffWords(QStringView oldLine, QStringView newLine, QList<Span> *oldSpans, QList<Span> *newSpans);
+
+    // 供 SIMD 与标量实现共用
+    static quint64 hashLine(QByteArrayView line);
+    static bool equalBytes(const char *a, const char *b, qsizetype size);
+    static qsizetype commonPrefix(QByteArrayView a, QByteArrayView b);
+    static qsizetype commonSuffix(QByteArrayView a, QByteArrayView b);
+
+private:
+    struct Side {
+        QByteArrayView text;
+        QList<qsizetype> starts;  // 每行的起点，末尾多一项为文本长度；行包含结尾的 '\n'
+        QList<int> ids;           // 相同内容的行编号相同（Myers 只为中间部分的行计算）
+        QList<bool> changed;
+
+        QByteArrayView line(int index) const { return text.sliced(starts[index], starts[index + 1] - starts[index]); }
+    };
+
+    // Myers 实际比较的行（去掉了一定是修改的行）：编号和它在原文件中的行号
+    struct Sequence {
+        QList<int> ids;
+        QList<int> lines;
+    };
+
+    struct Split {
+        int oldIndex;
+        int newIndex;
+        bool minLow;   // 前后两半是否要求最短的结果（不再使用启发式切分）
+        bool minHigh;
+    };
+
+    void prepare();
+    void assignIds(int prefixLines, int suffixLines);
+    void myers(int oldBegin, int oldEnd, int newBegin, int newEnd, int prefixLines, int suffixLines);
+    static bool isBuriedMultimatch(const QList<quint8> &discard, int index);
+    static Split middleSnake(const Sequence &a, const Sequence &b, int oldBegin, int oldEnd, int newBegin, int newEnd,
+                             bool needMin, int maxCost, QList<int> &forward, QList<int> &backward);
+    void histogram(int oldBegin, int oldEnd, int newBegin, int newEnd);
+    void slide(Side &side, Side &other, bool indentHeuristic) const;
+    QList<Change> collectChanges() const;
+
+    Side m_old;
+    Side m_new;
+    int m_prefixLines = 0;  // 两边开头相同的行数
+    int m_suffixLines = 0;  // 两边结尾相同的行数
+    int m_idCount = 0;
+};
+
+#endif // GITDIFFENGINE_H
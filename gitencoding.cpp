@@ -0,0 +1,266 @@
+#include "gitencoding.h"
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStringDecoder>
+#include <QStringEncoder>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GITENCODING_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define GITENCODING_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// 从 p 开始跳过连续的 ASCII 字节，返回第一个非 ASCII 字节的位置
+inline const quint8 *skipAscii(const quint8 *p, const quint8 *end)
+{
+#if defined(GITENCODING_SSE2)
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        // 最高位为 1 的字节即非 ASCII
+        int mask = _mm_movemask_epi8(chunk);
+        if (mask) {
+            return p + qCountTrailingZeroBits(quint32(mask));
+        }
+        p += 16;
+    }
+#elif defined(GITENCODING_NEON)
+    while (end - p >= 16) {
+        if (vmaxvq_u8(vld1q_u8(p)) >= 0x80) {
+            break;
+        }
+        p += 16;
+    }
+#endif
+    while (p < end && *p < 0x80) {
+        p++;
+    }
+    return p;
+}
+
+struct CachedEncoding {
+    qint64 size = -1;
+    qint64 modifiedMs = 0;
+    GitEncoding::Encoding encoding = GitEncoding::Utf8;
+};
+
+struct EncodingCache {
+    QMutex mutex;
+    QHash<QString, CachedEncoding> files;
+};
+
+Q_GLOBAL_STATIC(EncodingCache, encodingCache)
+
+// 按名称创建的 GB18030 转换器依赖 ICU（或平台支持），不可用时退回本地编码
+// （中文 Windows 的本地编码即 GBK）
+QString decodeGb18030(QByteArrayView data)
+{
+    QStringDecoder decoder("GB18030");
+    if (!decoder.isValid()) {
+        return QString::fromLocal8Bit(data);
+    }
+    return decoder.decode(data);
+}
+
+QByteArray encodeGb18030(QStringView text)
+{
+    QStringEncoder encoder("GB18030");
+    if (!encoder.isValid()) {
+        return text.toLocal8Bit();
+    }
+    return encoder.encode(text);
+}
+
+} // namespace
+
+bool GitEncoding::isAscii(QByteArrayView data)
+{
+    const quint8 *begin = reinterpret_cast<const quint8 *>(data.data());
+    const quint8 *end = begin + data.size();
+    return skipAscii(begin, end) == end;
+}
+
+GitEncoding::Encoding GitEncoding::detect(QByteArrayView data)
+{
+    const quint8 *p = reinterpret_cast<const quint8 *>(data.data());
+    const quint8 *end = p + data.size();
+
+    bool asciiOnly = true;
+    bool utf8Valid = true;
+    bool gbValid = true;
+
+    // UTF-8：还需要的后续字节数，以及下一个后续字节的合法范围（排除过长编码和代理区）
+    int utf8Pending = 0;
+    quint8 utf8Low = 0x80;
+    quint8 utf8High = 0xBF;
+
+    // GB18030：0 空闲；1 读到首字节；2 四字节序列读到第 2 字节（数字）；3 等待第 4 字节（数字）
+    int gbState = 0;
+
+    while (p < end) {
+        if (utf8Pending == 0 && gbState == 0) {
+            p = skipAscii(p, end);
+            if (p == end) {
+                break;
+            }
+        }
+
+        const quint8 c = *p++;
+        if (c >= 0x80) {
+            asciiOnly = false;
+        }
+
+        if (utf8Valid) {
+            if (utf8Pending == 0) {
+                if (c < 0x80) {
+                    // ASCII
+                } else if (c >= 0xC2 && c <= 0xDF) {
+                    utf8Pending = 1; utf8Low = 0x80; utf8High = 0xBF;
+                } else if (c == 0xE0) {
+                    utf8Pending = 2; utf8Low = 0xA0; utf8High = 0xBF;
+                } else if (c == 0xED) {
+                    utf8Pending = 2; utf8Low = 0x80; utf8High = 0x9F;
+                } else if (c >= 0xE1 && c <= 0xEF) {
+                    utf8Pending = 2; utf8Low = 0x80; utf8High = 0xBF;
+                } else if (c == 0xF0) {
+                    utf8Pending = 3; utf8Low = 0x90; utf8High = 0xBF;
+                } else if (c >= 0xF1 && c <= 0xF3) {
+                    utf8Pending = 3; utf8Low = 0x80; utf8High = 0xBF;
+                } else if (c == 0xF4) {
+                    utf8Pending = 3; utf8Low = 0x80; utf8High = 0x8F;
+                } else {
+                    utf8Valid = false;
+                }
+            } else if (c < utf8Low || c > utf8High) {
+                utf8Valid = false;
+                utf8Pending = 0;
+            } else {
+                utf8Pending--;
+                utf8Low = 0x80;
+                utf8High = 0xBF;
+            }
+        }
+
+        if (gbValid) {
+            switch (gbState) {
+            case 0:
+                if (c == 0x80 || c == 0xFF) {
+                    gbValid = false;
+                } else if (c > 0x80) {
+                    gbState = 1;
+                }
+                break;
+            case 1:
+                if (c >= 0x30 && c <= 0x39) {
+                    gbState = 2;
+                } else if ((c >= 0x40 && c <= 0x7E) || (c >= 0x80 && c <= 0xFE)) {
+                    gbState = 0;
+                } else {
+                    gbValid = false;
+                }
+                break;
+            case 2:
+                if (c >= 0x81 && c <= 0xFE) {
+                    gbState = 3;
+                } else {
+                    gbValid = false;
+                }
+                break;
+            case 3:
+                if (c >= 0x30 && c <= 0x39) {
+                    gbState = 0;
+                } else {
+                    gbValid = false;
+                }
+                break;
+            }
+            if (!gbValid) {
+                gbState = 0;
+            }
+        }
+
+        if (!utf8Valid && !gbValid) {
+            return Local;
+        }
+    }
+
+    // 末尾的多字节序列不完整
+    if (utf8Pending > 0) utf8Valid = false;
+    if (gbState != 0) gbValid = false;
+
+    if (asciiOnly) return Ascii;
+    if (utf8Valid) return Utf8;
+    if (gbValid) return Gb18030;
+    return Local;
+}
+
+QString GitEncoding::decode(QByteArrayView data, Encoding encoding)
+{
+    switch (encoding) {
+    case Ascii:
+        return QString::fromLatin1(data);
+    case Utf8:
+        return QString::fromUtf8(data);
+    case Gb18030:
+        return decodeGb18030(data);
+    case Local:
+        break;
+    }
+    return QString::fromLocal8Bit(data);
+}
+
+QByteArray GitEncoding::encode(QStringView text, Encoding encoding)
+{
+    switch (encoding) {
+    case Ascii:
+    case Utf8:
+        // ASCII 文件里新加入的非 ASCII 字符按 UTF-8 写入
+        return text.toUtf8();
+    case Gb18030:
+        return encodeGb18030(text);
+    case Local:
+        break;
+    }
+    return text.toLocal8Bit();
+}
+
+GitEncoding::Encoding GitEncoding::fileEncoding(const QString &filePath, QByteArrayView contents)
+{
+    QFileInfo info(filePath);
+    if (!info.exists()) {
+        return Utf8;
+    }
+    const qint64 size = info.size();
+    const qint64 modifiedMs = info.lastModified().toMSecsSinceEpoch();
+
+    EncodingCache *cache = encodingCache();
+    {
+        QMutexLocker locker(&cache->mutex);
+        auto it = cache->files.constFind(filePath);
+        if (it != cache->files.constEnd() && it->size == size && it->modifiedMs == modifiedMs) {
+            return it->encoding;
+        }
+    }
+
+    Encoding encoding;
+    if (!contents.isEmpty()) {
+        encoding = detect(contents);
+    } else {
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return Utf8;
+        }
+        encoding = detect(file.readAll());
+    }
+
+    QMutexLocker locker(&cache->mutex);
+    cache->files.insert(filePath, CachedEncoding{size, modifiedMs, encoding});
+    return encoding;
+}
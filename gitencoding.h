@@ -0,0 +1,36 @@
+#ifndef GITENCODING_H
+#define GITENCODING_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include <QStringView>
+
+// git 输出与工作区文件的编码识别
+// 以前的做法是先按 UTF-8 解码，再在结果里找替换字符，找到就整段用 fromLocal8Bit 重新解码；
+// 大输出要解码两次，而且文件内容总是按 UTF-8 读，GBK 文件显示为乱码。
+// 现在先对字节做一次分类（ASCII 部分用 SSE2 / NEON 每次跳过 16 字节，
+// 非 ASCII 部分同时跑 UTF-8 与 GB18030 两个状态机），再按结果只解码一次。
+class GitEncoding
+{
+public:
+    enum Encoding : quint8 {
+        Ascii,    // 纯 ASCII（同时也是合法的 UTF-8 / GB18030）
+        Utf8,
+        Gb18030,  // 合法的 GB18030（包含 GBK / GB2312）但不是合法的 UTF-8
+        Local     // 两者都不是，按本地编码解码
+    };
+
+    static bool isAscii(QByteArrayView data);
+    static Encoding detect(QByteArrayView data);
+
+    static QString decode(QByteArrayView data, Encoding encoding);
+    static QString decode(QByteArrayView data) { return decode(data, detect(data)); }
+    static QByteArray encode(QStringView text, Encoding encoding);
+
+    // 工作区文件的编码，按路径缓存；文件大小或修改时间变化后重新检测
+    // 缓存未命中时从 contents 检测，contents 为空则读取文件
+    static Encoding fileEncoding(const QString &filePath, QByteArrayView contents = QByteArrayView());
+};
+
+#endif // GITENCODING_H
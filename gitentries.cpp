@@ -0,0 +1,82 @@
+#include "gitentries.h"
+#include <QDateTime>
+
+QString formatFileSize(qint64 size)
+{
+    if (size < 1024) {
+        return QString::number(size) + " B";
+    } else if (size < 1024 * 1024) {
+        return QString::number(size / 1024.0, 'f', 1) + " KB";
+    } else if (size < 1024 * 1024 * 1024) {
+        return QString::number(size / (1024.0 * 1024.0), 'f', 1) + " MB";
+    } else {
+        return QString::number(size / (1024.0 * 1024.0 * 1024.0), 'f', 1) + " GB";
+    }
+}
+
+QString StatusEntry::statusName() const
+{
+    switch (status) {
+    case Added: return QStringLiteral("added");
+    case Deleted: return QStringLiteral("deleted");
+    case Renamed: return QStringLiteral("renamed");
+    case Untracked: return QStringLiteral("untracked");
+    case Modified: break;
+    }
+    return QStringLiteral("modified");
+}
+
+QString StatusEntry::sizeStr() const
+{
+    if (status == Deleted) {
+        return QStringLiteral("已删除");
+    }
+    return formatFileSize(size);
+}
+
+QString CommitFileEntry::statusText() const
+{
+    switch (status) {
+    case 'A': return QStringLiteral("添加");
+    case 'M': return QStringLiteral("修改");
+    case 'D': return QStringLiteral("删除");
+    case 'R': return QStringLiteral("重命名");
+    default: return statusName();
+    }
+}
+
+int CommitEntry::additions() const
+{
+    int total = 0;
+    for (const CommitFileEntry &file : files) {
+        total += qMax(file.additions, 0);
+    }
+    return total;
+}
+
+int CommitEntry::deletions() const
+{
+    int total = 0;
+    for (const CommitFileEntry &file : files) {
+        total += qMax(file.deletions, 0);
+    }
+    return total;
+}
+
+QString TreeEntry::typeName() const
+{
+    switch (type) {
+    case Tree: return QStringLiteral("tree");
+    case Submodule: return QStringLiteral("commit");
+    case Blob: break;
+    }
+    return QStringLiteral("blob");
+}
+
+QString TreeEntry::modified() const
+{
+    if (modifiedMs == 0) {
+        return QString();
+    }
+    return QDateTime::fromMSecsSinceEpoch(modifiedMs).toString("yyyy-MM-dd hh:mm");
+}
@@ -0,0 +1,173 @@
+#ifndef GITENTRIES_H
+#define GITENTRIES_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <qqml.h>
+#include "gitpathtable.h"
+
+// 传给 QML 的结果行类型
+// 之前每一行都是 QVariantMap（字符串键 + 每个值一个 QVariant，约 10 次堆分配），
+// 现在是紧凑的值类型：路径只保存仓库路径表中的 id（见 GitPathTable），
+// 文件名、大小文本、状态文字等在 QML 读取时才由已有字段计算出来。
+// QList<...> 在 QML 中仍表现为数组（length / filter / map / modelData.xxx 照常可用）。
+
+QString formatFileSize(qint64 size);
+
+// 工作区/暂存区中的一个文件（git status 的一行）
+struct StatusEntry
+{
+    Q_GADGET
+    QML_VALUE_TYPE(statusEntry)
+    Q_PROPERTY(QString path READ filePath CONSTANT)
+    Q_PROPERTY(QString name READ name CONSTANT)
+    Q_PROPERTY(QString status READ statusName CONSTANT)
+    Q_PROPERTY(bool staged MEMBER staged)
+    Q_PROPERTY(qint64 size MEMBER size)
+    Q_PROPERTY(QString sizeStr READ sizeStr CONSTANT)
+
+public:
+    enum Status : quint8 {
+        Modified,
+        Added,
+        Deleted,
+        Renamed,
+        Untracked
+    };
+
+    GitPathRef path;
+    qint64 size = 0;
+    Status status = Modified;
+    bool staged = false;
+
+    QString filePath() const { return path.toString(); }
+    QString name() const { return path.baseName(); }
+    QString statusName() const;
+    QString sizeStr() const;
+};
+
+// 提交中变更的一个文件（git log --raw --numstat 中的一项）
+struct CommitFileEntry
+{
+    Q_GADGET
+    QML_VALUE_TYPE(commitFileEntry)
+    Q_PROPERTY(QString name READ filePath CONSTANT)
+    Q_PROPERTY(QString path READ filePath CONSTANT)
+    Q_PROPERTY(QString oldPath READ oldFilePath CONSTANT)
+    Q_PROPERTY(QString status READ statusName CONSTANT)
+    Q_PROPERTY(QString statusText READ statusText CONSTANT)
+    Q_PROPERTY(int additions MEMBER additions)
+    Q_PROPERTY(int deletions MEMBER deletions)
+    Q_PROPERTY(bool isBinary READ isBinary CONSTANT)
+
+public:
+    GitPathRef path;
+    GitPathRef oldPath;  // 重命名和复制的来源，其他情况为空
+    int additions = 0;
+    int deletions = 0;  // 二进制文件两者都是 -1
+    char status = 'M';  // A / M / D / R ...
+
+    bool isBinary() const { return additions < 0; }
+
+    QString filePath() const { return path.toString(); }
+    QString oldFilePath() const { return oldPath.toString(); }
+    QString statusName() const { return QString(QLatin1Char(status)); }
+    QString statusText() const;
+};
+
+// 提交历史中的一条提交
+struct CommitEntry
+{
+    Q_GADGET
+    QML_VALUE_TYPE(commitEntry)
+    Q_PROPERTY(QString hash MEMBER hash)
+    Q_PROPERTY(QString shortHash READ shortHash CONSTANT)
+    Q_PROPERTY(QString author MEMBER author)
+    Q_PROPERTY(QString relativeDate MEMBER relativeDate)
+    Q_PROPERTY(QString fullDate MEMBER fullDate)
+    Q_PROPERTY(QString date READ date CONSTANT)
+    Q_PROPERTY(QString time READ time CONSTANT)
+    Q_PROPERTY(QString message MEMBER message)
+    Q_PROPERTY(QStringList parents MEMBER parents)
+    Q_PROPERTY(QList<CommitFileEntry> files MEMBER files)
+    Q_PROPERTY(int fileCount READ fileCount CONSTANT)
+    Q_PROPERTY(bool isMessageOnly READ isMessageOnly CONSTANT)
+    Q_PROPERTY(int additions READ additions CONSTANT)
+    Q_PROPERTY(int deletions READ deletions CONSTANT)
+
+public:
+    QString hash;
+    QString author;
+    QString relativeDate;
+    QString fullDate;  // "yyyy-MM-dd hh:mm:ss"
+    QString message;
+    QStringList parents;  // 父提交 id，合并提交有多个
+    QList<CommitFileEntry> files;
+
+    QString shortHash() const { return hash.left(7); }
+    QString date() const { return fullDate.left(10); }
+    QString time() const { return fullDate.length() >= 19 ? fullDate.mid(11, 8) : QString(); }
+    int fileCount() const { return int(files.size()); }
+    bool isMessageOnly() const { return files.isEmpty(); }
+    int additions() const;
+    int deletions() const;
+};
+
+// 目录浏览中的一项（本地工作区或远程分支的 ls-tree）
+struct TreeEntry
+{
+    Q_GADGET
+    QML_VALUE_TYPE(treeEntry)
+    Q_PROPERTY(QString path READ filePath CONSTANT)
+    Q_PROPERTY(QString name READ name CONSTANT)
+    Q_PROPERTY(bool isDir READ isDir CONSTANT)
+    Q_PROPERTY(QString type READ typeName CONSTANT)
+    Q_PROPERTY(qint64 size MEMBER size)
+    Q_PROPERTY(QString modified READ modified CONSTANT)
+    Q_PROPERTY(QString commitMsg MEMBER commitMsg)
+    Q_PROPERTY(QString commitTimeRelative MEMBER commitTimeRelative)
+    Q_PROPERTY(QString commitTimeFull MEMBER commitTimeFull)
+
+public:
+    enum Type : quint8 {
+        Blob,
+        Tree,
+        Submodule
+    };
+
+    GitPathRef path;
+    qint64 size = 0;
+    qint64 modifiedMs = 0;  // 本地文件的修改时间（毫秒时间戳），远程条目为 0
+    Type type = Blob;
+    QString commitMsg;
+    QString commitTimeRelative;
+    QString commitTimeFull;
+
+    QString filePath() const { return path.toString(); }
+    QString name() const { return path.baseName(); }
+    bool isDir() const { return type == Tree; }
+    QString typeName() const;
+    QString modified() const;
+};
+
+// 历史中的大文件
+struct LargeFileEntry
+{
+    Q_GADGET
+    QML_VALUE_TYPE(largeFileEntry)
+    Q_PROPERTY(QString hash MEMBER hash)
+    Q_PROPERTY(QString path READ filePath CONSTANT)
+    Q_PROPERTY(qint64 size MEMBER size)
+    Q_PROPERTY(QString sizeStr READ sizeStr CONSTANT)
+
+public:
+    QString hash;
+    GitPathRef path;
+    qint64 size = 0;
+
+    QString filePath() const { return path.toString(); }
+    QString sizeStr() const { return QString::number(size / 1024.0 / 1024.0, 'f', 2) + " MB"; }
+};
+
+#endif // GITENTRIES_H
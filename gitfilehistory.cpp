@@ -0,0 +1,212 @@
+#include "gitfilehistory.h"
+#include "gitoperationqueue.h"
+#include "gitprocess.h"
+#include "gittokenizer.h"
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSettings>
+#include <QtConcurrent>
+
+namespace {
+
+// commit-graph 文件是否带有变更路径过滤器（BDAT 块）
+// 格式："CGPH" 版本 哈希版本 块数 基础文件数，之后是 (块数 + 1) 项 { 4 字节 id, 8 字节偏移 }
+bool graphFileHasFilters(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray header = file.read(8);
+    if (header.size() < 8 || !header.startsWith("CGPH")) {
+        return false;
+    }
+    const int chunks = quint8(header[6]);
+    const QByteArray table = file.read(qint64(chunks + 1) * 12);
+    for (qsizetype offset = 0; offset + 12 <= table.size(); offset += 12) {
+        if (QByteArrayView(table).sliced(offset, 4) == "BDAT") {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+GitFileHistory *GitFileHistory::forRepo(const QString &repoPath)
+{
+    return GitRepoRegistry<GitFileHistory>::instance(repoPath, [&repoPath]() {
+        return new GitFileHistory(repoPath);
+    });
+}
+
+bool GitFileHistory::lookup(const QString &tip, const QString &path, Result *result) const
+{
+    const QString key = tip + ':' + path;
+    QMutexLocker locker(&m_mutex);
+    auto it = m_results.constFind(key);
+    if (it == m_results.constEnd()) {
+        return false;
+    }
+    *result = it.value();
+    m_order.removeOne(key);
+    m_order.append(key);
+    return true;
+}
+
+void GitFileHistory::insert(const QString &tip, const QString &path, const Result &result)
+{
+    const QString key = tip + ':' + path;
+    QMutexLocker locker(&m_mutex);
+    if (!m_results.contains(key)) {
+        m_order.append(key);
+    }
+    m_results.insert(key, result);
+    while (m_order.size() > MaxEntries) {
+        m_results.remove(m_order.takeFirst());
+    }
+}
+
+bool GitFileHistory::walk(const QString &tip, const QString &path, const std::shared_ptr<GitCancelToken> &token,
+                          const Progress &progress, Result *result, QString *error)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    *result = Result();
+    result->names.append(path);
+    QString revision = tip;
+    QString name = path;
+
+    for (int segment = 0; segment <= MaxRenames; segment++) {
+        QByteArray buffer;
+        QByteArray oldest;
+        auto consume = [&](QByteArrayView data) {
+            QByteArray batch;
+            GitTokenizer::forEachLine(data, [&](QByteArrayView line) {
+                const QByteArray oid = QByteArray::fromHex(line.toByteArray());
+                if (oid.isEmpty()) return;
+                if (result->oidSize == 0) {
+                    result->oidSize = int(oid.size());
+                }
+                batch.append(oid);
+                oldest = line.toByteArray();
+            });
+            if (!batch.isEmpty()) {
+                result->oids.append(batch);
+                progress(batch, result->oidSize, result->names);
+            }
+        };
+
+        GitProcess process(m_repoPath, token);
+        process.setOutputHandler([&](const QByteArray &chunk) {
+            buffer.append(chunk);
+            const qsizetype end = buffer.lastIndexOf('\n');
+            if (end < 0) return;
+            consume(QByteArrayView(buffer).first(end));
+            buffer.remove(0, end + 1);
+        });
+        GitResult log = process.run({"log", "--format=%H", revision, "--", name});
+        if (!log.ok()) {
+            if (error && !log.cancelled) *error = log.errorText();
+            return false;
+        }
+        consume(buffer);
+
+        // 这一段最早的提交新增了这个文件：如果是从别的路径重命名来的，按旧路径继续
+        const QString source = oldest.isEmpty() ? QString() : renameSource(QString::fromLatin1(oldest), name, token);
+        if (token && token->isCancelled()) {
+            return false;
+        }
+        if (source.isEmpty() || result->names.contains(source)) {
+            break;
+        }
+        name = source;
+        result->names.append(source);
+        revision = QString::fromLatin1(oldest) + "^";
+    }
+
+    qDebug() << "File history:" << path << result->oids.size() / qMax(result->oidSize, 1) << "commits,"
+             << result->names.size() << "paths in" << timer.elapsed() << "ms";
+    insert(tip, path, *result);
+    return true;
+}
+
+QString GitFileHistory::renameSource(const QString &commit, const QString &path, const std::shared_ptr<GitCancelToken> &token) const
+{
+    // -z 输出：":<模式> <模式> <对象> <对象> R<相似度>" NUL <旧路径> NUL <新路径> NUL
+    // 根提交没有父提交，diff-tree 不输出任何内容
+    GitResult result = GitProcess(m_repoPath, token).run({"diff-tree", "-r", "-M", "--raw", "-z", "--no-commit-id", commit});
+    if (!result.ok()) {
+        return QString();
+    }
+    const QList<QByteArray> tokens = result.output.split('\0');
+    for (qsizetype i = 0; i < tokens.size(); i++) {
+        const QByteArray &token = tokens[i];
+        if (!token.startsWith(':')) continue;
+        const qsizetype space = token.lastIndexOf(' ');
+        const bool rename = space >= 0 && space + 1 < token.size() && token[space + 1] == 'R';
+        if (rename && i + 2 < tokens.size() && GitTokenizer::toString(tokens[i + 2]) == path) {
+            return GitTokenizer::toString(tokens[i + 1]);
+        }
+    }
+    return QString();
+}
+
+void GitFileHistory::checkChangedPathFilters()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_filtersChecked) return;
+        m_filtersChecked = true;
+    }
+    // 已有过滤器时 git log -- <路径> 会自动使用，这里不需要做任何事
+    if (hasChangedPathFilters()) {
+        return;
+    }
+    // 不擅自改动用户的仓库：只有在设置中明确开启（GitPushTool/FileHistory 的 writeChangedPathFilters）时才写入
+    if (!QSettings("GitPushTool", "FileHistory").value("writeChangedPathFilters", false).toBool()) {
+        qDebug() << "File history: no changed-path filters in" << m_repoPath << "(git commit-graph write --changed-paths to enable)";
+        return;
+    }
+
+    // 只增加 .git/objects/info 下的缓存文件，由 git 自己的 commit-graph.lock 保护，
+    // 不占用仓库写队列，也不影响同时进行的读取；写完之前的查询照常按树比较
+    QString repoPath = m_repoPath;
+    QFuture<void> future = QtConcurrent::run([repoPath]() {
+        QElapsedTimer timer;
+        timer.start();
+        GitResult result = GitProcess(repoPath).run({"commit-graph", "write", "--reachable", "--changed-paths"});
+        qDebug() << "File history: commit-graph with changed-path filters written in" << timer.elapsed()
+                 << "ms" << (result.ok() ? "" : qPrintable(result.errorText()));
+    });
+}
+
+bool GitFileHistory::hasChangedPathFilters() const
+{
+    // 工作树和子模块的 objects 目录不一定在 <仓库>/.git 下
+    GitResult result = GitProcess(m_repoPath).run({"rev-parse", "--git-path", "objects/info"}, 10000);
+    if (!result.ok()) {
+        return true;  // 无法判断时不写
+    }
+    QString infoPath = result.outputText();
+    if (QFileInfo(infoPath).isRelative()) {
+        infoPath = m_repoPath + "/" + infoPath;
+    }
+
+    if (graphFileHasFilters(infoPath + "/commit-graph")) {
+        return true;
+    }
+    // 分层的 commit-graph：commit-graphs/*.graph
+    const QStringList layers = QDir(infoPath + "/commit-graphs").entryList({"*.graph"}, QDir::Files);
+    for (const QString &layer : layers) {
+        if (graphFileHasFilters(infoPath + "/commit-graphs/" + layer)) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,63 @@
+#ifndef GITFILEHISTORY_H
+#define GITFILEHISTORY_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <memory>
+
+class GitCancelToken;
+
+// 单个文件的历史（跟随重命名）
+// git log --follow 不使用 commit-graph 中的变更路径布隆过滤器，长历史上每次都要比较每个提交的树。
+// 这里改为分段查询：
+// - 每段是普通的 git log -- <路径>（有过滤器时绝大多数提交不用读树），只输出提交 id
+// - 一段中最早的提交新增了这个文件时，用 diff-tree -M 检查是否由重命名而来，
+//   是则从它的父提交开始按旧路径继续下一段（与 --follow 的判断方式相同）
+// - 结果按 (HEAD 提交, 路径) 缓存，HEAD 不变时再次打开直接使用
+// - 仓库的 commit-graph 已有变更路径过滤器时由 git 自动使用；没有时不会擅自写入，
+//   只有在设置中开启 writeChangedPathFilters 后才在后台写一次（与 git maintenance 的 commit-graph 任务相同）
+class GitFileHistory
+{
+public:
+    struct Result {
+        QByteArray oids;    // 从新到旧，原始字节，每个 oidSize 字节
+        int oidSize = 0;
+        QStringList names;  // 文件在历史中用过的所有路径（当前路径在前）
+    };
+
+    // 获取指定仓库的实例
+    static GitFileHistory *forRepo(const QString &repoPath);
+
+    bool lookup(const QString &tip, const QString &path, Result *result) const;
+
+    // 在工作线程中调用：从 tip 开始查询 path 的历史；每读到一批提交调用一次 progress
+    using Progress = std::function<void(const QByteArray &oids, int oidSize, const QStringList &names)>;
+    bool walk(const QString &tip, const QString &path, const std::shared_ptr<GitCancelToken> &token,
+              const Progress &progress, Result *result, QString *error);
+
+    // 在工作线程中调用：检查是否有变更路径过滤器；没有且用户开启了写入时安排后台写入（每次运行程序最多一次）
+    void checkChangedPathFilters();
+
+private:
+    explicit GitFileHistory(const QString &repoPath) : m_repoPath(repoPath) {}
+    Q_DISABLE_COPY(GitFileHistory)
+
+    void insert(const QString &tip, const QString &path, const Result &result);
+    bool hasChangedPathFilters() const;
+    QString renameSource(const QString &commit, const QString &path, const std::shared_ptr<GitCancelToken> &token) const;
+
+    static constexpr int MaxEntries = 16;
+    static constexpr int MaxRenames = 100;
+
+    QString m_repoPath;
+    mutable QMutex m_mutex;
+    QHash<QString, Result> m_results;
+    mutable QStringList m_order;  // 最近使用的在末尾
+    bool m_filtersChecked = false;
+};
+
+#endif // GITFILEHISTORY_H
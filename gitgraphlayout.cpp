@@ -0,0 +1,91 @@
+#include "gitgraphlayout.h"
+
+GitGraphRow GitGraphLayout::append(const QString &hash, const QStringList &parents)
+{
+    GitGraphRow row;
+    const QByteArray oid = QByteArray::fromHex(hash.toLatin1());
+
+    // 有子提交在等待这个提交时沿用那条泳道，否则是分支的顶端，占用一条空闲泳道
+    auto waiting = m_laneOf.constFind(oid);
+    if (waiting != m_laneOf.constEnd()) {
+        row.lane = waiting.value();
+        row.continuesUp = true;
+        m_lanes[row.lane].clear();
+        m_laneOf.erase(waiting);
+    } else {
+        row.lane = takeFreeLane();
+    }
+
+    // 其余仍在等待的泳道从这一行直通（节点泳道此时为空，不会计入）
+    for (int lane = 0; lane < m_lanes.size(); lane++) {
+        if (m_lanes[lane].isEmpty()) {
+            continue;
+        }
+        if (!row.through.isEmpty() && row.through.last() == lane - 1) {
+            row.through.last() = quint16(lane);
+        } else {
+            row.through << quint16(lane) << quint16(lane);
+        }
+    }
+
+    row.parentLanes.reserve(parents.size());
+    for (qsizetype i = 0; i < parents.size(); i++) {
+        const QByteArray parent = QByteArray::fromHex(parents[i].toLatin1());
+        int target;
+        auto found = m_laneOf.constFind(parent);
+        if (found != m_laneOf.constEnd()) {
+            // 父提交已经有泳道（分支在这里合拢）：斜线连过去
+            target = found.value();
+        } else {
+            // 第一个父提交沿用节点的泳道，合并进来的其他父提交各占一条新泳道
+            target = m_lanes[row.lane].isEmpty() ? row.lane : takeFreeLane();
+            m_lanes[target] = parent;
+            m_laneOf.insert(parent, target);
+        }
+        row.parentLanes.append(quint16(target));
+    }
+
+    // 根提交，或者所有父提交都在别的泳道上
+    if (m_lanes[row.lane].isEmpty()) {
+        releaseLane(row.lane);
+    }
+
+    row.width = row.lane + 1;
+    for (quint16 lane : std::as_const(row.parentLanes)) {
+        row.width = qMax(row.width, lane + 1);
+    }
+    if (!row.through.isEmpty()) {
+        row.width = qMax(row.width, row.through.last() + 1);
+    }
+    return row;
+}
+
+void GitGraphLayout::clear()
+{
+    m_lanes.clear();
+    m_laneOf.clear();
+    m_freeLanes = {};
+}
+
+int GitGraphLayout::takeFreeLane()
+{
+    // 堆里可能残留已被截掉或重新占用的泳道，取出时再确认
+    while (!m_freeLanes.empty()) {
+        const int lane = m_freeLanes.top();
+        m_freeLanes.pop();
+        if (lane < m_lanes.size() && m_lanes[lane].isEmpty()) {
+            return lane;
+        }
+    }
+    m_lanes.append(QByteArray());
+    return int(m_lanes.size()) - 1;
+}
+
+void GitGraphLayout::releaseLane(int lane)
+{
+    m_freeLanes.push(lane);
+    // 末尾的空闲泳道直接截掉，之后的直通扫描只覆盖实际在用的范围
+    while (!m_lanes.isEmpty() && m_lanes.last().isEmpty()) {
+        m_lanes.removeLast();
+    }
+}
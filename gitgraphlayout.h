@@ -0,0 +1,65 @@
+#ifndef GITGRAPHLAYOUT_H
+#define GITGRAPHLAYOUT_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <qqml.h>
+#include <functional>
+#include <queue>
+#include <vector>
+
+// 提交图中的一行：节点所在的泳道和穿过这一行的线段
+// 每行以节点高度分为上下两半：
+// - 上半：子提交在等待这个提交时，从顶部沿节点泳道连到节点（continuesUp）
+// - 下半：从节点连到每个父提交所在的泳道底部（parentLanes，可能是斜线）
+// - 其余仍在等待各自提交的泳道从顶部直通到底部，按连续区间保存（through）
+// 泳道编号不随行移动，空出的泳道被后面的分支复用，所以直通的泳道通常只有少数几个区间。
+struct GitGraphRow
+{
+    Q_GADGET
+    QML_VALUE_TYPE(graphRow)
+    Q_PROPERTY(int lane MEMBER lane)
+    Q_PROPERTY(int width MEMBER width)
+    Q_PROPERTY(bool continuesUp MEMBER continuesUp)
+
+public:
+    int lane = -1;  // -1 表示没有图（搜索结果）
+    int width = 0;  // 这一行用到的泳道数
+    bool continuesUp = false;
+    QList<quint16> parentLanes;
+    QList<quint16> through;  // [起始泳道, 结束泳道] 成对存放，包含两端
+
+    bool isValid() const { return lane >= 0; }
+    bool operator==(const GitGraphRow &other) const
+    {
+        return lane == other.lane && width == other.width && continuesUp == other.continuesUp
+            && parentLanes == other.parentLanes && through == other.through;
+    }
+    bool operator!=(const GitGraphRow &other) const { return !(*this == other); }
+};
+
+// 按 git log 的输出顺序（子提交在父提交之前）逐个分配泳道
+// 每个提交只看当前等待中的泳道，复杂度与泳道数成正比，不需要整个历史；
+// 历史边读边显示时每一页到达就能画出来。
+class GitGraphLayout
+{
+public:
+    GitGraphRow append(const QString &hash, const QStringList &parents);
+    void clear();
+
+    // 当前同时存在的泳道数
+    int laneCount() const { return int(m_lanes.size()); }
+
+private:
+    int takeFreeLane();
+    void releaseLane(int lane);
+
+    QList<QByteArray> m_lanes;          // 泳道 -> 等待的提交 id（原始字节），空表示空闲
+    QHash<QByteArray, int> m_laneOf;    // 等待中的提交 id -> 泳道
+    std::priority_queue<int, std::vector<int>, std::greater<int>> m_freeLanes;  // 最小的空闲泳道优先
+};
+
+#endif // GITGRAPHLAYOUT_H
@@ -0,0 +1,512 @@
+#include "githistoryindex.h"
+#include "gitprocess.h"
+#include "gittokenizer.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QScopeGuard>
+#include <QStandardPaths>
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+constexpr quint32 kFileMagic = 0x47504849;  // "GPHI"
+constexpr quint32 kFileVersion = 1;
+
+constexpr char kRecordMark = '\x1e';
+constexpr char kFieldMark = '\x1f';
+
+// 不可达的提交太多时（例如切换到另一条完全不同的历史）直接重建更快
+constexpr qsizetype kMaxRemovedBeforeRebuild = 10000;
+
+// 标记删除的文档超过总数的 1/kCompactFraction 时压缩（切换分支、amend 不断留下的旧提交）
+constexpr qsizetype kCompactFraction = 4;
+
+quint32 trigramAt(const char *p)
+{
+    return (quint32(uchar(p[0])) << 16) | (quint32(uchar(p[1])) << 8) | quint32(uchar(p[2]));
+}
+
+void appendVarint(QByteArray &data, quint32 value)
+{
+    while (value >= 0x80) {
+        data.append(char((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    data.append(char(value));
+}
+
+// 十六进制关键字与提交 id 前缀比较（关键字可以是奇数位）
+bool matchesOidPrefix(QByteArrayView oid, QByteArrayView hexPrefix)
+{
+    static constexpr char digits[] = "0123456789abcdef";
+    for (qsizetype i = 0; i < hexPrefix.size(); i++) {
+        const uchar byte = uchar(oid[i / 2]);
+        const char digit = digits[(i % 2 == 0) ? (byte >> 4) : (byte & 0x0f)];
+        if (digit != hexPrefix[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool isHex(QByteArrayView text)
+{
+    return std::all_of(text.begin(), text.end(), [](char c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+    });
+}
+
+} // namespace
+
+GitHistoryIndex *GitHistoryIndex::forRepo(const QString &repoPath)
+{
+    return GitRepoRegistry<GitHistoryIndex>::instance(repoPath, [&repoPath]() {
+        return new GitHistoryIndex(repoPath);
+    });
+}
+
+bool GitHistoryIndex::isReady() const
+{
+    QReadLocker locker(&m_lock);
+    return m_ready;
+}
+
+bool GitHistoryIndex::update(QString *error)
+{
+    if (!m_updateMutex.tryLock()) {
+        return true;
+    }
+    auto unlock = qScopeGuard([this]() { m_updateMutex.unlock(); });
+
+    QElapsedTimer timer;
+    timer.start();
+
+    if (!m_loaded) {
+        m_loaded = true;
+        if (load()) {
+            qDebug() << "History index: loaded" << m_offsets.size() - 1 << "commits in" << timer.elapsed() << "ms";
+        }
+    }
+
+    GitResult result = GitProcess(m_repoPath).run({"rev-parse", "--verify", "-q", "HEAD"}, 10000);
+    const QString head = result.outputText();
+    if (head.isEmpty()) {
+        // 还没有提交
+        QWriteLocker locker(&m_lock);
+        clear();
+        m_ready = true;
+        return result.exitCode == 1 || result.ok();
+    }
+
+    QString oldHead;
+    {
+        QReadLocker locker(&m_lock);
+        oldHead = m_headHash;
+    }
+    if (oldHead == head) {
+        QWriteLocker locker(&m_lock);
+        m_ready = true;
+        return true;
+    }
+
+    bool ok = false;
+    if (!oldHead.isEmpty() && removeUnreachable(oldHead, head, error)) {
+        const qsizetype before = m_offsets.size();
+        ok = indexCommits({head, "--not", oldHead}, error);
+        qDebug() << "History index: appended" << m_offsets.size() - before << "commits in" << timer.elapsed() << "ms";
+    }
+    if (!ok) {
+        // 第一次建立，或旧 HEAD 已不存在：从头重建
+        {
+            QWriteLocker locker(&m_lock);
+            clear();
+        }
+        ok = indexCommits({head}, error);
+        qDebug() << "History index: built" << m_offsets.size() - 1 << "commits in" << timer.elapsed() << "ms";
+    }
+    if (!ok) {
+        return false;
+    }
+
+    {
+        QWriteLocker locker(&m_lock);
+        const qsizetype docCount = m_offsets.size() - 1;
+        if (!m_removed.isEmpty() && m_removed.size() * kCompactFraction > docCount) {
+            const qsizetype removed = m_removed.size();
+            compact();
+            qDebug() << "History index: compacted" << removed << "unreachable of" << docCount << "commits";
+        }
+        m_headHash = head;
+        m_ready = true;
+    }
+    save();
+    return true;
+}
+
+QStringList GitHistoryIndex::search(const QString &query, int limit) const
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QStringList hashes;
+    const QByteArray needle = query.trimmed().toUtf8().toLower();
+    if (needle.isEmpty()) {
+        return hashes;
+    }
+
+    QReadLocker locker(&m_lock);
+    const quint32 docCount = m_offsets.isEmpty() ? 0 : quint32(m_offsets.size() - 1);
+    QSet<quint32> matched;
+
+    // 提交 id 前缀
+    if (needle.size() >= 4 && needle.size() <= m_oidSize * 2 && isHex(needle)) {
+        for (quint32 doc = docCount; doc-- > 0 && hashes.size() < limit;) {
+            if (!m_removed.contains(doc) && matchesOidPrefix(QByteArrayView(m_oids).sliced(qsizetype(doc) * m_oidSize, m_oidSize), needle)) {
+                hashes.append(oidAt(doc));
+                matched.insert(doc);
+            }
+        }
+    }
+
+    auto verify = [&](quint32 doc) {
+        if (hashes.size() >= limit || m_removed.contains(doc) || matched.contains(doc)) return;
+        if (documentText(doc).indexOf(needle) >= 0) {
+            hashes.append(oidAt(doc));
+        }
+    };
+
+    if (needle.size() < 3) {
+        // 太短，没有三字节组可用，直接扫描
+        for (quint32 doc = docCount; doc-- > 0 && hashes.size() < limit;) {
+            verify(doc);
+        }
+    } else {
+        // 关键字中的每个三字节组都必须出现，从最短的倒排表开始求交集
+        QList<const Posting *> postings;
+        for (qsizetype i = 0; i + 3 <= needle.size(); i++) {
+            auto it = m_postings.constFind(trigramAt(needle.constData() + i));
+            if (it == m_postings.constEnd()) {
+                postings.clear();
+                break;
+            }
+            if (!postings.contains(&it.value())) {
+                postings.append(&it.value());
+            }
+        }
+        std::sort(postings.begin(), postings.end(), [](const Posting *a, const Posting *b) {
+            return a->count < b->count;
+        });
+
+        QList<quint32> candidates = postings.isEmpty() ? QList<quint32>() : decode(*postings.first());
+        for (qsizetype i = 1; i < postings.size() && !candidates.isEmpty(); i++) {
+            const QList<quint32> other = decode(*postings[i]);
+            QList<quint32> intersection;
+            std::set_intersection(candidates.cbegin(), candidates.cend(), other.cbegin(), other.cend(),
+                                  std::back_inserter(intersection));
+            candidates = std::move(intersection);
+        }
+        for (auto it = candidates.crbegin(); it != candidates.crend() && hashes.size() < limit; ++it) {
+            verify(*it);
+        }
+    }
+
+    qDebug() << "History index: search" << query << "->" << hashes.size() << "of" << docCount << "commits in"
+             << timer.elapsed() << "ms";
+    return hashes;
+}
+
+void GitHistoryIndex::addDocument(QByteArrayView oid, const QByteArray &text)
+{
+    const quint32 doc = quint32(m_offsets.size() - 1);
+    if (m_oidSize == 0) {
+        m_oidSize = int(oid.size());
+    }
+    m_oids.append(oid.first(qMin<qsizetype>(oid.size(), m_oidSize)));
+    m_oids.append(QByteArray(m_oidSize - qMin<qsizetype>(oid.size(), m_oidSize), '\0'));
+    m_text.append(text);
+    m_offsets.append(quint32(m_text.size()));
+
+    // 每个三字节组在一篇文档中只记录一次
+    QList<quint32> trigrams;
+    trigrams.reserve(text.size());
+    for (qsizetype i = 0; i + 3 <= text.size(); i++) {
+        trigrams.append(trigramAt(text.constData() + i));
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+    for (quint32 trigram : std::as_const(trigrams)) {
+        Posting &posting = m_postings[trigram];
+        appendVarint(posting.data, posting.count == 0 ? doc : doc - posting.last);
+        posting.last = doc;
+        posting.count++;
+    }
+}
+
+void GitHistoryIndex::compact()
+{
+    const QByteArray oids = std::exchange(m_oids, QByteArray());
+    const QByteArray text = std::exchange(m_text, QByteArray());
+    const QList<quint32> offsets = std::exchange(m_offsets, QList<quint32>{0});
+    const QSet<quint32> removed = std::exchange(m_removed, QSet<quint32>());
+    m_postings.clear();
+
+    // 保留的文档按原来的先后重新加入，倒排表随之重建
+    const QByteArrayView textView(text);
+    for (quint32 doc = 0; doc + 1 < quint32(offsets.size()); doc++) {
+        if (removed.contains(doc)) continue;
+        addDocument(QByteArrayView(oids).sliced(qsizetype(doc) * m_oidSize, m_oidSize),
+                    textView.sliced(offsets[doc], offsets[doc + 1] - offsets[doc]).toByteArray());
+    }
+}
+
+void GitHistoryIndex::clear()
+{
+    m_headHash.clear();
+    m_oidSize = 0;
+    m_oids.clear();
+    m_text.clear();
+    m_offsets = {0};
+    m_removed.clear();
+    m_postings.clear();
+    m_ready = false;
+}
+
+bool GitHistoryIndex::indexCommits(const QStringList &revisions, QString *error)
+{
+    // 从旧到新，文档 id 与提交先后一致
+    QStringList args = {"log", "--reverse", "-z", "--name-only", "--format=%x1e%H%x1f%an%x1f%B"};
+    args += revisions;
+
+    QByteArray buffer;
+    QByteArray oid;
+    QByteArray text;
+    int pathCount = 0;
+    QList<QPair<QByteArray, QByteArray>> pending;
+
+    // 曾经索引过、后来不可达而标记删除的提交再次出现时恢复原文档，不再追加新文档
+    QHash<QByteArray, quint32> revivable;
+    int revived = 0;
+    {
+        QReadLocker locker(&m_lock);
+        revivable.reserve(m_removed.size());
+        for (quint32 doc : m_removed) {
+            revivable.insert(m_oids.mid(qsizetype(doc) * m_oidSize, m_oidSize), doc);
+        }
+    }
+
+    auto flushCommit = [&]() {
+        if (!oid.isEmpty()) {
+            pending.append({oid, text.toLower()});
+        }
+        oid.clear();
+        text.clear();
+        pathCount = 0;
+    };
+    auto flushPending = [&]() {
+        if (pending.isEmpty()) return;
+        QWriteLocker locker(&m_lock);
+        for (const auto &commit : std::as_const(pending)) {
+            auto it = revivable.constFind(commit.first);
+            if (it != revivable.constEnd()) {
+                m_removed.remove(it.value());
+                revived++;
+            } else {
+                addDocument(commit.first, commit.second);
+            }
+        }
+        pending.clear();
+    };
+    auto parseToken = [&](QByteArrayView token) {
+        if (token.startsWith('\n')) {
+            token = token.sliced(1);
+        }
+        if (token.isEmpty()) return;
+        if (token.front() == kRecordMark) {
+            flushCommit();
+            auto fields = GitTokenizer::split<3>(token.sliced(1), kFieldMark);
+            oid = QByteArray::fromHex(fields[0].toByteArray());
+            text = fields[1].toByteArray() + '\n' + GitTokenizer::trimmed(fields[2]).toByteArray();
+        } else if (!oid.isEmpty() && pathCount < MaxPathsPerCommit) {
+            // 大批量修改（导入、格式化）的提交只索引前面的路径
+            text += '\n';
+            text += token;
+            pathCount++;
+        }
+    };
+
+    GitProcess process(m_repoPath);
+    process.setOutputHandler([&](const QByteArray &chunk) {
+        buffer += chunk;
+        const qsizetype end = buffer.lastIndexOf('\0');
+        if (end < 0) return;
+        GitTokenizer::forEachRecord(QByteArrayView(buffer).first(end + 1), '\0', parseToken);
+        buffer.remove(0, end + 1);
+        if (pending.size() >= 1000) {
+            flushPending();
+        }
+    });
+    GitResult result = process.run(args);
+    if (!result.ok()) {
+        if (error) *error = result.errorText();
+        return false;
+    }
+    if (!buffer.isEmpty()) {
+        parseToken(buffer);
+    }
+    flushCommit();
+    flushPending();
+    if (revived > 0) {
+        qDebug() << "History index: restored" << revived << "reachable commits";
+    }
+    return true;
+}
+
+bool GitHistoryIndex::removeUnreachable(const QString &oldHead, const QString &head, QString *error)
+{
+    Q_UNUSED(error)
+    GitResult result = GitProcess(m_repoPath).run({"rev-list", oldHead, "--not", head});
+    if (!result.ok()) {
+        // 旧 HEAD 已被回收
+        return false;
+    }
+
+    QSet<QByteArray> unreachable;
+    GitTokenizer::forEachLine(result.output, [&unreachable](QByteArrayView line) {
+        unreachable.insert(QByteArray::fromHex(line.toByteArray()));
+    });
+    if (unreachable.size() > kMaxRemovedBeforeRebuild) {
+        return false;
+    }
+    if (unreachable.isEmpty()) {
+        return true;
+    }
+
+    QWriteLocker locker(&m_lock);
+    const quint32 docCount = quint32(m_offsets.size() - 1);
+    for (quint32 doc = docCount; doc-- > 0 && !unreachable.isEmpty();) {
+        QByteArray oid = m_oids.mid(qsizetype(doc) * m_oidSize, m_oidSize);
+        if (unreachable.remove(oid)) {
+            m_removed.insert(doc);
+        }
+    }
+    return true;
+}
+
+QList<quint32> GitHistoryIndex::decode(const Posting &posting) const
+{
+    QList<quint32> docs;
+    docs.reserve(posting.count);
+    quint32 doc = 0;
+    quint32 value = 0;
+    int shift = 0;
+    for (char c : posting.data) {
+        value |= quint32(uchar(c) & 0x7f) << shift;
+        if (uchar(c) & 0x80) {
+            shift += 7;
+            continue;
+        }
+        doc = docs.isEmpty() ? value : doc + value;
+        docs.append(doc);
+        value = 0;
+        shift = 0;
+    }
+    return docs;
+}
+
+QByteArrayView GitHistoryIndex::documentText(quint32 doc) const
+{
+    return QByteArrayView(m_text).sliced(m_offsets[doc], m_offsets[doc + 1] - m_offsets[doc]);
+}
+
+QString GitHistoryIndex::oidAt(quint32 doc) const
+{
+    return QString::fromLatin1(m_oids.mid(qsizetype(doc) * m_oidSize, m_oidSize).toHex());
+}
+
+QString GitHistoryIndex::indexFilePath() const
+{
+    const QString key = GitOperationQueue::repoKey(m_repoPath);
+    const QByteArray name = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/history-index/" + name + ".idx";
+}
+
+bool GitHistoryIndex::load()
+{
+    QFile file(indexFilePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_8);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    in >> magic >> version;
+    if (magic != kFileMagic || version != kFileVersion) {
+        return false;
+    }
+
+    QString headHash;
+    qint32 oidSize = 0;
+    QByteArray oids;
+    QByteArray text;
+    QList<quint32> offsets;
+    QSet<quint32> removed;
+    quint32 postingCount = 0;
+    in >> headHash >> oidSize >> oids >> text >> offsets >> removed >> postingCount;
+
+    QHash<quint32, Posting> postings;
+    postings.reserve(postingCount);
+    for (quint32 i = 0; i < postingCount && in.status() == QDataStream::Ok; i++) {
+        quint32 trigram = 0;
+        Posting posting;
+        in >> trigram >> posting.last >> posting.count >> posting.data;
+        postings.insert(trigram, posting);
+    }
+    if (in.status() != QDataStream::Ok || offsets.isEmpty()
+        || oids.size() != qsizetype(oidSize) * (offsets.size() - 1) || offsets.last() != quint32(text.size())) {
+        qWarning() << "History index: ignoring corrupt index file" << file.fileName();
+        return false;
+    }
+
+    QWriteLocker locker(&m_lock);
+    m_headHash = headHash;
+    m_oidSize = oidSize;
+    m_oids = std::move(oids);
+    m_text = std::move(text);
+    m_offsets = std::move(offsets);
+    m_removed = std::move(removed);
+    m_postings = std::move(postings);
+    m_ready = true;
+    return true;
+}
+
+bool GitHistoryIndex::save() const
+{
+    const QString path = indexFilePath();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "History index: cannot write" << path;
+        return false;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_8);
+
+    QReadLocker locker(&m_lock);
+    out << kFileMagic << kFileVersion << m_headHash << qint32(m_oidSize) << m_oids << m_text << m_offsets
+        << m_removed << quint32(m_postings.size());
+    for (auto it = m_postings.cbegin(); it != m_postings.cend(); ++it) {
+        out << it.key() << it->last << it->count << it->data;
+    }
+    return file.commit();
+}
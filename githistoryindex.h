@@ -0,0 +1,79 @@
+#ifndef GITHISTORYINDEX_H
+#define GITHISTORYINDEX_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+// 提交历史的全文搜索索引
+// 以前搜索只在 QML 中对已加载的 30 条提交做子串匹配。现在后台为整个历史建立索引：
+// - 每个提交是一篇文档：作者、完整提交信息和修改的路径（ASCII 转小写）
+// - 倒排索引按三字节组（trigram）建立，子串查询先求所有三字节组的交集，再对候选文档核对原文；
+//   文档 id 按提交从旧到新递增，倒排表按差值变长编码，50 万个提交也只占几十 MB
+// - 保存在缓存目录中，下次启动直接加载；HEAD 移动后只追加新提交（git log HEAD --not <旧 HEAD>），
+//   不再可达的提交（amend、rebase、reset 之后）标记为删除，再次可达时（切换回原来的分支）恢复原文档；
+//   标记删除的文档超过四分之一时在内存中压缩，来回切换分支不会让索引无限增长
+// - 关键字是十六进制时同时匹配提交 id 前缀
+class GitHistoryIndex
+{
+public:
+    // 获取指定仓库的索引
+    static GitHistoryIndex *forRepo(const QString &repoPath);
+
+    // 在工作线程中调用：加载磁盘上的索引并追加到当前 HEAD，必要时重建
+    // 已有其他线程在更新时直接返回
+    bool update(QString *error = nullptr);
+
+    // 索引是否已经可用（可能落后于 HEAD，直到下一次 update 完成）
+    bool isReady() const;
+
+    // 任意线程：按从新到旧返回匹配的提交 id，最多 limit 个
+    QStringList search(const QString &query, int limit = 10000) const;
+
+private:
+    explicit GitHistoryIndex(const QString &repoPath) : m_repoPath(repoPath) {}
+    Q_DISABLE_COPY(GitHistoryIndex)
+
+    struct Posting {
+        QByteArray data;  // 文档 id 的差值，变长编码
+        quint32 last = 0;
+        quint32 count = 0;
+    };
+
+    // 追加文档（调用方持有写锁）
+    void addDocument(QByteArrayView oid, const QByteArray &text);
+    // 去掉标记删除的文档，文档 id 重新连续编号（调用方持有写锁）
+    void compact();
+    void clear();
+    bool indexCommits(const QStringList &revisions, QString *error);
+    bool removeUnreachable(const QString &oldHead, const QString &head, QString *error);
+    QList<quint32> decode(const Posting &posting) const;
+    QByteArrayView documentText(quint32 doc) const;
+    QString oidAt(quint32 doc) const;
+    bool load();
+    bool save() const;
+    QString indexFilePath() const;
+
+    static constexpr int MaxPathsPerCommit = 200;
+
+    QString m_repoPath;
+    QMutex m_updateMutex;
+    mutable QReadWriteLock m_lock;
+    bool m_loaded = false;
+    bool m_ready = false;
+
+    QString m_headHash;
+    int m_oidSize = 0;
+    QByteArray m_oids;          // 文档 id -> 提交 id（原始字节，每个 m_oidSize 字节）
+    QByteArray m_text;          // 所有文档的文本
+    QList<quint32> m_offsets = {0};  // 文档 i 的文本为 [m_offsets[i], m_offsets[i + 1])
+    QSet<quint32> m_removed;    // 已不可达的文档
+    QHash<quint32, Posting> m_postings;
+};
+
+#endif // GITHISTORYINDEX_H
@@ -0,0 +1,327 @@
+#include "gitindex.h"
+#include "gitconfig.h"
+#include "gitprocess.h"
+#include "gittokenizer.h"
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// 条目中 oid 之前的 stat 信息：ctime、mtime 各 8 字节，dev、ino、mode、uid、gid、size 各 4 字节
+constexpr qsizetype kStatBytes = 40;
+constexpr qsizetype kModeOffset = 24;
+
+constexpr quint16 kFlagAssumeValid = 0x8000;
+constexpr quint16 kFlagExtended = 0x4000;
+constexpr quint16 kFlagStageMask = 0x3000;
+constexpr quint16 kFlagSkipWorktree = 0x4000;   // 扩展标志
+constexpr quint16 kFlagIntentToAdd = 0x2000;    // 扩展标志
+
+// index v4 路径压缩使用的变长整数（与 git 的 decode_varint 相同）
+bool readVarint(const uchar *&p, const uchar *end, quint64 *value)
+{
+    if (p >= end) return false;
+    uchar c = *p++;
+    quint64 v = c & 127;
+    while (c & 128) {
+        if (p >= end) return false;
+        c = *p++;
+        v = ((v + 1) << 7) | (c & 127);
+    }
+    *value = v;
+    return true;
+}
+
+bool isSpecified(QByteArrayView value)
+{
+    return value != "unspecified" && value != "unset";
+}
+
+} // namespace
+
+GitIndex *GitIndex::forRepo(const QString &repoPath)
+{
+    return GitRepoRegistry<GitIndex>::instance(repoPath, [&repoPath]() {
+        return new GitIndex(repoPath);
+    });
+}
+
+bool GitIndex::blobId(const QString &path, QString *oid)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!reload()) {
+        return false;
+    }
+    const QByteArray key = path.toUtf8();
+    auto pathOf = [this](const Entry &entry) {
+        return QByteArrayView(m_paths).sliced(entry.pathOffset, entry.pathLength);
+    };
+    // index 按路径的字节序排列
+    auto it = std::lower_bound(m_entries.cbegin(), m_entries.cend(), key, [&](const Entry &entry, const QByteArray &k) {
+        const QByteArrayView p = pathOf(entry);
+        const int c = std::memcmp(p.data(), k.constData(), size_t(qMin(p.size(), k.size())));
+        return c < 0 || (c == 0 && p.size() < k.size());
+    });
+    if (it == m_entries.cend() || pathOf(*it) != QByteArrayView(key)) {
+        return false;
+    }
+    const qsizetype index = it - m_entries.cbegin();
+    *oid = QString::fromLatin1(QByteArrayView(m_oids).sliced(index * m_oidSize, m_oidSize).toByteArray().toHex());
+    return true;
+}
+
+GitIndex::Conversion GitIndex::conversion(const QString &path)
+{
+    const GitConfig::Snapshot config = GitConfig::forRepo(m_repoPath)->snapshot();
+    QByteArray stamp;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!locate()) {
+            return Unsupported;
+        }
+        if (config.revision != m_configRevision) {
+            // core.autocrlf 或全局属性文件的位置可能变了，之前的结果都不再可信
+            m_configRevision = config.revision;
+            m_autoCrlf = QString::fromLatin1(config.value("core.autocrlf").trimmed().toLower());
+            QString attributesFile = QString::fromUtf8(config.value("core.attributesfile").trimmed());
+            const QString home = qEnvironmentVariable("HOME", QDir::homePath());
+            if (attributesFile.isEmpty()) {
+                attributesFile = qEnvironmentVariable("XDG_CONFIG_HOME", home + "/.config") + "/git/attributes";
+            } else if (attributesFile.startsWith("~/")) {
+                attributesFile = home + attributesFile.mid(1);
+            }
+            m_globalAttributesPath = attributesFile;
+            m_conversions.clear();
+        }
+        stamp = attributesStamp(path);
+        auto it = m_conversions.constFind(path);
+        if (it != m_conversions.constEnd() && it->attributes == stamp) {
+            return it->conversion;
+        }
+    }
+
+    GitResult result = GitProcess(m_repoPath).run(
+        {"check-attr", "-z", "filter", "diff", "text", "eol", "crlf", "ident", "working-tree-encoding", "--", path}, 10000);
+    if (!result.ok()) {
+        return Unsupported;
+    }
+    // -z 输出：路径、属性名、值，各以 NUL 结尾
+    QHash<QByteArray, QByteArray> attributes;
+    QList<QByteArrayView> fields;
+    GitTokenizer::forEachRecord(result.output, '\0', [&](QByteArrayView field) {
+        fields.append(field);
+    });
+    for (qsizetype i = 0; i + 2 < fields.size(); i += 3) {
+        attributes.insert(fields[i + 1].toByteArray(), fields[i + 2].toByteArray());
+    }
+
+    Conversion conversion = NoConversion;
+    const QByteArray text = attributes.value("text");
+    const QByteArray crlf = attributes.value("crlf");
+    if (isSpecified(attributes.value("filter")) || attributes.value("diff") != "unspecified"
+        || attributes.value("ident") == "set" || isSpecified(attributes.value("working-tree-encoding"))) {
+        // 清理过滤器、diff 驱动（textconv、二进制）、$Id$ 展开、编码转换：结果只有 git 能给出
+        conversion = Unsupported;
+    } else if (text == "unset" || (text == "unspecified" && crlf == "unset")) {
+        conversion = NoConversion;
+    } else if (text != "unspecified" || crlf != "unspecified" || isSpecified(attributes.value("eol"))) {
+        conversion = CrlfToLf;
+    } else {
+        QMutexLocker locker(&m_mutex);
+        conversion = (m_autoCrlf == "true" || m_autoCrlf == "input") ? CrlfToLf : NoConversion;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_conversions.insert(path, {conversion, stamp});
+    return conversion;
+}
+
+QByteArray GitIndex::attributesStamp(const QString &path) const
+{
+    // 属性来自全局属性文件、$GIT_DIR/info/attributes 以及路径上每一级目录的 .gitattributes，
+    // 记下它们的大小和修改时间（不存在为 -1），任何一个改变都需要重新运行 check-attr
+    QByteArray stamp;
+    auto add = [&stamp](const QString &filePath) {
+        const QFileInfo info(filePath);
+        stamp += info.exists() ? QByteArray::number(info.size()) + ':'
+                     + QByteArray::number(info.lastModified().toMSecsSinceEpoch())
+                               : QByteArray("-1");
+        stamp += ';';
+    };
+    add(m_globalAttributesPath);
+    add(m_infoAttributesPath);
+    QString dir = m_repoPath;
+    add(dir + "/.gitattributes");
+    const QStringList parts = path.split('/');
+    for (qsizetype i = 0; i + 1 < parts.size(); i++) {
+        dir += "/" + parts[i];
+        add(dir + "/.gitattributes");
+    }
+    return stamp;
+}
+
+bool GitIndex::locate()
+{
+    if (m_located) {
+        return !m_indexPath.isEmpty();
+    }
+    m_located = true;
+
+    // 工作树和子模块的 index 不一定在 <仓库>/.git 下
+    GitResult result = GitProcess(m_repoPath).run({"rev-parse", "--git-path", "index", "--git-path", "info/attributes"}, 10000);
+    QStringList paths = result.outputText().split('\n');
+    if (!result.ok() || paths.size() != 2) {
+        return false;
+    }
+    for (QString &path : paths) {
+        path = path.trimmed();
+        if (QFileInfo(path).isRelative()) {
+            path = m_repoPath + "/" + path;
+        }
+    }
+
+    // 对象格式在仓库创建后不会改变
+    const GitConfig::Snapshot config = GitConfig::forRepo(m_repoPath)->snapshot();
+    if (config.value("extensions.objectformat").trimmed().toLower() == "sha256") {
+        m_oidSize = 32;
+    }
+    m_indexPath = paths[0];
+    m_infoAttributesPath = paths[1];
+    return true;
+}
+
+bool GitIndex::reload()
+{
+    if (!locate()) {
+        return false;
+    }
+    const QFileInfo info(m_indexPath);
+    if (!info.exists()) {
+        m_valid = false;
+        m_entries.clear();
+        m_paths.clear();
+        m_oids.clear();
+        m_size = -1;
+        m_checksum.clear();
+        return false;
+    }
+    // git 总是写入新文件再改名。修改时间的精度有限（同一时刻内连续写入时大小也可能相同），
+    // 大小和时间都没变时再比较文件结尾的校验和；index.skipHash 时校验和全为 0，只能依靠前者
+    if (info.size() == m_size && info.lastModified() == m_modified && info.metadataChangeTime() == m_changed
+        && trailingChecksum() == m_checksum) {
+        return m_valid;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QFile file(m_indexPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray data = file.readAll();
+    m_size = info.size();
+    m_modified = info.lastModified();
+    m_changed = info.metadataChangeTime();
+    m_checksum = data.right(m_oidSize);
+    m_valid = parse(data);
+    if (!m_valid) {
+        m_entries.clear();
+        m_paths.clear();
+        m_oids.clear();
+    }
+    qDebug() << "Index:" << m_entries.size() << "entries parsed in" << timer.elapsed() << "ms"
+             << (m_valid ? "" : "(unsupported, falling back to git diff)");
+    return m_valid;
+}
+
+QByteArray GitIndex::trailingChecksum() const
+{
+    QFile file(m_indexPath);
+    if (!file.open(QIODevice::ReadOnly) || file.size() < m_oidSize || !file.seek(file.size() - m_oidSize)) {
+        return QByteArray();
+    }
+    return file.read(m_oidSize);
+}
+
+bool GitIndex::parse(const QByteArray &data)
+{
+    m_entries.clear();
+    m_paths.clear();
+    m_oids.clear();
+    if (data.size() < 12 + m_oidSize || !data.startsWith("DIRC")) {
+        return false;
+    }
+    const uchar *begin = reinterpret_cast<const uchar *>(data.constData());
+    const uchar *end = begin + data.size() - m_oidSize;  // 结尾是整个文件的校验和
+    const quint32 version = qFromBigEndian<quint32>(begin + 4);
+    const quint32 count = qFromBigEndian<quint32>(begin + 8);
+    if (version < 2 || version > 4) {
+        return false;
+    }
+
+    m_entries.reserve(count);
+    m_oids.reserve(qsizetype(count) * m_oidSize);
+    QByteArray previous;  // v4 的路径相对前一个条目压缩
+    const uchar *p = begin + 12;
+    for (quint32 n = 0; n < count; n++) {
+        const uchar *entry = p;
+        if (end - p < kStatBytes + m_oidSize + 2) return false;
+        const quint32 mode = qFromBigEndian<quint32>(p + kModeOffset);
+        const uchar *oid = p + kStatBytes;
+        p += kStatBytes + m_oidSize;
+        const quint16 flags = qFromBigEndian<quint16>(p);
+        p += 2;
+        quint16 extended = 0;
+        if (flags & kFlagExtended) {
+            if (version < 3 || end - p < 2) return false;
+            extended = qFromBigEndian<quint16>(p);
+            p += 2;
+        }
+
+        QByteArrayView path;
+        if (version == 4) {
+            quint64 strip = 0;
+            if (!readVarint(p, end, &strip) || strip > quint64(previous.size())) return false;
+            const qsizetype nul = GitTokenizer::indexOf(QByteArrayView(p, end - p), '\0');
+            if (nul < 0) return false;
+            previous.chop(qsizetype(strip));
+            previous.append(reinterpret_cast<const char *>(p), nul);
+            p += nul + 1;
+            path = previous;
+        } else {
+            const qsizetype nul = GitTokenizer::indexOf(QByteArrayView(p, end - p), '\0');
+            if (nul < 0) return false;
+            path = QByteArrayView(p, nul);
+            // 条目长度补齐到 8 字节（至少一个 NUL）
+            const qsizetype size = ((p - entry) + nul + 8) & ~qsizetype(7);
+            if (end - entry < size) return false;
+            p = entry + size;
+        }
+
+        const bool regularFile = (mode >> 12) == 8;
+        if (regularFile && !(flags & (kFlagAssumeValid | kFlagStageMask))
+            && !(extended & (kFlagSkipWorktree | kFlagIntentToAdd))) {
+            m_entries.append({quint32(m_paths.size()), quint32(path.size())});
+            m_paths.append(path);
+            m_oids.append(reinterpret_cast<const char *>(oid), m_oidSize);
+        }
+    }
+
+    // 扩展：4 字节签名 + 4 字节长度；拆分的 index 的条目不全在这个文件里
+    while (end - p >= 8) {
+        const quint32 size = qFromBigEndian<quint32>(p + 4);
+        if (std::memcmp(p, "link", 4) == 0) {
+            return false;
+        }
+        if (quint64(end - p - 8) < size) return false;
+        p += 8 + size;
+    }
+    return true;
+}
@@ -0,0 +1,77 @@
+#ifndef GITINDEX_H
+#define GITINDEX_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+// 直接读取 .git/index，查询文件在暂存区中的 blob id，供工作区差异在进程内比较使用
+// - 按 index 文件的大小、修改时间和结尾的校验和缓存，暂存、提交、切换分支后下次查询时重新读取
+// - 支持 v2 / v3 / v4 格式；拆分的 index（split index）不支持，调用方退回 git diff
+// - 只收录 stage 0 的普通文件；冲突中、intent-to-add、assume-unchanged、skip-worktree 的条目
+//   不收录（git diff 对它们有特殊处理）
+class GitIndex
+{
+public:
+    // 工作区文件与暂存区内容之间需要的转换（由 .gitattributes 和 core.autocrlf 决定）
+    enum Conversion {
+        NoConversion,
+        CrlfToLf,     // text / eol / autocrlf：比较前把工作区文件的 CRLF 换成 LF
+        Unsupported   // filter、diff 驱动、ident、working-tree-encoding 等：交给 git diff
+    };
+
+    // 获取指定仓库的 index
+    static GitIndex *forRepo(const QString &repoPath);
+
+    // 在工作线程中调用：path 为相对仓库根目录的路径；不在 index 中或不能直接比较时返回 false
+    bool blobId(const QString &path, QString *oid);
+
+    // 在工作线程中调用：第一次查询某个路径时运行 git check-attr，之后使用缓存；
+    // 影响这个路径的 .gitattributes 文件或仓库配置（core.autocrlf 等）改变后重新查询
+    Conversion conversion(const QString &path);
+
+private:
+    explicit GitIndex(const QString &repoPath) : m_repoPath(repoPath) {}
+    Q_DISABLE_COPY(GitIndex)
+
+    struct Entry {
+        quint32 pathOffset;  // 在 m_paths 中的位置
+        quint32 pathLength;
+    };
+
+    struct CachedConversion {
+        Conversion conversion;
+        QByteArray attributes;  // 查询时相关属性文件的状态（见 attributesStamp）
+    };
+
+    bool locate();
+    bool reload();
+    bool parse(const QByteArray &data);
+    QByteArray trailingChecksum() const;
+    QByteArray attributesStamp(const QString &path) const;
+
+    QString m_repoPath;
+    QMutex m_mutex;
+    bool m_located = false;
+    QString m_indexPath;
+    QString m_infoAttributesPath;
+    int m_oidSize = 20;
+    int m_configRevision = 0;
+    QString m_autoCrlf;
+    QString m_globalAttributesPath;
+
+    qint64 m_size = -1;
+    QDateTime m_modified;
+    QDateTime m_changed;
+    QByteArray m_checksum;   // 文件结尾的校验和（index.skipHash 时全为 0）
+    bool m_valid = false;
+    QByteArray m_paths;      // 所有路径依次拼接（index 中按路径排序）
+    QList<Entry> m_entries;
+    QByteArray m_oids;       // 每个条目的 oid 原始字节（m_oidSize 字节）依次拼接
+    QHash<QString, CachedConversion> m_conversions;
+};
+
+#endif // GITINDEX_H
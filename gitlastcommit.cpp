@@ -0,0 +1,139 @@
+#include "gitlastcommit.h"
+#include "gitprocess.h"
+#include "gittokenizer.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QSet>
+
+namespace {
+
+// 提交头部行的起始标记与字段分隔符（不会出现在路径和单行提交信息中）
+constexpr char kRecordMark = '\x1e';
+constexpr char kFieldMark = '\x1f';
+
+} // namespace
+
+GitLastCommitEngine *GitLastCommitEngine::forRepo(const QString &repoPath)
+{
+    return GitRepoRegistry<GitLastCommitEngine>::instance(repoPath, [&repoPath]() {
+        return new GitLastCommitEngine(repoPath);
+    });
+}
+
+QHash<QString, GitLastCommit> GitLastCommitEngine::resolve(const QString &revision, const QString &dirPath, QString *error)
+{
+    QHash<QString, GitLastCommit> commits;
+    GitProcess process(m_repoPath);
+
+    // 缓存键使用解析后的提交：分支移动后自动失效
+    GitResult result = process.run({"rev-parse", "--verify", "-q", revision + "^{commit}"}, 10000);
+    const QString commitHash = result.outputText();
+    if (!result.ok() || commitHash.isEmpty()) {
+        if (error && result.stalled) *error = result.errorText();
+        return commits;
+    }
+    const QString cacheKey = commitHash + '\n' + dirPath;
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_cache.constFind(cacheKey);
+        if (it != m_cache.constEnd()) {
+            m_cacheOrder.removeOne(cacheKey);
+            m_cacheOrder.append(cacheKey);
+            return it.value();
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // 该提交中目录下的条目（未跟踪的本地文件不在其中，否则遍历永远不会提前结束）
+    const QByteArray prefix = dirPath.isEmpty() ? QByteArray() : dirPath.toUtf8() + '/';
+    QStringList lsTreeArgs = {"-c", "core.quotepath=false", "ls-tree", "-z", "--name-only", commitHash};
+    if (!dirPath.isEmpty()) {
+        lsTreeArgs << "--" << dirPath + "/";
+    }
+    result = process.run(lsTreeArgs, 10000);
+    if (!result.ok()) {
+        if (error) *error = result.errorText();
+        return commits;
+    }
+    QSet<QByteArray> pending;
+    GitTokenizer::forEachRecord(result.output, '\0', [&pending, &prefix](QByteArrayView path) {
+        if (path.startsWith(prefix)) {
+            pending.insert(path.sliced(prefix.size()).toByteArray());
+        }
+    });
+    const qsizetype entryCount = pending.size();
+
+    if (!pending.isEmpty()) {
+        // 单次遍历：每个提交输出一行头部，后面是它在该目录下修改的路径
+        GitCancelToken::Ptr stopToken = GitCancelToken::create(QString());
+        GitLastCommit current;
+        QByteArray buffer;
+        GitProcess logProcess(m_repoPath, stopToken);
+        logProcess.setOutputHandler([&](const QByteArray &chunk) {
+            if (pending.isEmpty()) return;
+            buffer += chunk;
+            qsizetype end = buffer.lastIndexOf('\n');
+            if (end < 0) return;
+
+            GitTokenizer::forEachLine(QByteArrayView(buffer).first(end + 1), [&](QByteArrayView line) {
+                if (pending.isEmpty()) return;
+                if (line.startsWith(kRecordMark)) {
+                    auto fields = GitTokenizer::split<4>(line.sliced(1), kFieldMark);
+                    current.hash = GitTokenizer::toString(fields[0]);
+                    current.relativeTime = GitTokenizer::toString(fields[1]);
+                    // "2025-01-16 14:30:00 +0800" -> "2025-01-16 14:30"
+                    current.time = GitTokenizer::toString(fields[2].first(qMin<qsizetype>(fields[2].size(), 16)));
+                    current.message = GitTokenizer::toString(fields[3]);
+                    return;
+                }
+
+                QByteArray unquoted;
+                if (GitTokenizer::isQuoted(line)) {
+                    unquoted = GitTokenizer::unquote(line);
+                    line = unquoted;
+                }
+                if (!line.startsWith(prefix)) return;
+                QByteArrayView rest = line.sliced(prefix.size());
+                qsizetype slash = rest.indexOf('/');
+                QByteArray name = (slash >= 0 ? rest.first(slash) : rest).toByteArray();
+                if (pending.remove(name)) {
+                    commits.insert(QString::fromUtf8(name), current);
+                }
+            });
+            buffer.remove(0, end + 1);
+
+            if (pending.isEmpty()) {
+                // 所有条目都已确定，不再继续遍历更早的历史
+                stopToken->cancel();
+            }
+        });
+
+        QStringList logArgs = {"-c", "core.quotepath=false", "log", "--no-renames", "--name-only",
+                               "--format=%x1e%H%x1f%ar%x1f%ci%x1f%s", commitHash};
+        if (!dirPath.isEmpty()) {
+            logArgs << "--" << dirPath + "/";
+        }
+        result = logProcess.run(logArgs);
+        if (result.stalled && error) {
+            *error = result.errorText();
+        }
+    }
+
+    qDebug() << "Last commits for" << (dirPath.isEmpty() ? "/" : dirPath) << ":" << commits.size() << "of"
+             << entryCount << "entries resolved in one traversal," << timer.elapsed() << "ms";
+
+    // 卡死时结果不完整，不缓存
+    if (!result.stalled) {
+        QMutexLocker locker(&m_mutex);
+        m_cache.insert(cacheKey, commits);
+        m_cacheOrder.removeOne(cacheKey);
+        m_cacheOrder.append(cacheKey);
+        while (m_cacheOrder.size() > CacheLimit) {
+            m_cache.remove(m_cacheOrder.takeFirst());
+        }
+    }
+    return commits;
+}
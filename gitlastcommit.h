@@ -0,0 +1,46 @@
+#ifndef GITLASTCOMMIT_H
+#define GITLASTCOMMIT_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+// 最后一次修改某个条目的提交
+struct GitLastCommit
+{
+    QString hash;
+    QString message;
+    QString relativeTime;  // "3 days ago"
+    QString time;          // "2025-01-16 14:30"
+};
+
+// 目录浏览用的"每个条目最后一次提交"计算
+// 以前对目录中的每个条目各运行一次 git log -1 -- <path>，300 个条目就是 300 次历史遍历。
+// 现在对一个目录只遍历一次历史（git log --name-only，限定在该目录下），
+// 按变更路径的第一级名称把提交分配给尚未确定的条目，全部确定后立即终止 git。
+// 结果按（解析后的提交 hash，目录）缓存：提交不变时同一目录不会再遍历。
+// 远程目录浏览和本地文件列表共用。
+class GitLastCommitEngine
+{
+public:
+    // 获取指定仓库的实例
+    static GitLastCommitEngine *forRepo(const QString &repoPath);
+
+    // 在工作线程中调用：revision 中 dirPath 目录（空为根目录）下每个条目名 -> 最后一次提交
+    // 出错时 error 返回错误信息，已确定的条目仍然返回
+    QHash<QString, GitLastCommit> resolve(const QString &revision, const QString &dirPath, QString *error = nullptr);
+
+private:
+    explicit GitLastCommitEngine(const QString &repoPath) : m_repoPath(repoPath) {}
+    Q_DISABLE_COPY(GitLastCommitEngine)
+
+    static constexpr int CacheLimit = 64;
+
+    QString m_repoPath;
+    QMutex m_mutex;
+    QHash<QString, QHash<QString, GitLastCommit>> m_cache;
+    QStringList m_cacheOrder;  // 最近使用的在末尾
+};
+
+#endif // GITLASTCOMMIT_H
@@ -0,0 +1,276 @@
+#include "gitlockmanager.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QThread>
+#include "gitprocess.h"
+
+namespace {
+
+// 无法检查持有进程时按锁文件的年龄判断：git 只在写 index / refs 的短时间内持有锁，
+// 超过这个时间仍然存在的锁很可能是残留；但 git commit 等待编辑器或钩子时也会长时间保留锁，
+// 所以只报告给用户，不自动删除
+constexpr qint64 kStaleLockAgeMs = 60000;
+
+GitLockManager::HolderState stateByAge(const QString &lockFile)
+{
+    const QDateTime modified = QFileInfo(lockFile).lastModified();
+    return modified.msecsTo(QDateTime::currentDateTime()) >= kStaleLockAgeMs ? GitLockManager::Expired
+                                                                             : GitLockManager::Unknown;
+}
+
+QString canonicalOrClean(const QString &path)
+{
+    QString canonical = QFileInfo(path).canonicalFilePath();
+    return canonical.isEmpty() ? QDir::cleanPath(QFileInfo(path).absoluteFilePath()) : canonical;
+}
+
+bool isInside(const QString &path, const QString &root)
+{
+    return path == root || path.startsWith(root + '/');
+}
+
+#ifdef Q_OS_LINUX
+QByteArray readProcFile(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+// /proc/<pid>/stat 第三个字段是进程状态，Z 表示僵尸进程（已退出，只是尚未被回收）
+bool isZombie(const QString &pidDir)
+{
+    QByteArray stat = readProcFile(pidDir + "/stat");
+    int close = stat.lastIndexOf(')');
+    return close > 0 && close + 2 < stat.size() && stat.at(close + 2) == 'Z';
+}
+#endif
+
+} // namespace
+
+QString GitLockManager::gitDir(const QString &repoPath)
+{
+    QString dotGit = repoPath + "/.git";
+    QFileInfo info(dotGit);
+
+    if (info.isFile()) {
+        // worktree / submodule: ".git" 文件内容为 "gitdir: <path>"
+        QFile file(dotGit);
+        if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            QString line = QString::fromUtf8(file.readLine()).trimmed();
+            if (line.startsWith("gitdir:")) {
+                QString target = line.mid(7).trimmed();
+                if (QFileInfo(target).isRelative()) {
+                    target = repoPath + "/" + target;
+                }
+                return QDir::cleanPath(target);
+            }
+        }
+    }
+    return dotGit;
+}
+
+QStringList GitLockManager::existingLockFiles(const QString &repoPath)
+{
+    static const QStringList lockNames = {
+        "index.lock", "HEAD.lock", "ORIG_HEAD.lock", "config.lock",
+        "packed-refs.lock", "shallow.lock"
+    };
+
+    QStringList result;
+    QString dir = gitDir(repoPath);
+    for (const QString &name : lockNames) {
+        QString path = dir + "/" + name;
+        if (QFileInfo::exists(path)) {
+            result.append(path);
+        }
+    }
+    return result;
+}
+
+GitLockManager::HolderState GitLockManager::findHolder(const QString &repoPath, const QString &lockFile,
+                                                       qint64 *pid, QString *name)
+{
+#ifdef Q_OS_LINUX
+    const QString repoRoot = canonicalOrClean(repoPath);
+    const QString dotGitDir = canonicalOrClean(gitDir(repoPath));
+    const QString lockPath = canonicalOrClean(lockFile);
+    const qint64 selfPid = QCoreApplication::applicationPid();
+
+    QDir proc("/proc");
+    if (!proc.exists()) {
+        return stateByAge(lockFile);
+    }
+
+    // 只有打开了锁文件句柄的进程才能确认为持有者；但 git 创建锁文件后可能关闭句柄而保留文件
+    // （例如 git commit 等待编辑器或运行钩子），所以仓库中还有存活的 git 进程时不能认定为残留
+    // （本程序自己的子进程已在下面排除）
+    bool uncheckedGit = false;
+    qint64 gitInRepoPid = 0;
+    QString gitInRepoName;
+    const QStringList entries = proc.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &entry : entries) {
+        bool ok = false;
+        qint64 processId = entry.toLongLong(&ok);
+        if (!ok || processId == selfPid) continue;
+        // 本程序的子进程：读操作不取锁，写操作与锁检查在写队列中串行，不会同时运行
+        if (GitProcess::isRunningChild(processId)) continue;
+
+        const QString pidDir = "/proc/" + entry;
+        const QString comm = QString::fromUtf8(readProcFile(pidDir + "/comm")).trimmed();
+        const bool isGit = comm == "git" || comm.startsWith("git-");
+
+        // 其他用户的进程读不到 cwd，返回空字符串
+        const QString cwd = QFileInfo(pidDir + "/cwd").symLinkTarget();
+        const bool inRepo = !cwd.isEmpty() && (isInside(cwd, repoRoot) || isInside(cwd, dotGitDir));
+
+        if (!isGit && !inRepo) continue;
+        if (isZombie(pidDir)) continue;
+        if (isGit && inRepo && gitInRepoPid == 0) {
+            gitInRepoPid = processId;
+            gitInRepoName = comm;
+        }
+
+        QDir fdDir(pidDir + "/fd");
+        if (!fdDir.isReadable()) {
+            // 其他用户的 git 进程：看不到它打开的文件
+            uncheckedGit = uncheckedGit || isGit;
+            continue;
+        }
+        const QStringList fds = fdDir.entryList(QDir::AllEntries | QDir::System | QDir::NoDotAndDotDot);
+        for (const QString &fd : fds) {
+            if (QFileInfo(fdDir.filePath(fd)).symLinkTarget() == lockPath) {
+                *pid = processId;
+                *name = comm;
+                return HeldByProcess;
+            }
+        }
+    }
+
+    if (gitInRepoPid > 0) {
+        *pid = gitInRepoPid;
+        *name = gitInRepoName;
+        return Unknown;
+    }
+    return uncheckedGit ? stateByAge(lockFile) : Stale;
+#else
+    // Windows / macOS 没有 /proc，扫描全系统的 git 进程也无法知道谁打开了锁文件，只按锁的年龄判断
+    Q_UNUSED(repoPath)
+    Q_UNUSED(pid)
+    Q_UNUSED(name)
+    return stateByAge(lockFile);
+#endif
+}
+
+GitLockManager::LockStatus GitLockManager::inspect(const QString &repoPath, const QString &lockFile)
+{
+    LockStatus status;
+    status.lockFile = lockFile;
+
+    QFileInfo info(lockFile);
+    if (!info.exists()) {
+        status.state = NoLock;
+        return status;
+    }
+    status.ageMs = info.lastModified().msecsTo(QDateTime::currentDateTime());
+    status.state = findHolder(repoPath, lockFile, &status.holderPid, &status.holderName);
+    return status;
+}
+
+bool GitLockManager::removeIfStale(const QString &repoPath, const QString &lockFile, LockStatus *status,
+                                   bool includeExpired)
+{
+    auto removable = [includeExpired](HolderState state) {
+        return state == Stale || (includeExpired && state == Expired);
+    };
+
+    LockStatus first = inspect(repoPath, lockFile);
+    if (status) *status = first;
+    if (!removable(first.state)) {
+        return false;
+    }
+
+    // 再确认一次，排除"进程刚创建锁文件、还没来得及被扫描到"的竞争
+    QDateTime modified = QFileInfo(lockFile).lastModified();
+    QThread::msleep(100);
+    LockStatus second = inspect(repoPath, lockFile);
+    if (status) *status = second;
+    if (!removable(second.state) || QFileInfo(lockFile).lastModified() != modified) {
+        return false;
+    }
+
+    if (!QFile::remove(lockFile)) {
+        return false;
+    }
+    qDebug() << "Removed stale git lock:" << lockFile << "age" << second.ageMs << "ms";
+    return true;
+}
+
+bool GitLockManager::waitForRelease(const QString &repoPath, int maxWaitMs, QString *errorMessage)
+{
+    QElapsedTimer timer;
+    timer.start();
+    int backoffMs = 25;
+
+    while (true) {
+        const QStringList locks = existingLockFiles(repoPath);
+        if (locks.isEmpty()) {
+            return true;
+        }
+
+        LockStatus blocking;
+        for (const QString &lockFile : locks) {
+            LockStatus status;
+            if (removeIfStale(repoPath, lockFile, &status)) {
+                continue;
+            }
+            if (status.state != NoLock) {
+                blocking = status;
+                break;
+            }
+        }
+
+        if (blocking.state == NoLock) {
+            // 所有锁都已释放或被清理
+            if (existingLockFiles(repoPath).isEmpty()) {
+                return true;
+            }
+            continue;
+        }
+
+        // 按年龄判断的残留锁不会自行消失，也不能自动删除：不再等待，交给用户确认后解锁
+        if (blocking.state == Expired || timer.elapsed() + backoffMs > maxWaitMs) {
+            if (errorMessage) {
+                QString name = QFileInfo(blocking.lockFile).fileName();
+                if (blocking.state == HeldByProcess) {
+                    *errorMessage = QString("仓库被另一个 Git 进程锁定（%1，PID %2 持有 %3），请等待其完成后重试")
+                                        .arg(blocking.holderName).arg(blocking.holderPid).arg(name);
+                } else if (blocking.holderPid > 0) {
+                    *errorMessage = QString("仓库被锁定（%1），Git 进程（%2，PID %3）仍在该仓库中运行，"
+                                            "可能正在等待编辑器或钩子，请等待其完成后重试")
+                                        .arg(name, blocking.holderName).arg(blocking.holderPid);
+                } else if (blocking.state == Expired) {
+                    *errorMessage = QString("仓库被锁定（%1，%2 秒前创建），无法确认持有进程是否仍在运行；"
+                                            "确认没有其他 Git 程序在使用该仓库后可以解锁")
+                                        .arg(name).arg(blocking.ageMs / 1000);
+                } else {
+                    *errorMessage = QString("仓库被锁定（%1，%2 秒前创建），无法确认持有进程是否仍在运行；"
+                                            "超过 %3 秒仍未释放时可以解锁")
+                                        .arg(name).arg(blocking.ageMs / 1000).arg(kStaleLockAgeMs / 1000);
+                }
+            }
+            return false;
+        }
+
+        // 持有者存活：指数退避等待
+        QThread::msleep(backoffMs);
+        backoffMs = qMin(backoffMs * 2, 1000);
+    }
+}
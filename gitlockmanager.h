@@ -0,0 +1,54 @@
+#ifndef GITLOCKMANAGER_H
+#define GITLOCKMANAGER_H
+
+#include <QString>
+#include <QStringList>
+
+// Git 锁文件管理
+// 不再盲目删除 .git/index.lock：先确认是否有外部进程持有锁，
+// 持有者存活时按退避策略等待，只有证实为残留的锁才会被清理
+// - Linux：检查 /proc 中打开了锁文件句柄的进程（本程序自己的 git 子进程除外）
+// - 其他平台：无法检查句柄，按锁文件的年龄判断（较新的锁视为可能仍被持有）；
+//   年龄只能说明"很可能是残留"，这类锁不会自动删除，只在用户明确解锁时才删除
+class GitLockManager
+{
+public:
+    enum HolderState {
+        NoLock,         // 锁文件不存在
+        HeldByProcess,  // 有存活的进程打开着锁文件
+        Stale,          // 没有任何进程持有，属于异常中断留下的残留锁
+        Expired,        // 无法检查持有进程，锁文件已长时间未变化，很可能是残留
+        Unknown         // 无法判断（仓库中有存活的 git 进程，或无法检查持有进程且锁文件还很新）
+    };
+
+    struct LockStatus {
+        QString lockFile;
+        HolderState state = NoLock;
+        qint64 holderPid = 0;   // HeldByProcess 时为持有者；Unknown 时为在仓库中运行的 git 进程（如果有）
+        QString holderName;
+        qint64 ageMs = 0;
+    };
+
+    // 解析仓库的 .git 目录（兼容 worktree/submodule 中 .git 为文件的情况）
+    static QString gitDir(const QString &repoPath);
+
+    // 仓库当前存在的锁文件（index.lock、HEAD.lock、config.lock 等）
+    static QStringList existingLockFiles(const QString &repoPath);
+
+    // 判断锁文件的持有者
+    static LockStatus inspect(const QString &repoPath, const QString &lockFile);
+
+    // 等待仓库的锁释放：持有者存活时指数退避等待，证实为残留的锁直接清理
+    // 返回 false 表示超时后仍被锁定，或锁只能按年龄判断为残留（需要用户解锁），errorMessage 给出原因
+    static bool waitForRelease(const QString &repoPath, int maxWaitMs = 30000, QString *errorMessage = nullptr);
+
+    // 仅在证实为残留锁时删除，返回是否已删除
+    // includeExpired 为 true 时也删除按年龄判断的残留锁，只用于用户明确要求解锁
+    static bool removeIfStale(const QString &repoPath, const QString &lockFile, LockStatus *status = nullptr,
+                              bool includeExpired = false);
+
+private:
+    static HolderState findHolder(const QString &repoPath, const QString &lockFile, qint64 *pid, QString *name);
+};
+
+#endif // GITLOCKMANAGER_H
@@ -0,0 +1,144 @@
+#include "gitlogparser.h"
+#include "gittokenizer.h"
+#include <utility>
+
+namespace {
+
+constexpr char kRecordMark = '\x1e';
+constexpr char kFieldMark = '\x1f';
+
+} // namespace
+
+QStringList GitLogParser::formatArguments()
+{
+    return {"-z", "--raw", "--numstat", "--format=%x1e%H%x1f%P%x1f%an%x1f%ar%x1f%ci%x1f%s"};
+}
+
+void GitLogParser::feed(QByteArrayView chunk)
+{
+    m_buffer.append(chunk);
+    qsizetype end = m_buffer.lastIndexOf('\0');
+    if (end < 0) {
+        return;
+    }
+
+    // 只处理完整的记录，最后不完整的部分留到下一块
+    qsizetype start = 0;
+    QByteArrayView data(m_buffer);
+    while (start <= end) {
+        qsizetype next = GitTokenizer::indexOf(data, '\0', start);
+        parseToken(data.sliced(start, next - start));
+        start = next + 1;
+    }
+    m_buffer.remove(0, end + 1);
+}
+
+void GitLogParser::finish()
+{
+    if (!m_buffer.isEmpty()) {
+        parseToken(m_buffer);
+        m_buffer.clear();
+    }
+    completeCurrent();
+}
+
+QList<CommitEntry> GitLogParser::takeCommits()
+{
+    return std::exchange(m_commits, {});
+}
+
+void GitLogParser::parseToken(QByteArrayView token)
+{
+    // 文件列表与提交头部之间有一个换行
+    if (token.startsWith('\n')) {
+        token = token.sliced(1);
+    }
+
+    switch (m_expect) {
+    case Expect::RawPath:
+    case Expect::RawRenameTarget:
+        m_current.files.last().path = internRawGitPath(m_pathTable, token);
+        m_expect = Expect::Any;
+        return;
+    case Expect::RawRenameSource:
+        m_current.files.last().oldPath = internRawGitPath(m_pathTable, token);
+        m_expect = Expect::RawRenameTarget;
+        return;
+    case Expect::NumstatRenameSource:
+        m_expect = Expect::NumstatRenameTarget;
+        return;
+    case Expect::NumstatRenameTarget:
+        m_expect = Expect::Any;
+        return;
+    case Expect::Any:
+        break;
+    }
+
+    if (token.isEmpty()) {
+        return;
+    }
+    if (token.front() == kRecordMark) {
+        parseHeader(token.sliced(1));
+    } else if (token.front() == ':') {
+        // ":<旧模式> <新模式> <旧对象> <新对象> <状态>"，后面是路径（重命名和复制有两个路径）
+        if (!m_hasCurrent) return;
+        CommitFileEntry file;
+        qsizetype space = token.lastIndexOf(' ');
+        file.status = space >= 0 && space + 1 < token.size() ? token[space + 1] : 'M';
+        m_current.files.append(file);
+        m_expect = (file.status == 'R' || file.status == 'C') ? Expect::RawRenameSource : Expect::RawPath;
+    } else {
+        parseNumstat(token);
+    }
+}
+
+void GitLogParser::parseHeader(QByteArrayView header)
+{
+    completeCurrent();
+
+    auto fields = GitTokenizer::split<6>(header, kFieldMark);
+    if (fields.count < 6) return;
+
+    m_current = CommitEntry();
+    m_current.hash = GitTokenizer::toString(fields[0]);
+    // 父提交以空格分隔，根提交为空
+    if (!fields[1].isEmpty()) {
+        m_current.parents = GitTokenizer::toString(fields[1]).split(' ', Qt::SkipEmptyParts);
+    }
+    m_current.author = GitTokenizer::toString(fields[2]);
+    m_current.relativeDate = GitTokenizer::toString(fields[3]);
+    // "2025-01-16 14:30:00 +0800" -> "2025-01-16 14:30:00"
+    m_current.fullDate = GitTokenizer::toString(fields[4].first(qMin<qsizetype>(fields[4].size(), 19)));
+    m_current.message = GitTokenizer::toString(fields[5]);
+    m_numstatIndex = 0;
+    m_hasCurrent = true;
+}
+
+void GitLogParser::parseNumstat(QByteArrayView token)
+{
+    // "<增加>\t<删除>\t<路径>"；重命名时路径为空，后面跟两个路径记录；二进制文件为 "-"
+    auto fields = GitTokenizer::split<3>(token, '\t');
+    if (fields.count < 3 || !m_hasCurrent) return;
+
+    if (m_numstatIndex < m_current.files.size()) {
+        CommitFileEntry &file = m_current.files[m_numstatIndex];
+        file.additions = fields[0] == "-" ? -1 : int(GitTokenizer::toInt64(fields[0]));
+        file.deletions = fields[1] == "-" ? -1 : int(GitTokenizer::toInt64(fields[1]));
+    }
+    m_numstatIndex++;
+
+    if (fields[2].isEmpty()) {
+        m_expect = Expect::NumstatRenameSource;
+    }
+}
+
+void GitLogParser::completeCurrent()
+{
+    if (!m_hasCurrent) {
+        return;
+    }
+    m_commits.append(std::move(m_current));
+    m_current = CommitEntry();
+    m_hasCurrent = false;
+    m_expect = Expect::Any;
+}
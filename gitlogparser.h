@@ -0,0 +1,57 @@
+#ifndef GITLOGPARSER_H
+#define GITLOGPARSER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QStringList>
+#include "gitentries.h"
+
+// git log 输出的增量解析
+// 以前先运行 git log -30，再对每个提交各运行一次 git diff-tree --name-status（共 31 个进程），
+// 并按 '|' 拆分字段，提交信息中含 '|' 时会错位。
+// 现在只运行一次 git log -z --raw --numstat：
+// - 提交头部以 \x1e 开始，字段以 \x1f 分隔（不会出现在作者和单行提交信息中）
+// - --raw 给出每个文件的状态，--numstat 给出增删行数，两者顺序一致，按序号对应
+// - -z 输出的路径不加引号、不转义，以 NUL 结尾，任何文件名都能正确解析
+// 输出按块喂给 feed()，每个提交在下一个提交头部到达时完成，调用方可以边读边显示。
+class GitLogParser
+{
+public:
+    explicit GitLogParser(GitPathTable *pathTable) : m_pathTable(pathTable) {}
+
+    // git log 的格式参数（放在 log 之后，后面可以再加范围、数量等参数）
+    static QStringList formatArguments();
+
+    // 解析一块输出；完整的提交放入 takeCommits() 的结果
+    void feed(QByteArrayView chunk);
+    // 输出结束：最后一个提交也算完成
+    void finish();
+
+    bool hasCommits() const { return !m_commits.isEmpty(); }
+    QList<CommitEntry> takeCommits();
+
+private:
+    enum class Expect {
+        Any,
+        RawPath,
+        RawRenameSource,
+        RawRenameTarget,
+        NumstatRenameSource,
+        NumstatRenameTarget
+    };
+
+    void parseToken(QByteArrayView token);
+    void parseHeader(QByteArrayView header);
+    void parseNumstat(QByteArrayView token);
+    void completeCurrent();
+
+    GitPathTable *m_pathTable;
+    QByteArray m_buffer;
+    Expect m_expect = Expect::Any;
+    bool m_hasCurrent = false;
+    CommitEntry m_current;
+    qsizetype m_numstatIndex = 0;  // 下一条 numstat 对应的文件序号
+    QList<CommitEntry> m_commits;
+};
+
+#endif // GITLOGPARSER_H
@@ -1,26 +1,85 @@
 #include "gitmanager.h"
+#include "gitoperationqueue.h"
+#include "gitlockmanager.h"
+#include "gitprocess.h"
+#include "gitpathtable.h"
+#include "gittokenizer.h"
+#include "gitencoding.h"
+#include "gitremotetree.h"
+#include "gitdiffcache.h"
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
 #include <QTextStream>
-#include <QRegularExpression>
 #include <QDirIterator>
 #include <QCryptographicHash>
 #include <QCoreApplication>
 #include <QSettings>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QtConcurrent>
 #include <QFutureWatcher>
 #include <QDesktopServices>
 #include <QUrl>
+#include <QHash>
+#include <QPointer>
 #include <algorithm>
 
+// 流式刷新状态时向界面提交一批结果的间隔
+static constexpr int kStatusBatchMs = 50;
+
+// 在仓库写队列中执行 work（工作线程，与其他写操作串行），完成后在 GUI 线程中以结果调用 done
+template <typename Work, typename Done>
+void GitManager::runWrite(Work work, Done done)
+{
+    using Result = std::invoke_result_t<Work>;
+    QFuture<Result> future = operationQueue()->run(GitOperationQueue::Write, std::move(work));
+    QFutureWatcher<Result> *watcher = new QFutureWatcher<Result>(this);
+    connect(watcher, &QFutureWatcher<Result>::finished, this, [watcher, done = std::move(done)]() {
+        done(watcher->result());
+        watcher->deleteLater();
+    });
+    watcher->setFuture(future);
+}
+
 GitManager::GitManager(QObject *parent)
     : QObject(parent)
 {
     // Create file system watcher
     m_watcher = new QFileSystemWatcher(this);
     
+    // 本地目录浏览模型（异步列出目录）
+    m_repoFileModel = new RepoFileModel(this);
+    
+    // 任意版本的文件浏览（按对象 id 缓存树和文件内容）
+    m_revisionBrowser = new RevisionBrowserModel(this);
+    
+    // 提交历史（整个历史分页读取）；HEAD 提交变化时更新 lastCommit / lastCommitFiles
+    m_historyModel = new CommitHistoryModel(this);
+    connect(m_historyModel, &CommitHistoryModel::headChanged, this, &GitManager::commitHistoryChanged);
+    connect(m_historyModel, &CommitHistoryModel::errorOccurred, this, &GitManager::setError);
+    
+    // 单个文件的历史（设置 path 后读取，跟随重命名）
+    m_fileHistoryModel = new CommitHistoryModel(this);
+    connect(m_fileHistoryModel, &CommitHistoryModel::errorOccurred, this, &GitManager::setError);
+    
+    // 文件查看器的逐行追溯（打开追溯视图时才运行）
+    m_blameModel = new FileBlameModel(this);
+    
+    // 提交详情中的完整差异（按文件分段流式读取）
+    m_commitDiffModel = new CommitDiffModel(this);
+    
+    // 文件差异对话框（异步、按页解析）
+    m_diffModel = new DiffModel(this);
+    m_diffSplitModel = new SideBySideDiffModel(m_diffModel, this);
+    // 退出程序也算关闭仓库：写盘的差异缓存不留在磁盘上
+    connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, []() {
+        GitDiffCache::instance()->removeFiles();
+    });
+    
+    // 远程文件浏览自动 fetch 的有效期（秒）
+    m_remoteFetchTtl = QSettings("GitPushTool", "RemoteBrowser").value("fetchTtl", 300).toInt();
+    
     // Create debounce timer (minimal delay for batching rapid changes)
     m_refreshTimer = new QTimer(this);
     m_refreshTimer->setSingleShot(true);
@@ -92,41 +151,6 @@ GitManager::GitManager(QObject *parent)
         }
     });
     
-    // Create async process for long operations
-    m_asyncProcess = new QProcess(this);
-    connect(m_asyncProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, [this](int exitCode, QProcess::ExitStatus exitStatus) {
-        Q_UNUSED(exitStatus)
-        QString errorOutput = QString::fromUtf8(m_asyncProcess->readAllStandardError()).trimmed();
-        QString output = QString::fromUtf8(m_asyncProcess->readAllStandardOutput()).trimmed();
-        
-        setLoading(false);
-        
-        // Disable bulk operation mode after any async operation
-        if (m_bulkOperationMode) {
-            setBulkOperationMode(false);
-        }
-        
-        if (exitCode != 0) {
-            setError(m_asyncErrorPrefix + ": " + (errorOutput.isEmpty() ? output : errorOutput));
-        } else {
-            // Special handling for clone - set repo path after success
-            if (m_asyncSuccessMsg == "克隆成功" && !m_cloneTargetPath.isEmpty()) {
-                setRepoPath(m_cloneTargetPath);
-                m_cloneTargetPath.clear();
-            }
-            emit operationSuccess(m_asyncSuccessMsg);
-            
-            // Auto refresh remote files if it was a file operation
-            if (m_asyncSuccessMsg.contains("已保存并推送") || 
-                m_asyncSuccessMsg.contains("已删除") ||
-                m_asyncSuccessMsg.contains("已重命名")) {
-                emit remoteFilesNeedRefresh();
-            }
-        }
-        refresh();
-    });
-    
     // Load global git config on startup
     loadGlobalUserInfo();
     
@@ -175,6 +199,19 @@ void GitManager::setRepoPath(const QString &path)
     if (m_repoPath != cleanPath) {
         m_repoPath = cleanPath;
         emit repoPathChanged();
+        m_repoFileModel->setRepoPath(m_repoPath);
+        m_revisionBrowser->setRepoPath(m_repoPath);
+        m_historyModel->setRepoPath(m_repoPath);
+        m_fileHistoryModel->setRepoPath(m_repoPath);
+        m_blameModel->setRepoPath(m_repoPath);
+        m_commitDiffModel->setRepoPath(m_repoPath);
+        m_diffModel->setRepoPath(m_repoPath);
+        // 差异缓存中是上一个仓库的内容，连同写出的文件一起清除
+        QFuture<void> future = QtConcurrent::run([]() {
+            GitDiffCache::instance()->clear();
+        });
+        m_remoteTrackingRef.clear();
+        m_remoteTrackingHash.clear();
         
         // Setup file watcher for the new repo
         setupFileWatcher();
@@ -305,11 +342,10 @@ void GitManager::cleanupFileWatcherAsync()
         m_refreshTimer->stop();
     }
     
-    // 强制终止正在运行的异步进程
-    if (m_asyncProcess && m_asyncProcess->state() != QProcess::NotRunning) {
+    // 取消所有正在运行的可取消操作（工作线程会终止对应的 git 进程组）
+    if (!m_activeOperations.isEmpty()) {
         qDebug() << "Terminating running async process";
-        m_asyncProcess->kill();
-        m_asyncProcess->waitForFinished(500); // 最多等待500ms
+        cancelOperation();
     }
     
     // 异步清理所有监控路径
@@ -496,76 +532,92 @@ void GitManager::watchDirectory(const QString &path, int depth)
     }
 }
 
-QString GitManager::decodeOctalEscapes(const QString &input)
+QStringList GitManager::parseLocalBranches(QByteArrayView output)
 {
-    QString str = input;
-    
-    // Handle quoted paths with octal escapes for non-ASCII characters
-    if (str.startsWith('"') && str.endsWith('"')) {
-        str = str.mid(1, str.length() - 2);
-    }
-    
-    // Check if there are any octal escapes (backslash followed by digits)
-    QRegularExpression octalPattern("\\\\[0-7]{3}");
-    if (!octalPattern.match(str).hasMatch()) {
-        // No octal escapes, just handle simple escapes and return
-        str.replace("\\n", "\n");
-        str.replace("\\t", "\t");
-        str.replace("\\r", "\r");
-        str.replace("\\\"", "\"");
-        str.replace("\\\\", "\\");
-        return str;
-    }
-    
-    // Has octal escapes - need to decode byte by byte
-    QByteArray bytes;
-    for (int i = 0; i < str.length(); i++) {
-        if (str[i] == '\\' && i + 1 < str.length()) {
-            QChar next = str[i + 1];
-            
-            // Check for octal escape sequence (\xxx where x is 0-7)
-            if (next >= '0' && next <= '7' && i + 3 < str.length()) {
-                QString octalStr = str.mid(i + 1, 3);
-                bool validOctal = (octalStr.length() == 3);
-                for (int j = 0; j < octalStr.length() && validOctal; j++) {
-                    if (octalStr[j] < '0' || octalStr[j] > '7') validOctal = false;
-                }
-                if (validOctal) {
-                    bool ok;
-                    int value = octalStr.toInt(&ok, 8);
-                    if (ok) {
-                        bytes.append(static_cast<char>(value));
-                        i += 3;
-                        continue;
-                    }
-                }
-            }
-            
-            // Handle standard escape sequences
-            if (next == 'n') { bytes.append('\n'); i++; continue; }
-            if (next == 't') { bytes.append('\t'); i++; continue; }
-            if (next == 'r') { bytes.append('\r'); i++; continue; }
-            if (next == '"') { bytes.append('"'); i++; continue; }
-            if (next == '\\') { bytes.append('\\'); i++; continue; }
-            
-            // Unknown escape, keep the backslash and next char
-            bytes.append('\\');
-            bytes.append(next.toLatin1());
-            i++;
-            continue;
+    QStringList branches;
+    GitTokenizer::forEachLine(output, [&branches](QByteArrayView line) {
+        QByteArrayView branch = GitTokenizer::trimmed(line);
+        if (branch.startsWith("* ")) {
+            branch = branch.sliced(2);
         }
-        
-        // For ASCII characters, append directly
-        if (str[i].unicode() < 128) {
-            bytes.append(static_cast<char>(str[i].unicode()));
-        } else {
-            // Non-ASCII character that's not escaped - append its UTF-8 encoding
-            QByteArray utf8Char = QString(str[i]).toUtf8();
-            bytes.append(utf8Char);
+        if (!branch.isEmpty()) {
+            branches.append(GitTokenizer::toString(branch));
         }
-    }
-    
-    return QString::fromUtf8(bytes);
+    });
+    return branches;
+}
+
+QStringList GitManager::parseRemoteBranches(QByteArrayView output, const QStringList &localBranches)
+{
+    QStringList branches;
+    GitTokenizer::forEachLine(output, [&branches, &localBranches](QByteArrayView line) {
+        QByteArrayView branch = GitTokenizer::trimmed(line);
+        if (branch.isEmpty() || branch.contains("->")) {
+            return;
+        }
+        // Remove origin/ prefix for display
+        if (branch.startsWith("origin/")) {
+            branch = branch.sliced(7);
+        }
+        QString name = GitTokenizer::toString(branch);
+        if (!branches.contains(name) && !localBranches.contains(name)) {
+            branches.append(name);
+        }
+    });
+    return branches;
+}
+
+void GitManager::parseStatusOutput(QByteArrayView output, GitPathTable *pathTable, const QString &sizeRoot,
+                                   QList<StatusEntry> &changedFiles, QList<StatusEntry> &stagedFiles)
+{
+    // sizeRoot 为空时不读取文件大小（GUI 线程上的同步刷新）
+    auto fileSize = [&sizeRoot](const GitPathRef &path) -> qint64 {
+        if (sizeRoot.isEmpty()) {
+            return 0;
+        }
+        QFileInfo fileInfoObj(sizeRoot + "/" + path.toString());
+        return fileInfoObj.exists() ? fileInfoObj.size() : 0;
+    };
+
+    GitTokenizer::forEachLine(output, [&](QByteArrayView line) {
+        if (line.size() < 4) return;
+
+        const char indexStatus = line[0];
+        const char workTreeStatus = line[1];
+        QByteArrayView filePath = line.sliced(3);
+
+        // Handle renamed files (format: "R  old -> new")
+        qsizetype arrow = filePath.lastIndexOf(QByteArrayView(" -> "));
+        if (arrow >= 0) {
+            filePath = filePath.sliced(arrow + 4);
+        }
+        if (filePath.isEmpty()) return;
+
+        StatusEntry entry;
+        entry.path = internGitPath(pathTable, filePath);
+        if (indexStatus == 'A' || workTreeStatus == 'A') entry.status = StatusEntry::Added;
+        else if (indexStatus == 'M' || workTreeStatus == 'M') entry.status = StatusEntry::Modified;
+        else if (indexStatus == 'D' || workTreeStatus == 'D') entry.status = StatusEntry::Deleted;
+        else if (indexStatus == 'R') entry.status = StatusEntry::Renamed;
+        else if (indexStatus == '?' || workTreeStatus == '?') entry.status = StatusEntry::Untracked;
+        else entry.status = StatusEntry::Modified;
+
+        if (entry.status != StatusEntry::Deleted) {
+            entry.size = fileSize(entry.path);
+        }
+
+        // Staged files（暂存/未暂存两份引用同一个路径 id）
+        if (indexStatus != ' ' && indexStatus != '?') {
+            entry.staged = true;
+            stagedFiles.append(entry);
+        }
+
+        // Unstaged files
+        if (workTreeStatus != ' ') {
+            entry.staged = false;
+            changedFiles.append(entry);
+        }
+    });
 }
 
 QString GitManager::currentBranch() const
@@ -588,12 +640,12 @@ QStringList GitManager::remoteBranches() const
     return m_remoteBranches;
 }
 
-QVariantList GitManager::changedFiles() const
+QList<StatusEntry> GitManager::changedFiles() const
 {
     return m_changedFiles;
 }
 
-QVariantList GitManager::stagedFiles() const
+QList<StatusEntry> GitManager::stagedFiles() const
 {
     return m_stagedFiles;
 }
@@ -663,8 +715,8 @@ QString GitManager::translateGitError(const QString &error)
     else if (error.contains("refusing to merge unrelated histories") || error.contains("unrelated histories")) {
         translated = "推送失败：远程仓库有不相关的提交历史\n\n这通常发生在：\n1. 远程仓库初始化时添加了 README 或 LICENSE\n2. 本地仓库是独立初始化的\n\n解决方法：点击工具栏的「合并推送」按钮";
     }
-    else if (error.contains("index.lock") || error.contains("Another git process")) {
-        translated = "仓库被锁定：有其他 Git 操作正在进行或上次操作异常中断\n\n正在自动解锁...";
+    else if (error.contains("Another git process") || (error.contains("Unable to create") && error.contains(".lock'"))) {
+        translated = "仓库被锁定：有其他 Git 操作正在进行或上次操作异常中断\n\n正在检查锁的持有进程...";
     }
     
     // Merge conflicts
@@ -727,11 +779,35 @@ void GitManager::setError(const QString &error)
         emit operationFailed(translatedError);
     }
     
-    // 自动解锁：如果检测到锁定错误，自动尝试解锁
-    if (error.contains("index.lock") || error.contains("Another git process")) {
-        QTimer::singleShot(500, this, [this]() {
-            unlockRepository();
+    // 锁定错误：检查锁的持有进程，只清理已证实为残留的锁
+    // （只匹配 git 自身的报错文本，避免对下面给出的提示再次触发检查）
+    // 放在写队列中检查：本程序自己的写操作不会同时持有锁
+    if ((error.contains("Another git process") || (error.contains("Unable to create") && error.contains(".lock'")))
+        && !m_repoPath.isEmpty()) {
+        QString repoPath = m_repoPath;
+        QFuture<QString> future = GitOperationQueue::forRepo(repoPath)->run(GitOperationQueue::Write, [repoPath]() -> QString {
+            QString message;
+            // 持有者存活时按退避等待一段时间，等它完成后即可重试
+            if (GitLockManager::waitForRelease(repoPath, 10000, &message)) {
+                return QString();
+            }
+            return message;
+        }, -1);
+        
+        QFutureWatcher<QString> *watcher = new QFutureWatcher<QString>(this);
+        connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, repoPath]() {
+            QString message = watcher->result();
+            if (repoPath == m_repoPath) {
+                if (message.isEmpty()) {
+                    emit operationSuccess("仓库锁已释放，可以重试刚才的操作");
+                    refresh();
+                } else {
+                    setError(message);
+                }
+            }
+            watcher->deleteLater();
         });
+        watcher->setFuture(future);
     }
 }
 
@@ -741,34 +817,30 @@ QString GitManager::runGitCommand(const QStringList &args)
         return QString();
     }
 
-    QProcess process;
-    process.setWorkingDirectory(m_repoPath);
-    process.start("git", args);
-    process.waitForFinished(30000);
+    // 只用于 GUI 线程上的快速读操作；写操作一律通过 runWrite 放入写队列，不在 GUI 线程等待
+    if (GitOperationQueue::classify(args) == GitOperationQueue::Write) {
+        qWarning() << "runGitCommand refuses write command" << args.value(0);
+        return QString();
+    }
+
+    GitResult result = GitProcess(m_repoPath).run(args);
 
-    if (process.exitCode() != 0) {
-        QByteArray errorBytes = process.readAllStandardError();
-        // Try UTF-8 first, then local encoding
-        QString errorOutput = QString::fromUtf8(errorBytes);
-        if (errorOutput.contains(QChar::ReplacementCharacter)) {
-            errorOutput = QString::fromLocal8Bit(errorBytes);
-        }
-        errorOutput = errorOutput.trimmed();
+    if (result.stalled) {
+        // 看门狗终止了卡死的进程：明确报错，不能把空输出当成成功
+        setError(result.errorText());
+        return QString();
+    }
+
+    if (!result.ok()) {
+        QString errorOutput = result.errorText();
         if (!errorOutput.isEmpty()) {
             qDebug() << "Git error:" << errorOutput;
         }
         return QString();
     }
 
-    QByteArray rawOutput = process.readAllStandardOutput();
-    
-    // Try UTF-8 first
-    QString output = QString::fromUtf8(rawOutput);
-    
-    // If UTF-8 produces replacement characters, try local encoding (GBK on Chinese Windows)
-    if (output.contains(QChar::ReplacementCharacter)) {
-        output = QString::fromLocal8Bit(rawOutput);
-    }
+    // 一次识别编码（UTF-8 / GB18030 / 本地编码）后只解码一次
+    QString output = GitEncoding::decode(result.output);
     
     // Only remove trailing whitespace, not leading
     while (output.endsWith('\n') || output.endsWith('\r') || output.endsWith(' ')) {
@@ -791,13 +863,12 @@ void GitManager::refresh()
     // Run all git commands asynchronously
     QString repoPath = m_repoPath;
     
-    QFuture<void> future = QtConcurrent::run([this, repoPath]() {
+    QFuture<void> future = GitOperationQueue::forRepo(repoPath)->run(GitOperationQueue::Read, [this, repoPath]() {
         // Check if it's a valid git repo
-        QProcess process;
-        process.setWorkingDirectory(repoPath);
-        process.start("git", {"rev-parse", "--git-dir"});
-        process.waitForFinished(10000);
-        bool isValidRepo = (process.exitCode() == 0);
+        GitProcess process(repoPath);
+        GitResult result = process.run({"rev-parse", "--git-dir"}, 10000);
+        bool isValidRepo = result.ok();
+        QString stallError = result.stalled ? result.errorText() : QString();
         
         QString currentBranch;
         QString userName;
@@ -805,75 +876,64 @@ void GitManager::refresh()
         QStringList localBranches;
         QStringList remoteBranches;
         
+        // 某一步卡死时记录错误，界面上明确提示而不是显示空的分支列表
+        auto runStep = [&process, &stallError](const QStringList &args) {
+            GitResult stepResult = process.run(args, 10000);
+            if (stepResult.stalled && stallError.isEmpty()) {
+                stallError = stepResult.errorText();
+            }
+            return stepResult;
+        };
+        
         if (isValidRepo) {
             // Get current branch
-            process.start("git", {"branch", "--show-current"});
-            process.waitForFinished(10000);
-            if (process.exitCode() == 0) {
-                currentBranch = QString::fromUtf8(process.readAllStandardOutput()).trimmed();
+            result = runStep({"branch", "--show-current"});
+            if (result.ok()) {
+                currentBranch = result.outputText();
             }
             
             if (currentBranch.isEmpty()) {
-                process.start("git", {"rev-parse", "--short", "HEAD"});
-                process.waitForFinished(10000);
-                if (process.exitCode() == 0) {
-                    currentBranch = QString::fromUtf8(process.readAllStandardOutput()).trimmed();
+                result = runStep({"rev-parse", "--short", "HEAD"});
+                if (result.ok()) {
+                    currentBranch = result.outputText();
                 }
             }
             
             // Get user info
-            process.start("git", {"config", "user.name"});
-            process.waitForFinished(5000);
-            if (process.exitCode() == 0) {
-                userName = QString::fromUtf8(process.readAllStandardOutput()).trimmed();
+            result = runStep({"config", "user.name"});
+            if (result.ok()) {
+                userName = result.outputText();
             }
             
-            process.start("git", {"config", "user.email"});
-            process.waitForFinished(5000);
-            if (process.exitCode() == 0) {
-                userEmail = QString::fromUtf8(process.readAllStandardOutput()).trimmed();
+            result = runStep({"config", "user.email"});
+            if (result.ok()) {
+                userEmail = result.outputText();
             }
             
             // Get local branches
-            process.start("git", {"branch"});
-            process.waitForFinished(10000);
-            if (process.exitCode() == 0) {
-                QString localOutput = QString::fromUtf8(process.readAllStandardOutput());
-                QStringList localLines = localOutput.split('\n', Qt::SkipEmptyParts);
-                for (const QString &line : localLines) {
-                    QString branch = line.trimmed();
-                    if (branch.startsWith("* ")) {
-                        branch = branch.mid(2);
-                    }
-                    if (!branch.isEmpty()) {
-                        localBranches.append(branch);
-                    }
-                }
+            result = runStep({"branch"});
+            if (result.ok()) {
+                localBranches = parseLocalBranches(result.output);
             }
             
             // Get remote branches
-            process.start("git", {"branch", "-r"});
-            process.waitForFinished(10000);
-            if (process.exitCode() == 0) {
-                QString remoteOutput = QString::fromUtf8(process.readAllStandardOutput());
-                QStringList remoteLines = remoteOutput.split('\n', Qt::SkipEmptyParts);
-                for (const QString &line : remoteLines) {
-                    QString branch = line.trimmed();
-                    if (!branch.contains("->") && !branch.isEmpty()) {
-                        // Remove origin/ prefix for display
-                        if (branch.startsWith("origin/")) {
-                            branch = branch.mid(7);
-                        }
-                        if (!remoteBranches.contains(branch) && !localBranches.contains(branch)) {
-                            remoteBranches.append(branch);
-                        }
-                    }
-                }
+            result = runStep({"branch", "-r"});
+            if (result.ok()) {
+                remoteBranches = parseRemoteBranches(result.output, localBranches);
             }
         }
         
         // Update UI in main thread
-        QMetaObject::invokeMethod(this, [this, isValidRepo, currentBranch, userName, userEmail, localBranches, remoteBranches]() {
+        QMetaObject::invokeMethod(this, [this, isValidRepo, currentBranch, userName, userEmail, localBranches, remoteBranches, stallError]() {
+            if (!stallError.isEmpty()) {
+                setError(stallError);
+            }
+            if (!isValidRepo && !stallError.isEmpty()) {
+                // git 卡死不代表不是仓库，保持原状态
+                setLoading(false);
+                return;
+            }
+            
             m_isValidRepo = isValidRepo;
             emit isValidRepoChanged();
             
@@ -919,38 +979,23 @@ void GitManager::refresh()
 
 void GitManager::updateBranches()
 {
-    // Get local branches
-    QString localOutput = runGitCommand({"branch"});
-    m_localBranches.clear();
+    GitProcess process(m_repoPath);
     
-    QStringList localLines = localOutput.split('\n', Qt::SkipEmptyParts);
-    for (const QString &line : localLines) {
-        QString branch = line.trimmed();
-        if (branch.startsWith("* ")) {
-            branch = branch.mid(2);
-        }
-        if (!branch.isEmpty()) {
-            m_localBranches.append(branch);
-        }
+    // Get local branches
+    GitResult result = process.run({"branch"});
+    if (result.stalled) {
+        // 保留原有的分支列表
+        setError(result.errorText());
+        return;
     }
+    m_localBranches = result.ok() ? parseLocalBranches(result.output) : QStringList();
     
     // Get remote branches
-    QString remoteOutput = runGitCommand({"branch", "-r"});
-    m_remoteBranches.clear();
-    
-    QStringList remoteLines = remoteOutput.split('\n', Qt::SkipEmptyParts);
-    for (const QString &line : remoteLines) {
-        QString branch = line.trimmed();
-        if (!branch.contains("->") && !branch.isEmpty()) {
-            // Remove origin/ prefix for display
-            if (branch.startsWith("origin/")) {
-                branch = branch.mid(7);
-            }
-            if (!m_remoteBranches.contains(branch) && !m_localBranches.contains(branch)) {
-                m_remoteBranches.append(branch);
-            }
-        }
+    result = process.run({"branch", "-r"});
+    if (result.stalled) {
+        setError(result.errorText());
     }
+    m_remoteBranches = result.ok() ? parseRemoteBranches(result.output, m_localBranches) : QStringList();
     
     // Combined list (local first, then remote-only)
     m_branches = m_localBranches + m_remoteBranches;
@@ -960,126 +1005,43 @@ void GitManager::updateBranches()
 
 void GitManager::parseStatus()
 {
-    // Set core.quotepath to false to show Chinese paths without escaping
-    QProcess configProcess;
-    configProcess.setWorkingDirectory(m_repoPath);
-    configProcess.start("git", {"config", "core.quotepath", "false"});
-    configProcess.waitForFinished(5000);
+    // 同步结果优先于仍在运行的异步刷新
+    ++m_statusGeneration;
     
-    QProcess process;
-    process.setWorkingDirectory(m_repoPath);
-    process.start("git", {"status", "--porcelain=v1", "-uall"});
-    process.waitForFinished(30000);
+    // Pass core.quotepath=false per command to show Chinese paths without escaping
+    // (writing it into .git/config would make every status refresh a write operation)
+    GitProcess process(m_repoPath);
+    GitResult result = process.run({"-c", "core.quotepath=false", "status", "--porcelain=v1", "-uall"});
+    if (result.stalled) {
+        // 保留上一次的列表，不把卡死当成"没有改动"
+        setError(result.errorText());
+        return;
+    }
     
-    QByteArray rawOutput = process.readAllStandardOutput();
+    GitPathTable *pathTable = GitPathTable::forRepo(m_repoPath);
     
     m_changedFiles.clear();
     m_stagedFiles.clear();
 
     // If git status returns empty, try to find untracked files manually
-    if (rawOutput.isEmpty() || rawOutput.trimmed().isEmpty()) {
+    if (GitTokenizer::trimmed(result.output).isEmpty()) {
         // Use git ls-files to find untracked files
-        process.start("git", {"ls-files", "--others", "--exclude-standard"});
-        process.waitForFinished(30000);
-        QByteArray untrackedOutput = process.readAllStandardOutput();
-        
-        if (!untrackedOutput.isEmpty()) {
-            // Try UTF-8 first, then local encoding
-            QString untrackedStr = QString::fromUtf8(untrackedOutput);
-            if (untrackedStr.contains(QChar::ReplacementCharacter)) {
-                untrackedStr = QString::fromLocal8Bit(untrackedOutput);
-            }
-            QStringList untrackedFiles = untrackedStr.split('\n', Qt::SkipEmptyParts);
-            
-            for (const QString &filePath : untrackedFiles) {
-                if (filePath.isEmpty()) continue;
-                
-                QString fileName = filePath;
-                if (filePath.contains('/')) {
-                    fileName = filePath.section('/', -1);
-                }
-                
-                QVariantMap fileInfo;
-                fileInfo["path"] = filePath;
-                fileInfo["name"] = fileName;
-                fileInfo["status"] = "added";
-                fileInfo["staged"] = false;
-                m_changedFiles.append(fileInfo);
-            }
-        }
-        
-        emit changedFilesChanged();
-        emit stagedFilesChanged();
-        return;
-    }
-
-    // Try UTF-8 first, then local encoding (GBK on Chinese Windows)
-    QString statusOutput = QString::fromUtf8(rawOutput);
-    if (statusOutput.contains(QChar::ReplacementCharacter)) {
-        statusOutput = QString::fromLocal8Bit(rawOutput);
-    }
-    
-    QStringList lines = statusOutput.split('\n', Qt::SkipEmptyParts);
-    
-    for (int i = 0; i < lines.size(); i++) {
-        QString line = lines[i];
-        
-        if (line.length() < 4) continue;
-        
-        QChar indexStatus = line[0];
-        QChar workTreeStatus = line[1];
-        QString filePath = line.mid(3);
-        
-        // Handle quoted paths with octal escapes (for paths Git still escapes)
-        if (filePath.startsWith('"') && filePath.endsWith('"')) {
-            filePath = decodeOctalEscapes(filePath);
-        }
-
-        // Handle renamed files: "old -> new"
-        if (filePath.contains(" -> ")) {
-            filePath = filePath.split(" -> ").last();
-        }
-
-        if (filePath.isEmpty()) continue;
-
-        // Extract filename from path
-        QString fileName = filePath;
-        if (filePath.contains('/')) {
-            fileName = filePath.section('/', -1);
-        }
-
-        QVariantMap fileInfo;
-        fileInfo["path"] = filePath;
-        fileInfo["name"] = fileName;
-
-        // Determine status type
-        QString statusType;
-        if (indexStatus == 'A' || workTreeStatus == '?') {
-            statusType = "added";
-        } else if (indexStatus == 'D' || workTreeStatus == 'D') {
-            statusType = "deleted";
-        } else if (indexStatus == 'R') {
-            statusType = "renamed";
-        } else {
-            statusType = "modified";
-        }
-        fileInfo["status"] = statusType;
-
-        // Staged files
-        if (indexStatus != ' ' && indexStatus != '?') {
-            QVariantMap stagedInfo = fileInfo;
-            stagedInfo["staged"] = true;
-            m_stagedFiles.append(stagedInfo);
-        }
-
-        // Unstaged files
-        if (workTreeStatus != ' ') {
-            QVariantMap unstagedInfo = fileInfo;
-            unstagedInfo["staged"] = false;
-            m_changedFiles.append(unstagedInfo);
-        }
+        result = process.run({"ls-files", "--others", "--exclude-standard"});
+        if (result.stalled) {
+            setError(result.errorText());
+        }
+        GitTokenizer::forEachLine(result.output, [this, pathTable](QByteArrayView filePath) {
+            StatusEntry entry;
+            entry.path = internGitPath(pathTable, filePath);
+            entry.status = StatusEntry::Added;
+            m_changedFiles.append(entry);
+        });
+    } else {
+        // 同步刷新在 GUI 线程上执行，不逐个读取文件大小
+        parseStatusOutput(result.output, pathTable, QString(), m_changedFiles, m_stagedFiles);
     }
 
+    m_repoFileModel->setStatusEntries(m_changedFiles, m_stagedFiles);
     emit changedFilesChanged();
     emit stagedFilesChanged();
 }
@@ -1087,160 +1049,122 @@ void GitManager::parseStatus()
 void GitManager::parseStatusAsync(bool showLoading)
 {
     QString repoPath = m_repoPath;
+    // 较早发起、较晚返回的刷新不能覆盖新的结果
+    const int generation = ++m_statusGeneration;
     
     if (showLoading) {
+        // 不再用固定的 8 秒强制结束加载状态：看门狗保证 git 卡死时会被终止并报错
         setLoading(true);
-        // Add timeout protection only when showing loading
-        QTimer::singleShot(8000, this, [this]() {
-            if (m_isLoading) {
-                qDebug() << "parseStatusAsync timeout, forcing setLoading(false)";
-                setLoading(false);
-            }
-        });
     }
     
-    QFuture<void> future = QtConcurrent::run([this, repoPath, showLoading]() {
-        // Set core.quotepath to false to show Chinese paths without escaping
-        QProcess configProcess;
-        configProcess.setWorkingDirectory(repoPath);
-        configProcess.start("git", {"config", "core.quotepath", "false"});
-        configProcess.waitForFinished(3000); // 减少等待时间
+    QFuture<void> future = GitOperationQueue::forRepo(repoPath)->run(GitOperationQueue::Read, [this, repoPath, showLoading, generation]() {
+        GitPathTable *pathTable = GitPathTable::forRepo(repoPath);
+        
+        // 当前批次；后台静默刷新不分批，结束时一次性替换，避免列表在刷新过程中先变短再变长
+        QList<StatusEntry> changedFiles;
+        QList<StatusEntry> stagedFiles;
+        bool firstBatch = true;
+        qsizetype entryCount = 0;
+        QElapsedTimer parseTimer;
+        parseTimer.start();
+        qint64 firstBatchMs = -1;
+        QElapsedTimer batchTimer;
+        batchTimer.start();
         
-        QProcess process;
-        process.setWorkingDirectory(repoPath);
-        process.start("git", {"status", "--porcelain=v1", "-uall"});
-        process.waitForFinished(15000); // 减少等待时间，提高响应速度
+        auto publish = [&](bool last) {
+            if (firstBatchMs < 0) {
+                firstBatchMs = parseTimer.elapsed();
+            }
+            entryCount += changedFiles.size() + stagedFiles.size();
+            QMetaObject::invokeMethod(this, [this, generation, changedFiles, stagedFiles, reset = firstBatch, last, showLoading]() {
+                applyStatusBatch(generation, changedFiles, stagedFiles, reset, last, showLoading);
+            }, Qt::QueuedConnection);
+            changedFiles.clear();
+            stagedFiles.clear();
+            firstBatch = false;
+            batchTimer.restart();
+        };
         
-        QByteArray rawOutput = process.readAllStandardOutput();
+        // 边运行边解析：只保留最后一行不完整的数据，完整的行立即解析，每 ~50ms 把新条目送到界面
+        QByteArray pending;
+        GitProcess process(repoPath);
+        process.setOutputHandler([&](const QByteArray &chunk) {
+            pending += chunk;
+            qsizetype end = pending.lastIndexOf('\n');
+            if (end < 0) return;
+            parseStatusOutput(QByteArrayView(pending).first(end + 1), pathTable, repoPath, changedFiles, stagedFiles);
+            pending.remove(0, end + 1);
+            if (showLoading && batchTimer.elapsed() >= kStatusBatchMs && (!changedFiles.isEmpty() || !stagedFiles.isEmpty())) {
+                publish(false);
+            }
+        });
+        
+        // Pass core.quotepath=false per command to show Chinese paths without escaping
+        GitResult result = process.run({"-c", "core.quotepath=false", "status", "--porcelain=v1", "-uall"});
+        if (result.stalled) {
+            // 未分批时保留上一次的列表，不把卡死当成"没有改动"
+            QString error = result.errorText();
+            QMetaObject::invokeMethod(this, [this, error, showLoading]() {
+                setError(error);
+                if (showLoading) {
+                    setLoading(false);
+                }
+            }, Qt::QueuedConnection);
+            return;
+        }
+        parseStatusOutput(pending, pathTable, repoPath, changedFiles, stagedFiles);
         
-        QVariantList changedFiles;
-        QVariantList stagedFiles;
-
         // If git status returns empty, try to find untracked files manually
-        if (rawOutput.isEmpty() || rawOutput.trimmed().isEmpty()) {
+        if (firstBatch && changedFiles.isEmpty() && stagedFiles.isEmpty()) {
             // Use git ls-files to find untracked files
-            process.start("git", {"ls-files", "--others", "--exclude-standard"});
-            process.waitForFinished(30000);
-            QByteArray untrackedOutput = process.readAllStandardOutput();
-            
-            if (!untrackedOutput.isEmpty()) {
-                // Try UTF-8 first, then local encoding
-                QString untrackedStr = QString::fromUtf8(untrackedOutput);
-                if (untrackedStr.contains(QChar::ReplacementCharacter)) {
-                    untrackedStr = QString::fromLocal8Bit(untrackedOutput);
-                }
-                QStringList untrackedFiles = untrackedStr.split('\n', Qt::SkipEmptyParts);
-                
-                for (const QString &filePath : untrackedFiles) {
-                    if (filePath.isEmpty()) continue;
-                    
-                    QString fileName = filePath;
-                    if (filePath.contains('/')) {
-                        fileName = filePath.section('/', -1);
-                    }
-                    
-                    QVariantMap fileInfo;
-                    fileInfo["path"] = filePath;
-                    fileInfo["name"] = fileName;
-                    fileInfo["status"] = "added";
-                    fileInfo["staged"] = false;
-                    
-                    // Add file size
-                    QFileInfo fileInfoObj(repoPath + "/" + filePath);
-                    if (fileInfoObj.exists()) {
-                        qint64 size = fileInfoObj.size();
-                        fileInfo["size"] = size;
-                        fileInfo["sizeStr"] = formatFileSize(size);
-                    } else {
-                        fileInfo["size"] = 0;
-                        fileInfo["sizeStr"] = "0 B";
-                    }
-                    
-                    changedFiles.append(fileInfo);
-                }
-            }
-        } else {
-            // Try UTF-8 first, then local encoding
-            QString output = QString::fromUtf8(rawOutput);
-            if (output.contains(QChar::ReplacementCharacter)) {
-                output = QString::fromLocal8Bit(rawOutput);
-            }
+            QByteArray untrackedOutput = GitProcess(repoPath).run({"ls-files", "--others", "--exclude-standard"}).output;
             
-            QStringList lines = output.split('\n', Qt::SkipEmptyParts);
-            
-            for (const QString &line : lines) {
-                if (line.length() < 3) continue;
-                
-                char indexStatus = line[0].toLatin1();
-                char workTreeStatus = line[1].toLatin1();
-                QString filePath = line.mid(3);
-                
-                // Handle renamed files (format: "R  old -> new")
-                if (filePath.contains(" -> ")) {
-                    filePath = filePath.section(" -> ", -1);
-                }
-                
-                // Decode octal escapes for Chinese file names
-                filePath = decodeOctalEscapes(filePath);
-                
-                QString fileName = filePath;
-                if (filePath.contains('/')) {
-                    fileName = filePath.section('/', -1);
-                }
-                
-                QString status;
-                if (indexStatus == 'A' || workTreeStatus == 'A') status = "added";
-                else if (indexStatus == 'M' || workTreeStatus == 'M') status = "modified";
-                else if (indexStatus == 'D' || workTreeStatus == 'D') status = "deleted";
-                else if (indexStatus == 'R') status = "renamed";
-                else if (indexStatus == '?' || workTreeStatus == '?') status = "untracked";
-                else status = "modified";
-                
-                QVariantMap fileInfo;
-                fileInfo["path"] = filePath;
-                fileInfo["name"] = fileName;
-                fileInfo["status"] = status;
+            changedFiles.reserve(GitTokenizer::count(untrackedOutput, '\n'));
+            GitTokenizer::forEachLine(untrackedOutput, [&changedFiles, pathTable, &repoPath](QByteArrayView filePath) {
+                StatusEntry entry;
+                entry.path = internGitPath(pathTable, filePath);
+                entry.status = StatusEntry::Added;
                 
                 // Add file size
-                QFileInfo fileInfoObj(repoPath + "/" + filePath);
-                if (fileInfoObj.exists() && status != "deleted") {
-                    qint64 size = fileInfoObj.size();
-                    fileInfo["size"] = size;
-                    fileInfo["sizeStr"] = formatFileSize(size);
-                } else {
-                    fileInfo["size"] = 0;
-                    fileInfo["sizeStr"] = status == "deleted" ? "已删除" : "0 B";
-                }
-                
-                // Staged files
-                if (indexStatus != ' ' && indexStatus != '?') {
-                    QVariantMap stagedInfo = fileInfo;
-                    stagedInfo["staged"] = true;
-                    stagedFiles.append(stagedInfo);
+                QFileInfo fileInfoObj(repoPath + "/" + entry.path.toString());
+                if (fileInfoObj.exists()) {
+                    entry.size = fileInfoObj.size();
                 }
                 
-                // Unstaged files
-                if (workTreeStatus != ' ') {
-                    QVariantMap unstagedInfo = fileInfo;
-                    unstagedInfo["staged"] = false;
-                    changedFiles.append(unstagedInfo);
-                }
-            }
+                changedFiles.append(entry);
+            });
         }
         
-        // Update the lists in the main thread
-        QMetaObject::invokeMethod(this, [this, changedFiles, stagedFiles, showLoading]() {
-            m_changedFiles = changedFiles;
-            m_stagedFiles = stagedFiles;
-            emit changedFilesChanged();
-            emit stagedFilesChanged();
-            if (showLoading) {
-                setLoading(false);
-            }
-        }, Qt::QueuedConnection);
+        publish(true);
+        
+        qDebug() << "Status:" << entryCount << "entries in" << parseTimer.elapsed() << "ms (first batch after"
+                 << firstBatchMs << "ms), path table" << pathTable->count()
+                 << "paths /" << pathTable->memoryUsage() / 1024 << "KB";
     });
 }
 
+void GitManager::applyStatusBatch(int generation, const QList<StatusEntry> &changedFiles,
+                                  const QList<StatusEntry> &stagedFiles, bool reset, bool last, bool showLoading)
+{
+    if (last && showLoading) {
+        setLoading(false);
+    }
+    if (generation != m_statusGeneration) {
+        return;
+    }
+    
+    if (reset) {
+        m_changedFiles = changedFiles;
+        m_stagedFiles = stagedFiles;
+    } else {
+        m_changedFiles += changedFiles;
+        m_stagedFiles += stagedFiles;
+    }
+    m_repoFileModel->setStatusEntries(m_changedFiles, m_stagedFiles);
+    emit changedFilesChanged();
+    emit stagedFilesChanged();
+}
+
 void GitManager::stageFile(const QString &filePath)
 {
     if (m_repoPath.isEmpty() || filePath.isEmpty()) return;
@@ -1251,26 +1175,22 @@ void GitManager::stageFile(const QString &filePath)
     QString fullPath = repoPath + "/" + filePath;
     bool fileExists = QFileInfo(fullPath).exists();
     
-    QFuture<QPair<bool, QString>> future = QtConcurrent::run([repoPath, filePath, fileExists]() -> QPair<bool, QString> {
-        QProcess process;
-        process.setWorkingDirectory(repoPath);
+    QFuture<QPair<bool, QString>> future = GitOperationQueue::forRepo(repoPath)->run(GitOperationQueue::Write, [repoPath, filePath, fileExists]() -> QPair<bool, QString> {
+        GitProcess process(repoPath);
+        GitResult result;
         
         if (fileExists) {
-            process.start("git", {"add", "--", filePath});
-            process.waitForFinished(60000);
+            result = process.run({"add", "--", filePath});
         } else {
-            process.start("git", {"add", "-u", "--", filePath});
-            process.waitForFinished(60000);
+            result = process.run({"add", "-u", "--", filePath});
             
-            if (process.exitCode() != 0) {
-                process.start("git", {"rm", "--", filePath});
-                process.waitForFinished(60000);
+            if (!result.ok() && !result.stalled) {
+                result = process.run({"rm", "--", filePath});
             }
         }
         
-        if (process.exitCode() != 0) {
-            QString err = QString::fromUtf8(process.readAllStandardError()).trimmed();
-            return qMakePair(false, err);
+        if (!result.ok()) {
+            return qMakePair(false, result.errorText());
         }
         return qMakePair(true, QString());
     });
@@ -1297,28 +1217,30 @@ void GitManager::stageFiles(const QStringList &filePaths)
     setLoading(true);
     
     QString repoPath = m_repoPath;
+    std::shared_ptr<GitCancelToken> token = beginOperation("暂存文件");
     
-    QFuture<QPair<bool, QString>> future = QtConcurrent::run([repoPath, filePaths]() -> QPair<bool, QString> {
-        QProcess process;
-        process.setWorkingDirectory(repoPath);
+    QFuture<QPair<bool, QString>> future = GitOperationQueue::forRepo(repoPath)->run(GitOperationQueue::Write, [repoPath, filePaths, token]() -> QPair<bool, QString> {
+        // git add 先写 index.lock 再整体替换 index，中途终止时 index 保持不变
+        GitProcess process(repoPath, token);
         
         QStringList args = {"add", "--"};
         args.append(filePaths);
         
-        process.start("git", args);
-        process.waitForFinished(120000);
-        
-        if (process.exitCode() != 0) {
-            QString err = QString::fromUtf8(process.readAllStandardError()).trimmed();
-            return qMakePair(false, err);
+        GitResult result = process.run(args, 120000);
+        if (!result.ok()) {
+            return qMakePair(false, result.errorText());
         }
         return qMakePair(true, QString());
     });
     
     QFutureWatcher<QPair<bool, QString>> *watcher = new QFutureWatcher<QPair<bool, QString>>(this);
-    connect(watcher, &QFutureWatcher<QPair<bool, QString>>::finished, this, [this, watcher, filePaths]() {
+    connect(watcher, &QFutureWatcher<QPair<bool, QString>>::finished, this, [this, watcher, filePaths, token]() {
         auto result = watcher->result();
-        if (result.first) {
+        endOperation(token);
+        if (token->isCancelled()) {
+            refresh();
+            emit operationSuccess("已取消暂存操作");
+        } else if (result.first) {
             refresh();
             emit operationSuccess("已暂存 " + QString::number(filePaths.size()) + " 个文件");
         } else {
@@ -1338,17 +1260,19 @@ void GitManager::unstageFile(const QString &filePath)
     
     QString repoPath = m_repoPath;
     
-    QFuture<void> future = QtConcurrent::run([repoPath, filePath]() {
-        QProcess process;
-        process.setWorkingDirectory(repoPath);
-        process.start("git", {"reset", "HEAD", "--", filePath});
-        process.waitForFinished(60000);
+    QFuture<GitResult> future = GitOperationQueue::forRepo(repoPath)->run(GitOperationQueue::Write, [repoPath, filePath]() {
+        return GitProcess(repoPath).run({"reset", "HEAD", "--", filePath});
     });
     
-    QFutureWatcher<void> *watcher = new QFutureWatcher<void>(this);
-    connect(watcher, &QFutureWatcher<void>::finished, this, [this, watcher, filePath]() {
+    QFutureWatcher<GitResult> *watcher = new QFutureWatcher<GitResult>(this);
+    connect(watcher, &QFutureWatcher<GitResult>::finished, this, [this, watcher, filePath]() {
+        GitResult result = watcher->result();
         refresh();
-        emit operationSuccess("已取消暂存: " + filePath);
+        if (result.stalled) {
+            setError("取消暂存失败: " + result.errorText());
+        } else {
+            emit operationSuccess("已取消暂存: " + filePath);
+        }
         watcher->deleteLater();
     });
     watcher->setFuture(future);
@@ -1362,21 +1286,22 @@ void GitManager::unstageFiles(const QStringList &filePaths)
     
     QString repoPath = m_repoPath;
     
-    QFuture<void> future = QtConcurrent::run([repoPath, filePaths]() {
-        QProcess process;
-        process.setWorkingDirectory(repoPath);
-        
+    QFuture<GitResult> future = GitOperationQueue::forRepo(repoPath)->run(GitOperationQueue::Write, [repoPath, filePaths]() {
         QStringList args = {"reset", "HEAD", "--"};
         args.append(filePaths);
         
-        process.start("git", args);
-        process.waitForFinished(120000);
+        return GitProcess(repoPath).run(args);
     });
     
-    QFutureWatcher<void> *watcher = new QFutureWatcher<void>(this);
-    connect(watcher, &QFutureWatcher<void>::finished, this, [this, watcher, filePaths]() {
+    QFutureWatcher<GitResult> *watcher = new QFutureWatcher<GitResult>(this);
+    connect(watcher, &QFutureWatcher<GitResult>::finished, this, [this, watcher, filePaths]() {
+        GitResult result = watcher->result();
         refresh();
-        emit operationSuccess("已取消暂存 " + QString::number(filePaths.size()) + " 个文件");
+        if (result.stalled) {
+            setError("取消暂存失败: " + result.errorText());
+        } else {
+            emit operationSuccess("已取消暂存 " + QString::number(filePaths.size()) + " 个文件");
+        }
         watcher->deleteLater();
     });
     watcher->setFuture(future);
@@ -1389,25 +1314,27 @@ void GitManager::stageAll()
     setLoading(true);
     
     QString repoPath = m_repoPath;
+    std::shared_ptr<GitCancelToken> token = beginOperation("暂存所有文件");
     
-    QFuture<QPair<bool, QString>> future = QtConcurrent::run([repoPath]() -> QPair<bool, QString> {
-        QProcess process;
-        process.setWorkingDirectory(repoPath);
-        process.start("git", {"add", "-A"});
-        process.waitForFinished(120000);
+    QFuture<QPair<bool, QString>> future = GitOperationQueue::forRepo(repoPath)->run(GitOperationQueue::Write, [repoPath, token]() -> QPair<bool, QString> {
+        GitProcess process(repoPath, token);
+        GitResult result = process.run({"add", "-A"}, 120000);
         
-        if (process.exitCode() != 0) {
-            QString err = QString::fromUtf8(process.readAllStandardError()).trimmed();
-            return qMakePair(false, err);
+        if (!result.ok()) {
+            return qMakePair(false, result.errorText());
         }
         return qMakePair(true, QString());
     });
     
     QFutureWatcher<QPair<bool, QString>> *watcher = new QFutureWatcher<QPair<bool, QString>>(this);
-    connect(watcher, &QFutureWatcher<QPair<bool, QString>>::finished, this, [this, watcher]() {
+    connect(watcher, &QFutureWatcher<QPair<bool, QString>>::finished, this, [this, watcher, token]() {
         auto result = watcher->result();
+        endOperation(token);
         setBulkOperationMode(false);
-        if (result.first) {
+        if (token->isCancelled()) {
+            refresh();
+            emit operationSuccess("已取消暂存操作");
+        } else if (result.first) {
             refresh();
             emit operationSuccess("已暂存所有文件");
         } else {
@@ -1437,13 +1364,10 @@ void GitManager::unstageAll()
     
     // For new repositories without commits, use 'git rm --cached .' instead of 'git reset HEAD'
     // First check if HEAD exists by checking if there are any commits
-    QProcess checkProcess;
-    checkProcess.setWorkingDirectory(m_repoPath);
-    checkProcess.start("git", {"rev-parse", "--verify", "HEAD"});
-    checkProcess.waitForFinished(5000);
+    GitResult headCheck = GitProcess(m_repoPath).run({"rev-parse", "--verify", "HEAD"}, 5000);
     
     QStringList args;
-    if (checkProcess.exitCode() == 0) {
+    if (headCheck.ok()) {
         // HEAD exists, use normal reset
         args = {"reset", "HEAD"};
     } else {
@@ -1451,19 +1375,15 @@ void GitManager::unstageAll()
         args = {"rm", "--cached", "-r", "."};
     }
     
-    // Use async process for better control
-    if (m_asyncProcess->state() != QProcess::NotRunning) {
+    // Use async command for better control
+    if (m_asyncBusy) {
         setLoading(false);
         setBulkOperationMode(false);
         setError("有操作正在进行中，请稍候");
         return;
     }
     
-    m_asyncSuccessMsg = "已取消暂存所有文件";
-    m_asyncErrorPrefix = "取消暂存失败";
-    
-    m_asyncProcess->setWorkingDirectory(m_repoPath);
-    m_asyncProcess->start("git", args);
+    runAsyncGitCommand(args, "已取消暂存所有文件", "取消暂存失败");
 }
 
 void GitManager::commit(const QString &message)
@@ -1481,41 +1401,44 @@ void GitManager::commit(const QString &message)
 
     setLoading(true);
     
-    QProcess process;
-    process.setWorkingDirectory(m_repoPath);
+    QString repoPath = m_repoPath;
     
     // Commit only the staged files
-    process.start("git", {"commit", "-m", message});
-    process.waitForFinished(30000);
-    
-    QString errorOutput = QString::fromUtf8(process.readAllStandardError()).trimmed();
-    QString output = QString::fromUtf8(process.readAllStandardOutput()).trimmed();
-    
-    qDebug() << "Commit exitCode:" << process.exitCode();
-    qDebug() << "Commit stdout:" << output;
-    qDebug() << "Commit stderr:" << errorOutput;
-    
-    int exitCode = process.exitCode();
-    
-    if (exitCode != 0) {
-        setLoading(false);
-        // Check for common errors
-        if (errorOutput.contains("user.email") || errorOutput.contains("user.name") ||
-            errorOutput.contains("Please tell me who you are")) {
-            setError("请先配置 Git 用户信息:\ngit config user.name \"你的名字\"\ngit config user.email \"你的邮箱\"");
-        } else if (errorOutput.contains("nothing to commit") || output.contains("nothing to commit")) {
-            setError("没有需要提交的更改");
-        } else if (errorOutput.isEmpty() && output.isEmpty()) {
-            setError("提交失败 (exitCode: " + QString::number(exitCode) + ")");
-        } else {
-            setError("提交失败: " + (errorOutput.isEmpty() ? output : errorOutput));
+    // 提交时会运行 hooks（pre-commit 等），看门狗只在 hook 和 git 都没有进展时才终止
+    runWrite([repoPath, message]() {
+        return GitProcess(repoPath).run({"commit", "-m", message});
+    }, [this](const GitResult &result) {
+        QString errorOutput = result.errorText();
+        QString output = result.outputText();
+        
+        qDebug() << "Commit exitCode:" << result.exitCode;
+        qDebug() << "Commit stdout:" << output;
+        qDebug() << "Commit stderr:" << errorOutput;
+        
+        int exitCode = result.exitCode;
+        
+        if (!result.ok()) {
+            setLoading(false);
+            // Check for common errors
+            if (result.stalled) {
+                setError("提交失败: " + errorOutput);
+            } else if (errorOutput.contains("user.email") || errorOutput.contains("user.name") ||
+                errorOutput.contains("Please tell me who you are")) {
+                setError("请先配置 Git 用户信息:\ngit config user.name \"你的名字\"\ngit config user.email \"你的邮箱\"");
+            } else if (errorOutput.contains("nothing to commit") || output.contains("nothing to commit")) {
+                setError("没有需要提交的更改");
+            } else if (errorOutput.isEmpty() && output.isEmpty()) {
+                setError("提交失败 (exitCode: " + QString::number(exitCode) + ")");
+            } else {
+                setError("提交失败: " + (errorOutput.isEmpty() ? output : errorOutput));
+            }
+            return;
         }
-        return;
-    }
-    
-    setLoading(false);
-    emit operationSuccess("提交成功");
-    refresh();
+        
+        setLoading(false);
+        emit operationSuccess("提交成功");
+        refresh();
+    });
 }
 
 void GitManager::push()
@@ -1543,58 +1466,56 @@ void GitManager::quickSync(const QString &message)
 
     setLoading(true);
     
-    QProcess process;
-    process.setWorkingDirectory(m_repoPath);
-    
-    // Step 1: Stage all changes (quick operation)
-    process.start("git", {"add", "-A"});
-    process.waitForFinished(30000);
-    
-    if (process.exitCode() != 0) {
-        setLoading(false);
-        QString err = QString::fromUtf8(process.readAllStandardError()).trimmed();
-        setError("暂存失败: " + err);
-        return;
-    }
-    
-    // Step 2: Check if there's anything to commit (quick operation)
-    process.start("git", {"status", "--porcelain"});
-    process.waitForFinished(30000);
-    QString statusOutput = QString::fromUtf8(process.readAllStandardOutput()).trimmed();
+    QString repoPath = m_repoPath;
+    QString branch = m_currentBranch;
     
-    if (statusOutput.isEmpty()) {
-        setLoading(false);
-        setError("没有需要提交的更改");
-        return;
-    }
-    
-    // Step 3: Commit (quick operation)
-    process.start("git", {"commit", "-m", message});
-    process.waitForFinished(30000);
-    
-    QString commitError = QString::fromUtf8(process.readAllStandardError()).trimmed();
-    QString commitOutput = QString::fromUtf8(process.readAllStandardOutput()).trimmed();
-    int commitExitCode = process.exitCode();
-    
-    if (commitExitCode != 0) {
+    // 暂存、检查、提交在写队列中连续执行，返回错误信息（空表示成功）
+    runWrite([repoPath, message]() -> QString {
+        GitProcess process(repoPath);
+        
+        // Step 1: Stage all changes (quick operation)
+        GitResult result = process.run({"add", "-A"});
+        if (!result.ok()) {
+            return "暂存失败: " + result.errorText();
+        }
+        
+        // Step 2: Check if there's anything to commit (quick operation)
+        result = process.run({"status", "--porcelain"});
+        if (result.stalled) {
+            return result.errorText();
+        }
+        if (result.outputText().isEmpty()) {
+            return "没有需要提交的更改";
+        }
+        
+        // Step 3: Commit (quick operation)
+        result = process.run({"commit", "-m", message});
+        if (result.ok()) {
+            return QString();
+        }
+        
+        QString commitError = result.errorText();
+        QString commitOutput = result.outputText();
+        if (result.stalled) {
+            return "提交失败: " + commitError;
+        }
         if (commitError.contains("nothing to commit") || commitOutput.contains("nothing to commit")) {
-            setLoading(false);
-            setError("没有需要提交的更改");
-            return;
+            return "没有需要提交的更改";
         }
         if (commitError.contains("user.email") || commitError.contains("user.name") ||
             commitError.contains("Please tell me who you are")) {
+            return "请先配置 Git 用户信息:\ngit config user.name \"你的名字\"\ngit config user.email \"你的邮箱\"";
+        }
+        return "提交失败: " + (commitError.isEmpty() ? commitOutput : commitError);
+    }, [this, branch](const QString &error) {
+        if (!error.isEmpty()) {
             setLoading(false);
-            setError("请先配置 Git 用户信息:\ngit config user.name \"你的名字\"\ngit config user.email \"你的邮箱\"");
+            setError(error);
             return;
         }
-        setLoading(false);
-        setError("提交失败: " + (commitError.isEmpty() ? commitOutput : commitError));
-        return;
-    }
-    
-    // Step 4: Push asynchronously (this is the slow part)
-    runAsyncGitCommand({"push", "-u", "origin", m_currentBranch}, "同步成功！已提交并推送到远程", "提交成功，但推送失败");
+        // Step 4: Push asynchronously (this is the slow part)
+        runAsyncGitCommand({"push", "-u", "origin", branch}, "同步成功！已提交并推送到远程", "提交成功，但推送失败");
+    });
 }
 
 void GitManager::pull()
@@ -1608,41 +1529,47 @@ void GitManager::switchBranch(const QString &branchName)
 {
     setLoading(true);
     
-    QProcess process;
-    process.setWorkingDirectory(m_repoPath);
-    process.start("git", {"checkout", branchName});
-    process.waitForFinished(30000);
-    
-    QString errorOutput = QString::fromUtf8(process.readAllStandardError()).trimmed();
+    QString repoPath = m_repoPath;
     
-    if (process.exitCode() != 0) {
-        setLoading(false);
-        if (errorOutput.contains("uncommitted changes") || errorOutput.contains("would be overwritten")) {
-            setError("切换失败：有未提交的更改，请先提交或撤销");
-        } else if (errorOutput.contains("did not match")) {
-            // Try to checkout remote branch
-            process.start("git", {"checkout", "-b", branchName, "origin/" + branchName});
-            process.waitForFinished(30000);
-            if (process.exitCode() != 0) {
-                setError("切换失败: " + errorOutput);
-                return;
+    // 返回 (是否成功, 切换后的当前分支 / 错误信息)
+    runWrite([repoPath, branchName]() -> QPair<bool, QString> {
+        GitProcess process(repoPath);
+        GitResult result = process.run({"checkout", branchName});
+        
+        QString errorOutput = result.errorText();
+        
+        if (!result.ok()) {
+            if (result.stalled) {
+                return qMakePair(false, "切换失败: " + errorOutput);
+            } else if (errorOutput.contains("uncommitted changes") || errorOutput.contains("would be overwritten")) {
+                return qMakePair(false, QString("切换失败：有未提交的更改，请先提交或撤销"));
+            } else if (errorOutput.contains("did not match")) {
+                // Try to checkout remote branch
+                result = process.run({"checkout", "-b", branchName, "origin/" + branchName});
+                if (!result.ok()) {
+                    return qMakePair(false, "切换失败: " + (result.stalled ? result.errorText() : errorOutput));
+                }
+            } else {
+                return qMakePair(false, "切换失败: " + errorOutput);
             }
-        } else {
-            setError("切换失败: " + errorOutput);
+        }
+        
+        // Update current branch
+        return qMakePair(true, process.run({"branch", "--show-current"}).outputText());
+    }, [this](const QPair<bool, QString> &result) {
+        if (!result.first) {
+            setLoading(false);
+            setError(result.second);
             return;
         }
-    }
-    
-    // Update current branch
-    m_currentBranch = runGitCommand({"branch", "--show-current"});
-    emit currentBranchChanged();
-    
-    // Update branch list
-    updateBranches();
-    parseStatus();
-    
-    setLoading(false);
-    emit operationSuccess("已切换到分支: " + m_currentBranch);
+        
+        m_currentBranch = result.second;
+        emit currentBranchChanged();
+        
+        // 分支列表和文件状态在读线程中刷新
+        refresh();
+        emit operationSuccess("已切换到分支: " + m_currentBranch);
+    });
 }
 
 void GitManager::createBranch(const QString &branchName)
@@ -1654,16 +1581,23 @@ void GitManager::createBranch(const QString &branchName)
 
     setLoading(true);
     
-    // Create and switch to new branch (local operation, fast)
-    QProcess process;
-    process.setWorkingDirectory(m_repoPath);
-    process.start("git", {"checkout", "-b", branchName});
-    process.waitForFinished(30000);
-
-    // Check if we're now on the new branch
-    QString currentBranch = runGitCommand({"branch", "--show-current"});
+    QString repoPath = m_repoPath;
     
-    if (currentBranch == branchName) {
+    // 返回 (切换后的当前分支, 错误信息)
+    runWrite([repoPath, branchName]() -> QPair<QString, QString> {
+        // Create and switch to new branch (local operation, fast)
+        GitProcess process(repoPath);
+        GitResult result = process.run({"checkout", "-b", branchName});
+        
+        // Check if we're now on the new branch
+        return qMakePair(process.run({"branch", "--show-current"}).outputText(), result.errorText());
+    }, [this, branchName](const QPair<QString, QString> &result) {
+        if (result.first != branchName) {
+            setLoading(false);
+            setError("创建分支失败: " + result.second);
+            return;
+        }
+        
         // Update current branch immediately
         m_currentBranch = branchName;
         emit currentBranchChanged();
@@ -1675,11 +1609,7 @@ void GitManager::createBranch(const QString &branchName)
         runAsyncGitCommand({"push", "-u", "origin", branchName}, 
                            "已创建分支并推送到远程: " + branchName,
                            "已创建本地分支，但推送失败");
-    } else {
-        QString errorOutput = QString::fromUtf8(process.readAllStandardError()).trimmed();
-        setLoading(false);
-        setError("创建分支失败: " + errorOutput);
-    }
+    });
 }
 
 void GitManager::deleteBranch(const QString &branchName)
@@ -1691,44 +1621,53 @@ void GitManager::deleteBranch(const QString &branchName)
 
     setLoading(true);
     
-    QProcess process;
-    process.setWorkingDirectory(m_repoPath);
-    
+    QString repoPath = m_repoPath;
     bool isLocal = m_localBranches.contains(branchName);
     bool isRemote = m_remoteBranches.contains(branchName);
     
-    int exitCode = 0;
-    QString errorOutput;
+    // 删除远程分支要访问网络，可以取消
+    std::shared_ptr<GitCancelToken> token = beginOperation("删除分支");
     
-    // Delete local branch if exists
-    if (isLocal) {
-        process.start("git", {"branch", "-D", branchName});
-        process.waitForFinished(30000);
-        exitCode = process.exitCode();
-        errorOutput = QString::fromUtf8(process.readAllStandardError()).trimmed();
-    }
-    
-    // Delete remote branch if exists
-    if (isRemote || isLocal) {
-        // Also try to delete from remote
-        process.start("git", {"push", "origin", "--delete", branchName});
-        process.waitForFinished(60000);
-        // Don't fail if remote delete fails (branch might not exist on remote)
-        if (process.exitCode() != 0 && !isLocal) {
-            exitCode = process.exitCode();
-            errorOutput = QString::fromUtf8(process.readAllStandardError()).trimmed();
+    // 返回 (exitCode, 错误信息)
+    runWrite([repoPath, branchName, isLocal, isRemote, token]() -> QPair<int, QString> {
+        GitProcess process(repoPath, token);
+        
+        int exitCode = 0;
+        QString errorOutput;
+        
+        // Delete local branch if exists
+        if (isLocal) {
+            GitResult result = process.run({"branch", "-D", branchName});
+            exitCode = result.exitCode;
+            errorOutput = result.errorText();
         }
-    }
-
-    // Update branch list
-    updateBranches();
-    setLoading(false);
-    
-    if (exitCode == 0 || (!m_localBranches.contains(branchName) && !m_remoteBranches.contains(branchName))) {
-        emit operationSuccess("已删除分支: " + branchName);
-    } else {
-        setError("删除分支失败: " + errorOutput);
-    }
+        
+        // Delete remote branch if exists
+        if (isRemote || isLocal) {
+            // Also try to delete from remote
+            GitResult result = process.run({"push", "origin", "--delete", branchName}, 120000);
+            // Don't fail if remote delete fails (branch might not exist on remote)
+            if (!result.ok() && (!isLocal || result.stalled)) {
+                exitCode = result.exitCode;
+                errorOutput = result.errorText();
+            }
+        }
+        return qMakePair(exitCode, errorOutput);
+    }, [this, branchName, token](const QPair<int, QString> &result) {
+        endOperation(token);
+        
+        // Update branch list
+        updateBranches();
+        setLoading(false);
+        
+        if (token->isCancelled()) {
+            emit operationSuccess("已取消删除分支");
+        } else if (result.first == 0 || (!m_localBranches.contains(branchName) && !m_remoteBranches.contains(branchName))) {
+            emit operationSuccess("已删除分支: " + branchName);
+        } else {
+            setError("删除分支失败: " + result.second);
+        }
+    });
 }
 
 void GitManager::mergeBranch(const QString &branchName)
@@ -1742,46 +1681,55 @@ void GitManager::mergeBranch(const QString &branchName)
     
     QString repoPath = m_repoPath;
     QString currentBranch = m_currentBranch;
+    std::shared_ptr<GitCancelToken> token = beginOperation("合并分支");
     
-    QFuture<QPair<int, QString>> future = QtConcurrent::run([repoPath, branchName, currentBranch]() -> QPair<int, QString> {
-        QProcess process;
-        process.setWorkingDirectory(repoPath);
+    QFuture<QPair<int, QString>> future = GitOperationQueue::forRepo(repoPath)->run(GitOperationQueue::Write, [repoPath, branchName, currentBranch, token]() -> QPair<int, QString> {
+        GitProcess process(repoPath, token);
         
         // First fetch to make sure we have latest refs
-        process.start("git", {"fetch", "--all"});
-        process.waitForFinished(60000);
+        token->reportProgress("获取远程更新", -1);
+        GitResult result = process.run({"fetch", "--all", "--progress"}, 60000);
+        if (result.cancelled) {
+            return qMakePair(300, QString());
+        }
         
         // Try to merge remote branch first (origin/branchName), fall back to local
         QString mergeBranch = "origin/" + branchName;
         
         // Check if remote branch exists
-        process.start("git", {"rev-parse", "--verify", mergeBranch});
-        process.waitForFinished(5000);
-        if (process.exitCode() != 0) {
+        result = process.run({"rev-parse", "--verify", mergeBranch}, 5000);
+        if (result.exitCode != 0) {
             // Remote branch doesn't exist, use local
             mergeBranch = branchName;
         }
         
         // Merge the specified branch into current branch
-        process.start("git", {"merge", mergeBranch, "-m", "合并分支 " + branchName + " 到 " + currentBranch});
-        process.waitForFinished(120000);
+        token->reportProgress("合并中", -1);
+        result = process.run({"merge", "--progress", mergeBranch, "-m", "合并分支 " + branchName + " 到 " + currentBranch}, 120000);
+        
+        if (result.cancelled) {
+            // 回滚：中止未完成的合并，恢复到合并前的状态
+            if (QFileInfo::exists(GitLockManager::gitDir(repoPath) + "/MERGE_HEAD")) {
+                GitProcess(repoPath).run({"merge", "--abort"});
+            }
+            return qMakePair(300, QString());
+        }
         
-        QString errorOutput = QString::fromUtf8(process.readAllStandardError()).trimmed();
-        QString output = QString::fromUtf8(process.readAllStandardOutput()).trimmed();
-        int exitCode = process.exitCode();
+        QString errorOutput = result.errorText();
+        QString output = result.outputText();
+        int exitCode = result.exitCode;
         
-        QString result = errorOutput.isEmpty() ? output : errorOutput;
+        QString message = errorOutput.isEmpty() ? output : errorOutput;
         
         bool alreadyUpToDate = output.contains("Already up to date") || output.contains("Already up-to-date");
         
         if (exitCode != 0 && !alreadyUpToDate) {
-            return qMakePair(exitCode, result);
+            return qMakePair(exitCode, message);
         }
         
         // Check if there are unpushed commits
-        process.start("git", {"log", "origin/" + currentBranch + ".." + currentBranch, "--oneline"});
-        process.waitForFinished(10000);
-        QString unpushed = QString::fromUtf8(process.readAllStandardOutput()).trimmed();
+        result = process.run({"log", "origin/" + currentBranch + ".." + currentBranch, "--oneline"}, 10000);
+        QString unpushed = result.outputText();
         
         if (unpushed.isEmpty() && alreadyUpToDate) {
             // Really nothing to do
@@ -1789,11 +1737,14 @@ void GitManager::mergeBranch(const QString &branchName)
         }
         
         // Push (either merge result or existing unpushed commits)
-        process.start("git", {"push", "-u", "origin", currentBranch});
-        process.waitForFinished(120000);
+        result = process.run({"push", "--progress", "-u", "origin", currentBranch}, 120000);
+        if (result.cancelled) {
+            // 合并已在本地完成，只是没有推送
+            return qMakePair(301, QString());
+        }
         
-        if (process.exitCode() != 0) {
-            QString pushError = QString::fromUtf8(process.readAllStandardError()).trimmed();
+        if (result.exitCode != 0) {
+            QString pushError = result.errorText();
             // Check if it's because remote has changes
             if (pushError.contains("rejected") || pushError.contains("failed to push")) {
                 return qMakePair(201, pushError);  // Need force push
@@ -1809,14 +1760,21 @@ void GitManager::mergeBranch(const QString &branchName)
     });
     
     QFutureWatcher<QPair<int, QString>> *watcher = new QFutureWatcher<QPair<int, QString>>(this);
-    connect(watcher, &QFutureWatcher<QPair<int, QString>>::finished, this, [this, watcher, branchName]() {
+    connect(watcher, &QFutureWatcher<QPair<int, QString>>::finished, this, [this, watcher, branchName, token]() {
         auto result = watcher->result();
         int code = result.first;
         QString msg = result.second;
         
+        endOperation(token);
         setLoading(false);
         
-        if (code == 0) {
+        if (code == 300) {
+            refresh();
+            emit operationSuccess("已取消合并，仓库已恢复到合并前的状态");
+        } else if (code == 301) {
+            refresh();
+            emit operationSuccess("已合并到本地，推送已取消");
+        } else if (code == 0) {
             refresh();
             emit operationSuccess("已将 " + branchName + " 合并到 " + m_currentBranch + " 并推送到远程");
         } else if (code == 100) {
@@ -1849,22 +1807,65 @@ void GitManager::mergeBranch(const QString &branchName)
 
 void GitManager::discardChanges(const QString &filePath)
 {
+    if (m_repoPath.isEmpty() || filePath.isEmpty()) return;
+    
     setLoading(true);
-    runGitCommand({"checkout", "--", filePath});
-    refresh();
-    emit operationSuccess("已撤销更改: " + filePath);
+    
+    QString repoPath = m_repoPath;
+    
+    QFuture<GitResult> future = GitOperationQueue::forRepo(repoPath)->run(GitOperationQueue::Write, [repoPath, filePath]() {
+        return GitProcess(repoPath).run({"checkout", "--", filePath});
+    });
+    
+    QFutureWatcher<GitResult> *watcher = new QFutureWatcher<GitResult>(this);
+    connect(watcher, &QFutureWatcher<GitResult>::finished, this, [this, watcher, filePath]() {
+        GitResult result = watcher->result();
+        refresh();
+        if (result.stalled) {
+            setError("撤销失败: " + result.errorText());
+        } else {
+            emit operationSuccess("已撤销更改: " + filePath);
+        }
+        watcher->deleteLater();
+    });
+    watcher->setFuture(future);
 }
 
 void GitManager::discardAllChanges()
 {
+    if (m_repoPath.isEmpty()) return;
+    
     setLoading(true);
-    // Discard all changes in tracked files
-    runGitCommand({"checkout", "--", "."});
-    // Remove untracked files
-    runGitCommand({"clean", "-fd"});
-    refresh();
-    setBulkOperationMode(false);
-    emit operationSuccess("已撤销所有更改");
+    
+    QString repoPath = m_repoPath;
+    
+    // 放入写队列，不再在 GUI 线程上同步执行（避免与后台暂存/推送争抢 index.lock）
+    QFuture<GitResult> future = GitOperationQueue::forRepo(repoPath)->run(GitOperationQueue::Write, [repoPath]() {
+        GitProcess process(repoPath);
+        
+        // Discard all changes in tracked files
+        GitResult result = process.run({"checkout", "--", "."});
+        if (result.stalled) {
+            return result;
+        }
+        
+        // Remove untracked files
+        return process.run({"clean", "-fd"});
+    });
+    
+    QFutureWatcher<GitResult> *watcher = new QFutureWatcher<GitResult>(this);
+    connect(watcher, &QFutureWatcher<GitResult>::finished, this, [this, watcher]() {
+        GitResult result = watcher->result();
+        refresh();
+        setBulkOperationMode(false);
+        if (result.stalled) {
+            setError("撤销失败: " + result.errorText());
+        } else {
+            emit operationSuccess("已撤销所有更改");
+        }
+        watcher->deleteLater();
+    });
+    watcher->setFuture(future);
 }
 
 void GitManager::deleteNewFile(const QString &filePath)
@@ -2136,20 +2137,26 @@ void GitManager::abortMerge()
     
     setLoading(true);
     
-    QProcess process;
-    process.setWorkingDirectory(m_repoPath);
-    process.start("git", {"merge", "--abort"});
-    process.waitForFinished(30000);
-    
-    if (process.exitCode() != 0) {
-        // Try reset if merge --abort fails
-        process.start("git", {"reset", "--hard", "HEAD"});
-        process.waitForFinished(30000);
-    }
+    QString repoPath = m_repoPath;
     
-    setLoading(false);
-    refresh();
-    emit operationSuccess("已取消合并");
+    runWrite([repoPath]() {
+        GitProcess process(repoPath);
+        GitResult result = process.run({"merge", "--abort"});
+        
+        if (!result.ok()) {
+            // Try reset if merge --abort fails
+            result = process.run({"reset", "--hard", "HEAD"});
+        }
+        return result;
+    }, [this](const GitResult &result) {
+        setLoading(false);
+        refresh();
+        if (result.stalled) {
+            setError("取消合并失败: " + result.errorText());
+            return;
+        }
+        emit operationSuccess("已取消合并");
+    });
 }
 
 void GitManager::resetToBranch(const QString &branchName)
@@ -2165,50 +2172,66 @@ void GitManager::resetToBranch(const QString &branchName)
     QString repoPath = m_repoPath;
     QString currentBranch = m_currentBranch;
     
-    QFuture<QPair<bool, QString>> future = QtConcurrent::run([repoPath, branchName, currentBranch]() -> QPair<bool, QString> {
-        QProcess process;
-        process.setWorkingDirectory(repoPath);
+    std::shared_ptr<GitCancelToken> token = beginOperation("重置分支");
+    
+    QFuture<QPair<bool, QString>> future = GitOperationQueue::forRepo(repoPath)->run(GitOperationQueue::Write, [repoPath, branchName, currentBranch, token]() -> QPair<bool, QString> {
+        GitProcess process(repoPath, token);
         
         // Fetch latest
-        process.start("git", {"fetch", "--all"});
-        process.waitForFinished(60000);
+        token->reportProgress("获取远程更新", -1);
+        GitResult result = process.run({"fetch", "--all", "--progress"}, 60000);
+        if (result.cancelled) {
+            return qMakePair(false, QString());
+        }
         
         // Try remote branch first
         QString targetBranch = "origin/" + branchName;
-        process.start("git", {"rev-parse", "--verify", targetBranch});
-        process.waitForFinished(5000);
-        if (process.exitCode() != 0) {
+        result = process.run({"rev-parse", "--verify", targetBranch}, 5000);
+        if (result.exitCode != 0) {
             targetBranch = branchName;
         }
         
+        // 记录重置前的提交，推送被取消时恢复
+        QString previousHead = process.run({"rev-parse", "HEAD"}, 5000).outputText();
+        
         // Reset current branch to target branch
-        process.start("git", {"reset", "--hard", targetBranch});
-        process.waitForFinished(60000);
+        result = process.run({"reset", "--hard", targetBranch}, 60000);
         
-        if (process.exitCode() != 0) {
-            QString err = QString::fromUtf8(process.readAllStandardError()).trimmed();
-            return qMakePair(false, err);
+        if (result.cancelled) {
+            return qMakePair(false, QString());
+        }
+        if (result.exitCode != 0) {
+            return qMakePair(false, result.errorText());
         }
         
         // Force push to update remote
-        process.start("git", {"push", "--force", "origin", currentBranch});
-        process.waitForFinished(120000);
+        token->reportProgress("推送中", -1);
+        result = process.run({"push", "--progress", "--force", "origin", currentBranch}, 120000);
         
-        if (process.exitCode() != 0) {
-            QString err = QString::fromUtf8(process.readAllStandardError()).trimmed();
-            return qMakePair(false, QString("重置成功，但推送失败: ") + err);
+        if (result.cancelled) {
+            // 回滚：远程没有被改写，本地分支也恢复到重置前
+            if (!previousHead.isEmpty()) {
+                GitProcess(repoPath).run({"reset", "--hard", previousHead}, 60000);
+            }
+            return qMakePair(false, QString());
+        }
+        if (result.exitCode != 0) {
+            return qMakePair(false, QString("重置成功，但推送失败: ") + result.errorText());
         }
         
         return qMakePair(true, QString());
     });
     
     QFutureWatcher<QPair<bool, QString>> *watcher = new QFutureWatcher<QPair<bool, QString>>(this);
-    connect(watcher, &QFutureWatcher<QPair<bool, QString>>::finished, this, [this, watcher, branchName]() {
+    connect(watcher, &QFutureWatcher<QPair<bool, QString>>::finished, this, [this, watcher, branchName, token]() {
         auto result = watcher->result();
+        endOperation(token);
         setLoading(false);
         refresh();
         
-        if (result.first) {
+        if (token->isCancelled()) {
+            emit operationSuccess("已取消重置，分支保持原状");
+        } else if (result.first) {
             emit operationSuccess("已将当前分支重置为 " + branchName + " 的内容并推送");
         } else {
             setError(result.second);
@@ -2246,22 +2269,18 @@ void GitManager::cloneRepo(const QString &url, const QString &targetPath)
     setError("");
 
     // Run clone asynchronously
-    if (m_asyncProcess->state() != QProcess::NotRunning) {
+    if (m_asyncBusy) {
         setLoading(false);
         setError("有操作正在进行中，请稍候");
         return;
     }
     
-    m_asyncSuccessMsg = "克隆成功";
-    m_asyncErrorPrefix = "克隆失败";
-    
-    m_asyncProcess->setWorkingDirectory(cleanPath);
-    m_asyncProcess->start("git", {"clone", url});
+    runAsyncGitCommand({"clone", url}, "克隆成功", "克隆失败", cleanPath);
 }
 
-QVariantList GitManager::repoFiles() const
+RepoFileModel *GitManager::repoFiles() const
 {
-    return m_repoFiles;
+    return m_repoFileModel;
 }
 
 QString GitManager::currentPath() const
@@ -2278,40 +2297,14 @@ void GitManager::loadRepoFiles(const QString &subPath)
 {
     if (m_repoPath.isEmpty()) return;
 
-    m_currentPath = subPath;
-    emit currentPathChanged();
-
-    QString fullPath = m_repoPath;
-    if (!subPath.isEmpty()) {
-        fullPath += "/" + subPath;
-    }
-
-    QDir dir(fullPath);
-    if (!dir.exists()) {
+    // 在后台列出目录，条目分块出现在模型中；最近浏览过且没有变化的目录直接取自缓存
+    if (!m_repoFileModel->load(subPath)) {
         setError("目录不存在");
         return;
     }
 
-    m_repoFiles.clear();
-
-    // Get all entries
-    QFileInfoList entries = dir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot, QDir::DirsFirst | QDir::Name);
-
-    for (const QFileInfo &info : entries) {
-        // Skip .git folder
-        if (info.fileName() == ".git") continue;
-
-        QVariantMap fileInfo;
-        fileInfo["name"] = info.fileName();
-        fileInfo["path"] = subPath.isEmpty() ? info.fileName() : subPath + "/" + info.fileName();
-        fileInfo["isDir"] = info.isDir();
-        fileInfo["size"] = info.size();
-        fileInfo["modified"] = info.lastModified().toString("yyyy-MM-dd hh:mm");
-
-        m_repoFiles.append(fileInfo);
-    }
-
-    emit repoFilesChanged();
+    m_currentPath = subPath;
+    emit currentPathChanged();
 }
 
 void GitManager::openFile(const QString &filePath)
@@ -2354,13 +2347,16 @@ void GitManager::openFile(const QString &filePath)
         return;
     }
 
-    QTextStream in(&file);
-    in.setEncoding(QStringConverter::Utf8);
-    m_fileContent = in.readAll();
+    // 按文件自身的编码解码（GBK 文件不再显示为乱码），保存时按同一编码写回
+    QByteArray contents = file.readAll();
     file.close();
+    m_fileContent = GitEncoding::decode(contents, GitEncoding::fileEncoding(fullPath, contents));
 
     setLoading(false);
     emit fileContentChanged();
+
+    // 追溯视图打开着时跟随切换到这个文件
+    m_blameModel->setFilePath(filePath);
 }
 
 void GitManager::openFileLocation(const QString &filePath)
@@ -2381,109 +2377,13 @@ void GitManager::openFileLocation(const QString &filePath)
     #endif
 }
 
-QVariantList GitManager::getFileDiff(const QString &filePath, bool staged)
-{
-    QVariantList diffLines;
-    if (m_repoPath.isEmpty() || filePath.isEmpty()) return diffLines;
-    
-    QProcess process;
-    process.setWorkingDirectory(m_repoPath);
-    
-    // Get diff: staged uses --cached, unstaged doesn't
-    QStringList args;
-    if (staged) {
-        args = {"diff", "--cached", "--", filePath};
-    } else {
-        args = {"diff", "--", filePath};
-    }
-    
-    process.start("git", args);
-    process.waitForFinished(30000);
-    
-    QString output = QString::fromUtf8(process.readAllStandardOutput());
-    
-    if (output.isEmpty()) {
-        // For new files, show all content as added
-        if (!staged) {
-            // Check if it's a new untracked file
-            QString fullPath = m_repoPath + "/" + filePath;
-            QFile file(fullPath);
-            if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-                QTextStream in(&file);
-                in.setEncoding(QStringConverter::Utf8);
-                QString content = in.readAll();
-                file.close();
-                
-                QStringList lines = content.split('\n');
-                for (int i = 0; i < lines.size(); i++) {
-                    QVariantMap line;
-                    line["type"] = "add";
-                    line["content"] = lines[i];
-                    line["lineNum"] = i + 1;
-                    diffLines.append(line);
-                }
-            }
-        }
-        return diffLines;
-    }
-    
-    // Parse diff output
-    QStringList lines = output.split('\n');
-    int oldLineNum = 0;
-    int newLineNum = 0;
-    
-    for (const QString &line : lines) {
-        // Skip diff header lines
-        if (line.startsWith("diff --git") || line.startsWith("index ") ||
-            line.startsWith("---") || line.startsWith("+++")) {
-            continue;
-        }
-        
-        QVariantMap diffLine;
-        
-        if (line.startsWith("@@")) {
-            // Parse hunk header: @@ -oldStart,oldCount +newStart,newCount @@
-            QRegularExpression re("@@ -(\\d+)(?:,\\d+)? \\+(\\d+)(?:,\\d+)? @@");
-            QRegularExpressionMatch match = re.match(line);
-            if (match.hasMatch()) {
-                oldLineNum = match.captured(1).toInt();
-                newLineNum = match.captured(2).toInt();
-            }
-            diffLine["type"] = "header";
-            diffLine["content"] = line;
-            diffLine["lineNum"] = 0;
-        }
-        else if (line.startsWith("-")) {
-            diffLine["type"] = "delete";
-            diffLine["content"] = line.mid(1);
-            diffLine["lineNum"] = oldLineNum++;
-        }
-        else if (line.startsWith("+")) {
-            diffLine["type"] = "add";
-            diffLine["content"] = line.mid(1);
-            diffLine["lineNum"] = newLineNum++;
-        }
-        else if (line.startsWith(" ")) {
-            diffLine["type"] = "context";
-            diffLine["content"] = line.mid(1);
-            diffLine["lineNum"] = newLineNum++;
-            oldLineNum++;
-        }
-        else {
-            continue;
-        }
-        
-        diffLines.append(diffLine);
-    }
-    
-    return diffLines;
-}
-
 void GitManager::saveFile(const QString &filePath, const QString &content)
 {
     if (m_repoPath.isEmpty()) return;
 
     QString fullPath = m_repoPath + "/" + filePath;
+    // 按文件原有的编码写回（新文件为 UTF-8）；必须在打开（截断）文件之前确定
+    QByteArray contents = GitEncoding::encode(content, GitEncoding::fileEncoding(fullPath));
     QFile file(fullPath);
 
     if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
@@ -2491,9 +2391,7 @@ void GitManager::saveFile(const QString &filePath, const QString &content)
         return;
     }
 
-    QTextStream out(&file);
-    out.setEncoding(QStringConverter::Utf8);
-    out << content;
+    file.write(contents);
     file.close();
 
     emit operationSuccess("文件已保存");
@@ -2536,7 +2434,7 @@ void GitManager::goBack()
     }
 }
 
-QVariantList GitManager::remoteFiles() const
+QList<TreeEntry> GitManager::remoteFiles() const
 {
     return m_remoteFiles;
 }
@@ -2551,109 +2449,196 @@ QString GitManager::remoteUrl() const
     return m_remoteUrl;
 }
 
-void GitManager::loadRemoteFiles(const QString &subPath)
+RevisionBrowserModel *GitManager::revisionBrowser() const
+{
+    return m_revisionBrowser;
+}
+
+int GitManager::remoteFetchTtl() const
+{
+    return m_remoteFetchTtl;
+}
+
+void GitManager::setRemoteFetchTtl(int seconds)
+{
+    seconds = qMax(0, seconds);
+    if (m_remoteFetchTtl == seconds) return;
+    m_remoteFetchTtl = seconds;
+    QSettings settings("GitPushTool", "RemoteBrowser");
+    settings.setValue("fetchTtl", seconds);
+    emit remoteFetchTtlChanged();
+}
+
+bool GitManager::diffCacheOnDisk() const
+{
+    return GitDiffCache::instance()->diskSpill();
+}
+
+void GitManager::setDiffCacheOnDisk(bool enabled)
+{
+    if (diffCacheOnDisk() == enabled) return;
+    QSettings settings("GitPushTool", "DiffCache");
+    settings.setValue("diskSpill", enabled);
+    GitDiffCache::instance()->setDiskSpill(enabled);
+    if (!enabled) {
+        // 删除已经写出的文件，不在界面线程中做
+        QFuture<void> future = QtConcurrent::run([]() {
+            GitDiffCache::instance()->removeFiles();
+        });
+    }
+    emit diffCacheOnDiskChanged();
+}
+
+void GitManager::loadRemoteFiles(const QString &subPath, bool forceFetch)
 {
     if (m_repoPath.isEmpty()) return;
 
-    setLoading(true);
     m_remoteCurrentPath = subPath;
     emit remoteCurrentPathChanged();
 
     QString repoPath = m_repoPath;
-    QString currentBranch = m_currentBranch;
+    QString remoteBranch = "origin/" + m_currentBranch;
+    GitRemoteTreeCache *treeCache = GitRemoteTreeCache::forRepo(repoPath);
+    
+    // 已知的远程跟踪提交上有缓存时立即显示，不运行任何 git 命令；
+    // 是否需要 fetch 由有效期决定，在后台进行
+    QList<TreeEntry> cached;
+    if (!forceFetch && m_remoteTrackingRef == remoteBranch
+        && treeCache->lookup(m_remoteTrackingHash, subPath, &cached)) {
+        m_remoteFiles = cached;
+        emit remoteFilesChanged();
+        prefetchRemoteChildren();
+        refreshRemoteTreeInBackground();
+        return;
+    }
+
+    setLoading(true);
+    
+    struct RemoteListing {
+        QString remoteUrl;
+        QString commitHash;
+        QList<TreeEntry> files;
+        QString error;
+    };
+    
+    // 手动刷新（或从未 fetch 过）时先 fetch 再列出，需要在写队列中执行；其余情况只读
+    const bool fetchFirst = forceFetch || (m_remoteTrackingHash.isEmpty() && treeCache->isFetchDue(qint64(m_remoteFetchTtl) * 1000));
+    GitOperationQueue::Kind kind = fetchFirst ? GitOperationQueue::Write : GitOperationQueue::Read;
     
-    QFuture<QPair<QString, QVariantList>> future = QtConcurrent::run([repoPath, subPath, currentBranch]() -> QPair<QString, QVariantList> {
-        QProcess process;
-        process.setWorkingDirectory(repoPath);
-        QVariantList files;
+    QFuture<RemoteListing> future = GitOperationQueue::forRepo(repoPath)->run(kind, [repoPath, subPath, remoteBranch, fetchFirst, treeCache]() -> RemoteListing {
+        GitProcess process(repoPath);
+        RemoteListing listing;
         
         // Get remote URL
-        process.start("git", {"remote", "get-url", "origin"});
-        process.waitForFinished(10000);
-        QString remoteUrl = QString::fromUtf8(process.readAllStandardOutput()).trimmed();
-        
-        // Fetch latest from remote
-        process.start("git", {"fetch", "origin"});
-        process.waitForFinished(60000);
-        
-        // Use git ls-tree to list files from remote branch
-        QString remoteBranch = "origin/" + currentBranch;
-        
-        QStringList args;
-        if (subPath.isEmpty()) {
-            args = {"ls-tree", "-l", remoteBranch};
-        } else {
-            args = {"ls-tree", "-l", remoteBranch, subPath + "/"};
+        listing.remoteUrl = process.run({"remote", "get-url", "origin"}, 10000).outputText();
+        
+        if (fetchFirst) {
+            // Fetch latest from remote
+            GitResult result = process.run({"fetch", "origin"});
+            if (result.stalled) {
+                // 拉取卡死时仍展示本地已有的 origin 引用，同时提示错误
+                listing.error = result.errorText();
+            } else {
+                treeCache->markFetched();
+            }
         }
         
-        process.start("git", args);
-        process.waitForFinished(30000);
-        QString detailOutput = QString::fromUtf8(process.readAllStandardOutput());
-        
-        // Parse ls-tree output
-        QStringList lines = detailOutput.split('\n', Qt::SkipEmptyParts);
-        for (const QString &line : lines) {
-            QRegularExpression re("^(\\d+)\\s+(\\w+)\\s+(\\w+)\\s+(\\S+)\\s+(.+)$");
-            QRegularExpressionMatch match = re.match(line);
-            
-            if (match.hasMatch()) {
-                QString type = match.captured(2);
-                QString size = match.captured(4);
-                QString fullPath = match.captured(5);
-                
-                // Decode octal escapes - use the class method
-                fullPath = GitManager::decodeOctalEscapes(fullPath);
-                
-                QString name = fullPath;
-                if (fullPath.contains('/')) {
-                    name = fullPath.section('/', -1);
-                }
-                
-                QVariantMap fileInfo;
-                fileInfo["name"] = name;
-                fileInfo["path"] = fullPath;
-                fileInfo["isDir"] = (type == "tree");
-                fileInfo["size"] = (size == "-") ? 0 : size.toLongLong();
-                fileInfo["type"] = type;
-                
-                // Get last commit info with full time
-                process.start("git", {"log", "-1", "--format=%s|%ar|%ci", remoteBranch, "--", fullPath});
-                process.waitForFinished(5000);
-                QString logOutput = QString::fromUtf8(process.readAllStandardOutput()).trimmed();
-                if (!logOutput.isEmpty()) {
-                    QStringList logParts = logOutput.split('|');
-                    if (logParts.size() >= 3) {
-                        fileInfo["commitMsg"] = logParts[0].trimmed();
-                        fileInfo["commitTimeRelative"] = logParts[1].trimmed();
-                        // Parse full time: 2025-01-16 14:30:00 +0800 -> 2025-01-16 14:30
-                        QString fullTime = logParts[2].trimmed();
-                        if (fullTime.length() >= 16) {
-                            fileInfo["commitTimeFull"] = fullTime.left(16);
-                        } else {
-                            fileInfo["commitTimeFull"] = fullTime;
-                        }
-                    } else if (logParts.size() >= 2) {
-                        fileInfo["commitMsg"] = logParts[0].trimmed();
-                        fileInfo["commitTimeRelative"] = logParts[1].trimmed();
-                    }
-                }
-                
-                files.append(fileInfo);
-            }
+        // 缓存以远程跟踪分支当前指向的提交为键
+        GitResult result = process.run({"rev-parse", "--verify", "-q", remoteBranch + "^{commit}"}, 10000);
+        if (result.stalled) {
+            listing.error = result.errorText();
+            return listing;
         }
+        listing.commitHash = result.outputText();
         
-        return qMakePair(remoteUrl, files);
+        QString listError;
+        listing.files = treeCache->list(listing.commitHash, subPath, &listError);
+        if (listing.error.isEmpty()) {
+            listing.error = listError;
+        }
+        return listing;
     });
     
-    QFutureWatcher<QPair<QString, QVariantList>> *watcher = new QFutureWatcher<QPair<QString, QVariantList>>(this);
-    connect(watcher, &QFutureWatcher<QPair<QString, QVariantList>>::finished, this, [this, watcher]() {
-        auto result = watcher->result();
-        m_remoteUrl = result.first;
-        m_remoteFiles = result.second;
+    QFutureWatcher<RemoteListing> *watcher = new QFutureWatcher<RemoteListing>(this);
+    connect(watcher, &QFutureWatcher<RemoteListing>::finished, this, [this, watcher, subPath, remoteBranch, fetchFirst]() {
+        RemoteListing result = watcher->result();
+        setLoading(false);
+        watcher->deleteLater();
+        if (!result.error.isEmpty()) {
+            setError(result.error);
+        }
+        // 等待期间已经进入了别的目录
+        if (subPath != m_remoteCurrentPath) {
+            return;
+        }
+        m_remoteUrl = result.remoteUrl;
+        m_remoteTrackingRef = remoteBranch;
+        m_remoteTrackingHash = result.commitHash;
+        m_remoteFiles = result.files;
         emit remoteUrlChanged();
         emit remoteFilesChanged();
-        setLoading(false);
+        prefetchRemoteChildren();
+        if (!fetchFirst) {
+            refreshRemoteTreeInBackground();
+        }
+    });
+    watcher->setFuture(future);
+}
+
+void GitManager::prefetchRemoteChildren()
+{
+    if (m_remoteTrackingHash.isEmpty()) return;
+    
+    // 推测用户接下来会进入的子目录，在读线程池中提前列出
+    QStringList children;
+    for (const TreeEntry &entry : std::as_const(m_remoteFiles)) {
+        if (entry.isDir()) {
+            children.append(entry.filePath());
+        }
+    }
+    if (children.isEmpty()) return;
+    
+    QString commitHash = m_remoteTrackingHash;
+    GitRemoteTreeCache *treeCache = GitRemoteTreeCache::forRepo(m_repoPath);
+    QFuture<void> future = GitOperationQueue::forRepo(m_repoPath)->run(GitOperationQueue::Read, [treeCache, commitHash, children]() {
+        treeCache->prefetch(commitHash, children);
+    });
+}
+
+void GitManager::refreshRemoteTreeInBackground()
+{
+    GitRemoteTreeCache *treeCache = GitRemoteTreeCache::forRepo(m_repoPath);
+    if (m_remoteFetchInFlight || !treeCache->isFetchDue(qint64(m_remoteFetchTtl) * 1000)) {
+        return;
+    }
+    m_remoteFetchInFlight = true;
+    
+    QString repoPath = m_repoPath;
+    QString remoteBranch = m_remoteTrackingRef;
+    QFuture<QString> future = GitOperationQueue::forRepo(repoPath)->run(GitOperationQueue::Write, [repoPath, remoteBranch, treeCache]() -> QString {
+        GitProcess process(repoPath);
+        GitResult result = process.run({"fetch", "origin"});
+        if (!result.ok()) {
+            qDebug() << "Background fetch failed:" << result.errorText();
+            return QString();
+        }
+        treeCache->markFetched();
+        return process.run({"rev-parse", "--verify", "-q", remoteBranch + "^{commit}"}, 10000).outputText();
+    });
+    
+    QFutureWatcher<QString> *watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, repoPath, remoteBranch]() {
+        QString commitHash = watcher->result();
+        m_remoteFetchInFlight = false;
         watcher->deleteLater();
+        if (repoPath != m_repoPath || remoteBranch != m_remoteTrackingRef
+            || commitHash.isEmpty() || commitHash == m_remoteTrackingHash) {
+            return;
+        }
+        // 远程分支有更新：在新提交上重新列出当前目录（不重新 fetch）
+        qDebug() << "Remote branch moved to" << commitHash.left(7) << ", reloading remote files";
+        m_remoteTrackingHash.clear();
+        loadRemoteFiles(m_remoteCurrentPath);
     });
     watcher->setFuture(future);
 }
@@ -2687,17 +2672,27 @@ void GitManager::deleteRemoteFile(const QString &filePath, const QString &messag
         QFile::remove(fullPath);
     }
 
-    // Stage the deletion
-    runGitCommand({"add", "-A"});
-
-    // Commit
+    QString repoPath = m_repoPath;
+    QString branch = m_currentBranch;
     QString commitMsg = message.isEmpty() ? "Delete " + filePath : message;
-    runGitCommand({"commit", "-m", commitMsg});
 
-    // Push to remote - async
-    runAsyncGitCommand({"push", "origin", m_currentBranch}, 
-                       "已删除并推送: " + filePath + "，请点击刷新查看",
-                       "已删除，但推送失败");
+    runWrite([repoPath, commitMsg]() {
+        GitProcess process(repoPath);
+        // Stage the deletion
+        process.run({"add", "-A"});
+        // Commit
+        return process.run({"commit", "-m", commitMsg});
+    }, [this, filePath, branch](const GitResult &result) {
+        if (result.stalled) {
+            setLoading(false);
+            setError("提交失败: " + result.errorText());
+            return;
+        }
+        // Push to remote - async
+        runAsyncGitCommand({"push", "origin", branch}, 
+                           "已删除并推送: " + filePath + "，请点击刷新查看",
+                           "已删除，但推送失败");
+    });
 }
 
 void GitManager::saveAndPushFile(const QString &filePath, const QString &content, const QString &message)
@@ -2708,6 +2703,8 @@ void GitManager::saveAndPushFile(const QString &filePath, const QString &content
 
     // Save file locally
     QString fullPath = m_repoPath + "/" + filePath;
+    // 按文件原有的编码写回（新文件为 UTF-8）；必须在打开（截断）文件之前确定
+    QByteArray contents = GitEncoding::encode(content, GitEncoding::fileEncoding(fullPath));
     QFile file(fullPath);
 
     if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
@@ -2716,43 +2713,46 @@ void GitManager::saveAndPushFile(const QString &filePath, const QString &content
         return;
     }
 
-    QTextStream out(&file);
-    out.setEncoding(QStringConverter::Utf8);
-    out << content;
+    file.write(contents);
     file.close();
 
-    // Stage the file
-    runGitCommand({"add", filePath});
-
     // Handle commit message
     QString commitMsg = message.trimmed();
     if (commitMsg.isEmpty()) {
         commitMsg = "Update " + filePath;
     }
     
-    // Run git commit (local, fast)
-    QProcess process;
-    process.setWorkingDirectory(m_repoPath);
-    
-    process.start("git", QStringList() << "commit" << "-m" << commitMsg);
-    process.waitForFinished(30000);
-    
-    int exitCode = process.exitCode();
-    QString stdOut = QString::fromUtf8(process.readAllStandardOutput());
-    QString stdErr = QString::fromUtf8(process.readAllStandardError());
+    QString repoPath = m_repoPath;
+    QString branch = m_currentBranch;
     
-    if (exitCode != 0) {
-        if (stdErr.contains("nothing to commit") || stdOut.contains("nothing to commit")) {
-            setLoading(false);
-            setError("文件没有变化，无需提交");
-            return;
+    runWrite([repoPath, filePath, commitMsg]() {
+        GitProcess process(repoPath);
+        // Stage the file
+        process.run({"add", filePath});
+        // Run git commit (local, fast)
+        return process.run(QStringList() << "commit" << "-m" << commitMsg);
+    }, [this, filePath, branch](const GitResult &result) {
+        QString stdOut = QString::fromUtf8(result.output);
+        QString stdErr = QString::fromUtf8(result.errorOutput);
+        
+        if (!result.ok()) {
+            if (result.stalled) {
+                setLoading(false);
+                setError("提交失败: " + result.errorText());
+                return;
+            }
+            if (stdErr.contains("nothing to commit") || stdOut.contains("nothing to commit")) {
+                setLoading(false);
+                setError("文件没有变化，无需提交");
+                return;
+            }
         }
-    }
 
-    // Push to remote - async
-    runAsyncGitCommand({"push", "origin", m_currentBranch}, 
-                       "已保存并推送: " + filePath + "，请点击刷新查看",
-                       "已保存，但推送失败");
+        // Push to remote - async
+        runAsyncGitCommand({"push", "origin", branch}, 
+                           "已保存并推送: " + filePath + "，请点击刷新查看",
+                           "已保存，但推送失败");
+    });
 }
 
 void GitManager::renameRemoteFile(const QString &oldPath, const QString &newPath, const QString &message)
@@ -2765,79 +2765,97 @@ void GitManager::renameRemoteFile(const QString &oldPath, const QString &newPath
 
     setLoading(true);
 
-    // Use git mv to rename the file
-    QString result = runGitCommand({"mv", oldPath, newPath});
-    
     // Commit the rename
     QString commitMsg = message.trimmed();
     if (commitMsg.isEmpty()) {
         commitMsg = "Rename " + oldPath + " to " + newPath;
     }
     
-    QProcess process;
-    process.setWorkingDirectory(m_repoPath);
-    process.start("git", {"commit", "-m", commitMsg});
-    process.waitForFinished(30000);
+    QString repoPath = m_repoPath;
+    QString branch = m_currentBranch;
+    
+    runWrite([repoPath, oldPath, newPath, commitMsg]() {
+        GitProcess process(repoPath);
+        // Use git mv to rename the file
+        process.run({"mv", oldPath, newPath});
+        return process.run({"commit", "-m", commitMsg});
+    }, [this, oldPath, newPath, branch](const GitResult &commitResult) {
+        if (commitResult.stalled) {
+            setLoading(false);
+            setError("提交失败: " + commitResult.errorText());
+            return;
+        }
 
-    // Push to remote - async
-    // Store path for refresh after push
-    QString currentRemotePath = m_remoteCurrentPath;
-    runAsyncGitCommand({"push", "origin", m_currentBranch}, 
-                       "已重命名: " + oldPath + " → " + newPath + "，请点击刷新查看",
-                       "已重命名，但推送失败");
+        // Push to remote - async
+        runAsyncGitCommand({"push", "origin", branch}, 
+                           "已重命名: " + oldPath + " → " + newPath + "，请点击刷新查看",
+                           "已重命名，但推送失败");
+    });
 }
 
-QVariantList GitManager::commitHistory() const
+CommitHistoryModel *GitManager::history() const
 {
-    return m_commitHistory;
+    return m_historyModel;
 }
 
-QVariantMap GitManager::lastCommit() const
+CommitHistoryModel *GitManager::fileHistory() const
 {
-    if (m_commitHistory.isEmpty()) {
-        return QVariantMap();
-    }
-    return m_commitHistory.first().toMap();
+    return m_fileHistoryModel;
+}
+
+FileBlameModel *GitManager::blame() const
+{
+    return m_blameModel;
+}
+
+CommitDiffModel *GitManager::commitDiff() const
+{
+    return m_commitDiffModel;
+}
+
+DiffModel *GitManager::diff() const
+{
+    return m_diffModel;
+}
+
+SideBySideDiffModel *GitManager::diffSplit() const
+{
+    return m_diffSplitModel;
+}
+
+CommitEntry GitManager::lastCommit() const
+{
+    return m_historyModel->headCommit();
 }
 
 QStringList GitManager::lastCommitFiles() const
 {
-    if (m_repoPath.isEmpty()) return QStringList();
-    
-    QProcess process;
-    process.setWorkingDirectory(m_repoPath);
-    process.start("git", {"diff-tree", "--no-commit-id", "--name-only", "-r", "HEAD"});
-    process.waitForFinished(5000);
-    
-    QString output = QString::fromUtf8(process.readAllStandardOutput()).trimmed();
-    if (output.isEmpty()) return QStringList();
-    
-    return output.split("\n", Qt::SkipEmptyParts);
+    // 历史的第一条就是 HEAD，变更文件已随 git log 一起读取
+    QStringList files;
+    const QList<CommitFileEntry> changes = m_historyModel->headCommit().files;
+    files.reserve(changes.size());
+    for (const CommitFileEntry &file : changes) {
+        files.append(file.filePath());
+    }
+    return files;
 }
 
 QString GitManager::lastCommitTime() const
 {
     if (m_repoPath.isEmpty()) return QString();
     
-    QProcess process;
-    process.setWorkingDirectory(m_repoPath);
-    process.start("git", {"log", "-1", "--format=%ci|%ar"});
-    process.waitForFinished(5000);
-    
-    QString output = QString::fromUtf8(process.readAllStandardOutput()).trimmed();
+    GitResult result = GitProcess(m_repoPath).run({"log", "-1", "--format=%ci|%ar"}, 5000);
+    QByteArrayView output = GitTokenizer::trimmed(result.output);
     if (output.isEmpty()) return QString();
     
-    QStringList parts = output.split('|');
-    if (parts.size() >= 2) {
-        QString fullTime = parts[0].trimmed();
-        QString relativeTime = parts[1].trimmed();
+    auto parts = GitTokenizer::split<2>(output, '|');
+    if (parts.count >= 2) {
+        QByteArrayView fullTime = GitTokenizer::trimmed(parts[0]);
+        QString relativeTime = GitTokenizer::toString(GitTokenizer::trimmed(parts[1]));
         // Format: 2025-01-16 22:30:00 +0800 -> 2025-01-16 22:30
-        if (fullTime.length() >= 16) {
-            return fullTime.left(16) + " (" + relativeTime + ")";
-        }
-        return fullTime + " (" + relativeTime + ")";
+        return GitTokenizer::toString(fullTime.first(qMin<qsizetype>(fullTime.size(), 16))) + " (" + relativeTime + ")";
     }
-    return output;
+    return GitTokenizer::toString(output);
 }
 
 QString GitManager::userName() const
@@ -2869,92 +2887,7 @@ void GitManager::loadCommitHistory()
 {
     if (m_repoPath.isEmpty()) return;
 
-    setLoading(true);
-    
-    QString repoPath = m_repoPath;
-    
-    QFuture<QVariantList> future = QtConcurrent::run([repoPath]() -> QVariantList {
-        QVariantList history;
-        QProcess process;
-        process.setWorkingDirectory(repoPath);
-        
-        // Get commit history with detailed info
-        process.start("git", {"log", "--pretty=format:%H|%an|%ar|%ci|%s", "-30"});
-        process.waitForFinished(30000);
-        QString output = QString::fromUtf8(process.readAllStandardOutput());
-        
-        QStringList commits = output.split('\n', Qt::SkipEmptyParts);
-        
-        for (const QString &commit : commits) {
-            QStringList parts = commit.split('|');
-            if (parts.size() >= 5) {
-                QVariantMap commitInfo;
-                commitInfo["hash"] = parts[0];
-                commitInfo["shortHash"] = parts[0].left(7);
-                commitInfo["author"] = parts[1];
-                commitInfo["relativeDate"] = parts[2];
-                
-                QString fullDate = parts[3];
-                if (fullDate.length() >= 19) {
-                    QString dateOnly = fullDate.left(10);
-                    QString timeOnly = fullDate.mid(11, 8);
-                    commitInfo["fullDate"] = dateOnly + " " + timeOnly;
-                    commitInfo["date"] = dateOnly;
-                    commitInfo["time"] = timeOnly;
-                } else {
-                    commitInfo["fullDate"] = fullDate;
-                    commitInfo["date"] = fullDate;
-                    commitInfo["time"] = "";
-                }
-                
-                commitInfo["message"] = parts.mid(4).join('|');
-                
-                // Get files changed in this commit
-                process.start("git", {"diff-tree", "--no-commit-id", "--name-status", "-r", parts[0]});
-                process.waitForFinished(10000);
-                QString filesOutput = QString::fromUtf8(process.readAllStandardOutput());
-                
-                QVariantList fileChanges;
-                QStringList fileLines = filesOutput.split('\n', Qt::SkipEmptyParts);
-                for (const QString &fileLine : fileLines) {
-                    if (fileLine.length() > 2) {
-                        QVariantMap fileChange;
-                        QString status = fileLine.left(1);
-                        QString fileName = GitManager::decodeOctalEscapes(fileLine.mid(2).trimmed());
-                        
-                        fileChange["name"] = fileName;
-                        fileChange["status"] = status;
-                        
-                        QString statusText;
-                        if (status == "A") statusText = "添加";
-                        else if (status == "M") statusText = "修改";
-                        else if (status == "D") statusText = "删除";
-                        else if (status == "R") statusText = "重命名";
-                        else statusText = status;
-                        fileChange["statusText"] = statusText;
-                        
-                        fileChanges.append(fileChange);
-                    }
-                }
-                commitInfo["files"] = fileChanges;
-                commitInfo["fileCount"] = fileChanges.count();
-                commitInfo["isMessageOnly"] = (fileChanges.count() == 0);
-                
-                history.append(commitInfo);
-            }
-        }
-        
-        return history;
-    });
-    
-    QFutureWatcher<QVariantList> *watcher = new QFutureWatcher<QVariantList>(this);
-    connect(watcher, &QFutureWatcher<QVariantList>::finished, this, [this, watcher]() {
-        m_commitHistory = watcher->result();
-        emit commitHistoryChanged();
-        setLoading(false);
-        watcher->deleteLater();
-    });
-    watcher->setFuture(future);
+    m_historyModel->reload();
 }
 
 void GitManager::amendCommitMessage(const QString &newMessage)
@@ -2966,25 +2899,26 @@ void GitManager::amendCommitMessage(const QString &newMessage)
 
     setLoading(true);
     
-    // Amend the last commit message (local, fast)
-    QProcess process;
-    process.setWorkingDirectory(m_repoPath);
-    process.start("git", QStringList() << "commit" << "--amend" << "--allow-empty" << "-m" << newMessage.trimmed());
-    process.waitForFinished(30000);
-    
-    int exitCode = process.exitCode();
-    QString stdErr = QString::fromUtf8(process.readAllStandardError());
+    QString repoPath = m_repoPath;
+    QString branch = m_currentBranch;
     
-    if (exitCode != 0) {
-        setLoading(false);
-        setError("修改提交信息失败: " + stdErr);
-        return;
-    }
+    // Amend the last commit message (local, fast)
+    runWrite([repoPath, newMessage]() {
+        return GitProcess(repoPath).run(QStringList() << "commit" << "--amend" << "--allow-empty" << "-m" << newMessage.trimmed());
+    }, [this, branch](const GitResult &result) {
+        QString stdErr = QString::fromUtf8(result.errorOutput);
+        
+        if (!result.ok()) {
+            setLoading(false);
+            setError("修改提交信息失败: " + stdErr);
+            return;
+        }
 
-    // Force push to update remote - async
-    runAsyncGitCommand({"push", "--force", "origin", m_currentBranch}, 
-                       "提交信息已修改并推送",
-                       "提交信息已修改，但推送失败");
+        // Force push to update remote - async
+        runAsyncGitCommand({"push", "--force", "origin", branch}, 
+                           "提交信息已修改并推送",
+                           "提交信息已修改，但推送失败");
+    });
 }
 
 void GitManager::revertCommit(const QString &commitHash, const QString &message)
@@ -2993,23 +2927,32 @@ void GitManager::revertCommit(const QString &commitHash, const QString &message)
 
     setLoading(true);
     
+    QString repoPath = m_repoPath;
+    QString branch = m_currentBranch;
+    
     // Revert the specific commit
     QString commitMsg = message.isEmpty() ? "Revert commit " + commitHash.left(7) : message;
-    QString result = runGitCommand({"revert", "--no-edit", commitHash});
-    
-    if (result.isEmpty()) {
-        // Try with message
-        runGitCommand({"revert", "--no-commit", commitHash});
-        runGitCommand({"commit", "-m", commitMsg});
-    }
-
-    // Push to remote
-    runGitCommand({"push", "origin", m_currentBranch});
-    
-    setLoading(false);
-    emit operationSuccess("已撤销提交并推送");
-    loadCommitHistory();
-    refresh();
+    runWrite([repoPath, commitHash, commitMsg]() {
+        GitProcess process(repoPath);
+        GitResult result = process.run({"revert", "--no-edit", commitHash});
+        
+        if (!result.ok() || result.output.trimmed().isEmpty()) {
+            // Try with message
+            process.run({"revert", "--no-commit", commitHash});
+            result = process.run({"commit", "-m", commitMsg});
+        }
+        return result;
+    }, [this, branch](const GitResult &result) {
+        if (result.stalled) {
+            setLoading(false);
+            setError("撤销提交失败: " + result.errorText());
+            return;
+        }
+        loadCommitHistory();
+        
+        // Push to remote - async（可取消，完成后刷新）
+        runAsyncGitCommand({"push", "origin", branch}, "已撤销提交并推送", "已撤销提交，但推送失败");
+    });
 }
 
 void GitManager::configureUser(const QString &name, const QString &email, bool global)
@@ -3019,33 +2962,52 @@ void GitManager::configureUser(const QString &name, const QString &email, bool g
         return;
     }
 
+    if (!global && m_repoPath.isEmpty()) {
+        setError("未选择仓库");
+        return;
+    }
+
     setLoading(true);
-    
-    QProcess process;
-    if (global) {
-        // Global config
-        process.start("git", {"config", "--global", "user.name", name});
-        process.waitForFinished(10000);
-        
-        process.start("git", {"config", "--global", "user.email", email});
-        process.waitForFinished(10000);
-    } else {
-        // Local repo config
-        process.setWorkingDirectory(m_repoPath);
-        process.start("git", {"config", "user.name", name});
-        process.waitForFinished(10000);
-        
-        process.start("git", {"config", "user.email", email});
-        process.waitForFinished(10000);
+
+    // 写配置在工作线程中执行，返回错误信息（空表示成功）
+    auto work = [repoPath = global ? QString() : m_repoPath, name, email, global]() -> QString {
+        const QStringList scope = global ? QStringList{"--global"} : QStringList();
+        GitProcess process(repoPath);
+        GitResult result = process.run(QStringList{"config"} + scope + QStringList{"user.name", name}, 10000);
+        if (result.ok()) {
+            result = process.run(QStringList{"config"} + scope + QStringList{"user.email", email}, 10000);
+        }
+        return result.ok() ? QString() : "保存用户配置失败: " + result.errorText();
+    };
+    auto done = [this, repoPath = m_repoPath, name, email, global](const QString &error) {
+        setLoading(false);
+        if (!error.isEmpty()) {
+            setError(error);
+            return;
+        }
+        // 仓库配置只在仍是该仓库时更新缓存的用户信息
+        if (global || repoPath == m_repoPath) {
+            m_userName = name;
+            m_userEmail = email;
+            emit userInfoChanged();
+        }
+        emit operationSuccess(global ? "全局用户配置已保存" : "仓库用户配置已保存");
+    };
+
+    if (!global) {
+        // 仓库配置写入 .git/config，与其他写操作一样放入写队列
+        runWrite(std::move(work), std::move(done));
+        return;
     }
-    
-    // Update cached user info
-    m_userName = name;
-    m_userEmail = email;
-    emit userInfoChanged();
-    
-    setLoading(false);
-    emit operationSuccess(global ? "全局用户配置已保存" : "仓库用户配置已保存");
+
+    // 全局配置与仓库无关，不需要仓库的写锁，但同样不在 GUI 线程执行
+    QFuture<QString> future = QtConcurrent::run(std::move(work));
+    QFutureWatcher<QString> *watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [watcher, done = std::move(done)]() {
+        done(watcher->result());
+        watcher->deleteLater();
+    });
+    watcher->setFuture(future);
 }
 
 void GitManager::runGitInstaller()
@@ -3137,14 +3099,9 @@ void GitManager::clearRecentRepos()
 void GitManager::loadGlobalUserInfo()
 {
     // Read global git config (doesn't need a repo)
-    QProcess process;
-    process.start("git", {"config", "--global", "user.name"});
-    process.waitForFinished(5000);
-    QString name = QString::fromUtf8(process.readAllStandardOutput()).trimmed();
-    
-    process.start("git", {"config", "--global", "user.email"});
-    process.waitForFinished(5000);
-    QString email = QString::fromUtf8(process.readAllStandardOutput()).trimmed();
+    GitProcess process(QString());
+    QString name = process.run({"config", "--global", "user.name"}, 5000).outputText();
+    QString email = process.run({"config", "--global", "user.email"}, 5000).outputText();
     
     if (!name.isEmpty() || !email.isEmpty()) {
         m_userName = name;
@@ -3153,29 +3110,117 @@ void GitManager::loadGlobalUserInfo()
     }
 }
 
-void GitManager::runAsyncGitCommand(const QStringList &args, const QString &successMsg, const QString &errorPrefix)
+void GitManager::runAsyncGitCommand(const QStringList &args, const QString &successMsg, const QString &errorPrefix,
+                                    const QString &workingDirectory)
 {
-    if (m_repoPath.isEmpty()) {
+    QString workDir = workingDirectory.isEmpty() ? m_repoPath : workingDirectory;
+    if (workDir.isEmpty()) {
         setLoading(false);
         setError("未选择仓库");
         return;
     }
     
-    // If async process is already running, wait for it
-    if (m_asyncProcess->state() != QProcess::NotRunning) {
+    // If async command is already running, wait for it
+    if (m_asyncBusy) {
         setLoading(false);
         setError("有操作正在进行中，请稍候");
         return;
     }
     
+    m_asyncBusy = true;
     m_asyncSuccessMsg = successMsg;
     m_asyncErrorPrefix = errorPrefix;
     
-    m_asyncProcess->setWorkingDirectory(m_repoPath);
-    m_asyncProcess->start("git", args);
+    // 网络操作请求进度输出，便于显示进度并让用户中途取消
+    static const QHash<QString, QString> operationNames = {
+        {"push", "推送"}, {"pull", "拉取"}, {"fetch", "获取"}, {"clone", "克隆"},
+        {"reset", "取消暂存"}, {"rm", "取消暂存"}
+    };
+    QString command = args.value(0);
+    QStringList gitArgs = args;
+    if ((command == "push" || command == "pull" || command == "fetch" || command == "clone")
+        && !gitArgs.contains("--progress")) {
+        gitArgs.insert(1, "--progress");
+    }
+    
+    std::shared_ptr<GitCancelToken> token = beginOperation(operationNames.value(command, command));
+    
+    // 克隆被取消时需要删除不完整的目标目录（仅限本次克隆新建的目录）
+    QString cloneTarget = command == "clone" ? m_cloneTargetPath : QString();
+    bool cloneTargetExisted = !cloneTarget.isEmpty() && QFileInfo::exists(cloneTarget);
+    
+    // 按命令类型放入仓库调度器：push/pull/clone 等写操作与其他写操作串行执行
+    GitOperationQueue::Kind kind = GitOperationQueue::classify(gitArgs);
+    QFuture<GitResult> future = GitOperationQueue::forRepo(workDir)->run(kind,
+        [workDir, gitArgs, token, command, cloneTarget, cloneTargetExisted]() -> GitResult {
+        GitProcess process(workDir, token);
+        // 网络操作带 --progress，持续有输出；2 分钟既无输出也不占 CPU 视为卡死（例如网络中断）
+        GitResult result = process.run(gitArgs, 120000);
+        
+        if (result.cancelled || result.stalled) {
+            // 回滚：pull 中断时中止未完成的合并，clone 中断时删除半成品目录
+            if (command == "pull" && QFileInfo::exists(GitLockManager::gitDir(workDir) + "/MERGE_HEAD")) {
+                GitProcess(workDir).run({"merge", "--abort"});
+            }
+            if (command == "clone" && !cloneTargetExisted && !cloneTarget.isEmpty()) {
+                QDir(cloneTarget).removeRecursively();
+            }
+        }
+        return result;
+    });
+    
+    QFutureWatcher<GitResult> *watcher = new QFutureWatcher<GitResult>(this);
+    connect(watcher, &QFutureWatcher<GitResult>::finished, this, [this, watcher, token]() {
+        GitResult result = watcher->result();
+        m_asyncBusy = false;
+        endOperation(token);
+        finishAsyncGitCommand(result, token->operationName());
+        watcher->deleteLater();
+    });
+    watcher->setFuture(future);
+}
+
+void GitManager::finishAsyncGitCommand(const GitResult &result, const QString &operation)
+{
+    setLoading(false);
+    
+    // Disable bulk operation mode after any async operation
+    if (m_bulkOperationMode) {
+        setBulkOperationMode(false);
+    }
+    
+    QString output = result.outputText();
+    QString errorOutput = result.errorText();
+    
+    if (result.cancelled) {
+        m_cloneTargetPath.clear();
+        emit operationSuccess("已取消" + operation);
+    } else if (result.exitCode != 0) {
+        setError(m_asyncErrorPrefix + ": " + (errorOutput.isEmpty() ? output : errorOutput));
+    } else {
+        // Special handling for clone - set repo path after success
+        if (m_asyncSuccessMsg == "克隆成功" && !m_cloneTargetPath.isEmpty()) {
+            setRepoPath(m_cloneTargetPath);
+            m_cloneTargetPath.clear();
+        }
+        emit operationSuccess(m_asyncSuccessMsg);
+        
+        // Auto refresh remote files if it was a file operation
+        if (m_asyncSuccessMsg.contains("已保存并推送") || 
+            m_asyncSuccessMsg.contains("已删除") ||
+            m_asyncSuccessMsg.contains("已重命名")) {
+            emit remoteFilesNeedRefresh();
+        }
+    }
+    refresh();
+}
+
+GitOperationQueue *GitManager::operationQueue() const
+{
+    return GitOperationQueue::forRepo(m_repoPath);
 }
 
-QVariantList GitManager::largeFilesList() const
+QList<LargeFileEntry> GitManager::largeFilesList() const
 {
     return m_largeFilesList;
 }
@@ -3192,81 +3237,84 @@ void GitManager::findLargeFiles(int minSizeMB)
     qint64 minSize = minSizeMB * 1024 * 1024;
     
     // Run in background thread
-    QFuture<QVariantList> future = QtConcurrent::run([repoPath, minSize]() -> QVariantList {
-        QVariantList result;
-        QProcess process;
-        process.setWorkingDirectory(repoPath);
+    QFuture<QPair<QList<LargeFileEntry>, QString>> future = GitOperationQueue::forRepo(repoPath)->run(GitOperationQueue::Read, [repoPath, minSize]() -> QPair<QList<LargeFileEntry>, QString> {
+        QList<LargeFileEntry> result;
+        GitProcess process(repoPath);
         
         // Step 1: Get all objects with their paths using rev-list
-        process.start("git", {"rev-list", "--objects", "--all"});
-        process.waitForFinished(60000);
-        QString objects = QString::fromUtf8(process.readAllStandardOutput());
-        
-        QMap<QString, QString> hashToPath;
-        QStringList objLines = objects.split('\n', Qt::SkipEmptyParts);
-        for (const QString &line : objLines) {
-            int spaceIdx = line.indexOf(' ');
-            if (spaceIdx > 0) {
-                QString hash = line.left(spaceIdx);
-                QString path = line.mid(spaceIdx + 1);
-                if (!path.isEmpty()) {
-                    hashToPath[hash] = path;
-                }
-            }
+        // 大仓库上可能运行数分钟，看门狗只在没有输出、也不消耗 CPU 时才终止
+        GitResult gitResult = process.run({"rev-list", "--objects", "--all"});
+        if (!gitResult.ok()) {
+            return qMakePair(result, gitResult.errorText());
         }
+        QByteArray objects = gitResult.output;
         
         // Step 2: Get sizes for ALL objects (both packed and loose) using cat-file --batch-check
         // This is the most reliable method
-        QMap<QString, qint64> objectSizes;
-        
-        // Batch check all blob objects for their sizes
-        process.start("git", {"cat-file", "--batch-check=%(objectname) %(objecttype) %(objectsize)", "--batch-all-objects"});
-        process.waitForFinished(120000);
-        QString batchOutput = QString::fromUtf8(process.readAllStandardOutput());
-        
-        QStringList batchLines = batchOutput.split('\n', Qt::SkipEmptyParts);
-        for (const QString &line : batchLines) {
-            QStringList parts = line.split(' ', Qt::SkipEmptyParts);
-            if (parts.size() >= 3 && parts[1] == "blob") {
-                QString hash = parts[0];
-                qint64 size = parts[2].toLongLong();
-                if (size >= minSize) {
-                    objectSizes[hash] = size;
-                }
+        gitResult = process.run({"cat-file", "--batch-check=%(objectname) %(objecttype) %(objectsize)", "--batch-all-objects"});
+        if (!gitResult.ok()) {
+            return qMakePair(result, gitResult.errorText());
+        }
+        
+        QElapsedTimer parseTimer;
+        parseTimer.start();
+        
+        // 先筛出超过阈值的 blob（通常只有几个），键直接引用输出缓冲区，不为每个对象分配字符串
+        QHash<QByteArrayView, qint64> objectSizes;
+        GitTokenizer::forEachLine(gitResult.output, [&objectSizes, minSize](QByteArrayView line) {
+            auto parts = GitTokenizer::split<3>(line, ' ');
+            if (parts.count < 3 || parts[1] != "blob") return;
+            qint64 size = GitTokenizer::toInt64(parts[2]);
+            if (size >= minSize) {
+                objectSizes.insert(parts[0], size);
             }
+        });
+        
+        // Step 3: 再扫描 rev-list 的 "<hash> <path>" 行，只为大文件记录路径
+        // （以前为历史中的每个对象都建一份 hash -> path 的 QMap）
+        QHash<QByteArrayView, QByteArrayView> hashToPath;
+        if (!objectSizes.isEmpty()) {
+            GitTokenizer::forEachLine(objects, [&objectSizes, &hashToPath](QByteArrayView line) {
+                qsizetype spaceIdx = GitTokenizer::indexOf(line, ' ');
+                if (spaceIdx <= 0 || spaceIdx + 1 >= line.size()) return;
+                QByteArrayView hash = line.first(spaceIdx);
+                if (objectSizes.contains(hash)) {
+                    hashToPath.insert(hash, line.sliced(spaceIdx + 1));
+                }
+            });
         }
         
-        // Step 3: Build result list - only include objects that have a file path
-        for (auto it = objectSizes.begin(); it != objectSizes.end(); ++it) {
-            QString hash = it.key();
-            qint64 size = it.value();
-            QString path = hashToPath.value(hash, "");
-            
-            // Only include if we have a valid file path
-            if (!path.isEmpty()) {
-                QVariantMap fileInfo;
-                fileInfo["hash"] = hash;
-                fileInfo["path"] = path;
-                fileInfo["size"] = size;
-                fileInfo["sizeStr"] = QString::number(size / 1024.0 / 1024.0, 'f', 2) + " MB";
-                result.append(fileInfo);
-            }
+        // Build result list - only include objects that have a file path
+        GitPathTable *pathTable = GitPathTable::forRepo(repoPath);
+        for (auto it = hashToPath.cbegin(); it != hashToPath.cend(); ++it) {
+            LargeFileEntry entry;
+            entry.hash = GitTokenizer::toString(it.key());
+            entry.path = internGitPath(pathTable, it.value());
+            entry.size = objectSizes.value(it.key());
+            result.append(entry);
         }
         
+        qDebug() << "Large files:" << GitTokenizer::count(objects, '\n') << "objects scanned in"
+                 << parseTimer.elapsed() << "ms," << result.size() << "above threshold";
+        
         // Sort by size descending
-        std::sort(result.begin(), result.end(), [](const QVariant &a, const QVariant &b) {
-            return a.toMap()["size"].toLongLong() > b.toMap()["size"].toLongLong();
+        std::sort(result.begin(), result.end(), [](const LargeFileEntry &a, const LargeFileEntry &b) {
+            return a.size > b.size;
         });
         
-        return result;
+        return qMakePair(result, QString());
     });
     
     // Watch for completion
-    QFutureWatcher<QVariantList> *watcher = new QFutureWatcher<QVariantList>(this);
-    connect(watcher, &QFutureWatcher<QVariantList>::finished, this, [this, watcher]() {
-        m_largeFilesList = watcher->result();
+    QFutureWatcher<QPair<QList<LargeFileEntry>, QString>> *watcher = new QFutureWatcher<QPair<QList<LargeFileEntry>, QString>>(this);
+    connect(watcher, &QFutureWatcher<QPair<QList<LargeFileEntry>, QString>>::finished, this, [this, watcher]() {
+        auto result = watcher->result();
+        m_largeFilesList = result.first;
         setLoading(false);
         emit largeFilesChanged();
+        if (!result.second.isEmpty()) {
+            setError("扫描大文件失败: " + result.second);
+        }
         watcher->deleteLater();
     });
     
@@ -3281,57 +3329,62 @@ void GitManager::removeLargeFileFromHistory(const QString &filePath)
     
     // Run in a separate thread using QtConcurrent
     QString repoPath = m_repoPath;
+    std::shared_ptr<GitCancelToken> token = beginOperation("清理历史大文件");
     
-    QFuture<bool> future = QtConcurrent::run([repoPath, filePath]() -> bool {
-        QProcess process;
-        process.setWorkingDirectory(repoPath);
+    QFuture<bool> future = GitOperationQueue::forRepo(repoPath)->run(GitOperationQueue::Write, [repoPath, filePath, token]() -> bool {
+        GitProcess process(repoPath, token);
+        // filter-branch 把 "Rewrite <sha> (n/total)" 进度打印在 stdout
+        process.setProgressOnStdout(true);
         
         // Use git filter-branch to remove file from history
         QString filterCmd = QString("git rm --cached --ignore-unmatch \"%1\"").arg(filePath);
         
-        process.start("git", {"filter-branch", "--force", "--index-filter", 
-                              filterCmd, "--prune-empty", "--tag-name-filter", "cat", "--", "--all"});
-        process.waitForFinished(300000); // 5 minutes timeout
+        token->reportProgress("重写历史", 0);
+        GitResult result = process.run({"filter-branch", "--force", "--index-filter",
+                                        filterCmd, "--prune-empty", "--tag-name-filter", "cat", "--", "--all"},
+                                       300000); // 5 minutes timeout
         
-        int exitCode = process.exitCode();
-        QString errorOutput = QString::fromUtf8(process.readAllStandardError());
+        if (result.cancelled) {
+            // 回滚：filter-branch 只在全部重写完成后才更新 refs，中途终止时 refs 保持原样，
+            // 只需删除它留下的临时目录（否则下次运行会报 ".git-rewrite already exists"）
+            QDir(repoPath + "/.git-rewrite").removeRecursively();
+            return false;
+        }
         
-        if (exitCode != 0 && !errorOutput.contains("Ref 'refs/heads")) {
+        QString errorOutput = result.errorText();
+        if (result.exitCode != 0 && !errorOutput.contains("Ref 'refs/heads")) {
             return false;
         }
         
+        // 以下为清理步骤：历史已重写完成，此后取消只是跳过清理，不影响仓库一致性
         // Clean up refs
-        process.start("git", {"for-each-ref", "--format=%(refname)", "refs/original/"});
-        process.waitForFinished(10000);
-        QString refs = QString::fromUtf8(process.readAllStandardOutput()).trimmed();
-        
-        if (!refs.isEmpty()) {
-            QStringList refList = refs.split('\n', Qt::SkipEmptyParts);
-            for (const QString &ref : refList) {
-                process.start("git", {"update-ref", "-d", ref});
-                process.waitForFinished(5000);
-            }
-        }
+        token->reportProgress("清理备份引用", -1);
+        GitResult refs = process.run({"for-each-ref", "--format=%(refname)", "refs/original/"}, 10000);
+        GitTokenizer::forEachLine(refs.output, [&process](QByteArrayView ref) {
+            process.run({"update-ref", "-d", GitTokenizer::toString(ref)}, 5000);
+        });
         
         // Expire reflog
-        process.start("git", {"reflog", "expire", "--expire=now", "--all"});
-        process.waitForFinished(30000);
+        process.run({"reflog", "expire", "--expire=now", "--all"}, 30000);
         
         // Garbage collect
-        process.start("git", {"gc", "--prune=now", "--aggressive"});
-        process.waitForFinished(120000);
+        token->reportProgress("压缩仓库", -1);
+        process.run({"gc", "--prune=now", "--aggressive"}, 120000);
         
         return true;
     });
     
     // Watch for completion
     QFutureWatcher<bool> *watcher = new QFutureWatcher<bool>(this);
-    connect(watcher, &QFutureWatcher<bool>::finished, this, [this, watcher, filePath]() {
+    connect(watcher, &QFutureWatcher<bool>::finished, this, [this, watcher, filePath, token]() {
         bool success = watcher->result();
+        endOperation(token);
         setLoading(false);
         
         if (success) {
             emit operationSuccess("已从历史中清理: " + filePath + "\n请点击强制推送更新远程仓库");
+        } else if (token->isCancelled()) {
+            emit operationSuccess("已取消清理，提交历史未被修改");
         } else {
             setError("清理失败，请检查文件路径");
         }
@@ -3359,28 +3412,34 @@ void GitManager::pushWithUnrelatedHistories()
     
     QString repoPath = m_repoPath;
     QString branch = m_currentBranch;
+    std::shared_ptr<GitCancelToken> token = beginOperation("合并推送");
     
     // 在后台线程执行
-    QFuture<QPair<bool, QString>> future = QtConcurrent::run([repoPath, branch]() -> QPair<bool, QString> {
-        QProcess process;
-        process.setWorkingDirectory(repoPath);
+    QFuture<QPair<bool, QString>> future = GitOperationQueue::forRepo(repoPath)->run(GitOperationQueue::Write, [repoPath, branch, token]() -> QPair<bool, QString> {
+        GitProcess process(repoPath, token);
         
         // 步骤 1: 先拉取并合并不相关的历史
-        process.start("git", {"pull", "origin", branch, "--allow-unrelated-histories", "--no-edit"});
-        process.waitForFinished(120000);
+        GitResult result = process.run({"pull", "--progress", "origin", branch, "--allow-unrelated-histories", "--no-edit"}, 120000);
         
-        if (process.exitCode() != 0) {
-            QString err = QString::fromUtf8(process.readAllStandardError()).trimmed();
-            return qMakePair(false, QString("拉取失败: ") + err);
+        if (result.cancelled) {
+            // 回滚：中止拉取产生的未完成合并
+            if (QFileInfo::exists(GitLockManager::gitDir(repoPath) + "/MERGE_HEAD")) {
+                GitProcess(repoPath).run({"merge", "--abort"});
+            }
+            return qMakePair(false, QString());
+        }
+        if (result.exitCode != 0) {
+            return qMakePair(false, QString("拉取失败: ") + result.errorText());
         }
         
         // 步骤 2: 推送
-        process.start("git", {"push", "-u", "origin", branch});
-        process.waitForFinished(120000);
+        result = process.run({"push", "--progress", "-u", "origin", branch}, 120000);
         
-        if (process.exitCode() != 0) {
-            QString err = QString::fromUtf8(process.readAllStandardError()).trimmed();
-            return qMakePair(false, QString("推送失败: ") + err);
+        if (result.cancelled) {
+            return qMakePair(false, QString());
+        }
+        if (result.exitCode != 0) {
+            return qMakePair(false, QString("推送失败: ") + result.errorText());
         }
         
         return qMakePair(true, QString());
@@ -3388,13 +3447,17 @@ void GitManager::pushWithUnrelatedHistories()
     
     // 监听完成
     QFutureWatcher<QPair<bool, QString>> *watcher = new QFutureWatcher<QPair<bool, QString>>(this);
-    connect(watcher, &QFutureWatcher<QPair<bool, QString>>::finished, this, [this, watcher]() {
+    connect(watcher, &QFutureWatcher<QPair<bool, QString>>::finished, this, [this, watcher, token]() {
         auto result = watcher->result();
+        endOperation(token);
         setLoading(false);
         
         if (result.first) {
             emit operationSuccess("推送成功！");
             refresh();
+        } else if (token->isCancelled()) {
+            emit operationSuccess("已取消合并推送");
+            refresh();
         } else {
             setError(result.second);
         }
@@ -3429,33 +3492,133 @@ void GitManager::unlockRepository()
         return;
     }
     
-    QString lockFile = m_repoPath + "/.git/index.lock";
-    QFile file(lockFile);
-    
-    if (!file.exists()) {
+    if (GitLockManager::existingLockFiles(m_repoPath).isEmpty()) {
         emit operationSuccess("仓库未被锁定，无需解锁");
         return;
     }
     
-    if (file.remove()) {
-        emit operationSuccess("仓库解锁成功！现在可以继续操作了");
-        refresh();
-    } else {
-        setError("解锁失败：无法删除锁文件，请手动删除 .git/index.lock");
+    // 在写队列中检查（不预先等待）：本程序自己的写操作此时不会在运行，锁只可能属于外部进程或是残留
+    // 只删除已证实为残留的锁；有存活的进程持有时拒绝删除，避免损坏 index
+    QString repoPath = m_repoPath;
+    QFuture<QString> future = operationQueue()->run(GitOperationQueue::Write, [repoPath]() -> QString {
+        const QStringList lockFiles = GitLockManager::existingLockFiles(repoPath);
+        for (const QString &lockFile : lockFiles) {
+            GitLockManager::LockStatus status;
+            // 用户明确要求解锁：按年龄判断的残留锁也删除
+            if (GitLockManager::removeIfStale(repoPath, lockFile, &status, true)) {
+                continue;
+            }
+            if (status.state == GitLockManager::NoLock) {
+                continue;
+            }
+            
+            QString name = QFileInfo(lockFile).fileName();
+            if (status.state == GitLockManager::HeldByProcess) {
+                return QString("无法解锁：%1 正被进程（%2，PID %3）使用，请等待其完成")
+                           .arg(name, status.holderName).arg(status.holderPid);
+            }
+            if (status.state == GitLockManager::Unknown && status.holderPid > 0) {
+                return QString("无法解锁：Git 进程（%1，PID %2）仍在该仓库中运行，可能正在使用 %3，请等待其完成")
+                           .arg(status.holderName).arg(status.holderPid).arg(name);
+            }
+            if (status.state == GitLockManager::Unknown) {
+                return QString("无法解锁：%1 创建于 %2 秒前，可能仍被 Git 进程使用，请稍后再试")
+                           .arg(name).arg(status.ageMs / 1000);
+            }
+            return "解锁失败：无法删除锁文件，请手动删除 .git/" + name;
+        }
+        return QString();
+    }, -1);
+    
+    QFutureWatcher<QString> *watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, repoPath]() {
+        QString message = watcher->result();
+        if (repoPath == m_repoPath) {
+            if (message.isEmpty()) {
+                emit operationSuccess("仓库解锁成功！现在可以继续操作了");
+                refresh();
+            } else {
+                setError(message);
+            }
+        }
+        watcher->deleteLater();
+    });
+    watcher->setFuture(future);
+}
+
+std::shared_ptr<GitCancelToken> GitManager::beginOperation(const QString &name)
+{
+    std::shared_ptr<GitCancelToken> token = GitCancelToken::create(name);
+    
+    // 进度在工作线程中上报，切回主线程更新属性
+    QPointer<GitManager> self(this);
+    GitCancelToken *rawToken = token.get();
+    token->setProgressCallback([self, rawToken](const QString &phase, int percent) {
+        if (!self) return;
+        QMetaObject::invokeMethod(self.data(), [self, rawToken, phase, percent]() {
+            if (!self || self->m_activeOperations.isEmpty() || self->m_activeOperations.last().get() != rawToken) {
+                return;
+            }
+            if (self->m_progressPhase != phase || self->m_progressPercent != percent) {
+                self->m_progressPhase = phase;
+                self->m_progressPercent = percent;
+                emit self->operationProgressChanged();
+            }
+        }, Qt::QueuedConnection);
+    });
+    
+    m_activeOperations.append(token);
+    m_progressPhase.clear();
+    m_progressPercent = -1;
+    emit operationProgressChanged();
+    return token;
+}
+
+void GitManager::endOperation(const std::shared_ptr<GitCancelToken> &token)
+{
+    token->setProgressCallback(nullptr);
+    m_activeOperations.removeAll(token);
+    m_progressPhase.clear();
+    m_progressPercent = -1;
+    emit operationProgressChanged();
+}
+
+void GitManager::cancelOperation()
+{
+    for (const std::shared_ptr<GitCancelToken> &token : std::as_const(m_activeOperations)) {
+        token->cancel();
+    }
+    if (!m_activeOperations.isEmpty()) {
+        m_progressPhase = "正在取消...";
+        m_progressPercent = -1;
+        emit operationProgressChanged();
     }
 }
 
-QString GitManager::formatFileSize(qint64 size)
+bool GitManager::canCancel() const
 {
-    if (size < 1024) {
-        return QString::number(size) + " B";
-    } else if (size < 1024 * 1024) {
-        return QString::number(size / 1024.0, 'f', 1) + " KB";
-    } else if (size < 1024 * 1024 * 1024) {
-        return QString::number(size / (1024.0 * 1024.0), 'f', 1) + " MB";
-    } else {
-        return QString::number(size / (1024.0 * 1024.0 * 1024.0), 'f', 1) + " GB";
+    return !m_activeOperations.isEmpty();
+}
+
+QString GitManager::operationName() const
+{
+    return m_activeOperations.isEmpty() ? QString() : m_activeOperations.last()->operationName();
+}
+
+QString GitManager::progressText() const
+{
+    if (m_progressPhase.isEmpty()) {
+        return QString();
     }
+    if (m_progressPercent < 0) {
+        return m_progressPhase;
+    }
+    return m_progressPhase + " " + QString::number(m_progressPercent) + "%";
+}
+
+int GitManager::progressPercent() const
+{
+    return m_progressPercent;
 }
 
 void GitManager::initAndPushRepo(const QString &remoteUrl, const QString &branchName)
@@ -3481,42 +3644,37 @@ void GitManager::initAndPushRepo(const QString &remoteUrl, const QString &branch
     QString url = remoteUrl.trimmed();
     
     // 在后台线程执行所有操作
-    QFuture<QPair<bool, QString>> future = QtConcurrent::run([repoPath, url, branch]() -> QPair<bool, QString> {
-        QProcess process;
-        process.setWorkingDirectory(repoPath);
+    QFuture<QPair<bool, QString>> future = GitOperationQueue::forRepo(repoPath)->run(GitOperationQueue::Write, [repoPath, url, branch]() -> QPair<bool, QString> {
+        GitProcess process(repoPath);
         
         // 步骤 1: 检查是否已经是 Git 仓库
-        process.start("git", {"rev-parse", "--git-dir"});
-        process.waitForFinished(5000);
-        bool isGitRepo = (process.exitCode() == 0);
+        bool isGitRepo = process.run({"rev-parse", "--git-dir"}, 5000).ok();
         
         // 步骤 2: 如果不是 Git 仓库，初始化并设置初始分支
         if (!isGitRepo) {
-            process.start("git", {"init", "-b", branch});
-            process.waitForFinished(10000);
-            if (process.exitCode() != 0) {
+            GitResult result = process.run({"init", "-b", branch}, 10000);
+            if (!result.ok()) {
                 // 如果 -b 参数不支持（旧版本 Git），尝试传统方式
-                process.start("git", {"init"});
-                process.waitForFinished(10000);
-                if (process.exitCode() != 0) {
-                    QString err = QString::fromUtf8(process.readAllStandardError()).trimmed();
-                    return qMakePair(false, QString("初始化失败: ") + err);
+                result = process.run({"init"}, 10000);
+                if (!result.ok()) {
+                    return qMakePair(false, QString("初始化失败: ") + result.errorText());
                 }
                 
                 // 手动重命名分支（如果不是默认分支）
-                process.start("git", {"branch", "-M", branch});
-                process.waitForFinished(5000);
+                process.run({"branch", "-M", branch}, 5000);
                 // 忽略错误，因为可能还没有提交
             }
         }
         
         // 步骤 3: 检查远程仓库是否为空
         // 使用 git ls-remote 检查远程仓库的引用
-        process.start("git", {"ls-remote", "--heads", url});
-        process.waitForFinished(30000);
+        GitResult lsRemote = process.run({"ls-remote", "--heads", url});
+        if (lsRemote.stalled) {
+            return qMakePair(false, QString("连接远程仓库失败: ") + lsRemote.errorText());
+        }
         
-        if (process.exitCode() == 0) {
-            QString remoteRefs = QString::fromUtf8(process.readAllStandardOutput()).trimmed();
+        if (lsRemote.ok()) {
+            QString remoteRefs = lsRemote.outputText();
             
             // 如果有输出，说明远程仓库有分支（不是空的）
             if (!remoteRefs.isEmpty()) {
@@ -3526,25 +3684,19 @@ void GitManager::initAndPushRepo(const QString &remoteUrl, const QString &branch
         // 如果 ls-remote 失败（比如仓库不存在或网络问题），继续执行，让后续步骤报错
         
         // 步骤 4: 检查是否已有远程仓库
-        process.start("git", {"remote", "get-url", "origin"});
-        process.waitForFinished(5000);
-        bool hasRemote = (process.exitCode() == 0);
+        bool hasRemote = process.run({"remote", "get-url", "origin"}, 5000).ok();
         
         if (hasRemote) {
             // 如果已有远程仓库，更新 URL
-            process.start("git", {"remote", "set-url", "origin", url});
-            process.waitForFinished(5000);
-            if (process.exitCode() != 0) {
-                QString err = QString::fromUtf8(process.readAllStandardError()).trimmed();
-                return qMakePair(false, QString("更新远程仓库失败: ") + err);
+            GitResult result = process.run({"remote", "set-url", "origin", url}, 5000);
+            if (!result.ok()) {
+                return qMakePair(false, QString("更新远程仓库失败: ") + result.errorText());
             }
         } else {
             // 添加远程仓库
-            process.start("git", {"remote", "add", "origin", url});
-            process.waitForFinished(5000);
-            if (process.exitCode() != 0) {
-                QString err = QString::fromUtf8(process.readAllStandardError()).trimmed();
-                return qMakePair(false, QString("添加远程仓库失败: ") + err);
+            GitResult result = process.run({"remote", "add", "origin", url}, 5000);
+            if (!result.ok()) {
+                return qMakePair(false, QString("添加远程仓库失败: ") + result.errorText());
             }
         }
         
@@ -8,7 +8,21 @@
 #include <QVariantMap>
 #include <QFileSystemWatcher>
 #include <QTimer>
+#include <QAtomicInt>
 #include <qqml.h>
+#include <memory>
+#include "gitentries.h"
+#include "repofilemodel.h"
+#include "revisionbrowsermodel.h"
+#include "commithistorymodel.h"
+#include "fileblamemodel.h"
+#include "commitdiffmodel.h"
+#include "diffmodel.h"
+#include "sidebysidediffmodel.h"
+
+class GitOperationQueue;
+class GitCancelToken;
+struct GitResult;
 
 class GitManager : public QObject
 {
@@ -19,26 +33,38 @@ class GitManager : public QObject
     Q_PROPERTY(QStringList branches READ branches NOTIFY branchesChanged)
     Q_PROPERTY(QStringList localBranches READ localBranches NOTIFY branchesChanged)
     Q_PROPERTY(QStringList remoteBranches READ remoteBranches NOTIFY branchesChanged)
-    Q_PROPERTY(QVariantList changedFiles READ changedFiles NOTIFY changedFilesChanged)
-    Q_PROPERTY(QVariantList stagedFiles READ stagedFiles NOTIFY stagedFilesChanged)
+    Q_PROPERTY(QList<StatusEntry> changedFiles READ changedFiles NOTIFY changedFilesChanged)
+    Q_PROPERTY(QList<StatusEntry> stagedFiles READ stagedFiles NOTIFY stagedFilesChanged)
     Q_PROPERTY(bool isLoading READ isLoading NOTIFY isLoadingChanged)
     Q_PROPERTY(QString lastError READ lastError NOTIFY lastErrorChanged)
     Q_PROPERTY(bool isValidRepo READ isValidRepo NOTIFY isValidRepoChanged)
-    Q_PROPERTY(QVariantList repoFiles READ repoFiles NOTIFY repoFilesChanged)
+    Q_PROPERTY(RepoFileModel *repoFiles READ repoFiles CONSTANT)
     Q_PROPERTY(QString currentPath READ currentPath NOTIFY currentPathChanged)
     Q_PROPERTY(QString fileContent READ fileContent NOTIFY fileContentChanged)
-    Q_PROPERTY(QVariantList remoteFiles READ remoteFiles NOTIFY remoteFilesChanged)
+    Q_PROPERTY(QList<TreeEntry> remoteFiles READ remoteFiles NOTIFY remoteFilesChanged)
     Q_PROPERTY(QString remoteCurrentPath READ remoteCurrentPath NOTIFY remoteCurrentPathChanged)
     Q_PROPERTY(QString remoteUrl READ remoteUrl NOTIFY remoteUrlChanged)
-    Q_PROPERTY(QVariantList commitHistory READ commitHistory NOTIFY commitHistoryChanged)
-    Q_PROPERTY(QVariantMap lastCommit READ lastCommit NOTIFY commitHistoryChanged)
+    Q_PROPERTY(int remoteFetchTtl READ remoteFetchTtl WRITE setRemoteFetchTtl NOTIFY remoteFetchTtlChanged)
+    Q_PROPERTY(bool diffCacheOnDisk READ diffCacheOnDisk WRITE setDiffCacheOnDisk NOTIFY diffCacheOnDiskChanged)
+    Q_PROPERTY(RevisionBrowserModel *revisionBrowser READ revisionBrowser CONSTANT)
+    Q_PROPERTY(CommitHistoryModel *history READ history CONSTANT)
+    Q_PROPERTY(CommitHistoryModel *fileHistory READ fileHistory CONSTANT)
+    Q_PROPERTY(FileBlameModel *blame READ blame CONSTANT)
+    Q_PROPERTY(CommitDiffModel *commitDiff READ commitDiff CONSTANT)
+    Q_PROPERTY(DiffModel *diff READ diff CONSTANT)
+    Q_PROPERTY(SideBySideDiffModel *diffSplit READ diffSplit CONSTANT)
+    Q_PROPERTY(CommitEntry lastCommit READ lastCommit NOTIFY commitHistoryChanged)
     Q_PROPERTY(QStringList lastCommitFiles READ lastCommitFiles NOTIFY commitHistoryChanged)
     Q_PROPERTY(QString lastCommitTime READ lastCommitTime NOTIFY lastCommitTimeChanged)
     Q_PROPERTY(QString userName READ userName NOTIFY userInfoChanged)
     Q_PROPERTY(QString userEmail READ userEmail NOTIFY userInfoChanged)
     Q_PROPERTY(QString userAvatar READ userAvatar NOTIFY userInfoChanged)
     Q_PROPERTY(QStringList recentReposList READ recentRepos NOTIFY recentReposChanged)
-    Q_PROPERTY(QVariantList largeFilesList READ largeFilesList NOTIFY largeFilesChanged)
+    Q_PROPERTY(QList<LargeFileEntry> largeFilesList READ largeFilesList NOTIFY largeFilesChanged)
+    Q_PROPERTY(bool canCancel READ canCancel NOTIFY operationProgressChanged)
+    Q_PROPERTY(QString operationName READ operationName NOTIFY operationProgressChanged)
+    Q_PROPERTY(QString progressText READ progressText NOTIFY operationProgressChanged)
+    Q_PROPERTY(int progressPercent READ progressPercent NOTIFY operationProgressChanged)
 
 public:
     explicit GitManager(QObject *parent = nullptr);
@@ -50,8 +76,8 @@ public:
     QStringList branches() const;
     QStringList localBranches() const;
     QStringList remoteBranches() const;
-    QVariantList changedFiles() const;
-    QVariantList stagedFiles() const;
+    QList<StatusEntry> changedFiles() const;
+    QList<StatusEntry> stagedFiles() const;
     bool isLoading() const;
     QString lastError() const;
     bool isValidRepo() const;
@@ -86,11 +112,11 @@ public:
     Q_INVOKABLE void loadRepoFiles(const QString &subPath = "");
     Q_INVOKABLE void openFile(const QString &filePath);
     Q_INVOKABLE void openFileLocation(const QString &filePath);
-    Q_INVOKABLE QVariantList getFileDiff(const QString &filePath, bool staged = false);
     Q_INVOKABLE void saveFile(const QString &filePath, const QString &content);
     Q_INVOKABLE void deleteRepoFile(const QString &filePath);
     Q_INVOKABLE void goBack();
-    Q_INVOKABLE void loadRemoteFiles(const QString &subPath = "");
+    // forceFetch 为 true 时忽略有效期，先 fetch 再列出（手动刷新）
+    Q_INVOKABLE void loadRemoteFiles(const QString &subPath = "", bool forceFetch = false);
     Q_INVOKABLE void goBackRemote();
     Q_INVOKABLE void deleteRemoteFile(const QString &filePath, const QString &message);
     Q_INVOKABLE void saveAndPushFile(const QString &filePath, const QString &content, const QString &message);
@@ -111,17 +137,33 @@ public:
     Q_INVOKABLE void initAndPushRepo(const QString &remoteUrl, const QString &branchName);
     Q_INVOKABLE void pushWithUnrelatedHistories();
     Q_INVOKABLE void unlockRepository();
+    Q_INVOKABLE void cancelOperation();
     
-    QVariantList largeFilesList() const;
+    QList<LargeFileEntry> largeFilesList() const;
+    bool canCancel() const;
+    QString operationName() const;
+    QString progressText() const;
+    int progressPercent() const;
 
-    QVariantList repoFiles() const;
+    RepoFileModel *repoFiles() const;
     QString currentPath() const;
     QString fileContent() const;
-    QVariantList remoteFiles() const;
+    QList<TreeEntry> remoteFiles() const;
     QString remoteCurrentPath() const;
     QString remoteUrl() const;
-    QVariantList commitHistory() const;
-    QVariantMap lastCommit() const;
+    int remoteFetchTtl() const;
+    void setRemoteFetchTtl(int seconds);
+    // 差异缓存是否写盘（默认关闭）
+    bool diffCacheOnDisk() const;
+    void setDiffCacheOnDisk(bool enabled);
+    RevisionBrowserModel *revisionBrowser() const;
+    CommitHistoryModel *history() const;
+    CommitHistoryModel *fileHistory() const;
+    FileBlameModel *blame() const;
+    CommitDiffModel *commitDiff() const;
+    DiffModel *diff() const;
+    SideBySideDiffModel *diffSplit() const;
+    CommitEntry lastCommit() const;
     QStringList lastCommitFiles() const;
     QString lastCommitTime() const;
     QString userName() const;
@@ -137,12 +179,13 @@ signals:
     void isLoadingChanged();
     void lastErrorChanged();
     void isValidRepoChanged();
-    void repoFilesChanged();
     void currentPathChanged();
     void fileContentChanged();
     void remoteFilesChanged();
     void remoteCurrentPathChanged();
     void remoteUrlChanged();
+    void remoteFetchTtlChanged();
+    void diffCacheOnDiskChanged();
     void commitHistoryChanged();
     void userInfoChanged();
     void operationSuccess(const QString &message);
@@ -151,11 +194,14 @@ signals:
     void largeFilesChanged();
     void remoteFilesNeedRefresh();
     void lastCommitTimeChanged();
+    void operationProgressChanged();
 
 private:
     QString runGitCommand(const QStringList &args);
     void parseStatus();
     void parseStatusAsync(bool showLoading = true);
+    void applyStatusBatch(int generation, const QList<StatusEntry> &changedFiles,
+                          const QList<StatusEntry> &stagedFiles, bool reset, bool last, bool showLoading);
     void updateBranches();
     void setLoading(bool loading);
     void setError(const QString &error);
@@ -165,25 +211,47 @@ private:
     void watchDirectory(const QString &path, int depth = 0);
     void watchDirectoryRecursively(const QString &path, int depth = 0);
     void cleanupFileWatcherAsync();
-    static QString decodeOctalEscapes(const QString &input);
-    static QString formatFileSize(qint64 size);
+    static QStringList parseLocalBranches(QByteArrayView output);
+    static QStringList parseRemoteBranches(QByteArrayView output, const QStringList &localBranches);
+    static void parseStatusOutput(QByteArrayView output, GitPathTable *pathTable, const QString &sizeRoot,
+                                  QList<StatusEntry> &changedFiles, QList<StatusEntry> &stagedFiles);
     void loadGlobalUserInfo();
-    void runAsyncGitCommand(const QStringList &args, const QString &successMsg, const QString &errorPrefix);
+    void runAsyncGitCommand(const QStringList &args, const QString &successMsg, const QString &errorPrefix,
+                            const QString &workingDirectory = QString());
+    void finishAsyncGitCommand(const GitResult &result, const QString &operation);
+    void prefetchRemoteChildren();
+    void refreshRemoteTreeInBackground();
+    GitOperationQueue *operationQueue() const;
+    template <typename Work, typename Done>
+    void runWrite(Work work, Done done);
+    std::shared_ptr<GitCancelToken> beginOperation(const QString &name);
+    void endOperation(const std::shared_ptr<GitCancelToken> &token);
 
     QString m_repoPath;
     QString m_currentBranch;
     QStringList m_branches;
     QStringList m_localBranches;
     QStringList m_remoteBranches;
-    QVariantList m_changedFiles;
-    QVariantList m_stagedFiles;
-    QVariantList m_repoFiles;
+    QList<StatusEntry> m_changedFiles;
+    QList<StatusEntry> m_stagedFiles;
+    int m_statusGeneration = 0;  // 每次 parseStatusAsync 递增，丢弃过期刷新的结果
+    RepoFileModel *m_repoFileModel = nullptr;
     QString m_currentPath;
     QString m_fileContent;
-    QVariantList m_remoteFiles;
+    QList<TreeEntry> m_remoteFiles;
     QString m_remoteCurrentPath;
     QString m_remoteUrl;
-    QVariantList m_commitHistory;
+    QString m_remoteTrackingRef;   // 当前远程浏览对应的跟踪分支（origin/<branch>）
+    QString m_remoteTrackingHash;  // 该分支最近一次解析到的提交，远程目录缓存的键
+    int m_remoteFetchTtl = 300;
+    RevisionBrowserModel *m_revisionBrowser = nullptr;
+    bool m_remoteFetchInFlight = false;
+    CommitHistoryModel *m_historyModel = nullptr;
+    CommitHistoryModel *m_fileHistoryModel = nullptr;
+    FileBlameModel *m_blameModel = nullptr;
+    CommitDiffModel *m_commitDiffModel = nullptr;
+    DiffModel *m_diffModel = nullptr;
+    SideBySideDiffModel *m_diffSplitModel = nullptr;
     QString m_userName;
     QString m_userEmail;
     bool m_isLoading = false;
@@ -196,14 +264,19 @@ private:
     QTimer *m_refreshTimer = nullptr;
     bool m_pendingRefresh = false;
     
-    // Async process for long operations
-    QProcess *m_asyncProcess = nullptr;
+    // Async git command for long operations (runs on the repo's write queue)
+    bool m_asyncBusy = false;
+    
+    // Cancellable operations currently running (latest one drives the progress display)
+    QList<std::shared_ptr<GitCancelToken>> m_activeOperations;
+    QString m_progressPhase;
+    int m_progressPercent = -1;
     QString m_asyncSuccessMsg;
     QString m_asyncErrorPrefix;
     QString m_cloneTargetPath;  // For clone operation
     
     // Large files list
-    QVariantList m_largeFilesList;
+    QList<LargeFileEntry> m_largeFilesList;
     
     // File watcher setup flag to prevent infinite loops
     bool m_settingUpWatcher = false;
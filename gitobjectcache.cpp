@@ -0,0 +1,213 @@
+#include "gitobjectcache.h"
+#include "gitencoding.h"
+#include "gitprocess.h"
+#include "gittokenizer.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <algorithm>
+
+namespace {
+
+// 与 git 判断二进制文件的方式一致：前 8000 字节中出现 NUL
+constexpr qsizetype kBinaryProbeBytes = 8000;
+
+} // namespace
+
+GitObjectCache *GitObjectCache::forRepo(const QString &repoPath)
+{
+    return GitRepoRegistry<GitObjectCache>::instance(repoPath, [&repoPath]() {
+        return new GitObjectCache(repoPath);
+    });
+}
+
+bool GitObjectCache::resolveRevision(const QString &revision, QString *commitHash, QString *treeOid, QString *error)
+{
+    if (revision.isEmpty() || revision.startsWith('-')) {
+        if (error) *error = QString("无效的版本：%1").arg(revision);
+        return false;
+    }
+
+    // 一次 rev-parse 同时得到提交和根树（标签会被解引用到它指向的提交）
+    GitResult result = GitProcess(m_repoPath).run({"rev-parse", revision + "^{commit}", revision + "^{tree}"}, 10000);
+    const QStringList hashes = result.outputText().split('\n', Qt::SkipEmptyParts);
+    if (!result.ok() || hashes.size() != 2) {
+        if (error) {
+            *error = result.stalled ? result.errorText() : QString("找不到版本：%1").arg(revision);
+        }
+        return false;
+    }
+    *commitHash = hashes[0].trimmed();
+    *treeOid = hashes[1].trimmed();
+    return true;
+}
+
+bool GitObjectCache::lookupTree(const QString &treeOid, QList<GitTreeItem> *items) const
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_trees.constFind(treeOid);
+    if (it == m_trees.constEnd()) {
+        return false;
+    }
+    *items = it.value();
+    return true;
+}
+
+bool GitObjectCache::lookupBlob(const QString &blobOid, GitBlobPreview *preview) const
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_blobs.constFind(blobOid);
+    if (it == m_blobs.constEnd()) {
+        return false;
+    }
+    *preview = it.value();
+    return true;
+}
+
+QList<GitTreeItem> GitObjectCache::tree(const QString &treeOid, QString *error)
+{
+    QList<GitTreeItem> items;
+    if (treeOid.isEmpty() || lookupTree(treeOid, &items)) {
+        return items;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // -z：名称不加引号、不转义，记录以 NUL 结尾
+    GitResult result = GitProcess(m_repoPath).run({"ls-tree", "-l", "-z", treeOid});
+    if (!result.ok()) {
+        if (error) *error = result.errorText();
+        return items;
+    }
+
+    // "<mode> <type> <object> <size>\t<name>\0"
+    GitTokenizer::forEachRecord(result.output, '\0', [&items](QByteArrayView record) {
+        auto columns = GitTokenizer::split<2>(record, '\t');
+        if (columns.count < 2 || columns[1].isEmpty()) return;
+        auto meta = GitTokenizer::splitWhitespace<4>(columns[0]);
+        if (meta.count < 4) return;
+
+        GitTreeItem item;
+        item.name = GitEncoding::decode(columns[1]);
+        item.oid = GitTokenizer::toString(meta[2]);
+        item.type = meta[1] == "tree" ? TreeEntry::Tree
+                  : meta[1] == "commit" ? TreeEntry::Submodule
+                  : TreeEntry::Blob;
+        item.size = (meta[3] == "-") ? 0 : GitTokenizer::toInt64(meta[3]);
+        items.append(item);
+    });
+
+    // 与其他文件列表一致：目录在前，按名称排序
+    std::sort(items.begin(), items.end(), [](const GitTreeItem &a, const GitTreeItem &b) {
+        if (a.isDir() != b.isDir()) {
+            return a.isDir();
+        }
+        return a.name < b.name;
+    });
+
+    qDebug() << "Read tree" << treeOid.left(8) << ":" << items.size() << "entries in" << timer.elapsed() << "ms";
+
+    QMutexLocker locker(&m_mutex);
+    if (!m_trees.contains(treeOid)) {
+        m_treeOrder.append(treeOid);
+    }
+    m_trees.insert(treeOid, items);
+    while (m_treeOrder.size() > TreeCacheLimit) {
+        m_trees.remove(m_treeOrder.takeFirst());
+    }
+    return items;
+}
+
+GitBlobPreview GitObjectCache::blob(const QString &blobOid, qint64 size, QString *error)
+{
+    GitBlobPreview preview;
+    if (blobOid.isEmpty() || lookupBlob(blobOid, &preview)) {
+        return preview;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // 边读边累积，达到预览上限就终止 git，大文件不会整个读进内存
+    preview.size = size;
+    preview.data.reserve(qMin(size, PreviewLimit));
+    GitCancelToken::Ptr stopToken = GitCancelToken::create(QString());
+    GitProcess process(m_repoPath, stopToken);
+    process.setOutputHandler([&](const QByteArray &chunk) {
+        if (preview.truncated) return;
+        const qint64 room = PreviewLimit - preview.data.size();
+        if (chunk.size() > room) {
+            preview.data.append(chunk.first(room));
+            preview.truncated = true;
+            stopToken->cancel();
+        } else {
+            preview.data.append(chunk);
+        }
+    });
+
+    GitResult result = process.run({"cat-file", "blob", blobOid});
+    if (!result.ok() && !preview.truncated) {
+        if (error) *error = result.errorText();
+        return GitBlobPreview();
+    }
+
+    preview.binary = QByteArrayView(preview.data).first(qMin(preview.data.size(), kBinaryProbeBytes)).contains('\0');
+    if (preview.binary) {
+        // 二进制内容不显示，也不占用缓存空间
+        preview.data.clear();
+    }
+    preview.data.squeeze();
+
+    qDebug() << "Read blob" << blobOid.left(8) << ":" << preview.data.size() << "of" << size << "bytes in"
+             << timer.elapsed() << "ms" << (preview.truncated ? "(truncated)" : "");
+
+    QMutexLocker locker(&m_mutex);
+    if (!m_blobs.contains(blobOid)) {
+        m_blobs.insert(blobOid, preview);
+        m_blobOrder.append(blobOid);
+        m_blobBytes += preview.data.size();
+    }
+    while (m_blobBytes > BlobCacheBytes && m_blobOrder.size() > 1) {
+        m_blobBytes -= m_blobs.take(m_blobOrder.takeFirst()).data.size();
+    }
+    return preview;
+}
+
+bool GitObjectCache::content(const QString &blobOid, QByteArray *data, QString *error)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_contents.constFind(blobOid);
+        if (it != m_contents.constEnd()) {
+            *data = it.value();
+            m_contentOrder.removeOne(blobOid);
+            m_contentOrder.append(blobOid);
+            return true;
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    GitResult result = GitProcess(m_repoPath).run({"cat-file", "blob", blobOid});
+    if (!result.ok()) {
+        if (error) *error = result.errorText();
+        return false;
+    }
+    *data = result.output;
+    qDebug() << "Read blob content" << blobOid.left(8) << ":" << data->size() << "bytes in" << timer.elapsed() << "ms";
+
+    if (data->size() > ContentCacheBytes / 2) {
+        return true;  // 太大的不缓存，避免把其他内容都挤出去
+    }
+    QMutexLocker locker(&m_mutex);
+    if (!m_contents.contains(blobOid)) {
+        m_contents.insert(blobOid, *data);
+        m_contentOrder.append(blobOid);
+        m_contentBytes += data->size();
+    }
+    while (m_contentBytes > ContentCacheBytes && m_contentOrder.size() > 1) {
+        m_contentBytes -= m_contents.take(m_contentOrder.takeFirst()).size();
+    }
+    return true;
+}
@@ -0,0 +1,82 @@
+#ifndef GITOBJECTCACHE_H
+#define GITOBJECTCACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include "gitentries.h"
+
+// 树对象中的一个条目（只有名称，完整路径由浏览器按展开层级拼出）
+struct GitTreeItem
+{
+    QString name;
+    QString oid;
+    TreeEntry::Type type = TreeEntry::Blob;
+    qint64 size = 0;  // 目录和子模块为 0
+
+    bool isDir() const { return type == TreeEntry::Tree; }
+};
+
+// 文件预览：只读取前 PreviewLimit 字节
+struct GitBlobPreview
+{
+    QByteArray data;
+    qint64 size = 0;
+    bool truncated = false;
+    bool binary = false;
+};
+
+// 按对象 id 缓存的树和文件内容，供版本浏览器使用
+// 对象 id 由内容决定，永远不会失效：不同提交、分支、标签之间没有变化的子目录和文件
+// 是同一个对象，切换版本后展开这些目录不需要再运行 git。
+// - 树：git ls-tree -l -z <树 id>，只列一层，展开目录时才读取下一层
+// - 文件：git cat-file blob <id> 流式读取，达到预览上限后立即终止，不检出任何内容
+class GitObjectCache
+{
+public:
+    static constexpr qint64 PreviewLimit = 1024 * 1024;
+
+    // 获取指定仓库的缓存
+    static GitObjectCache *forRepo(const QString &repoPath);
+
+    // 在工作线程中调用：把提交、分支、标签等解析为提交 hash 和根树 id，失败时返回 false
+    bool resolveRevision(const QString &revision, QString *commitHash, QString *treeOid, QString *error = nullptr);
+
+    // 只查缓存，不运行 git（可在 GUI 线程调用）
+    bool lookupTree(const QString &treeOid, QList<GitTreeItem> *items) const;
+    bool lookupBlob(const QString &blobOid, GitBlobPreview *preview) const;
+
+    // 在工作线程中调用：读取树对象的一层条目（目录在前，按名称排序）并缓存
+    QList<GitTreeItem> tree(const QString &treeOid, QString *error = nullptr);
+
+    // 在工作线程中调用：读取文件的预览内容并缓存；size 为树条目中的大小
+    GitBlobPreview blob(const QString &blobOid, qint64 size, QString *error = nullptr);
+
+    // 在工作线程中调用：读取文件的完整内容（进程内比较差异用）；不超过 ContentCacheBytes 的内容会缓存，
+    // 同一个暂存区版本再次比较时不需要运行 git
+    bool content(const QString &blobOid, QByteArray *data, QString *error = nullptr);
+
+private:
+    explicit GitObjectCache(const QString &repoPath) : m_repoPath(repoPath) {}
+    Q_DISABLE_COPY(GitObjectCache)
+
+    static constexpr int TreeCacheLimit = 4096;
+    static constexpr qint64 BlobCacheBytes = 32 * 1024 * 1024;
+    static constexpr qint64 ContentCacheBytes = 64 * 1024 * 1024;
+
+    QString m_repoPath;
+    mutable QMutex m_mutex;
+    QHash<QString, QList<GitTreeItem>> m_trees;
+    QStringList m_treeOrder;  // 最近加入的在末尾
+    QHash<QString, GitBlobPreview> m_blobs;
+    QStringList m_blobOrder;  // 最近加入的在末尾
+    qint64 m_blobBytes = 0;
+    QHash<QString, QByteArray> m_contents;
+    QStringList m_contentOrder;  // 最近使用的在末尾
+    qint64 m_contentBytes = 0;
+};
+
+#endif // GITOBJECTCACHE_H
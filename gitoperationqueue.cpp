@@ -0,0 +1,134 @@
+#include "gitoperationqueue.h"
+#include "gitlockmanager.h"
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QProcessEnvironment>
+#include <QThread>
+
+GitOperationQueue::GitOperationQueue(const QString &repoPath)
+    : m_repoPath(repoPath)
+{
+    // 读操作可以并发，但不需要占满所有核心（git 自身也会多线程）
+    m_readPool.setMaxThreadCount(qBound(2, QThread::idealThreadCount() / 2, 4));
+    m_readPool.setExpiryTimeout(30000);
+
+    // 写操作严格串行
+    m_writePool.setMaxThreadCount(1);
+    m_writePool.setExpiryTimeout(30000);
+}
+
+GitOperationQueue *GitOperationQueue::forRepo(const QString &repoPath)
+{
+    return GitRepoRegistry<GitOperationQueue>::instance(repoPath, [&repoPath]() {
+        return new GitOperationQueue(repoPath);
+    });
+}
+
+QString GitOperationQueue::repoKey(const QString &repoPath)
+{
+    QString key = QDir::cleanPath(QFileInfo(repoPath).absoluteFilePath());
+#ifdef Q_OS_WIN
+    key = key.toLower();
+#endif
+    return key;
+}
+
+GitOperationQueue::Kind GitOperationQueue::classify(const QStringList &args)
+{
+    // 跳过全局选项（-c key=value、-C path、--no-pager 等）找到子命令
+    int index = 0;
+    while (index < args.size() && args[index].startsWith('-')) {
+        const QString &option = args[index];
+        index += (option == "-c" || option == "-C") ? 2 : 1;
+    }
+    if (index >= args.size()) {
+        return Read;
+    }
+
+    const QString command = args[index];
+    const QStringList rest = args.mid(index + 1);
+
+    static const QStringList readCommands = {
+        "status", "log", "diff", "diff-tree", "diff-files", "diff-index",
+        "ls-files", "ls-tree", "ls-remote", "rev-parse", "rev-list", "cat-file",
+        "show", "blame", "for-each-ref", "show-ref", "merge-base", "describe",
+        "shortlog", "grep", "check-ignore", "check-attr", "name-rev", "version"
+    };
+    if (readCommands.contains(command)) {
+        return Read;
+    }
+
+    if (command == "branch") {
+        // 只有列出分支是读操作；创建/删除/重命名分支会修改 refs
+        for (const QString &arg : rest) {
+            if (!arg.startsWith('-')) {
+                return Write;
+            }
+            if (arg == "-d" || arg == "-D" || arg == "-m" || arg == "-M" ||
+                arg == "-c" || arg == "-C" || arg == "--delete" || arg == "--move" ||
+                arg == "--copy" || arg.startsWith("--set-upstream") || arg == "-u") {
+                return Write;
+            }
+        }
+        return Read;
+    }
+
+    if (command == "remote") {
+        if (rest.isEmpty() || rest.first() == "-v" || rest.first() == "get-url" || rest.first() == "show") {
+            return Read;
+        }
+        return Write;
+    }
+
+    if (command == "config") {
+        // git config <key> 是读取，git config <key> <value> 会写 .git/config
+        int positional = 0;
+        for (const QString &arg : rest) {
+            if (arg == "--get" || arg == "--get-all" || arg == "--list" || arg == "-l") {
+                return Read;
+            }
+            if (arg == "--unset" || arg == "--unset-all" || arg == "--add") {
+                return Write;
+            }
+            if (!arg.startsWith('-')) {
+                positional++;
+            }
+        }
+        return positional >= 2 ? Write : Read;
+    }
+
+    if (command == "tag") {
+        return rest.isEmpty() || rest.first() == "-l" || rest.first() == "--list" ? Read : Write;
+    }
+
+    // 其余命令（add/rm/mv/reset/checkout/commit/merge/pull/fetch/push/clean/
+    // revert/filter-branch/gc/reflog/update-ref/init/clone ...）都按写操作处理
+    return Write;
+}
+
+void GitOperationQueue::prepareProcess(QProcess &process, Kind kind)
+{
+    if (kind != Read) {
+        return;
+    }
+
+    // 读操作不刷新 index 的 stat 信息，避免与写操作争抢 index.lock
+    QProcessEnvironment env = process.processEnvironment();
+    if (env.isEmpty()) {
+        env = QProcessEnvironment::systemEnvironment();
+    }
+    env.insert("GIT_OPTIONAL_LOCKS", "0");
+    process.setProcessEnvironment(env);
+}
+
+void GitOperationQueue::waitForForeignLocks(int maxWaitMs)
+{
+    // 持有写锁时本程序不会有其他写操作在运行，此时存在的锁要么属于外部进程，要么是残留
+    // 这里只清理证实为残留的锁；无法证实的（包括按年龄判断的）只记录，git 报错后由用户决定是否解锁
+    QString error;
+    if (!GitLockManager::waitForRelease(m_repoPath, maxWaitMs, &error)) {
+        qDebug() << "Write proceeds while repository is still locked:" << error;
+    }
+}
@@ -0,0 +1,116 @@
+#ifndef GITOPERATIONQUEUE_H
+#define GITOPERATIONQUEUE_H
+
+#include <QProcess>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QScopeGuard>
+#include <QtConcurrent>
+#include <type_traits>
+
+// 每个仓库一个操作调度器（actor）
+// - 读操作（status/log/diff/ls-tree ...）在读线程池中并发执行，
+//   进程带 GIT_OPTIONAL_LOCKS=0，不会去抢 .git/index.lock
+// - 写操作（修改 index 或 refs：add/reset/commit/checkout/push/fetch ...）
+//   在单线程写队列中按提交顺序串行、独占执行
+// 所有写操作都必须经过写队列：GUI 线程不直接运行写命令，也不等待写队列
+class GitOperationQueue
+{
+public:
+    enum Kind {
+        Read,
+        Write
+    };
+
+    // 获取指定仓库的调度器（见 GitRepoRegistry）
+    static GitOperationQueue *forRepo(const QString &repoPath);
+
+    // 仓库路径的规范形式（Windows 上不区分大小写），按仓库缓存的键
+    static QString repoKey(const QString &repoPath);
+
+    // 根据 git 子命令及参数判断是读操作还是写操作
+    static Kind classify(const QStringList &args);
+
+    // 为即将启动的 git 进程设置环境（读操作禁用可选锁）
+    static void prepareProcess(QProcess &process, Kind kind);
+
+    QString repoPath() const { return m_repoPath; }
+
+    // 已提交但尚未完成的写操作数量
+    int pendingWrites() const { return m_pendingWrites.loadRelaxed(); }
+
+    // 写操作开始前先等待外部 git 进程释放锁（最多 foreignLockWaitMs）；
+    // 负为不等待，用于自己检查、清理锁的操作
+    template <typename Function>
+    auto run(Kind kind, Function function, int foreignLockWaitMs = 30000) -> QFuture<std::invoke_result_t<Function>>
+    {
+        if (kind == Read) {
+            return QtConcurrent::run(&m_readPool, std::move(function));
+        }
+
+        m_pendingWrites.ref();
+        return QtConcurrent::run(&m_writePool, [this, foreignLockWaitMs, function = std::move(function)]() mutable {
+            QMutexLocker locker(&m_writeMutex);
+            auto done = qScopeGuard([this]() { m_pendingWrites.deref(); });
+            if (foreignLockWaitMs >= 0) {
+                waitForForeignLocks(foreignLockWaitMs);
+            }
+            return function();
+        });
+    }
+
+private:
+    explicit GitOperationQueue(const QString &repoPath);
+    Q_DISABLE_COPY(GitOperationQueue)
+
+    // 写操作开始前：等待外部 git 进程释放锁，清理残留锁
+    void waitForForeignLocks(int maxWaitMs);
+
+    QString m_repoPath;
+    QThreadPool m_readPool;
+    QThreadPool m_writePool;
+    // 写队列只有一个线程；QFuture::waitForFinished 可能在等待方线程中直接执行尚未开始的任务，
+    // 写锁保证这种情况下仍然串行
+    QRecursiveMutex m_writeMutex;
+    QAtomicInt m_pendingWrites;
+};
+
+// 按仓库保存的进程级实例（调度器、路径表、对象缓存、索引等）：同一仓库始终得到同一个实例。
+// 实例有意不释放：后台线程和 QML 可能在程序退出前仍持有指针
+template <typename T>
+class GitRepoRegistry
+{
+public:
+    // create 只在第一次请求该仓库时调用
+    template <typename Create>
+    static T *instance(const QString &repoPath, Create create)
+    {
+        Storage &registry = storage();
+        const QString key = GitOperationQueue::repoKey(repoPath);
+        QMutexLocker locker(&registry.mutex);
+        T *&slot = registry.instances[key];
+        if (!slot) {
+            slot = create();
+        }
+        return slot;
+    }
+
+private:
+    struct Storage
+    {
+        QMutex mutex;
+        QHash<QString, T *> instances;
+    };
+
+    static Storage &storage()
+    {
+        static Storage *registry = new Storage();
+        return *registry;
+    }
+};
+
+#endif // GITOPERATIONQUEUE_H
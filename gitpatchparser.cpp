@@ -0,0 +1,154 @@
+#include "gitpatchparser.h"
+#include "gitencoding.h"
+#include "gittokenizer.h"
+#include <utility>
+
+namespace {
+
+// 从 "-12,5" / "+7" 中取出起始行号
+int hunkStart(QByteArrayView range)
+{
+    qsizetype comma = range.indexOf(',');
+    return int(GitTokenizer::toInt64(comma >= 0 ? range.sliced(1, comma - 1) : range.sliced(1)));
+}
+
+} // namespace
+
+QString GitDiffLine::typeName(Type type)
+{
+    switch (type) {
+    case Header: return QStringLiteral("header");
+    case Add: return QStringLiteral("add");
+    case Delete: return QStringLiteral("delete");
+    case Context: break;
+    }
+    return QStringLiteral("context");
+}
+
+void GitPatchParser::feed(QByteArrayView chunk)
+{
+    m_buffer.append(chunk);
+    qsizetype end = m_buffer.lastIndexOf('\n');
+    if (end < 0) {
+        return;
+    }
+    // 只处理完整的行，最后不完整的部分留到下一块
+    GitTokenizer::forEachLine(QByteArrayView(m_buffer).first(end), [this](QByteArrayView line) {
+        parseLine(line);
+    });
+    m_buffer.remove(0, end + 1);
+}
+
+void GitPatchParser::finish()
+{
+    if (!m_buffer.isEmpty()) {
+        GitTokenizer::forEachLine(m_buffer, [this](QByteArrayView line) {
+            parseLine(line);
+        });
+        m_buffer.clear();
+    }
+    completeSection();
+}
+
+QList<GitPatchParser::Section> GitPatchParser::takeSections()
+{
+    return std::exchange(m_sections, {});
+}
+
+void GitPatchParser::parseLine(QByteArrayView line)
+{
+    if (line.startsWith("diff --git ")) {
+        completeSection();
+        startSection();
+        return;
+    }
+    if (m_index < 0) {
+        return;
+    }
+
+    if (!m_inHunk) {
+        // 段头：index / 模式 / 重命名 / --- +++，第一个 @@ 之前的行都不显示
+        if (line.startsWith("Binary files ") || line.startsWith("GIT binary patch")) {
+            m_binary = true;
+            return;
+        }
+        if (!line.startsWith("@@")) {
+            return;
+        }
+    }
+
+    GitDiffLine::Type type;
+    QByteArrayView content = line;
+    if (line.startsWith("@@")) {
+        auto ranges = GitTokenizer::split<4>(line, ' ');
+        if (ranges.count >= 3 && ranges[1].startsWith('-') && ranges[2].startsWith('+')) {
+            m_oldLine = hunkStart(ranges[1]);
+            m_newLine = hunkStart(ranges[2]);
+        }
+        m_inHunk = true;
+        type = GitDiffLine::Header;
+    } else if (line.front() == '+') {
+        type = GitDiffLine::Add;
+        content = line.sliced(1);
+    } else if (line.front() == '-') {
+        type = GitDiffLine::Delete;
+        content = line.sliced(1);
+    } else if (line.front() == ' ') {
+        type = GitDiffLine::Context;
+        content = line.sliced(1);
+    } else {
+        return;  // "\ No newline at end of file"
+    }
+
+    if (m_keep && m_lineHandler) {
+        m_lineHandler(type,
+                      (type == GitDiffLine::Delete || type == GitDiffLine::Context) ? m_oldLine : 0,
+                      (type == GitDiffLine::Add || type == GitDiffLine::Context) ? m_newLine : 0,
+                      content);
+    } else if (m_keep) {
+        PendingLine pending{type, 0, 0, m_sectionBytes.size(), content.size()};
+        if (type == GitDiffLine::Delete || type == GitDiffLine::Context) pending.oldLine = m_oldLine;
+        if (type == GitDiffLine::Add || type == GitDiffLine::Context) pending.newLine = m_newLine;
+        m_sectionBytes.append(content);
+        m_sectionBytes.append('\n');
+        m_pending.append(pending);
+    }
+    if (type == GitDiffLine::Delete || type == GitDiffLine::Context) m_oldLine++;
+    if (type == GitDiffLine::Add || type == GitDiffLine::Context) m_newLine++;
+}
+
+void GitPatchParser::startSection()
+{
+    m_index++;
+    m_keep = !m_filter || m_filter(m_index);
+    m_inHunk = false;
+    m_binary = false;
+    m_oldLine = 0;
+    m_newLine = 0;
+}
+
+void GitPatchParser::completeSection()
+{
+    if (m_index < 0 || !m_keep) {
+        return;
+    }
+    m_keep = false;
+
+    Section section;
+    section.index = m_index;
+    section.binary = m_binary;
+    section.lines.reserve(m_pending.size());
+    const GitEncoding::Encoding encoding = GitEncoding::detect(m_sectionBytes);
+    const QByteArrayView bytes(m_sectionBytes);
+    for (const PendingLine &pending : std::as_const(m_pending)) {
+        GitDiffLine line;
+        line.type = pending.type;
+        line.oldLine = pending.oldLine;
+        line.newLine = pending.newLine;
+        line.content = GitEncoding::decode(bytes.sliced(pending.offset, pending.length), encoding);
+        section.lines.append(std::move(line));
+    }
+    m_sections.append(std::move(section));
+    m_sectionBytes.clear();
+    m_pending.clear();
+}
@@ -0,0 +1,88 @@
+#ifndef GITPATCHPARSER_H
+#define GITPATCHPARSER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <functional>
+
+// 补丁中的一行
+struct GitDiffLine
+{
+    enum Type : quint8 {
+        Header,   // "@@ -a,b +c,d @@"
+        Context,
+        Add,
+        Delete
+    };
+
+    Type type = Context;
+    int oldLine = 0;  // 删除行和上下文行在旧文件中的行号
+    int newLine = 0;  // 新增行和上下文行在新文件中的行号
+    QString content;  // 不含开头的 '+' / '-' / ' '
+
+    // 与以前 getFileDiff 的 lineNum 相同：删除行取旧行号，其余取新行号，块头为 0
+    int lineNum() const { return type == Header ? 0 : (type == Delete ? oldLine : newLine); }
+
+    // 界面使用的类型名："header" / "context" / "add" / "delete"
+    static QString typeName(Type type);
+};
+
+// git diff / git show -p 输出的增量解析
+// 每个文件是一段（以 "diff --git" 开始），按出现顺序编号；段完成时才解码（按整段检测编码，
+// GBK 文件不会被逐行误判）。setSectionFilter 返回 false 的段只跳过、不保存，
+// 大文件的补丁不会占用内存。
+// 设置 setLineHandler 后，保留的段中的行不再解码保存，而是把原始字节直接交给回调
+// （Section::lines 为空），由调用方按需解码。
+class GitPatchParser
+{
+public:
+    struct Section {
+        int index = 0;
+        bool binary = false;  // "Binary files ... differ"
+        QList<GitDiffLine> lines;
+    };
+
+    // content 指向解析器内部的缓冲区，只在回调期间有效
+    using LineHandler = std::function<void(GitDiffLine::Type type, int oldLine, int newLine, QByteArrayView content)>;
+
+    void setSectionFilter(std::function<bool(int index)> filter) { m_filter = std::move(filter); }
+    void setLineHandler(LineHandler handler) { m_lineHandler = std::move(handler); }
+
+    void feed(QByteArrayView chunk);
+    void finish();
+
+    bool hasSections() const { return !m_sections.isEmpty(); }
+    QList<Section> takeSections();
+    // 已经开始的段数（包括跳过的）
+    int sectionCount() const { return m_index + 1; }
+
+private:
+    struct PendingLine {
+        GitDiffLine::Type type;
+        int oldLine;
+        int newLine;
+        qsizetype offset;
+        qsizetype length;
+    };
+
+    void parseLine(QByteArrayView line);
+    void startSection();
+    void completeSection();
+
+    std::function<bool(int)> m_filter;
+    LineHandler m_lineHandler;
+    QByteArray m_buffer;
+    QList<Section> m_sections;
+
+    int m_index = -1;
+    bool m_keep = false;
+    bool m_inHunk = false;
+    bool m_binary = false;
+    int m_oldLine = 0;
+    int m_newLine = 0;
+    QByteArray m_sectionBytes;  // 当前段所有行的内容，段完成时一次检测编码
+    QList<PendingLine> m_pending;
+};
+
+#endif // GITPATCHPARSER_H
@@ -0,0 +1,126 @@
+#include "gitpathtable.h"
+#include "gitoperationqueue.h"
+#include "gitencoding.h"
+#include "gittokenizer.h"
+
+GitPathTable *GitPathTable::forRepo(const QString &repoPath)
+{
+    return GitRepoRegistry<GitPathTable>::instance(repoPath, []() {
+        return new GitPathTable();
+    });
+}
+
+quint32 GitPathTable::intern(QStringView path)
+{
+    return intern(QByteArrayView(path.toUtf8()));
+}
+
+quint32 GitPathTable::intern(QByteArrayView utf8Path)
+{
+    if (utf8Path.isEmpty() || utf8Path.size() > 0xffff) {
+        return InvalidId;
+    }
+
+    {
+        QReadLocker locker(&m_lock);
+        auto it = m_ids.constFind(utf8Path);
+        if (it != m_ids.constEnd()) {
+            return it.value();
+        }
+    }
+
+    QWriteLocker locker(&m_lock);
+    // 加写锁前可能已被其他线程加入
+    auto it = m_ids.constFind(utf8Path);
+    if (it != m_ids.constEnd()) {
+        return it.value();
+    }
+
+    Record record;
+    char *data = allocate(utf8Path.size(), &record.chunk, &record.offset);
+    memcpy(data, utf8Path.data(), utf8Path.size());
+    record.length = quint16(utf8Path.size());
+    qsizetype slash = utf8Path.lastIndexOf('/');
+    record.baseOffset = quint16(slash + 1);
+
+    const quint32 id = quint32(m_records.size());
+    m_records.push_back(record);
+    m_ids.insert(QByteArrayView(data, utf8Path.size()), id);
+    return id;
+}
+
+char *GitPathTable::allocate(qsizetype size, quint32 *chunk, quint32 *offset)
+{
+    if (m_chunkUsed + size > ChunkSize) {
+        m_chunks.push_back(std::make_unique<char[]>(ChunkSize));
+        m_chunkUsed = 0;
+    }
+    *chunk = quint32(m_chunks.size() - 1);
+    *offset = quint32(m_chunkUsed);
+    m_chunkUsed += size;
+    return m_chunks.back().get() + *offset;
+}
+
+QByteArrayView GitPathTable::view(const Record &record) const
+{
+    return QByteArrayView(m_chunks[record.chunk].get() + record.offset, record.length);
+}
+
+QByteArrayView GitPathTable::utf8Path(quint32 id) const
+{
+    QReadLocker locker(&m_lock);
+    if (id >= m_records.size()) {
+        return QByteArrayView();
+    }
+    // arena 中的字节写入后不再移动或修改，释放锁后视图依然有效
+    return view(m_records[id]);
+}
+
+QString GitPathTable::path(quint32 id) const
+{
+    return QString::fromUtf8(utf8Path(id));
+}
+
+QString GitPathTable::baseName(quint32 id) const
+{
+    QReadLocker locker(&m_lock);
+    if (id >= m_records.size()) {
+        return QString();
+    }
+    const Record &record = m_records[id];
+    return QString::fromUtf8(view(record).sliced(record.baseOffset));
+}
+
+qsizetype GitPathTable::count() const
+{
+    QReadLocker locker(&m_lock);
+    return qsizetype(m_records.size());
+}
+
+qsizetype GitPathTable::memoryUsage() const
+{
+    QReadLocker locker(&m_lock);
+    // 哈希表每个节点约为键(16) + 值(4) + 对齐/span 开销，按 32 字节估算
+    return qsizetype(m_chunks.size()) * ChunkSize
+         + qsizetype(m_records.capacity() * sizeof(Record))
+         + m_ids.capacity() * 32;
+}
+
+GitPathRef internGitPath(GitPathTable *pathTable, QByteArrayView field)
+{
+    QByteArray unquoted;
+    if (GitTokenizer::isQuoted(field)) {
+        unquoted = GitTokenizer::unquote(field);
+        field = unquoted;
+    }
+    return internRawGitPath(pathTable, field);
+}
+
+GitPathRef internRawGitPath(GitPathTable *pathTable, QByteArrayView path)
+{
+    GitEncoding::Encoding encoding = GitEncoding::detect(path);
+    if (encoding == GitEncoding::Ascii || encoding == GitEncoding::Utf8) {
+        return GitPathRef(pathTable, path);
+    }
+    return GitPathRef(pathTable, GitEncoding::decode(path, encoding));
+}
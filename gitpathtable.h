@@ -0,0 +1,87 @@
+#ifndef GITPATHTABLE_H
+#define GITPATHTABLE_H
+
+#include <QByteArrayView>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QStringView>
+#include <memory>
+#include <vector>
+
+// 每个仓库一张路径驻留表（interning）
+// 状态列表、提交文件列表、目录浏览、大文件列表里反复出现同一批仓库相对路径，
+// 以前每处都各存一份 QString（UTF-16 + 独立堆分配）。现在路径只以 UTF-8 存一次：
+// - 字节存放在按块分配的 arena 中，块不会搬移，哈希表直接以 arena 中的视图为键
+// - 每个路径对应一个 32 位 id，记录中同时保存文件名（basename）在路径中的偏移
+// 可在任意线程中驻留和读取（读写锁保护）。表的生命周期与程序相同。
+class GitPathTable
+{
+public:
+    static constexpr quint32 InvalidId = 0xffffffffu;
+
+    // 获取指定仓库的路径表；不释放，条目中的 GitPathRef 可能在任何时候被 QML 读取
+    static GitPathTable *forRepo(const QString &repoPath);
+
+    // 返回路径的 id，不存在时加入表中
+    quint32 intern(QByteArrayView utf8Path);
+    quint32 intern(QStringView path);
+
+    QString path(quint32 id) const;
+    QString baseName(quint32 id) const;
+    QByteArrayView utf8Path(quint32 id) const;
+
+    qsizetype count() const;
+
+    // 表自身占用的内存（arena + 记录 + 哈希表的估算值），用于调试输出
+    qsizetype memoryUsage() const;
+
+private:
+    GitPathTable() = default;
+    Q_DISABLE_COPY(GitPathTable)
+
+    struct Record {
+        quint32 chunk;
+        quint32 offset;
+        quint16 length;
+        quint16 baseOffset;  // 最后一个 '/' 之后的位置
+    };
+
+    QByteArrayView view(const Record &record) const;
+    char *allocate(qsizetype size, quint32 *chunk, quint32 *offset);
+
+    static constexpr qsizetype ChunkSize = 64 * 1024;
+
+    mutable QReadWriteLock m_lock;
+    std::vector<std::unique_ptr<char[]>> m_chunks;
+    qsizetype m_chunkUsed = ChunkSize;  // 当前块已用字节，初始值使第一次分配时新建块
+    std::vector<Record> m_records;
+    QHash<QByteArrayView, quint32> m_ids;
+};
+
+// 条目中保存的路径引用：表指针 + 32 位 id，读取时才转换为 QString
+struct GitPathRef
+{
+    const GitPathTable *table = nullptr;
+    quint32 id = GitPathTable::InvalidId;
+
+    GitPathRef() = default;
+    GitPathRef(GitPathTable *pathTable, QStringView path)
+        : table(pathTable), id(pathTable->intern(path)) {}
+    GitPathRef(GitPathTable *pathTable, QByteArrayView utf8Path)
+        : table(pathTable), id(pathTable->intern(utf8Path)) {}
+
+    bool isNull() const { return !table || id == GitPathTable::InvalidId; }
+    QString toString() const { return isNull() ? QString() : table->path(id); }
+    QString baseName() const { return isNull() ? QString() : table->baseName(id); }
+};
+
+// 把 git 输出中的路径字段驻留为路径引用：
+// 带 C 风格引号的先还原转义；UTF-8 路径直接按字节驻留，不经过 QString；
+// 不是 UTF-8 时（中文 Windows 上提交的 GBK 文件名）解码后再驻留
+GitPathRef internGitPath(GitPathTable *pathTable, QByteArrayView field);
+
+// -z 输出中的路径原样输出（不加引号），只需识别编码
+GitPathRef internRawGitPath(GitPathTable *pathTable, QByteArrayView path);
+
+#endif // GITPATHTABLE_H
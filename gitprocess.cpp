@@ -0,0 +1,364 @@
+#include "gitprocess.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QRegularExpression>
+#include <QSet>
+
+#ifdef Q_OS_UNIX
+#include <signal.h>
+#include <unistd.h>
+#endif
+#ifdef Q_OS_LINUX
+#include <QFile>
+#endif
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
+namespace {
+
+// 看门狗采样 CPU 时间的间隔
+constexpr int kWatchdogSampleMs = 1000;
+
+// 流式读取时等待新输出的最长时间（有数据会立即返回）
+constexpr int kStreamPollMs = 20;
+
+// 本程序正在运行的 git 子进程
+struct ChildRegistry
+{
+    QMutex mutex;
+    QSet<qint64> pids;
+};
+
+Q_GLOBAL_STATIC(ChildRegistry, childRegistry)
+
+#ifdef Q_OS_LINUX
+// /proc/<pid>/stat 中 utime/stime/cutime/cstime（第 14-17 个字段），单位为时钟滴答
+qint64 procCpuTicks(const QByteArray &pid)
+{
+    QFile file("/proc/" + pid + "/stat");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    QByteArray stat = file.readAll();
+    // comm 字段可能包含空格，从最后一个 ')' 之后开始解析（第 3 个字段起）
+    int close = stat.lastIndexOf(')');
+    if (close < 0) {
+        return -1;
+    }
+    const QList<QByteArray> fields = stat.mid(close + 2).split(' ');
+    if (fields.size() < 15) {
+        return -1;
+    }
+    qint64 ticks = 0;
+    for (int i = 11; i <= 14; i++) {
+        ticks += fields.at(i).toLongLong();
+    }
+    return ticks;
+}
+#endif
+
+} // namespace
+
+GitCancelToken::Ptr GitCancelToken::create(const QString &operationName)
+{
+    return Ptr(new GitCancelToken(operationName));
+}
+
+void GitCancelToken::setProgressCallback(ProgressCallback callback)
+{
+    QMutexLocker locker(&m_callbackMutex);
+    m_progressCallback = std::move(callback);
+}
+
+void GitCancelToken::reportProgress(const QString &phase, int percent)
+{
+    QMutexLocker locker(&m_callbackMutex);
+    if (m_progressCallback) {
+        m_progressCallback(phase, percent);
+    }
+}
+
+GitProcess::GitProcess(const QString &workingDirectory, GitCancelToken::Ptr token)
+    : m_workingDirectory(workingDirectory)
+    , m_token(std::move(token))
+{
+}
+
+GitResult GitProcess::run(const QStringList &args, int stallTimeoutMs)
+{
+    GitResult result;
+    if (m_token && m_token->isCancelled()) {
+        result.cancelled = true;
+        return result;
+    }
+
+    m_progressBuffer.clear();
+
+    QProcess process;
+    process.setWorkingDirectory(m_workingDirectory);
+    GitOperationQueue::prepareProcess(process, GitOperationQueue::classify(args));
+#ifdef Q_OS_UNIX
+    // 独立进程组，取消时可以一次性终止 git 及其派生的子进程
+    process.setChildProcessModifier([]() { ::setpgid(0, 0); });
+#endif
+    process.start("git", args);
+    if (!process.waitForStarted(10000)) {
+        result.errorOutput = process.errorString().toUtf8();
+        return result;
+    }
+
+    // 看门狗：lastProgress 在收到输出或 CPU 时间增长时重置
+    QElapsedTimer lastProgress;
+    lastProgress.start();
+    QElapsedTimer sampleTimer;
+    sampleTimer.start();
+    const qint64 pid = process.processId();
+    qint64 lastCpuMs = cpuTimeMs(pid);
+
+    {
+        QMutexLocker locker(&childRegistry()->mutex);
+        childRegistry()->pids.insert(pid);
+    }
+    auto unregister = qScopeGuard([pid]() {
+        QMutexLocker locker(&childRegistry()->mutex);
+        childRegistry()->pids.remove(pid);
+    });
+
+    while (process.state() != QProcess::NotRunning) {
+        if (m_outputHandler) {
+            process.waitForReadyRead(kStreamPollMs);
+        } else {
+            process.waitForFinished(100);
+        }
+
+        QByteArray out = process.readAllStandardOutput();
+        QByteArray err = process.readAllStandardError();
+        if (!out.isEmpty() || !err.isEmpty()) {
+            lastProgress.restart();
+        }
+        if (m_progressOnStdout && m_token && !out.isEmpty()) {
+            QString phase;
+            int percent = -1;
+            const QList<QByteArray> segments = out.split('\r');
+            for (auto it = segments.crbegin(); it != segments.crend(); ++it) {
+                if (parseProgressLine(QString::fromUtf8(it->trimmed()), &phase, &percent)) {
+                    m_token->reportProgress(phase, percent);
+                    break;
+                }
+            }
+        }
+        if (m_outputHandler) {
+            if (!out.isEmpty()) {
+                m_outputHandler(out);
+            }
+        } else {
+            result.output += out;
+        }
+        result.errorOutput += consumeProgress(err, false);
+
+        if (process.state() == QProcess::NotRunning) {
+            break;
+        }
+        if (m_token && m_token->isCancelled()) {
+            qDebug() << "Cancelling git" << args.value(0);
+            terminateTree(process);
+            result.cancelled = true;
+            break;
+        }
+        if (stallTimeoutMs < 0) {
+            continue;
+        }
+        if (sampleTimer.elapsed() >= kWatchdogSampleMs) {
+            sampleTimer.restart();
+            qint64 cpuMs = cpuTimeMs(pid);
+            if (cpuMs > lastCpuMs) {
+                lastProgress.restart();
+            }
+            lastCpuMs = cpuMs;
+        }
+        if (lastProgress.elapsed() > stallTimeoutMs) {
+            qWarning() << "git" << args << "made no progress for" << stallTimeoutMs << "ms, terminating";
+            terminateTree(process);
+            result.stalled = true;
+            break;
+        }
+    }
+
+    QByteArray out = process.readAllStandardOutput();
+    if (!m_outputHandler) {
+        result.output += out;
+    } else if (!out.isEmpty()) {
+        m_outputHandler(out);
+    }
+    result.errorOutput += consumeProgress(process.readAllStandardError(), true);
+
+    if (result.stalled) {
+        // 调用方直接把 errorText() 展示给用户，卡死必须明确报错而不是返回空结果
+        QString command;
+        for (int i = 0; i < args.size() && command.isEmpty(); i++) {
+            if (args[i] == "-c" || args[i] == "-C") {
+                i++;
+            } else if (!args[i].startsWith('-')) {
+                command = args[i];
+            }
+        }
+        result.errorOutput.prepend(QString("git %1 已 %2 秒没有任何进展，已终止\n")
+                                       .arg(command).arg(stallTimeoutMs / 1000).toUtf8());
+    } else if (!result.cancelled) {
+        result.exitCode = process.exitStatus() == QProcess::NormalExit ? process.exitCode() : -1;
+    }
+    return result;
+}
+
+QByteArray GitProcess::consumeProgress(const QByteArray &chunk, bool flush)
+{
+    m_progressBuffer += chunk;
+
+    QByteArray remaining;
+    qsizetype start = 0;
+    for (qsizetype i = 0; i < m_progressBuffer.size(); i++) {
+        const char c = m_progressBuffer.at(i);
+        if (c != '\r' && c != '\n') continue;
+
+        QByteArray line = m_progressBuffer.mid(start, i - start);
+        start = i + 1;
+
+        QString phase;
+        int percent = -1;
+        if (parseProgressLine(QString::fromUtf8(line), &phase, &percent)) {
+            if (m_token) {
+                m_token->reportProgress(phase, percent);
+            }
+        } else if (!line.isEmpty()) {
+            remaining += line;
+            remaining += '\n';
+        }
+    }
+    m_progressBuffer.remove(0, start);
+
+    if (flush && !m_progressBuffer.isEmpty()) {
+        QString phase;
+        int percent = -1;
+        if (!parseProgressLine(QString::fromUtf8(m_progressBuffer), &phase, &percent)) {
+            remaining += m_progressBuffer;
+        }
+        m_progressBuffer.clear();
+    }
+    return remaining;
+}
+
+bool GitProcess::parseProgressLine(const QString &line, QString *phase, int *percent)
+{
+    static const QRegularExpression percentPattern("^(?:remote: )?([A-Za-z][A-Za-z ]*?):\\s+(\\d+)%");
+    static const QRegularExpression rewritePattern("^Rewrite [0-9a-f]+ \\((\\d+)/(\\d+)\\)");
+    static const QHash<QString, QString> phaseNames = {
+        {"Enumerating objects", "枚举对象"},
+        {"Counting objects", "统计对象"},
+        {"Compressing objects", "压缩对象"},
+        {"Writing objects", "写入对象"},
+        {"Receiving objects", "接收对象"},
+        {"Resolving deltas", "处理差异"},
+        {"Updating files", "更新文件"},
+        {"Checking out files", "检出文件"},
+        {"Updating index flags", "更新索引"},
+        {"Rewrite", "重写历史"}
+    };
+
+    QRegularExpressionMatch match = percentPattern.match(line);
+    if (match.hasMatch()) {
+        QString name = match.captured(1).trimmed();
+        *phase = phaseNames.value(name, name);
+        *percent = match.captured(2).toInt();
+        return true;
+    }
+
+    match = rewritePattern.match(line);
+    if (match.hasMatch()) {
+        qint64 done = match.captured(1).toLongLong();
+        qint64 total = match.captured(2).toLongLong();
+        *phase = phaseNames.value("Rewrite");
+        *percent = total > 0 ? int(done * 100 / total) : -1;
+        return true;
+    }
+    return false;
+}
+
+qint64 GitProcess::cpuTimeMs(qint64 pid)
+{
+    if (pid <= 0) {
+        return -1;
+    }
+#if defined(Q_OS_LINUX)
+    static const long ticksPerSecond = ::sysconf(_SC_CLK_TCK);
+    const QByteArray pidText = QByteArray::number(pid);
+    qint64 ticks = procCpuTicks(pidText);
+    if (ticks < 0) {
+        return -1;
+    }
+    // git push/fetch 的主要工作在 pack-objects、index-pack 等直接子进程里
+    QFile children("/proc/" + pidText + "/task/" + pidText + "/children");
+    if (children.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> childPids = children.readAll().split(' ');
+        for (const QByteArray &child : childPids) {
+            if (child.trimmed().isEmpty()) continue;
+            ticks += qMax<qint64>(0, procCpuTicks(child.trimmed()));
+        }
+    }
+    return ticksPerSecond > 0 ? ticks * 1000 / ticksPerSecond : -1;
+#elif defined(Q_OS_WIN)
+    HANDLE handle = ::OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, static_cast<DWORD>(pid));
+    if (!handle) {
+        return -1;
+    }
+    FILETIME creation, exit, kernel, user;
+    qint64 ms = -1;
+    if (::GetProcessTimes(handle, &creation, &exit, &kernel, &user)) {
+        auto toMs = [](const FILETIME &time) {
+            return ((qint64(time.dwHighDateTime) << 32) | time.dwLowDateTime) / 10000;
+        };
+        ms = toMs(kernel) + toMs(user);
+    }
+    ::CloseHandle(handle);
+    return ms;
+#else
+    // 其他平台只依据输出判断进展
+    return -1;
+#endif
+}
+
+bool GitProcess::isRunningChild(qint64 pid)
+{
+    QMutexLocker locker(&childRegistry()->mutex);
+    return childRegistry()->pids.contains(pid);
+}
+
+void GitProcess::terminateTree(QProcess &process)
+{
+    if (process.state() == QProcess::NotRunning) {
+        return;
+    }
+
+    const qint64 pid = process.processId();
+#ifdef Q_OS_WIN
+    // /T 终止整个进程树
+    if (pid > 0) {
+        QProcess::execute("taskkill", {"/PID", QString::number(pid), "/T", "/F"});
+    }
+#else
+    if (pid > 0) {
+        ::kill(-static_cast<pid_t>(pid), SIGTERM);
+    }
+    if (process.waitForFinished(2000)) {
+        return;
+    }
+    if (pid > 0) {
+        ::kill(-static_cast<pid_t>(pid), SIGKILL);
+    }
+#endif
+    if (!process.waitForFinished(1000)) {
+        process.kill();
+        process.waitForFinished(1000);
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef GITPROCESS_H
+#define GITPROCESS_H
+
+#include <QByteArray>
+#include <QMutex>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+#include <QAtomicInt>
+#include <functional>
+#include <memory>
+#include "gitoperationqueue.h"
+#include "gitencoding.h"
+
+// 取消令牌：由 GUI 线程创建并在用户点击"取消"时触发，
+// 工作线程中的 GitProcess 轮询令牌并终止整个 git 进程组
+class GitCancelToken
+{
+public:
+    using Ptr = std::shared_ptr<GitCancelToken>;
+    using ProgressCallback = std::function<void(const QString &phase, int percent)>;
+
+    static Ptr create(const QString &operationName);
+
+    QString operationName() const { return m_operationName; }
+
+    void cancel() { m_cancelled.storeRelaxed(1); }
+    bool isCancelled() const { return m_cancelled.loadRelaxed() != 0; }
+
+    // 进度回调在工作线程中调用，回调内部负责切回 GUI 线程
+    void setProgressCallback(ProgressCallback callback);
+    void reportProgress(const QString &phase, int percent);
+
+private:
+    explicit GitCancelToken(const QString &operationName) : m_operationName(operationName) {}
+
+    QString m_operationName;
+    QAtomicInt m_cancelled;
+    QMutex m_callbackMutex;
+    ProgressCallback m_progressCallback;
+};
+
+struct GitResult
+{
+    int exitCode = -1;
+    bool cancelled = false;
+    bool stalled = false;       // 看门狗判定进程卡死并已终止
+    QByteArray output;
+    QByteArray errorOutput;
+
+    bool ok() const { return exitCode == 0 && !cancelled && !stalled; }
+    // 中文 Windows 上 git 的提示信息和非 UTF-8 路径可能是 GBK，先识别编码再解码一次
+    QString outputText() const { return GitEncoding::decode(output).trimmed(); }
+    QString errorText() const { return GitEncoding::decode(errorOutput).trimmed(); }
+};
+
+// 在工作线程中同步运行 git 命令：
+// - 子进程放入独立进程组，取消时连同 git 派生的子进程（remote-https、pack-objects 等）一起终止
+// - 解析 --progress 输出（stderr 中以 \r 分隔的进度行）并上报到取消令牌
+// - 看门狗：只要进程还在输出或消耗 CPU 就顺延截止时间，真正卡死时才终止并报错
+class GitProcess
+{
+public:
+    explicit GitProcess(const QString &workingDirectory, GitCancelToken::Ptr token = nullptr);
+
+    // filter-branch 等脚本把进度打印到 stdout，需要时开启对 stdout 的进度解析
+    void setProgressOnStdout(bool enabled) { m_progressOnStdout = enabled; }
+
+    // 流式读取 stdout：设置后输出不再累积到 GitResult::output，而是每收到一块就交给回调
+    // （在调用 run 的线程中执行），调用方可以边运行边解析，内存只与未处理的数据量有关
+    using OutputHandler = std::function<void(const QByteArray &chunk)>;
+    void setOutputHandler(OutputHandler handler) { m_outputHandler = std::move(handler); }
+
+    // 读/写类型由参数自动判断（见 GitOperationQueue::classify）
+    // stallTimeoutMs 是"无进展"超时而不是总时长：大仓库上的慢命令只要仍在工作就会一直等待；
+    // -1 表示不启用看门狗（由用户通过取消令牌终止）
+    GitResult run(const QStringList &args, int stallTimeoutMs = 30000);
+
+    // 解析一行 git 进度输出，例如 "Receiving objects:  45% (450/1000)" 或
+    // filter-branch 的 "Rewrite 1a2b3c (12/345)"，无法识别时返回 false
+    static bool parseProgressLine(const QString &line, QString *phase, int *percent);
+
+    // 终止进程及其整个进程组：先 SIGTERM 让 git 清理锁文件，超时后 SIGKILL
+    static void terminateTree(QProcess &process);
+
+    // 进程（含已回收的子进程）累计消耗的 CPU 时间，无法获取时返回 -1
+    static qint64 cpuTimeMs(qint64 pid);
+
+    // pid 是否为本程序当前正在运行的 git 子进程（检查锁的持有者时排除）
+    static bool isRunningChild(qint64 pid);
+
+private:
+    // 拆出 stderr 中的进度行并上报，返回剩余的普通错误输出
+    QByteArray consumeProgress(const QByteArray &chunk, bool flush);
+
+    QString m_workingDirectory;
+    GitCancelToken::Ptr m_token;
+    bool m_progressOnStdout = false;
+    OutputHandler m_outputHandler;
+    QByteArray m_progressBuffer;
+};
+
+#endif // GITPROCESS_H
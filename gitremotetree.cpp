@@ -0,0 +1,141 @@
+#include "gitremotetree.h"
+#include "gitlastcommit.h"
+#include "gitprocess.h"
+#include "gittokenizer.h"
+#include <QDebug>
+#include <QMutexLocker>
+
+namespace {
+
+// 每次最多预取的子目录数量（每个子目录都要计算一次最后提交）
+constexpr int kPrefetchLimit = 8;
+
+QString cacheKey(const QString &commitHash, const QString &subPath)
+{
+    return commitHash + '\n' + subPath;
+}
+
+} // namespace
+
+GitRemoteTreeCache *GitRemoteTreeCache::forRepo(const QString &repoPath)
+{
+    return GitRepoRegistry<GitRemoteTreeCache>::instance(repoPath, [&repoPath]() {
+        return new GitRemoteTreeCache(repoPath);
+    });
+}
+
+bool GitRemoteTreeCache::lookup(const QString &commitHash, const QString &subPath, QList<TreeEntry> *entries) const
+{
+    if (commitHash.isEmpty()) {
+        return false;
+    }
+    QMutexLocker locker(&m_mutex);
+    auto it = m_trees.constFind(cacheKey(commitHash, subPath));
+    if (it == m_trees.constEnd()) {
+        return false;
+    }
+    *entries = it.value();
+    return true;
+}
+
+QList<TreeEntry> GitRemoteTreeCache::list(const QString &commitHash, const QString &subPath, QString *error)
+{
+    QList<TreeEntry> files;
+    if (commitHash.isEmpty() || lookup(commitHash, subPath, &files)) {
+        return files;
+    }
+
+    QStringList args;
+    if (subPath.isEmpty()) {
+        args = {"ls-tree", "-l", commitHash};
+    } else {
+        args = {"ls-tree", "-l", commitHash, subPath + "/"};
+    }
+
+    GitResult result = GitProcess(m_repoPath).run(args);
+    if (!result.ok()) {
+        if (error) *error = result.errorText();
+        return files;
+    }
+
+    // Parse ls-tree output: "<mode> <type> <object> <size>\t<path>"
+    // 路径在 TAB 之后（可能含空格），前面的列按空白拆分（大小列右对齐）
+    GitPathTable *pathTable = GitPathTable::forRepo(m_repoPath);
+    files.reserve(GitTokenizer::count(result.output, '\n'));
+    GitTokenizer::forEachLine(result.output, [&](QByteArrayView line) {
+        auto columns = GitTokenizer::split<2>(line, '\t');
+        if (columns.count < 2 || columns[1].isEmpty()) return;
+        auto meta = GitTokenizer::splitWhitespace<4>(columns[0]);
+        if (meta.count < 4) return;
+
+        QByteArrayView type = meta[1];
+        QByteArrayView size = meta[3];
+
+        TreeEntry entry;
+        entry.path = internGitPath(pathTable, columns[1]);
+        entry.type = type == "tree" ? TreeEntry::Tree
+                   : type == "commit" ? TreeEntry::Submodule
+                   : TreeEntry::Blob;
+        entry.size = (size == "-") ? 0 : GitTokenizer::toInt64(size);
+        files.append(entry);
+    });
+
+    // 所有条目的最后一次提交在一次历史遍历中得到
+    QString lastCommitError;
+    QHash<QString, GitLastCommit> lastCommits = GitLastCommitEngine::forRepo(m_repoPath)->resolve(commitHash, subPath, &lastCommitError);
+    for (TreeEntry &entry : files) {
+        auto it = lastCommits.constFind(entry.name());
+        if (it != lastCommits.constEnd()) {
+            entry.commitMsg = it->message;
+            entry.commitTimeRelative = it->relativeTime;
+            entry.commitTimeFull = it->time;
+        }
+    }
+
+    if (!lastCommitError.isEmpty()) {
+        // 最后提交信息不完整，不缓存，下次重新计算
+        if (error) *error = lastCommitError;
+        return files;
+    }
+    store(cacheKey(commitHash, subPath), files);
+    return files;
+}
+
+void GitRemoteTreeCache::prefetch(const QString &commitHash, const QStringList &subPaths)
+{
+    int fetched = 0;
+    QList<TreeEntry> unused;
+    for (const QString &subPath : subPaths) {
+        if (fetched >= kPrefetchLimit) break;
+        if (lookup(commitHash, subPath, &unused)) continue;
+        list(commitHash, subPath);
+        fetched++;
+    }
+    if (fetched > 0) {
+        qDebug() << "Prefetched" << fetched << "remote directories";
+    }
+}
+
+bool GitRemoteTreeCache::isFetchDue(qint64 ttlMs) const
+{
+    QMutexLocker locker(&m_mutex);
+    return !m_lastFetch.isValid() || m_lastFetch.elapsed() >= ttlMs;
+}
+
+void GitRemoteTreeCache::markFetched()
+{
+    QMutexLocker locker(&m_mutex);
+    m_lastFetch.start();
+}
+
+void GitRemoteTreeCache::store(const QString &key, const QList<TreeEntry> &entries)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_trees.contains(key)) {
+        m_order.append(key);
+    }
+    m_trees.insert(key, entries);
+    while (m_order.size() > CacheLimit) {
+        m_trees.remove(m_order.takeFirst());
+    }
+}
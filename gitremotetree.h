@@ -0,0 +1,51 @@
+#ifndef GITREMOTETREE_H
+#define GITREMOTETREE_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include "gitentries.h"
+
+// 远程文件浏览的目录树缓存
+// 以前每次点击目录（包括返回上级）都要先 git fetch origin 再 ls-tree，每次点击一次网络往返。
+// 现在目录列表（含每个条目的最后一次提交）按（远程跟踪分支的提交 hash，目录）缓存：
+// 提交内容不会变化，hash 不变时缓存始终有效；fetch 让分支移动后自然换成新的键。
+// fetch 只在距上次超过设定的有效期时才在后台进行。
+class GitRemoteTreeCache
+{
+public:
+    // 获取指定仓库的缓存
+    static GitRemoteTreeCache *forRepo(const QString &repoPath);
+
+    // 只查缓存，不运行 git（可在 GUI 线程调用）
+    bool lookup(const QString &commitHash, const QString &subPath, QList<TreeEntry> *entries) const;
+
+    // 在工作线程中调用：列出 commitHash 中的 subPath 目录并缓存
+    QList<TreeEntry> list(const QString &commitHash, const QString &subPath, QString *error = nullptr);
+
+    // 在工作线程中调用：预先列出尚未缓存的子目录，让进入子目录时无需等待
+    void prefetch(const QString &commitHash, const QStringList &subPaths);
+
+    // 距上次 fetch 是否已超过 ttlMs（从未 fetch 过也算过期）
+    bool isFetchDue(qint64 ttlMs) const;
+    void markFetched();
+
+private:
+    explicit GitRemoteTreeCache(const QString &repoPath) : m_repoPath(repoPath) {}
+    Q_DISABLE_COPY(GitRemoteTreeCache)
+
+    void store(const QString &key, const QList<TreeEntry> &entries);
+
+    static constexpr int CacheLimit = 256;
+
+    QString m_repoPath;
+    mutable QMutex m_mutex;
+    QHash<QString, QList<TreeEntry>> m_trees;
+    QStringList m_order;  // 最近加入的在末尾
+    QElapsedTimer m_lastFetch;
+};
+
+#endif // GITREMOTETREE_H
@@ -0,0 +1,131 @@
+#include "gittokenizer.h"
+#include <QtAlgorithms>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GITTOKENIZER_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define GITTOKENIZER_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+#ifdef GITTOKENIZER_NEON
+// NEON 没有 movemask：把比较结果每字节右移压成 4 位/字节的 64 位掩码
+inline quint64 neonMask(uint8x16_t eq)
+{
+    uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(eq), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0);
+}
+#endif
+
+} // namespace
+
+qsizetype GitTokenizer::indexOf(QByteArrayView data, char delim, qsizetype from)
+{
+    if (from >= data.size()) {
+        return -1;
+    }
+    const char *begin = data.data();
+    const char *p = begin + from;
+    const char *end = begin + data.size();
+
+#if defined(GITTOKENIZER_SSE2)
+    const __m128i needle = _mm_set1_epi8(delim);
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+        if (mask) {
+            return (p - begin) + qCountTrailingZeroBits(quint32(mask));
+        }
+        p += 16;
+    }
+#elif defined(GITTOKENIZER_NEON)
+    const uint8x16_t needle = vdupq_n_u8(quint8(delim));
+    while (end - p >= 16) {
+        uint8x16_t chunk = vld1q_u8(reinterpret_cast<const quint8 *>(p));
+        quint64 mask = neonMask(vceqq_u8(chunk, needle));
+        if (mask) {
+            return (p - begin) + qCountTrailingZeroBits(mask) / 4;
+        }
+        p += 16;
+    }
+#endif
+
+    const void *hit = std::memchr(p, delim, size_t(end - p));
+    return hit ? static_cast<const char *>(hit) - begin : -1;
+}
+
+qsizetype GitTokenizer::count(QByteArrayView data, char delim)
+{
+    const char *p = data.data();
+    const char *end = p + data.size();
+    qsizetype total = 0;
+
+#if defined(GITTOKENIZER_SSE2)
+    const __m128i needle = _mm_set1_epi8(delim);
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        total += qPopulationCount(quint32(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle))));
+        p += 16;
+    }
+#elif defined(GITTOKENIZER_NEON)
+    const uint8x16_t needle = vdupq_n_u8(quint8(delim));
+    while (end - p >= 16) {
+        uint8x16_t chunk = vld1q_u8(reinterpret_cast<const quint8 *>(p));
+        // 相等的字节为 0xff，右移 7 位后为 1，横向求和即为个数
+        total += vaddvq_u8(vshrq_n_u8(vceqq_u8(chunk, needle), 7));
+        p += 16;
+    }
+#endif
+
+    for (; p < end; ++p) {
+        if (*p == delim) total++;
+    }
+    return total;
+}
+
+QByteArray GitTokenizer::unquote(QByteArrayView field)
+{
+    if (isQuoted(field)) {
+        field = field.sliced(1, field.size() - 2);
+    }
+
+    QByteArray bytes;
+    bytes.reserve(field.size());
+    const qsizetype size = field.size();
+    for (qsizetype i = 0; i < size; i++) {
+        const char c = field[i];
+        if (c != '\\' || i + 1 >= size) {
+            bytes.append(c);
+            continue;
+        }
+
+        const char next = field[i + 1];
+        // 八进制转义：\ooo，每个表示一个原始字节（UTF-8 中文路径即由若干个组成）
+        if (next >= '0' && next <= '7' && i + 3 < size
+            && field[i + 2] >= '0' && field[i + 2] <= '7'
+            && field[i + 3] >= '0' && field[i + 3] <= '7') {
+            bytes.append(char(((next - '0') << 6) | ((field[i + 2] - '0') << 3) | (field[i + 3] - '0')));
+            i += 3;
+            continue;
+        }
+
+        switch (next) {
+        case 'n': bytes.append('\n'); break;
+        case 't': bytes.append('\t'); break;
+        case 'r': bytes.append('\r'); break;
+        case '"': bytes.append('"'); break;
+        case '\\': bytes.append('\\'); break;
+        default:
+            // 未知转义，保留原样
+            bytes.append('\\');
+            bytes.append(next);
+            break;
+        }
+        i++;
+    }
+    return bytes;
+}
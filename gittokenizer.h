@@ -0,0 +1,127 @@
+#ifndef GITTOKENIZER_H
+#define GITTOKENIZER_H
+
+#include <QByteArrayView>
+#include <QString>
+#include <array>
+
+// git 输出的零拷贝分词
+// 所有解析器都直接在进程输出的 QByteArray 上工作：按行（'\n'）或 NUL（-z 输出）切分记录，
+// 再按分隔符切分字段，得到的都是指向原缓冲区的 QByteArrayView；
+// 只有真正要显示到界面上的字段才转换成 QString。
+// 分隔符查找使用 SSE2 / NEON 一次比较 16 字节，其他平台退回 memchr。
+class GitTokenizer
+{
+public:
+    // data 中从 from 开始第一个 delim 的位置，找不到返回 -1
+    static qsizetype indexOf(QByteArrayView data, char delim, qsizetype from = 0);
+
+    // delim 在 data 中出现的次数（用于预先 reserve 结果列表）
+    static qsizetype count(QByteArrayView data, char delim);
+
+    // 依次回调每条以 delim 结尾的记录（最后一条可以没有结尾分隔符），跳过空记录
+    template <typename Function>
+    static void forEachRecord(QByteArrayView data, char delim, Function function)
+    {
+        qsizetype start = 0;
+        while (start < data.size()) {
+            qsizetype end = indexOf(data, delim, start);
+            if (end < 0) {
+                end = data.size();
+            }
+            if (end > start) {
+                function(data.sliced(start, end - start));
+            }
+            start = end + 1;
+        }
+    }
+
+    // 按行回调，去掉行尾的 '\r'（Windows 上的 git 钩子/脚本可能输出 CRLF），跳过空行
+    template <typename Function>
+    static void forEachLine(QByteArrayView data, Function function)
+    {
+        forEachRecord(data, '\n', [&function](QByteArrayView line) {
+            if (line.endsWith('\r')) {
+                line.chop(1);
+            }
+            if (!line.isEmpty()) {
+                function(line);
+            }
+        });
+    }
+
+    // 最多拆成 N 个字段，最后一个字段包含剩余的全部内容（提交信息里可能也有分隔符）
+    template <int N>
+    struct Fields
+    {
+        std::array<QByteArrayView, N> values;
+        int count = 0;
+
+        QByteArrayView operator[](int index) const { return index < count ? values[index] : QByteArrayView(); }
+    };
+
+    template <int N>
+    static Fields<N> split(QByteArrayView record, char delim)
+    {
+        Fields<N> fields;
+        qsizetype start = 0;
+        while (fields.count < N - 1) {
+            qsizetype end = indexOf(record, delim, start);
+            if (end < 0) {
+                break;
+            }
+            fields.values[fields.count++] = record.sliced(start, end - start);
+            start = end + 1;
+        }
+        fields.values[fields.count++] = record.sliced(start);
+        return fields;
+    }
+
+    // 按连续空白拆分（ls-tree -l 的大小列是右对齐的，中间有多个空格）
+    template <int N>
+    static Fields<N> splitWhitespace(QByteArrayView record)
+    {
+        Fields<N> fields;
+        qsizetype i = 0;
+        const qsizetype size = record.size();
+        while (i < size && fields.count < N) {
+            while (i < size && isSpace(record[i])) i++;
+            if (i >= size) break;
+            qsizetype start = i;
+            if (fields.count == N - 1) {
+                fields.values[fields.count++] = trimmed(record.sliced(start));
+                break;
+            }
+            while (i < size && !isSpace(record[i])) i++;
+            fields.values[fields.count++] = record.sliced(start, i - start);
+        }
+        return fields;
+    }
+
+    static QByteArrayView trimmed(QByteArrayView view)
+    {
+        while (!view.isEmpty() && isSpace(view.front())) view = view.sliced(1);
+        while (!view.isEmpty() && isSpace(view.back())) view.chop(1);
+        return view;
+    }
+
+    static qint64 toInt64(QByteArrayView view)
+    {
+        bool ok = false;
+        qint64 value = view.toLongLong(&ok);
+        return ok ? value : 0;
+    }
+
+    static QString toString(QByteArrayView view) { return QString::fromUtf8(view); }
+
+    // git 对含特殊字符的路径输出 C 风格的带引号字符串（"\344\270\255.txt"、"a\tb"）
+    static bool isQuoted(QByteArrayView field) { return field.size() >= 2 && field.front() == '"' && field.back() == '"'; }
+
+    // 去掉引号并还原 \ooo、\n、\t、\"、\\ 等转义，得到原始路径字节
+    static QByteArray unquote(QByteArrayView field);
+
+private:
+    static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+};
+
+#endif // GITTOKENIZER_H
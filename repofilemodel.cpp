@@ -0,0 +1,322 @@
+#include "repofilemodel.h"
+#include "gitoperationqueue.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QPointer>
+#include <QtConcurrent>
+#include <algorithm>
+
+RepoFileModel::RepoFileModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int RepoFileModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return int(m_rows.size());
+}
+
+QVariant RepoFileModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size()) {
+        return QVariant();
+    }
+    const Row &row = m_rows.at(index.row());
+
+    switch (role) {
+    case PathRole:
+        return row.path.toString();
+    case Qt::DisplayRole:
+    case NameRole:
+        return row.path.baseName();
+    case IsDirRole:
+        return row.isDir;
+    case TypeRole:
+        return row.isDir ? QStringLiteral("tree") : QStringLiteral("blob");
+    case SizeRole:
+        ensureStat(row);
+        return row.size;
+    case SizeStrRole:
+        ensureStat(row);
+        return row.isDir ? QString() : formatFileSize(row.size);
+    case ModifiedRole:
+        ensureStat(row);
+        return row.modifiedMs > 0 ? QDateTime::fromMSecsSinceEpoch(row.modifiedMs).toString("yyyy-MM-dd hh:mm") : QString();
+    case StatusRole:
+        return statusFor(row);
+    case CommitMsgRole:
+        return m_lastCommits.value(row.path.baseName()).message;
+    case CommitTimeRelativeRole:
+        return m_lastCommits.value(row.path.baseName()).relativeTime;
+    case CommitTimeFullRole:
+        return m_lastCommits.value(row.path.baseName()).time;
+    }
+    return QVariant();
+}
+
+QHash<int, QByteArray> RepoFileModel::roleNames() const
+{
+    return {
+        {PathRole, "path"},
+        {NameRole, "name"},
+        {IsDirRole, "isDir"},
+        {TypeRole, "type"},
+        {SizeRole, "size"},
+        {SizeStrRole, "sizeStr"},
+        {ModifiedRole, "modified"},
+        {StatusRole, "status"},
+        {CommitMsgRole, "commitMsg"},
+        {CommitTimeRelativeRole, "commitTimeRelative"},
+        {CommitTimeFullRole, "commitTimeFull"}
+    };
+}
+
+void RepoFileModel::ensureStat(const Row &row) const
+{
+    if (row.size >= 0) {
+        return;
+    }
+    // 只有视图真正显示到这一行时才读取文件信息
+    QFileInfo info(m_repoPath + "/" + row.path.toString());
+    row.size = info.exists() ? info.size() : 0;
+    row.modifiedMs = info.exists() ? info.lastModified().toMSecsSinceEpoch() : 0;
+}
+
+QString RepoFileModel::statusFor(const Row &row) const
+{
+    if (row.isDir) {
+        return m_dirtyDirs.contains(row.path.id) ? QStringLiteral("modified") : QString();
+    }
+    auto it = m_fileStatus.constFind(row.path.id);
+    if (it == m_fileStatus.constEnd()) {
+        return QString();
+    }
+    StatusEntry entry;
+    entry.status = it.value();
+    return entry.statusName();
+}
+
+void RepoFileModel::setRepoPath(const QString &repoPath)
+{
+    if (repoPath == m_repoPath) {
+        return;
+    }
+    clear();
+    m_repoPath = repoPath;
+    m_pathTable = repoPath.isEmpty() ? nullptr : GitPathTable::forRepo(repoPath);
+}
+
+bool RepoFileModel::load(const QString &subPath)
+{
+    if (!m_pathTable) {
+        return false;
+    }
+
+    QString fullPath = m_repoPath;
+    if (!subPath.isEmpty()) {
+        fullPath += "/" + subPath;
+    }
+    QFileInfo dirInfo(fullPath);
+    if (!dirInfo.isDir()) {
+        return false;
+    }
+
+    const int generation = ++m_generation;
+    m_lastCommits.clear();
+
+    // 目录本身的修改时间在增删条目时变化；没有变化就直接使用缓存
+    const qint64 dirModifiedMs = dirInfo.lastModified().toMSecsSinceEpoch();
+    auto cached = m_cache.constFind(subPath);
+    if (cached != m_cache.constEnd() && cached->dirModifiedMs == dirModifiedMs) {
+        beginResetModel();
+        m_rows = cached->rows;
+        // 文件内容可能已经改变（不影响目录的修改时间），大小和时间重新读取
+        for (Row &row : m_rows) {
+            row.size = -1;
+            row.modifiedMs = -1;
+        }
+        endResetModel();
+        emit countChanged();
+        m_cacheOrder.removeOne(subPath);
+        m_cacheOrder.append(subPath);
+        setLoading(false);
+        resolveLastCommits(subPath, generation);
+        return true;
+    }
+
+    beginResetModel();
+    m_rows.clear();
+    endResetModel();
+    emit countChanged();
+    setLoading(true);
+
+    GitPathTable *pathTable = m_pathTable;
+    QPointer<RepoFileModel> self(this);
+    QFuture<void> future = QtConcurrent::run([self, pathTable, fullPath, subPath, generation, dirModifiedMs]() {
+        QElapsedTimer timer;
+        timer.start();
+
+        // 只枚举名称和类型，不读取大小和时间
+        struct Listed {
+            QString name;
+            bool isDir;
+        };
+        QList<Listed> listed;
+        QDirIterator it(fullPath, QDir::AllEntries | QDir::NoDotAndDotDot);
+        while (it.hasNext()) {
+            it.next();
+            QString name = it.fileName();
+            // Skip .git folder
+            if (name == ".git") continue;
+            listed.append({name, it.fileInfo().isDir()});
+        }
+
+        // 目录在前，名称不区分大小写（"README" 与 "a.txt" 按字母顺序排列）；只差大小写时再区分，保证顺序稳定
+        std::sort(listed.begin(), listed.end(), [](const Listed &a, const Listed &b) {
+            if (a.isDir != b.isDir) {
+                return a.isDir;
+            }
+            const int order = QString::compare(a.name, b.name, Qt::CaseInsensitive);
+            return order != 0 ? order < 0 : a.name < b.name;
+        });
+
+        QList<Row> rows;
+        rows.reserve(listed.size());
+        for (const Listed &entry : listed) {
+            Row row;
+            row.path = GitPathRef(pathTable, subPath.isEmpty() ? entry.name : subPath + "/" + entry.name);
+            row.isDir = entry.isDir;
+            rows.append(row);
+        }
+
+        qDebug() << "Listed" << rows.size() << "entries in" << fullPath << "in" << timer.elapsed() << "ms";
+
+        // 分块送到 GUI 线程，避免一次插入几万行阻塞界面
+        qsizetype start = 0;
+        do {
+            const qsizetype length = qMin<qsizetype>(ChunkSize, rows.size() - start);
+            const bool last = start + length >= rows.size();
+            QList<Row> chunk = rows.mid(start, length);
+            QMetaObject::invokeMethod(self.data(), [self, generation, chunk, last, subPath, dirModifiedMs]() {
+                if (self) {
+                    self->appendRows(generation, chunk, last, subPath, dirModifiedMs);
+                }
+            }, Qt::QueuedConnection);
+            start += length;
+        } while (start < rows.size());
+    });
+    return true;
+}
+
+void RepoFileModel::appendRows(int generation, const QList<Row> &rows, bool last, const QString &subPath, qint64 dirModifiedMs)
+{
+    if (generation != m_generation) {
+        return;
+    }
+
+    if (!rows.isEmpty()) {
+        beginInsertRows(QModelIndex(), int(m_rows.size()), int(m_rows.size() + rows.size() - 1));
+        m_rows += rows;
+        endInsertRows();
+        emit countChanged();
+    }
+
+    if (last) {
+        cacheListing(subPath, m_rows, dirModifiedMs);
+        setLoading(false);
+        resolveLastCommits(subPath, generation);
+    }
+}
+
+void RepoFileModel::resolveLastCommits(const QString &subPath, int generation)
+{
+    QString repoPath = m_repoPath;
+    QPointer<RepoFileModel> self(this);
+    QFuture<void> future = GitOperationQueue::forRepo(repoPath)->run(GitOperationQueue::Read, [self, repoPath, subPath, generation]() {
+        QHash<QString, GitLastCommit> commits = GitLastCommitEngine::forRepo(repoPath)->resolve("HEAD", subPath);
+        QMetaObject::invokeMethod(self.data(), [self, generation, commits]() {
+            if (!self || generation != self->m_generation) {
+                return;
+            }
+            self->m_lastCommits = commits;
+            if (!self->m_rows.isEmpty()) {
+                emit self->dataChanged(self->index(0), self->index(int(self->m_rows.size()) - 1),
+                                       {CommitMsgRole, CommitTimeRelativeRole, CommitTimeFullRole});
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void RepoFileModel::cacheListing(const QString &subPath, const QList<Row> &rows, qint64 dirModifiedMs)
+{
+    m_cache.insert(subPath, CachedListing{rows, dirModifiedMs});
+    m_cacheOrder.removeOne(subPath);
+    m_cacheOrder.append(subPath);
+    while (m_cacheOrder.size() > CacheLimit) {
+        m_cache.remove(m_cacheOrder.takeFirst());
+    }
+}
+
+void RepoFileModel::clear()
+{
+    ++m_generation;
+    beginResetModel();
+    m_rows.clear();
+    endResetModel();
+    emit countChanged();
+    m_cache.clear();
+    m_cacheOrder.clear();
+    m_fileStatus.clear();
+    m_dirtyDirs.clear();
+    m_lastCommits.clear();
+    setLoading(false);
+}
+
+void RepoFileModel::setStatusEntries(const QList<StatusEntry> &changedFiles, const QList<StatusEntry> &stagedFiles)
+{
+    if (!m_pathTable) {
+        return;
+    }
+
+    m_fileStatus.clear();
+    m_dirtyDirs.clear();
+
+    auto addEntry = [this](const StatusEntry &entry) {
+        if (entry.path.isNull()) {
+            return;
+        }
+        m_fileStatus.insert(entry.path.id, entry.status);
+
+        // 所有上级目录都标记为有改动（目录路径同样驻留在路径表中，按 id 比较）
+        QByteArrayView path = entry.path.table->utf8Path(entry.path.id);
+        for (qsizetype slash = path.indexOf('/'); slash > 0; slash = path.indexOf('/', slash + 1)) {
+            m_dirtyDirs.insert(m_pathTable->intern(path.first(slash)));
+        }
+    };
+    // 同一个文件既有暂存又有未暂存改动时，显示工作区中的状态
+    for (const StatusEntry &entry : stagedFiles) {
+        addEntry(entry);
+    }
+    for (const StatusEntry &entry : changedFiles) {
+        addEntry(entry);
+    }
+
+    if (!m_rows.isEmpty()) {
+        emit dataChanged(index(0), index(int(m_rows.size()) - 1), {StatusRole});
+    }
+}
+
+void RepoFileModel::setLoading(bool loading)
+{
+    if (m_loading != loading) {
+        m_loading = loading;
+        emit loadingChanged();
+    }
+}
@@ -0,0 +1,105 @@
+#ifndef REPOFILEMODEL_H
+#define REPOFILEMODEL_H
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <qqml.h>
+#include "gitentries.h"
+#include "gitlastcommit.h"
+
+// 本地工作区的目录浏览模型
+// 以前 loadRepoFiles 在 GUI 线程上同步调用 entryInfoList，并为每一项读取大小和修改时间，
+// 几万个条目的目录会让界面卡住。现在：
+// - 在工作线程中只枚举名称和类型，排好序后分块插入模型
+// - 大小、修改时间在视图第一次读取该行时才 stat，结果缓存在行中
+// - 每行的 git 状态（status 角色）从当前的状态列表按路径 id 关联，目录只要包含改动就标记
+// - 最近浏览过的目录保留在缓存中，返回上级时目录没有变化就直接复用
+// - 列出后在后台计算每个条目最后一次提交（GitLastCommitEngine，HEAD 上一次历史遍历）
+class RepoFileModel : public QAbstractListModel
+{
+    Q_OBJECT
+    QML_ELEMENT
+    QML_UNCREATABLE("由 GitManager.repoFiles 提供")
+    Q_PROPERTY(bool loading READ isLoading NOTIFY loadingChanged)
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+
+public:
+    enum Roles {
+        PathRole = Qt::UserRole + 1,
+        NameRole,
+        IsDirRole,
+        TypeRole,
+        SizeRole,
+        SizeStrRole,
+        ModifiedRole,
+        StatusRole,
+        CommitMsgRole,
+        CommitTimeRelativeRole,
+        CommitTimeFullRole
+    };
+
+    explicit RepoFileModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    bool isLoading() const { return m_loading; }
+
+    // 切换或关闭仓库时清空列表、目录缓存和状态标记
+    void setRepoPath(const QString &repoPath);
+
+    // 列出仓库中的 subPath 目录（异步）；目录不存在时返回 false
+    bool load(const QString &subPath);
+
+    // 状态列表更新后重新关联每行的状态标记
+    void setStatusEntries(const QList<StatusEntry> &changedFiles, const QList<StatusEntry> &stagedFiles);
+
+signals:
+    void loadingChanged();
+    void countChanged();
+
+private:
+    struct Row {
+        GitPathRef path;
+        bool isDir = false;
+        // 延迟读取：-1 表示尚未 stat
+        mutable qint64 size = -1;
+        mutable qint64 modifiedMs = -1;
+    };
+
+    struct CachedListing {
+        QList<Row> rows;
+        qint64 dirModifiedMs = 0;
+    };
+
+    void ensureStat(const Row &row) const;
+    QString statusFor(const Row &row) const;
+    void appendRows(int generation, const QList<Row> &rows, bool last, const QString &subPath, qint64 dirModifiedMs);
+    void setLoading(bool loading);
+    void cacheListing(const QString &subPath, const QList<Row> &rows, qint64 dirModifiedMs);
+    void clear();
+    void resolveLastCommits(const QString &subPath, int generation);
+
+    static constexpr int ChunkSize = 2000;
+    static constexpr int CacheLimit = 16;
+
+    QString m_repoPath;
+    GitPathTable *m_pathTable = nullptr;
+    QList<Row> m_rows;
+    bool m_loading = false;
+    int m_generation = 0;
+
+    QHash<QString, CachedListing> m_cache;
+    QStringList m_cacheOrder;  // 最近使用的在末尾
+
+    QHash<QString, GitLastCommit> m_lastCommits;  // 当前目录中条目名 -> 最后一次提交
+
+    QHash<quint32, StatusEntry::Status> m_fileStatus;
+    QSet<quint32> m_dirtyDirs;
+};
+
+#endif // REPOFILEMODEL_H
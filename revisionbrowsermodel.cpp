@@ -0,0 +1,316 @@
+#include "revisionbrowsermodel.h"
+#include "gitencoding.h"
+#include "gitoperationqueue.h"
+#include <QDebug>
+#include <QPointer>
+#include <algorithm>
+
+RevisionBrowserModel::RevisionBrowserModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int RevisionBrowserModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return int(m_rows.size());
+}
+
+QVariant RevisionBrowserModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size()) {
+        return QVariant();
+    }
+    const Row &row = m_rows.at(index.row());
+
+    switch (role) {
+    case Qt::DisplayRole:
+    case NameRole:
+        return row.item.name;
+    case PathRole:
+        return row.path;
+    case IsDirRole:
+        return row.item.isDir();
+    case TypeRole:
+        return row.item.type == TreeEntry::Tree ? QStringLiteral("tree")
+             : row.item.type == TreeEntry::Submodule ? QStringLiteral("commit")
+             : QStringLiteral("blob");
+    case SizeRole:
+        return row.item.size;
+    case DepthRole:
+        return row.depth;
+    case ExpandedRole:
+        return row.expanded;
+    case LoadingRole:
+        return row.loading;
+    case OidRole:
+        return row.item.oid;
+    }
+    return QVariant();
+}
+
+QHash<int, QByteArray> RevisionBrowserModel::roleNames() const
+{
+    return {
+        {NameRole, "name"},
+        {PathRole, "path"},
+        {IsDirRole, "isDir"},
+        {TypeRole, "type"},
+        {SizeRole, "size"},
+        {DepthRole, "depth"},
+        {ExpandedRole, "expanded"},
+        {LoadingRole, "loading"},
+        {OidRole, "oid"}
+    };
+}
+
+void RevisionBrowserModel::setRepoPath(const QString &repoPath)
+{
+    if (repoPath == m_repoPath) {
+        return;
+    }
+    clear();
+    m_repoPath = repoPath;
+}
+
+void RevisionBrowserModel::open(const QString &revision)
+{
+    const QString rev = revision.trimmed();
+    if (m_repoPath.isEmpty() || rev.isEmpty()) {
+        return;
+    }
+
+    clear();
+    m_revision = rev;
+    emit revisionChanged();
+    setLoading(true);
+
+    const int generation = m_generation;
+    QString repoPath = m_repoPath;
+    QPointer<RevisionBrowserModel> self(this);
+    QFuture<void> future = GitOperationQueue::forRepo(repoPath)->run(GitOperationQueue::Read, [self, repoPath, rev, generation]() {
+        GitObjectCache *cache = GitObjectCache::forRepo(repoPath);
+        QString commitHash;
+        QString treeOid;
+        QString error;
+        QList<GitTreeItem> items;
+        if (cache->resolveRevision(rev, &commitHash, &treeOid, &error)) {
+            items = cache->tree(treeOid, &error);
+        }
+        QMetaObject::invokeMethod(self.data(), [self, generation, commitHash, items, error]() {
+            if (!self || generation != self->m_generation) {
+                return;
+            }
+            self->m_commitHash = commitHash;
+            emit self->revisionChanged();
+            self->setError(error);
+            self->insertChildren(-1, items);
+            self->setLoading(false);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void RevisionBrowserModel::toggle(int row)
+{
+    if (row < 0 || row >= m_rows.size() || !m_rows[row].item.isDir() || m_rows[row].loading) {
+        return;
+    }
+    if (m_rows[row].expanded) {
+        collapse(row);
+        return;
+    }
+
+    // 没有变化的目录在其他版本中已经读取过，直接展开
+    QList<GitTreeItem> items;
+    GitObjectCache *cache = GitObjectCache::forRepo(m_repoPath);
+    if (cache->lookupTree(m_rows[row].item.oid, &items)) {
+        insertChildren(row, items);
+        return;
+    }
+
+    m_rows[row].loading = true;
+    emit dataChanged(index(row), index(row), {LoadingRole});
+
+    const int generation = m_generation;
+    const QString treeOid = m_rows[row].item.oid;
+    const QString path = m_rows[row].path;
+    const int depth = m_rows[row].depth;
+    QPointer<RevisionBrowserModel> self(this);
+    QFuture<void> future = GitOperationQueue::forRepo(m_repoPath)->run(GitOperationQueue::Read, [self, cache, treeOid, path, depth, generation]() {
+        QString error;
+        QList<GitTreeItem> items = cache->tree(treeOid, &error);
+        QMetaObject::invokeMethod(self.data(), [self, generation, path, depth, items, error]() {
+            if (!self || generation != self->m_generation) {
+                return;
+            }
+            // 读取期间上级目录可能被折叠或展开过，按路径重新定位
+            int row = self->findRow(path, depth);
+            if (row < 0) {
+                return;
+            }
+            self->m_rows[row].loading = false;
+            emit self->dataChanged(self->index(row), self->index(row), {LoadingRole});
+            self->setError(error);
+            if (error.isEmpty()) {
+                self->insertChildren(row, items);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void RevisionBrowserModel::preview(int row)
+{
+    if (row < 0 || row >= m_rows.size()) {
+        return;
+    }
+    const Row &entry = m_rows.at(row);
+    if (entry.item.isDir()) {
+        toggle(row);
+        return;
+    }
+    if (entry.item.type != TreeEntry::Blob) {
+        return;
+    }
+
+    const int generation = ++m_previewGeneration;
+    GitObjectCache *cache = GitObjectCache::forRepo(m_repoPath);
+    GitBlobPreview cached;
+    if (cache->lookupBlob(entry.item.oid, &cached)) {
+        showPreview(entry.path, cached);
+        return;
+    }
+
+    m_previewPath = entry.path;
+    m_previewContent.clear();
+    m_preview = GitBlobPreview();
+    m_previewLoading = true;
+    emit previewChanged();
+
+    const QString blobOid = entry.item.oid;
+    const qint64 size = entry.item.size;
+    const QString path = entry.path;
+    QPointer<RevisionBrowserModel> self(this);
+    QFuture<void> future = GitOperationQueue::forRepo(m_repoPath)->run(GitOperationQueue::Read, [self, cache, blobOid, size, path, generation]() {
+        QString error;
+        GitBlobPreview preview = cache->blob(blobOid, size, &error);
+        QMetaObject::invokeMethod(self.data(), [self, generation, path, preview, error]() {
+            if (!self || generation != self->m_previewGeneration) {
+                return;
+            }
+            self->setError(error);
+            self->showPreview(path, preview);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void RevisionBrowserModel::closePreview()
+{
+    ++m_previewGeneration;
+    m_previewPath.clear();
+    m_previewContent.clear();
+    m_preview = GitBlobPreview();
+    m_previewLoading = false;
+    emit previewChanged();
+}
+
+void RevisionBrowserModel::insertChildren(int parentRow, const QList<GitTreeItem> &items)
+{
+    const int depth = parentRow < 0 ? 0 : m_rows[parentRow].depth + 1;
+    const QString prefix = parentRow < 0 ? QString() : m_rows[parentRow].path + "/";
+    if (parentRow >= 0) {
+        m_rows[parentRow].expanded = true;
+        emit dataChanged(index(parentRow), index(parentRow), {ExpandedRole});
+    }
+    if (items.isEmpty()) {
+        return;
+    }
+
+    QList<Row> rows;
+    rows.reserve(items.size());
+    for (const GitTreeItem &item : items) {
+        Row row;
+        row.item = item;
+        row.path = prefix + item.name;
+        row.depth = depth;
+        rows.append(row);
+    }
+
+    const int first = parentRow + 1;
+    beginInsertRows(QModelIndex(), first, first + int(rows.size()) - 1);
+    m_rows.insert(first, rows.size(), Row());
+    std::move(rows.begin(), rows.end(), m_rows.begin() + first);
+    endInsertRows();
+    emit countChanged();
+}
+
+void RevisionBrowserModel::collapse(int row)
+{
+    const int depth = m_rows[row].depth;
+    int last = row;
+    while (last + 1 < m_rows.size() && m_rows[last + 1].depth > depth) {
+        last++;
+    }
+
+    m_rows[row].expanded = false;
+    emit dataChanged(index(row), index(row), {ExpandedRole});
+    if (last > row) {
+        beginRemoveRows(QModelIndex(), row + 1, last);
+        m_rows.remove(row + 1, last - row);
+        endRemoveRows();
+        emit countChanged();
+    }
+}
+
+int RevisionBrowserModel::findRow(const QString &path, int depth) const
+{
+    for (int i = 0; i < m_rows.size(); i++) {
+        if (m_rows[i].depth == depth && m_rows[i].path == path) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void RevisionBrowserModel::showPreview(const QString &path, const GitBlobPreview &preview)
+{
+    m_previewPath = path;
+    m_preview = preview;
+    m_previewContent = preview.binary ? QString() : GitEncoding::decode(preview.data);
+    m_previewLoading = false;
+    emit previewChanged();
+}
+
+void RevisionBrowserModel::setLoading(bool loading)
+{
+    if (m_loading != loading) {
+        m_loading = loading;
+        emit loadingChanged();
+    }
+}
+
+void RevisionBrowserModel::setError(const QString &error)
+{
+    if (m_error != error) {
+        m_error = error;
+        emit errorChanged();
+    }
+}
+
+void RevisionBrowserModel::clear()
+{
+    ++m_generation;
+    beginResetModel();
+    m_rows.clear();
+    endResetModel();
+    emit countChanged();
+    if (!m_revision.isEmpty() || !m_commitHash.isEmpty()) {
+        m_revision.clear();
+        m_commitHash.clear();
+        emit revisionChanged();
+    }
+    setError(QString());
+    setLoading(false);
+    closePreview();
+}
@@ -0,0 +1,112 @@
+#ifndef REVISIONBROWSERMODEL_H
+#define REVISIONBROWSERMODEL_H
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QString>
+#include <qqml.h>
+#include "gitobjectcache.h"
+
+// 版本浏览器：浏览任意提交、分支或标签中的文件，不检出任何内容
+// 远程文件浏览固定在 origin/<当前分支>；这里可以打开历史中的任意版本。
+// - 目录树展开为一维列表（depth 表示缩进层级），展开目录时才读取该目录的树对象
+// - 树和文件内容通过 GitObjectCache 按对象 id 缓存，不同版本之间没有变化的目录不再读取
+// - 文件预览流式读取前 1 MB，二进制文件只显示大小
+class RevisionBrowserModel : public QAbstractListModel
+{
+    Q_OBJECT
+    QML_ELEMENT
+    QML_UNCREATABLE("由 GitManager.revisionBrowser 提供")
+    Q_PROPERTY(QString revision READ revision NOTIFY revisionChanged)
+    Q_PROPERTY(QString commitHash READ commitHash NOTIFY revisionChanged)
+    Q_PROPERTY(bool loading READ isLoading NOTIFY loadingChanged)
+    Q_PROPERTY(QString error READ error NOTIFY errorChanged)
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+    Q_PROPERTY(QString previewPath READ previewPath NOTIFY previewChanged)
+    Q_PROPERTY(QString previewContent READ previewContent NOTIFY previewChanged)
+    Q_PROPERTY(qint64 previewSize READ previewSize NOTIFY previewChanged)
+    Q_PROPERTY(bool previewBinary READ previewBinary NOTIFY previewChanged)
+    Q_PROPERTY(bool previewTruncated READ previewTruncated NOTIFY previewChanged)
+    Q_PROPERTY(bool previewLoading READ previewLoading NOTIFY previewChanged)
+
+public:
+    enum Roles {
+        NameRole = Qt::UserRole + 1,
+        PathRole,
+        IsDirRole,
+        TypeRole,
+        SizeRole,
+        DepthRole,
+        ExpandedRole,
+        LoadingRole,
+        OidRole
+    };
+
+    explicit RevisionBrowserModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    QString revision() const { return m_revision; }
+    QString commitHash() const { return m_commitHash; }
+    bool isLoading() const { return m_loading; }
+    QString error() const { return m_error; }
+    QString previewPath() const { return m_previewPath; }
+    QString previewContent() const { return m_previewContent; }
+    qint64 previewSize() const { return m_preview.size; }
+    bool previewBinary() const { return m_preview.binary; }
+    bool previewTruncated() const { return m_preview.truncated; }
+    bool previewLoading() const { return m_previewLoading; }
+
+    // 切换或关闭仓库时清空
+    void setRepoPath(const QString &repoPath);
+
+    // 打开一个版本（提交 hash、分支、标签或任何 rev-parse 能识别的写法），显示根目录
+    Q_INVOKABLE void open(const QString &revision);
+    // 展开或折叠目录；第一次展开时读取树对象
+    Q_INVOKABLE void toggle(int row);
+    // 预览文件内容
+    Q_INVOKABLE void preview(int row);
+    Q_INVOKABLE void closePreview();
+
+signals:
+    void revisionChanged();
+    void loadingChanged();
+    void errorChanged();
+    void countChanged();
+    void previewChanged();
+
+private:
+    struct Row {
+        GitTreeItem item;
+        QString path;
+        int depth = 0;
+        bool expanded = false;
+        bool loading = false;
+    };
+
+    void insertChildren(int parentRow, const QList<GitTreeItem> &items);
+    void collapse(int row);
+    int findRow(const QString &path, int depth) const;
+    void showPreview(const QString &path, const GitBlobPreview &preview);
+    void setLoading(bool loading);
+    void setError(const QString &error);
+    void clear();
+
+    QString m_repoPath;
+    QString m_revision;
+    QString m_commitHash;
+    QList<Row> m_rows;
+    bool m_loading = false;
+    QString m_error;
+    int m_generation = 0;  // 每次打开新版本递增，丢弃过期的异步结果
+
+    QString m_previewPath;
+    QString m_previewContent;
+    GitBlobPreview m_preview;
+    bool m_previewLoading = false;
+    int m_previewGeneration = 0;
+};
+
+#endif // REVISIONBROWSERMODEL_H
@@ -0,0 +1,329 @@
+#include "sidebysidediffmodel.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QtConcurrent>
+#include <climits>
+
+namespace {
+
+// 同一内容的新增行很多时（空行、"}"）只检查前面这些候选位置
+constexpr int kMaxMoveCandidates = 64;
+
+// 字母数字的个数；非 ASCII 字节（汉字等）也算
+int alnumCount(QByteArrayView text)
+{
+    int count = 0;
+    for (char c : text) {
+        const uchar u = uchar(c);
+        if (u >= 0x80 || (u >= '0' && u <= '9') || (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z')) {
+            count++;
+        }
+    }
+    return count;
+}
+
+} // namespace
+
+SideBySideDiffModel::SideBySideDiffModel(DiffModel *source, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_source(source)
+{
+    connect(source, &QAbstractItemModel::modelReset, this, &SideBySideDiffModel::reset);
+    connect(source, &QAbstractItemModel::rowsInserted, this, [this]() {
+        layoutRows(!m_source->isLoading());
+    });
+    connect(source, &QAbstractItemModel::dataChanged, this, &SideBySideDiffModel::sourceDataChanged);
+    connect(source, &DiffModel::loadingChanged, this, [this]() {
+        if (!m_source->isLoading()) {
+            layoutRows(true);
+            findMovedBlocks();
+        }
+    });
+}
+
+int SideBySideDiffModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return int(m_rows.size());
+}
+
+QVariant SideBySideDiffModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size() || !m_source) {
+        return QVariant();
+    }
+    const Row &row = m_rows.at(index.row());
+    return sideData(role < NewTypeRole ? row.oldRow : row.newRow, role, role < NewTypeRole);
+}
+
+QHash<int, QByteArray> SideBySideDiffModel::roleNames() const
+{
+    return {
+        {OldTypeRole, "oldType"},
+        {OldLineNumRole, "oldLineNum"},
+        {OldContentRole, "oldContent"},
+        {OldSpansRole, "oldSpans"},
+        {OldMovedRole, "oldMoved"},
+        {NewTypeRole, "newType"},
+        {NewLineNumRole, "newLineNum"},
+        {NewContentRole, "newContent"},
+        {NewSpansRole, "newSpans"},
+        {NewMovedRole, "newMoved"}
+    };
+}
+
+QVariant SideBySideDiffModel::sideData(int sourceRow, int role, bool oldSide) const
+{
+    const int sideRole = oldSide ? role : role - (NewTypeRole - OldTypeRole);
+    if (sourceRow < 0) {
+        switch (sideRole) {
+        case OldTypeRole:
+            return QStringLiteral("filler");
+        case OldLineNumRole:
+            return 0;
+        case OldContentRole:
+            return QString();
+        case OldSpansRole:
+            return QVariantList();
+        case OldMovedRole:
+            return false;
+        }
+        return QVariant();
+    }
+
+    const QModelIndex index = m_source->index(sourceRow);
+    switch (sideRole) {
+    case OldTypeRole:
+        return m_source->data(index, DiffModel::TypeRole);
+    case OldLineNumRole:
+        return m_source->data(index, oldSide ? DiffModel::OldLineRole : DiffModel::NewLineRole);
+    case OldContentRole:
+        return m_source->data(index, DiffModel::ContentRole);
+    case OldSpansRole:
+        return m_source->data(index, DiffModel::SpansRole);
+    case OldMovedRole:
+        return sourceRow < m_moved.size() && m_moved.testBit(sourceRow);
+    }
+    return QVariant();
+}
+
+void SideBySideDiffModel::reset()
+{
+    ++m_generation;
+    beginResetModel();
+    m_rows.clear();
+    m_rowOfSource.clear();
+    m_cursor = 0;
+    m_runStart = -1;
+    m_moved.clear();
+    endResetModel();
+    emit countChanged();
+
+    // 重置时已有的行（不会发生 rowsInserted）
+    if (m_source && m_source->rowCount() > 0) {
+        layoutRows(!m_source->isLoading());
+    }
+}
+
+void SideBySideDiffModel::layoutRows(bool finished)
+{
+    if (!m_source) {
+        return;
+    }
+    const int count = m_source->rowCount();
+    m_rowOfSource.resize(count, -1);
+
+    QList<Row> rows;
+    auto place = [&](int oldRow, int newRow) {
+        const qint32 row = qint32(m_rows.size() + rows.size());
+        rows.append({oldRow, newRow});
+        if (oldRow >= 0) m_rowOfSource[oldRow] = row;
+        if (newRow >= 0) m_rowOfSource[newRow] = row;
+    };
+    // 一段删除行和紧随其后的新增行按顺序配对，较短的一边补空行
+    auto placeRun = [&]() {
+        if (m_runStart < 0) return;
+        int firstAdded = m_runStart;
+        while (firstAdded < m_cursor && m_source->lineAt(firstAdded).type == GitDiffLine::Delete) {
+            firstAdded++;
+        }
+        const int deleted = firstAdded - m_runStart;
+        const int added = m_cursor - firstAdded;
+        for (int k = 0; k < qMax(deleted, added); k++) {
+            place(k < deleted ? m_runStart + k : -1, k < added ? firstAdded + k : -1);
+        }
+        m_runStart = -1;
+    };
+
+    for (; m_cursor < count; m_cursor++) {
+        const GitDiffLine::Type type = m_source->lineAt(m_cursor).type;
+        if (type == GitDiffLine::Delete) {
+            // 新增行之后又是删除行：前一段结束
+            if (m_runStart >= 0 && m_source->lineAt(m_cursor - 1).type == GitDiffLine::Add) {
+                placeRun();
+            }
+            if (m_runStart < 0) m_runStart = m_cursor;
+        } else if (type == GitDiffLine::Add) {
+            if (m_runStart < 0) m_runStart = m_cursor;
+        } else {
+            placeRun();
+            place(m_cursor, m_cursor);
+        }
+    }
+    // 还在加载时最后一段可能不完整，等后面的行
+    if (finished) {
+        placeRun();
+    }
+
+    if (rows.isEmpty()) {
+        return;
+    }
+    const int first = int(m_rows.size());
+    beginInsertRows(QModelIndex(), first, first + int(rows.size()) - 1);
+    m_rows.append(rows);
+    endInsertRows();
+    emit countChanged();
+}
+
+void SideBySideDiffModel::sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight,
+                                            const QList<int> &roles)
+{
+    // 配对的行在两边的顺序不同，取范围内所有行对应的并排行的最小最大值
+    const int last = qMin(bottomRight.row(), int(m_rowOfSource.size()) - 1);
+    int low = INT_MAX;
+    int high = -1;
+    for (int row = topLeft.row(); row <= last; row++) {
+        const int mapped = m_rowOfSource[row];
+        if (mapped >= 0) {
+            low = qMin(low, mapped);
+            high = qMax(high, mapped);
+        }
+    }
+    if (high < 0) {
+        return;
+    }
+
+    QList<int> mappedRoles;
+    if (roles.contains(DiffModel::ContentRole)) {
+        mappedRoles << OldContentRole << NewContentRole;
+    }
+    if (roles.contains(DiffModel::SpansRole)) {
+        mappedRoles << OldSpansRole << NewSpansRole;
+    }
+    if (!roles.isEmpty() && mappedRoles.isEmpty()) {
+        return;
+    }
+    emit dataChanged(index(low), index(high), mappedRoles);
+}
+
+void SideBySideDiffModel::findMovedBlocks()
+{
+    if (!m_source || m_source->rowCount() == 0) {
+        return;
+    }
+    // 页是隐式共享的，复制到后台不拷贝内容
+    const QList<DiffModel::Page> pages = m_source->pages();
+    const int generation = m_generation;
+    QPointer<SideBySideDiffModel> self(this);
+    QFuture<void> future = QtConcurrent::run([self, generation, pages]() {
+        QElapsedTimer timer;
+        timer.start();
+
+        // 删除 / 新增行（忽略首尾空白）；run 为所在的修改段，同一段中的删除和新增是原地修改，不算移动
+        struct Changed {
+            int row;
+            int run;
+            QByteArrayView text;
+        };
+        QList<Changed> deleted;
+        QList<Changed> added;
+        int rows = 0;
+        int run = 0;
+        for (const DiffModel::Page &page : pages) {
+            for (const DiffModel::Line &line : page.lines) {
+                const QByteArrayView text = QByteArrayView(page.bytes).sliced(line.offset, line.length).trimmed();
+                if (line.type == GitDiffLine::Delete) {
+                    deleted.append({rows, run, text});
+                } else if (line.type == GitDiffLine::Add) {
+                    added.append({rows, run, text});
+                } else {
+                    run++;
+                }
+                rows++;
+            }
+        }
+
+        QHash<QByteArrayView, QList<qsizetype>> addedAt;
+        for (qsizetype j = 0; j < added.size(); j++) {
+            if (alnumCount(added[j].text) > 0) {
+                addedAt[added[j].text].append(j);
+            }
+        }
+
+        QBitArray moved(rows);
+        QList<bool> used(added.size(), false);
+        int blocks = 0;
+        for (qsizetype i = 0; i < deleted.size();) {
+            const Changed &start = deleted[i];
+            qsizetype bestStart = -1;
+            qsizetype bestLength = 0;
+            const auto it = addedAt.constFind(start.text);
+            if (it != addedAt.constEnd()) {
+                const QList<qsizetype> &candidates = it.value();
+                for (qsizetype c = 0; c < qMin<qsizetype>(candidates.size(), kMaxMoveCandidates); c++) {
+                    const qsizetype j = candidates[c];
+                    // 两边都必须是连续的行（不跨块），新增的一边不能已经被别的块使用
+                    qsizetype length = 0;
+                    while (i + length < deleted.size() && j + length < added.size()
+                           && deleted[i + length].row == start.row + length
+                           && added[j + length].row == added[j].row + length
+                           && added[j + length].run != start.run && !used[j + length]
+                           && deleted[i + length].text == added[j + length].text) {
+                        length++;
+                    }
+                    if (length > bestLength) {
+                        bestLength = length;
+                        bestStart = j;
+                    }
+                }
+            }
+
+            int alnum = 0;
+            for (qsizetype k = 0; k < bestLength; k++) {
+                alnum += alnumCount(deleted[i + k].text);
+            }
+            if (bestLength < SideBySideDiffModel::MinMovedLines || alnum < SideBySideDiffModel::MinMovedAlnum) {
+                i++;
+                continue;
+            }
+            for (qsizetype k = 0; k < bestLength; k++) {
+                moved.setBit(deleted[i + k].row);
+                moved.setBit(added[bestStart + k].row);
+                used[bestStart + k] = true;
+            }
+            blocks++;
+            i += bestLength;
+        }
+        qDebug() << "Side-by-side diff:" << blocks << "moved blocks among" << deleted.size() << "deleted and"
+                 << added.size() << "added lines in" << timer.elapsed() << "ms";
+
+        QMetaObject::invokeMethod(self.data(), [self, generation, moved]() {
+            if (self) {
+                self->applyMoved(generation, moved);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void SideBySideDiffModel::applyMoved(int generation, const QBitArray &moved)
+{
+    if (generation != m_generation) {
+        return;
+    }
+    m_moved = moved;
+    if (m_moved.count(true) > 0 && !m_rows.isEmpty()) {
+        emit dataChanged(index(0), index(int(m_rows.size()) - 1), {OldMovedRole, NewMovedRole});
+    }
+}